@@ -0,0 +1,1006 @@
+/*
+  =======================================================================
+  This file is part of Minimal (mnml) - A *.mini source to C compiler for
+  the Minimal programming language
+
+  Written in 2025 by approx-error
+
+  Minimal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Minimal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+  ======================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "inc/retcodes.h"
+#include "inc/tokens.h"
+#include "inc/syntax.h"
+#include "inc/parser-utils.h"
+#include "inc/ast.h"
+
+// The most meaningful children any construct has (a subprogram: name, return type, body)
+#define MAX_LOWERED_CHILDREN 4
+
+// Terminals that only delimit constructs. Everything they say is already in the shape of
+// the syntax tree, so they get no AST node
+static const MiniTokenSet PUNCTUATION =
+  TOKEN_BIT(COLON) | TOKEN_BIT(SEMICOLON) | TOKEN_BIT(COMMA) |
+  TOKEN_BIT(LEFT_PAREN) | TOKEN_BIT(RIGHT_PAREN) | TOKEN_BIT(LEFT_BRACKET) | TOKEN_BIT(RIGHT_BRACKET) |
+  TOKEN_BIT(REDIRECT) | TOKEN_BIT(ASSIGN) | TOKEN_BIT(READ_WRITE) | TOKEN_BIT(CALL) |
+  TOKEN_BIT(MAIN_DECLARATION) | TOKEN_BIT(MODULE) | TOKEN_BIT(END_MODULE) | TOKEN_BIT(MAIN) |
+  TOKEN_BIT(END_MAIN) | TOKEN_BIT(FUNC) | TOKEN_BIT(END_FUNC) | TOKEN_BIT(IF) | TOKEN_BIT(ELSE_IF) |
+  TOKEN_BIT(ELSE) | TOKEN_BIT(END_IF) | TOKEN_BIT(SWITCH) | TOKEN_BIT(CASE) | TOKEN_BIT(END_SWITCH) |
+  TOKEN_BIT(LOOP) | TOKEN_BIT(END_LOOP);
+
+static bool is_token(MiniSyntaxTree *node) {
+  return node != NULL && node->data_type == TOKEN;
+}
+
+static bool is_nonterm(MiniSyntaxTree *node, MiniNonTerm name) {
+  return node != NULL && node->data_type == NON_TERMINAL && node->data.non_terminal == name;
+}
+
+static bool is_punctuation(MiniSyntaxTree *node) {
+  return is_token(node) && (PUNCTUATION & TOKEN_BIT(node->data.token.name)) != 0;
+}
+
+// Puts the children of node that aren't punctuation into children, in order. Returns how
+// many there are, or -1 if there are more than MAX_LOWERED_CHILDREN
+static int meaningful_children(MiniSyntaxTree *node, MiniSyntaxTree **children) {
+  int count = 0;
+  for (MiniSyntaxTree *child = node->child; child != NULL; child = child->sibling) {
+    if (is_punctuation(child)) {
+      continue;
+    }
+    if (count == MAX_LOWERED_CHILDREN) {
+      return -1;
+    }
+    children[count++] = child;
+  }
+  return count;
+}
+
+static MiniSyntaxTree *find_token_child(MiniSyntaxTree *node, MiniTokenName name) {
+  for (MiniSyntaxTree *child = node->child; child != NULL; child = child->sibling) {
+    if (is_token(child) && child->data.token.name == name) {
+      return child;
+    }
+  }
+  return NULL;
+}
+
+static MiniStatus unexpected(MiniSyntaxTree *node) {
+  printf("lower_syntax_tree: Error: Unexpected ");
+  if (node == NULL) {
+    printf("end of construct\n");
+  } else {
+    print_construct_category(node->data_type == TOKEN ? (int)node->data.token.category : (int)node->data.non_terminal, node->data_type);
+    printf("\n");
+  }
+  return INVALID_CONSTRUCT;
+}
+
+MiniAstNode *alloc_ast_node(MiniAst *ast, MiniAstKind kind, MiniStatus *status) {
+  MiniAstBlock *block = ast->blocks;
+  if (block == NULL || block->used == MINIMAL_AST_BLOCK_SIZE) {
+    block = malloc(sizeof(MiniAstBlock));
+    if (block == NULL) {
+      printf("alloc_ast_node: Memory Error: Failed to allocate space for AST nodes\n");
+      *status = ALLOCATION_FAIL;
+      return NULL;
+    }
+    block->used = 0;
+    block->next = ast->blocks;
+    ast->blocks = block;
+  }
+  MiniAstNode *node = &block->nodes[block->used++];
+  memset(node, 0, sizeof(MiniAstNode));
+  node->kind = kind;
+  node->op = TOKEN_UNDETERMINED;
+  node->token.name = TOKEN_UNDETERMINED;
+  node->token.category = CATEGORY_UNDETERMINED;
+  ast->node_count++;
+  *status = SUCCESS;
+  return node;
+}
+
+// Copies the token of leaf into node, which takes over its string. Identifiers are interned
+// into node->symbol as well
+static MiniStatus take_token(MiniAstNode *node, MiniSyntaxTree *leaf) {
+  node->token = leaf->data.token;
+  node->token.next_token = NULL;
+  leaf->data.token.string_repr = NULL;
+  if (node->token.category == IDENTIFIER) {
+    return intern_symbol(node->token.string_repr, &node->symbol);
+  }
+  return SUCCESS;
+}
+
+static MiniStatus lower_type(MiniSyntaxTree *type_expr, MiniTypeId *type_id) {
+  if (!is_nonterm(type_expr, TYPE_EXPR) || !is_token(type_expr->child)) {
+    return unexpected(type_expr);
+  }
+  *type_id = type_expr->child->data.token.type_id;
+  return SUCCESS;
+}
+
+static MiniStatus lower_expression(MiniAst *ast, MiniSyntaxTree *node, MiniAstNode **result);
+static MiniStatus lower_sequence(MiniAst *ast, MiniSyntaxTree *sequence, MiniAstNode **first);
+
+static MiniStatus lower_operand(MiniAst *ast, MiniSyntaxTree *leaf, MiniAstNode **result) {
+  MiniAstKind kind = leaf->data.token.category == IDENTIFIER ? AST_NAME : AST_LITERAL;
+  MiniStatus status;
+  MiniAstNode *node = alloc_ast_node(ast, kind, &status);
+  if (status != SUCCESS) return status;
+  status = take_token(node, leaf);
+  if (status != SUCCESS) return status;
+  *result = node;
+  return SUCCESS;
+}
+
+// list holds an item, optionally followed by another nested_name non-terminal that holds
+// the rest of the items. The lowered items are linked by next. An item of a DICT is a key
+// and a value, which become an AST_PAIR
+static MiniStatus lower_expression_list(MiniAst *ast, MiniSyntaxTree *list, MiniNonTerm nested_name, MiniAstNode **first) {
+  MiniAstNode **link = first;
+  *first = NULL;
+  while (list != NULL) {
+    MiniSyntaxTree *children[MAX_LOWERED_CHILDREN];
+    int count = meaningful_children(list, children);
+    if (count < 1) return unexpected(list);
+    bool nested = is_nonterm(children[count - 1], nested_name);
+    int items = nested ? count - 1 : count;
+    MiniStatus status;
+    if (nested_name == DICT) {
+      if (items != 2) return unexpected(list);
+      MiniAstNode *pair = alloc_ast_node(ast, AST_PAIR, &status);
+      if (status != SUCCESS) return status;
+      status = lower_expression(ast, children[0], &pair->operands[0]);
+      if (status != SUCCESS) return status;
+      status = lower_expression(ast, children[1], &pair->operands[1]);
+      if (status != SUCCESS) return status;
+      *link = pair;
+    } else {
+      if (items != 1) return unexpected(list);
+      status = lower_expression(ast, children[0], link);
+      if (status != SUCCESS) return status;
+    }
+    link = &(*link)->next;
+    list = nested ? children[count - 1] : NULL;
+  }
+  return SUCCESS;
+}
+
+static MiniStatus lower_call(MiniAst *ast, MiniSyntaxTree *func_call, MiniAstNode **result) {
+  MiniSyntaxTree *children[MAX_LOWERED_CHILDREN];
+  int count = meaningful_children(func_call, children);
+  if (count != 1 || !is_token(children[0])) return unexpected(func_call);
+  MiniStatus status;
+  MiniAstNode *node = alloc_ast_node(ast, AST_CALL, &status);
+  if (status != SUCCESS) return status;
+  status = take_token(node, children[0]);
+  if (status != SUCCESS) return status;
+  // The argument list is the child of the left parenthesis
+  MiniSyntaxTree *paren = find_token_child(func_call, LEFT_PAREN);
+  if (paren != NULL && paren->child != NULL) {
+    if (!is_nonterm(paren->child, ARGUMENT_LIST)) return unexpected(paren->child);
+    status = lower_expression_list(ast, paren->child, ARGUMENT_LIST, &node->list);
+    if (status != SUCCESS) return status;
+  }
+  *result = node;
+  return SUCCESS;
+}
+
+static MiniStatus lower_arithmetic(MiniAst *ast, MiniSyntaxTree *arith, MiniAstNode **result) {
+  MiniSyntaxTree *children[MAX_LOWERED_CHILDREN];
+  int count = meaningful_children(arith, children);
+  MiniStatus status;
+  MiniAstNode *node;
+  switch (count) {
+    case 1:
+      return lower_expression(ast, children[0], result);
+    case 2:
+      if (!is_token(children[0])) return unexpected(children[0]);
+      node = alloc_ast_node(ast, AST_UNARY, &status);
+      if (status != SUCCESS) return status;
+      node->op = children[0]->data.token.name;
+      status = lower_expression(ast, children[1], &node->operands[0]);
+      break;
+    case 3:
+      if (!is_token(children[1])) return unexpected(children[1]);
+      node = alloc_ast_node(ast, AST_BINARY, &status);
+      if (status != SUCCESS) return status;
+      node->op = children[1]->data.token.name;
+      status = lower_expression(ast, children[0], &node->operands[0]);
+      if (status != SUCCESS) return status;
+      status = lower_expression(ast, children[2], &node->operands[1]);
+      break;
+    default:
+      return unexpected(arith);
+  }
+  *result = node;
+  return status;
+}
+
+// Expressions, initial values and everything else that evaluates to a value
+static MiniStatus lower_expression(MiniAst *ast, MiniSyntaxTree *node, MiniAstNode **result) {
+  if (node == NULL) {
+    return unexpected(node);
+  }
+  if (node->data_type == TOKEN) {
+    return lower_operand(ast, node, result);
+  }
+  MiniSyntaxTree *children[MAX_LOWERED_CHILDREN];
+  MiniStatus status;
+  MiniAstNode *collection;
+  switch (node->data.non_terminal) {
+    case PRIMARY_EXPRESSION:
+    case EXPRESSION:
+    case LOGICAL_EXPR:
+    case ARITH_OPERAND:
+      // Parenthesized expressions and wrappers around a single operand
+      if (meaningful_children(node, children) != 1) return unexpected(node);
+      return lower_expression(ast, children[0], result);
+    case ARITHMETIC_EXPR:
+      return lower_arithmetic(ast, node, result);
+    case FUNC_CALL:
+      return lower_call(ast, node, result);
+    case COLLECTION:
+      if (meaningful_children(node, children) != 1) return unexpected(node);
+      if (is_nonterm(children[0], LIST)) {
+        collection = alloc_ast_node(ast, AST_LIST, &status);
+      } else if (is_nonterm(children[0], DICT)) {
+        collection = alloc_ast_node(ast, AST_DICT, &status);
+      } else {
+        return unexpected(children[0]);
+      }
+      if (status != SUCCESS) return status;
+      *result = collection;
+      return lower_expression_list(ast, children[0], children[0]->data.non_terminal, &collection->list);
+    default:
+      return unexpected(node);
+  }
+}
+
+static MiniStatus lower_declaration(MiniAst *ast, MiniSyntaxTree *declaration, MiniAstNode **result) {
+  MiniSyntaxTree *children[MAX_LOWERED_CHILDREN];
+  int count = meaningful_children(declaration, children);
+  if (count < 2 || count > 3 || !is_token(children[1])) return unexpected(declaration);
+  MiniStatus status;
+  MiniAstNode *node = alloc_ast_node(ast, AST_DECLARATION, &status);
+  if (status != SUCCESS) return status;
+  status = lower_type(children[0], &node->type_id);
+  if (status != SUCCESS) return status;
+  status = take_token(node, children[1]);
+  if (status != SUCCESS) return status;
+  if (count == 3) {
+    status = lower_expression(ast, children[2], &node->operands[0]);
+    if (status != SUCCESS) return status;
+  }
+  *result = node;
+  return SUCCESS;
+}
+
+static MiniStatus lower_incrementation(MiniAst *ast, MiniSyntaxTree *incrementation, MiniAstNode **result) {
+  MiniSyntaxTree *children[MAX_LOWERED_CHILDREN];
+  int count = meaningful_children(incrementation, children);
+  if (count < 2 || count > 3 || !is_token(children[0]) || !is_token(children[1])) {
+    return unexpected(incrementation);
+  }
+  MiniStatus status;
+  MiniAstNode *node = alloc_ast_node(ast, AST_INCREMENT, &status);
+  if (status != SUCCESS) return status;
+  // Either the target or the operator comes first
+  int target = children[0]->data.token.category == UNA_ASSIGN_OP ? 1 : 0;
+  node->op = children[1 - target]->data.token.name;
+  status = take_token(node, children[target]);
+  if (status != SUCCESS) return status;
+  if (count == 3) {
+    status = lower_expression(ast, children[2], &node->operands[0]);
+    if (status != SUCCESS) return status;
+  }
+  *result = node;
+  return SUCCESS;
+}
+
+// The statements of an if-block, else-if-block or else-block and whatever follows it
+static MiniStatus lower_if(MiniAst *ast, MiniSyntaxTree *block, MiniAstNode **result) {
+  MiniAstNode **link = result;
+  while (block != NULL) {
+    MiniSyntaxTree *children[MAX_LOWERED_CHILDREN];
+    int count = meaningful_children(block, children);
+    MiniStatus status;
+    MiniAstNode *node;
+    if (is_nonterm(block, ELSE_BLOCK)) {
+      if (count != 1) return unexpected(block);
+      node = alloc_ast_node(ast, AST_ELSE, &status);
+      if (status != SUCCESS) return status;
+      *link = node;
+      return lower_sequence(ast, children[0], &node->list);
+    }
+    if (count < 2 || count > 3) return unexpected(block);
+    node = alloc_ast_node(ast, AST_IF, &status);
+    if (status != SUCCESS) return status;
+    *link = node;
+    status = lower_expression(ast, children[0], &node->operands[0]);
+    if (status != SUCCESS) return status;
+    MiniAstNode *body = alloc_ast_node(ast, AST_BLOCK, &status);
+    if (status != SUCCESS) return status;
+    node->operands[1] = body;
+    status = lower_sequence(ast, children[1], &body->list);
+    if (status != SUCCESS) return status;
+    link = &node->operands[2];
+    block = count == 3 ? children[2] : NULL;
+  }
+  return SUCCESS;
+}
+
+static MiniStatus lower_switch(MiniAst *ast, MiniSyntaxTree *switch_block, MiniAstNode **result) {
+  MiniSyntaxTree *children[MAX_LOWERED_CHILDREN];
+  int count = meaningful_children(switch_block, children);
+  if (count < 2 || count > 3) return unexpected(switch_block);
+  MiniStatus status;
+  MiniAstNode *node = alloc_ast_node(ast, AST_SWITCH, &status);
+  if (status != SUCCESS) return status;
+  *result = node;
+  status = lower_expression(ast, children[0], &node->operands[0]);
+  if (status != SUCCESS) return status;
+  if (count == 3) {
+    MiniAstNode *block = alloc_ast_node(ast, AST_BLOCK, &status);
+    if (status != SUCCESS) return status;
+    node->operands[1] = block;
+    status = lower_sequence(ast, children[1], &block->list);
+    if (status != SUCCESS) return status;
+  }
+
+  MiniAstNode **link = &node->list;
+  MiniSyntaxTree *case_block = children[count - 1];
+  while (case_block != NULL) {
+    if (!is_nonterm(case_block, CASE_BLOCK)) return unexpected(case_block);
+    count = meaningful_children(case_block, children);
+    if (count < 2 || count > 3 || !is_token(children[0])) return unexpected(case_block);
+    MiniAstNode *case_node = alloc_ast_node(ast, AST_CASE, &status);
+    if (status != SUCCESS) return status;
+    status = take_token(case_node, children[0]);
+    if (status != SUCCESS) return status;
+    status = lower_sequence(ast, children[1], &case_node->list);
+    if (status != SUCCESS) return status;
+    *link = case_node;
+    link = &case_node->next;
+    case_block = count == 3 ? children[2] : NULL;
+  }
+  return SUCCESS;
+}
+
+static MiniStatus lower_loop(MiniAst *ast, MiniSyntaxTree *loop, MiniAstNode **result) {
+  MiniSyntaxTree *children[MAX_LOWERED_CHILDREN];
+  int count = meaningful_children(loop, children);
+  MiniStatus status;
+  MiniAstNode *node;
+  if (is_nonterm(loop, FOR_LOOP)) {
+    if (count != 4) return unexpected(loop);
+    node = alloc_ast_node(ast, AST_FOR, &status);
+    if (status != SUCCESS) return status;
+    status = lower_declaration(ast, children[0], &node->operands[0]);
+    if (status != SUCCESS) return status;
+    status = lower_expression(ast, children[1], &node->operands[1]);
+    if (status != SUCCESS) return status;
+    status = lower_incrementation(ast, children[2], &node->operands[2]);
+  } else {
+    if (count != 2) return unexpected(loop);
+    node = alloc_ast_node(ast, AST_WHILE, &status);
+    if (status != SUCCESS) return status;
+    status = lower_expression(ast, children[0], &node->operands[0]);
+  }
+  if (status != SUCCESS) return status;
+  *result = node;
+  return lower_sequence(ast, children[count - 1], &node->list);
+}
+
+static MiniStatus lower_control(MiniAst *ast, MiniSyntaxTree *control, MiniAstNode **result) {
+  MiniSyntaxTree *children[MAX_LOWERED_CHILDREN];
+  int count = meaningful_children(control, children);
+  MiniStatus status;
+  MiniAstNode *node;
+  if (is_nonterm(control, IN_OUT_CTRL)) {
+    if (count != 2) return unexpected(control);
+    node = alloc_ast_node(ast, AST_IO, &status);
+    if (status != SUCCESS) return status;
+    status = lower_expression(ast, children[0], &node->operands[0]);
+    if (status != SUCCESS) return status;
+    status = lower_expression(ast, children[1], &node->operands[1]);
+    if (status != SUCCESS) return status;
+    *result = node;
+    return SUCCESS;
+  }
+  // Flow control
+  if (count < 1 || count > 2 || !is_token(children[0])) return unexpected(control);
+  switch (children[0]->data.token.name) {
+    case BREAK:
+      node = alloc_ast_node(ast, AST_BREAK, &status);
+      break;
+    case CONTINUE:
+      node = alloc_ast_node(ast, AST_CONTINUE, &status);
+      break;
+    case RETURN:
+      node = alloc_ast_node(ast, AST_RETURN, &status);
+      if (status != SUCCESS) return status;
+      if (count == 2) {
+        status = lower_expression(ast, children[1], &node->operands[0]);
+      }
+      break;
+    default:
+      return unexpected(children[0]);
+  }
+  if (status != SUCCESS) return status;
+  *result = node;
+  return SUCCESS;
+}
+
+// A statement or branch, through the non-terminals that only choose between alternatives
+static MiniStatus lower_statement(MiniAst *ast, MiniSyntaxTree *node, MiniAstNode **result) {
+  MiniSyntaxTree *children[MAX_LOWERED_CHILDREN];
+  int count;
+  MiniStatus status;
+  MiniAstNode *assignment;
+  while (node != NULL && node->data_type == NON_TERMINAL) {
+    switch (node->data.non_terminal) {
+      case STATEMENT:
+      case BRANCH:
+      case DESIGNATION:
+      case CONTROL:
+      case LOOP_BLOCK:
+        if (meaningful_children(node, children) != 1) return unexpected(node);
+        node = children[0];
+        break;
+      case DECLARATION:
+        return lower_declaration(ast, node, result);
+      case ASSIGNMENT:
+        count = meaningful_children(node, children);
+        if (count != 2 || !is_token(children[0])) return unexpected(node);
+        assignment = alloc_ast_node(ast, AST_ASSIGNMENT, &status);
+        if (status != SUCCESS) return status;
+        status = take_token(assignment, children[0]);
+        if (status != SUCCESS) return status;
+        *result = assignment;
+        return lower_expression(ast, children[1], &assignment->operands[0]);
+      case INCREMENTATION:
+        return lower_incrementation(ast, node, result);
+      case IN_OUT_CTRL:
+      case FLOW_CTRL:
+        return lower_control(ast, node, result);
+      case FUNC_CALL:
+        return lower_call(ast, node, result);
+      case IF_BLOCK:
+        return lower_if(ast, node, result);
+      case SWITCH_BLOCK:
+        return lower_switch(ast, node, result);
+      case FOR_LOOP:
+      case WHILE_LOOP:
+        return lower_loop(ast, node, result);
+      default:
+        return unexpected(node);
+    }
+  }
+  return unexpected(node);
+}
+
+static MiniStatus lower_sequence(MiniAst *ast, MiniSyntaxTree *sequence, MiniAstNode **first) {
+  MiniAstNode **link = first;
+  *first = NULL;
+  while (sequence != NULL) {
+    if (!is_nonterm(sequence, SEQUENCE)) return unexpected(sequence);
+    MiniSyntaxTree *children[MAX_LOWERED_CHILDREN];
+    int count = meaningful_children(sequence, children);
+    if (count < 1 || count > 2) return unexpected(sequence);
+    MiniStatus status = lower_statement(ast, children[0], link);
+    if (status != SUCCESS) return status;
+    link = &(*link)->next;
+    sequence = count == 2 ? children[1] : NULL;
+  }
+  return SUCCESS;
+}
+
+static MiniStatus lower_parameters(MiniAst *ast, MiniSyntaxTree *first_child, MiniAstNode **first) {
+  MiniAstNode **link = first;
+  MiniSyntaxTree *item = first_child;
+  while (item != NULL) {
+    // item is the type of a parameter, followed by its name and the rest of the list
+    while (is_punctuation(item)) {
+      item = item->sibling;
+    }
+    if (item == NULL) break;
+    MiniSyntaxTree *name = item->sibling;
+    if (!is_token(name)) return unexpected(name);
+    MiniStatus status;
+    MiniAstNode *parameter = alloc_ast_node(ast, AST_PARAMETER, &status);
+    if (status != SUCCESS) return status;
+    status = lower_type(item, &parameter->type_id);
+    if (status != SUCCESS) return status;
+    status = take_token(parameter, name);
+    if (status != SUCCESS) return status;
+    *link = parameter;
+    link = &parameter->next;
+    item = name->sibling;
+    while (is_punctuation(item)) {
+      item = item->sibling;
+    }
+    if (item == NULL) break;
+    if (!is_nonterm(item, PARAM_LIST)) return unexpected(item);
+    item = item->child;
+  }
+  return SUCCESS;
+}
+
+static MiniStatus lower_module_item(MiniAst *ast, MiniSyntaxTree *item, MiniAstNode **result) {
+  MiniSyntaxTree *children[MAX_LOWERED_CHILDREN];
+  int count = meaningful_children(item, children);
+  MiniStatus status;
+  MiniAstNode *node;
+  MiniSyntaxTree *paren;
+  if (item->data_type != NON_TERMINAL) return unexpected(item);
+  switch (item->data.non_terminal) {
+    case IMPORTING:
+      // The imported name is the child of the import keyword
+      if (count != 1 || !is_token(children[0]) || !is_token(children[0]->child)) return unexpected(item);
+      node = alloc_ast_node(ast, AST_IMPORT, &status);
+      if (status != SUCCESS) return status;
+      node->op = children[0]->data.token.name;
+      status = take_token(node, children[0]->child);
+      if (status != SUCCESS) return status;
+      break;
+    case TYPE_ALIASING:
+      if (count != 2 || !is_token(children[1])) return unexpected(item);
+      node = alloc_ast_node(ast, AST_TYPE_ALIAS, &status);
+      if (status != SUCCESS) return status;
+      status = lower_type(children[0], &node->type_id);
+      if (status != SUCCESS) return status;
+      status = take_token(node, children[1]);
+      if (status != SUCCESS) return status;
+      break;
+    case MODULE_DECLARATION:
+      return lower_declaration(ast, item, result);
+    case SUBPROGRAM:
+      if (count != 3 || !is_token(children[0])) return unexpected(item);
+      node = alloc_ast_node(ast, AST_SUBPROGRAM, &status);
+      if (status != SUCCESS) return status;
+      status = take_token(node, children[0]);
+      if (status != SUCCESS) return status;
+      // The parameters are the children of the left parenthesis
+      paren = find_token_child(item, LEFT_PAREN);
+      if (paren != NULL) {
+        status = lower_parameters(ast, paren->child, &node->operands[0]);
+        if (status != SUCCESS) return status;
+      }
+      status = lower_type(children[1], &node->type_id);
+      if (status != SUCCESS) return status;
+      status = lower_sequence(ast, children[2], &node->list);
+      if (status != SUCCESS) return status;
+      break;
+    default:
+      return unexpected(item);
+  }
+  *result = node;
+  return SUCCESS;
+}
+
+static MiniStatus lower_module(MiniAst *ast, MiniSyntaxTree *module_part, MiniAstNode **result) {
+  MiniSyntaxTree *children[MAX_LOWERED_CHILDREN];
+  int count = meaningful_children(module_part, children);
+  if (count < 1 || count > 2 || !is_token(children[0])) return unexpected(module_part);
+  MiniStatus status;
+  MiniAstNode *node = alloc_ast_node(ast, AST_MODULE, &status);
+  if (status != SUCCESS) return status;
+  status = take_token(node, children[0]);
+  if (status != SUCCESS) return status;
+  *result = node;
+
+  MiniAstNode **link = &node->list;
+  MiniSyntaxTree *sequence = count == 2 ? children[1] : NULL;
+  while (sequence != NULL) {
+    if (!is_nonterm(sequence, MODULE_SEQUENCE)) return unexpected(sequence);
+    count = meaningful_children(sequence, children);
+    if (count < 1 || count > 2) return unexpected(sequence);
+    status = lower_module_item(ast, children[0], link);
+    if (status != SUCCESS) return status;
+    link = &(*link)->next;
+    sequence = count == 2 ? children[1] : NULL;
+  }
+  return SUCCESS;
+}
+
+static MiniStatus lower_main(MiniAst *ast, MiniSyntaxTree *main_file, MiniAstNode **result) {
+  MiniSyntaxTree *children[MAX_LOWERED_CHILDREN];
+  int count = meaningful_children(main_file, children);
+  if (count < 1 || count > 2 || !is_nonterm(children[count - 1], MAIN_PART)) return unexpected(main_file);
+  MiniAstNode *module = NULL;
+  MiniStatus status;
+  if (count == 2) {
+    status = lower_module(ast, children[0], &module);
+    if (status != SUCCESS) return status;
+  }
+
+  MiniSyntaxTree *main_part = children[count - 1];
+  count = meaningful_children(main_part, children);
+  if (count < 2 || count > 3 || !is_token(children[0])) return unexpected(main_part);
+  MiniAstNode *node = alloc_ast_node(ast, AST_MAIN, &status);
+  if (status != SUCCESS) return status;
+  status = take_token(node, children[0]);
+  if (status != SUCCESS) return status;
+  if (count == 3) {
+    node->op = children[1]->data.token.name;
+  }
+  node->operands[0] = module;
+  *result = node;
+  return lower_sequence(ast, children[count - 1], &node->list);
+}
+
+static size_t count_syntax_tree_nodes(MiniSyntaxTree *tree) {
+  size_t count = 0;
+  for (; tree != NULL; tree = tree->sibling) {
+    count += 1 + count_syntax_tree_nodes(tree->child);
+  }
+  return count;
+}
+
+static MiniStatus lower_source(MiniAst *ast, MiniSyntaxTree *root) {
+  MiniStatus status;
+  ast->root = alloc_ast_node(ast, AST_PROGRAM, &status);
+  if (status != SUCCESS) return status;
+  MiniAstNode **link = &ast->root->list;
+  // Every SOURCE holds one file, followed by the SOURCE with the rest of the files
+  MiniSyntaxTree *source = root;
+  while (source != NULL) {
+    MiniSyntaxTree *file = source->child;
+    if (file == NULL) break;
+    if (is_nonterm(file, MODULE_FILE)) {
+      if (!is_nonterm(file->child, MODULE_PART)) return unexpected(file->child);
+      status = lower_module(ast, file->child, link);
+    } else if (is_nonterm(file, MAIN_FILE)) {
+      status = lower_main(ast, file, link);
+    } else {
+      return unexpected(file);
+    }
+    if (status != SUCCESS) return status;
+    link = &(*link)->next;
+    source = file->sibling;
+    if (source != NULL && !is_nonterm(source, SOURCE)) return unexpected(source);
+  }
+  return SUCCESS;
+}
+
+MiniStatus lower_syntax_tree(char *input_file, char *output_file, MiniSyntaxTree *root, MiniAst *ast, int write_file, int verbose) {
+  if (verbose) {
+    printf("Beginning lowering\n");
+  }
+  ast->root = NULL;
+  ast->blocks = NULL;
+  ast->node_count = 0;
+  size_t tree_node_count = verbose ? count_syntax_tree_nodes(root) : 0;
+
+  MiniStatus status = lower_source(ast, root);
+  if (status != SUCCESS) {
+    return status;
+  }
+  if (verbose) {
+    printf("Lowered %zu syntax tree nodes to %zu AST nodes\n", tree_node_count, ast->node_count);
+  }
+
+  if (write_file) {
+    if (output_file[0] == '\0') {
+      strcpy(output_file, input_file);
+      char *extension = strrchr(output_file, '.');
+      if (extension != NULL) {
+        strcpy(extension, ".ast");
+      }
+    }
+    if (verbose) {
+      printf("Output file: %s\n", output_file);
+    }
+    FILE *output_ptr = fopen(output_file, "w");
+    if (output_ptr == NULL) {
+      printf("lower_syntax_tree: Error: Failed to open %s\n", output_file);
+      return FILE_NOT_FOUND;
+    }
+    fprintf(output_ptr, "// Indentation increase = operand or list item of the node above\n\n");
+    file_print_ast(output_ptr, ast->root, 0);
+    fclose(output_ptr);
+  }
+  if (verbose) {
+    printf("Lowering complete\n");
+  }
+  return SUCCESS;
+}
+
+void free_ast(MiniAst *ast) {
+  MiniAstBlock *block = ast->blocks;
+  while (block != NULL) {
+    MiniAstBlock *next = block->next;
+    for (size_t i = 0; i < block->used; i++) {
+      free(block->nodes[i].token.string_repr);
+      free(block->nodes[i].layout.displacements);
+    }
+    free(block);
+    block = next;
+  }
+  ast->root = NULL;
+  ast->blocks = NULL;
+  ast->node_count = 0;
+}
+
+typedef struct minimal_ast_print {
+  FILE *file_ptr;
+  int indent_multiplier;
+} MiniAstPrint;
+
+static const char *ast_kind_name(MiniAstKind kind) {
+  switch (kind) {
+    case AST_PROGRAM: return "Program";
+    case AST_MODULE: return "Module";
+    case AST_MAIN: return "Main";
+    case AST_IMPORT: return "Import";
+    case AST_TYPE_ALIAS: return "Type Alias";
+    case AST_SUBPROGRAM: return "Subprogram";
+    case AST_PARAMETER: return "Parameter";
+    case AST_DECLARATION: return "Declaration";
+    case AST_ASSIGNMENT: return "Assignment";
+    case AST_INCREMENT: return "Incrementation";
+    case AST_IO: return "Input/Output";
+    case AST_BREAK: return "Break";
+    case AST_CONTINUE: return "Continue";
+    case AST_RETURN: return "Return";
+    case AST_CALL: return "Call";
+    case AST_IF: return "If";
+    case AST_ELSE: return "Else";
+    case AST_SWITCH: return "Switch";
+    case AST_CASE: return "Case";
+    case AST_BLOCK: return "Block";
+    case AST_FOR: return "For";
+    case AST_WHILE: return "While";
+    case AST_LIST: return "List";
+    case AST_DICT: return "Associative Array";
+    case AST_PAIR: return "Pair";
+    case AST_BINARY: return "Binary Operation";
+    case AST_UNARY: return "Unary Operation";
+    case AST_NAME: return "Name";
+    case AST_LITERAL: return "Literal";
+    default: return "Unclassifiable";
+  }
+}
+
+#define AST_WALK_INITIAL_CAPACITY 64
+
+typedef struct minimal_ast_frame {
+  MiniAstNode *node;
+  int depth;
+  bool leaving; // The children are done, only post is left
+} MiniAstFrame;
+
+typedef struct minimal_ast_walk {
+  MiniAstFrame *frames;
+  size_t count;
+  size_t capacity;
+  MiniAstFrame initial[AST_WALK_INITIAL_CAPACITY];
+} MiniAstWalk;
+
+static MiniStatus reserve_frames(MiniAstWalk *walk, size_t extra) {
+  if (walk->count + extra <= walk->capacity) {
+    return SUCCESS;
+  }
+  size_t capacity = walk->capacity;
+  while (walk->count + extra > capacity) {
+    capacity *= 2;
+  }
+  MiniAstFrame *frames = malloc(capacity * sizeof(MiniAstFrame));
+  if (frames == NULL) {
+    printf("walk_ast: Memory Error: Failed to grow the traversal stack\n");
+    return ALLOCATION_FAIL;
+  }
+  memcpy(frames, walk->frames, walk->count * sizeof(MiniAstFrame));
+  if (walk->frames != walk->initial) {
+    free(walk->frames);
+  }
+  walk->frames = frames;
+  walk->capacity = capacity;
+  return SUCCESS;
+}
+
+// Pushes the children of node so that the first one ends up on top of the stack. Counting
+// them has already loaded every child, so their own first children are fetched from here,
+// where that costs no wait, for when the walk gets to them
+static MiniStatus push_children(MiniAstWalk *walk, MiniAstNode *node, int depth) {
+  size_t child_count = 0;
+  for (int i = 0; i < MINIMAL_AST_OPERANDS; i++) {
+    for (MiniAstNode *child = node->operands[i]; child != NULL; child = child->next) {
+      child_count++;
+    }
+  }
+  for (MiniAstNode *child = node->list; child != NULL; child = child->next) {
+    child_count++;
+  }
+  if (child_count == 0) {
+    return SUCCESS;
+  }
+  MiniStatus status = reserve_frames(walk, child_count);
+  if (status != SUCCESS) return status;
+
+  size_t slot = walk->count + child_count;
+  for (int i = 0; i <= MINIMAL_AST_OPERANDS; i++) {
+    MiniAstNode *child = i < MINIMAL_AST_OPERANDS ? node->operands[i] : node->list;
+    for (; child != NULL; child = child->next) {
+      __builtin_prefetch(child->operands[0] != NULL ? child->operands[0] : child->list);
+      walk->frames[--slot] = (MiniAstFrame){child, depth + 1, false};
+    }
+  }
+  walk->count += child_count;
+  return SUCCESS;
+}
+
+MiniStatus walk_ast(MiniAstNode *root, const MiniAstVisitor *visitor) {
+  MiniAstWalk walk;
+  walk.frames = walk.initial;
+  walk.count = 0;
+  walk.capacity = AST_WALK_INITIAL_CAPACITY;
+  MiniStatus status = SUCCESS;
+  if (root != NULL) {
+    walk.frames[walk.count++] = (MiniAstFrame){root, 0, false};
+  }
+
+  while (walk.count > 0) {
+    MiniAstFrame frame = walk.frames[--walk.count];
+    if (frame.leaving) {
+      if (visitor->post(frame.node, frame.depth, visitor->context) == VISIT_STOP) {
+        break;
+      }
+      continue;
+    }
+
+    MiniVisitAction action = VISIT_CONTINUE;
+    if (visitor->pre != NULL) {
+      action = visitor->pre(frame.node, frame.depth, visitor->context);
+    }
+    if (action == VISIT_STOP) {
+      break;
+    }
+    if (visitor->post != NULL) {
+      status = reserve_frames(&walk, 1);
+      if (status != SUCCESS) break;
+      walk.frames[walk.count++] = (MiniAstFrame){frame.node, frame.depth, true};
+    }
+    if (action == VISIT_SKIP) {
+      continue;
+    }
+    status = push_children(&walk, frame.node, frame.depth);
+    if (status != SUCCESS) break;
+    // The next node to visit is on top of the stack now. Only its address is read here, its
+    // children were fetched when it was pushed, so nothing waits on it before the hooks run
+    if (walk.count > 0) {
+      __builtin_prefetch(walk.frames[walk.count - 1].node);
+    }
+  }
+
+  if (walk.frames != walk.initial) {
+    free(walk.frames);
+  }
+  return status;
+}
+
+static void file_print_constant(FILE *file_ptr, const MiniConstant *constant) {
+  char text[32];
+  switch (constant->kind) {
+    case CONSTANT_INT:
+      fprintf(file_ptr, " = %lld", (long long) constant->value.int_value);
+      break;
+    case CONSTANT_FLOAT:
+      snprintf(text, sizeof(text), "%.17g", constant->value.float_value);
+      // Whole floats keep a decimal point so that they don't read as ints
+      fprintf(file_ptr, " = %s%s", text, strpbrk(text, ".e") == NULL ? ".0" : "");
+      break;
+    case CONSTANT_BOOL:
+      fprintf(file_ptr, " = %s", constant->value.int_value ? "T" : "F");
+      break;
+    default:
+      break;
+  }
+}
+
+static void file_print_effects(FILE *file_ptr, uint8_t effects) {
+  const char *names[] = {"reads globals", "writes globals", "I/O", "external calls"};
+  if (!(effects & EFFECT_KNOWN)) {
+    return;
+  }
+  if (effects == EFFECT_KNOWN) {
+    fprintf(file_ptr, " {pure}");
+    return;
+  }
+  const char *separator = " {";
+  for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+    if (effects & (1 << i)) {
+      fprintf(file_ptr, "%s%s", separator, names[i]);
+      separator = ", ";
+    }
+  }
+  fprintf(file_ptr, "}");
+}
+
+static void file_print_layout(FILE *file_ptr, const MiniStaticLayout *layout, MiniAstKind kind) {
+  // Switches and collections without a table are left as they are
+  if (kind == AST_SWITCH) {
+    switch (layout->strategy) {
+      case SWITCH_IF_CHAIN: break;
+      case SWITCH_JUMP_TABLE: fprintf(file_ptr, " {jump table of %u slots from %lld}", layout->slot_count, (long long) layout->low); break;
+      case SWITCH_BINARY_SEARCH: fprintf(file_ptr, " {binary search of %u labels}", layout->slot_count); break;
+      case SWITCH_PERFECT_HASH: fprintf(file_ptr, " {perfect hash of %u slots, %u buckets, seed %u}", layout->slot_count, layout->bucket_count, layout->seed); break;
+    }
+    return;
+  }
+  if (!layout->is_static) {
+    return;
+  }
+  if (kind == AST_LIST) {
+    fprintf(file_ptr, " {static}");
+    return;
+  }
+  if (layout->perfect) {
+    fprintf(file_ptr, " {static, perfect hash of %u slots, %u buckets, seed %u}", layout->slot_count, layout->bucket_count, layout->seed);
+  } else {
+    fprintf(file_ptr, " {static, probed %u slots, seed %u}", layout->slot_count, layout->seed);
+  }
+}
+
+static MiniVisitAction print_ast_node(MiniAstNode *node, int depth, void *context) {
+  FILE *file_ptr = ((MiniAstPrint *)context)->file_ptr;
+  int indent_multiplier = ((MiniAstPrint *)context)->indent_multiplier + depth;
+  fprintf(file_ptr, "%*s[%s", indent_multiplier * TREE_INDENT_WIDTH, "", ast_kind_name(node->kind));
+  if (node->op != TOKEN_UNDETERMINED) {
+    fprintf(file_ptr, " (%s)", desc_token(node->op));
+  }
+  if (node->type_id != MINIMAL_NO_TYPE) {
+    fprintf(file_ptr, " ");
+    file_print_type(file_ptr, node->type_id);
+  }
+  if (node->token.string_repr != NULL) {
+    fprintf(file_ptr, ": %s", node->token.string_repr);
+  }
+  if (node->kind == AST_SUBPROGRAM) {
+    file_print_effects(file_ptr, node->effects);
+  }
+  if (node->kind == AST_LIST || node->kind == AST_DICT || node->kind == AST_SWITCH) {
+    file_print_layout(file_ptr, &node->layout, node->kind);
+  }
+  if (node->declaration != NULL && node->declaration->token.line == MINIMAL_AST_NO_LINE) {
+    fprintf(file_ptr, " (summary)");
+  } else if (node->declaration != NULL) {
+    fprintf(file_ptr, " (line %u)", node->declaration->token.line + 1);
+  }
+  // Literals and literal case labels show their value already
+  if (node->kind != AST_LITERAL && (node->kind != AST_CASE || node->token.category == IDENTIFIER)) {
+    file_print_constant(file_ptr, &node->constant);
+  }
+  fprintf(file_ptr, "]\n");
+  return VISIT_CONTINUE;
+}
+
+// [Kind (op) type: token], leaving out the parts the node doesn't have. Prints node and
+// the nodes linked to it by next
+void file_print_ast(FILE *file_ptr, MiniAstNode *node, int indent_multiplier) {
+  MiniAstPrint print = {.file_ptr = file_ptr, .indent_multiplier = indent_multiplier};
+  MiniAstVisitor visitor = {.pre = print_ast_node, .post = NULL, .context = &print};
+  for (; node != NULL; node = node->next) {
+    walk_ast(node, &visitor);
+  }
+}
@@ -0,0 +1,255 @@
+/* 
+  =======================================================================
+  This file is part of Minimal (mnml) - A *.mini source to C compiler for 
+  the Minimal programming language
+
+  Written in 2025 by approx-error
+
+  Minimal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Minimal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+  ======================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "inc/retcodes.h"
+#include "inc/tokens.h"
+#include "inc/ast.h"
+#include "inc/semantic.h"
+
+typedef struct minimal_call_edge {
+  uint32_t caller;
+  uint32_t callee;
+} MiniCallEdge;
+
+typedef struct minimal_effect_analysis {
+  // Both sorted by address so that a declaration can be looked up with bsearch()
+  MiniAstNode **subprograms;
+  size_t subprogram_count;
+  MiniAstNode **globals; // Module variables (constants can't be assigned to, so reading them is pure)
+  size_t global_count;
+  MiniCallEdge *edges;
+  size_t edge_count;
+  size_t edge_capacity;
+  uint32_t caller; // Index of the subprogram being walked
+  MiniStatus status;
+} MiniEffectAnalysis;
+
+static int compare_nodes(const void *first, const void *second) {
+  uintptr_t a = (uintptr_t) *(MiniAstNode *const *) first;
+  uintptr_t b = (uintptr_t) *(MiniAstNode *const *) second;
+  return (a > b) - (a < b);
+}
+
+static MiniAstNode **find_node(MiniAstNode **nodes, size_t count, MiniAstNode *node) {
+  return count == 0 ? NULL : bsearch(&node, nodes, count, sizeof(MiniAstNode *), compare_nodes);
+}
+
+static MiniAstNode *program_module(MiniAstNode *file) {
+  MiniAstNode *module = file->kind == AST_MAIN ? file->operands[0] : file;
+  return module != NULL && module->kind == AST_MODULE ? module : NULL;
+}
+
+// Fills in the subprograms and globals of every module, sorted. With NULL arrays only counts
+static void collect_items(MiniAst *ast, MiniEffectAnalysis *analysis) {
+  analysis->subprogram_count = 0;
+  analysis->global_count = 0;
+  for (MiniAstNode *file = ast->root->list; file != NULL; file = file->next) {
+    MiniAstNode *module = program_module(file);
+    for (MiniAstNode *item = module == NULL ? NULL : module->list; item != NULL; item = item->next) {
+      if (item->kind == AST_SUBPROGRAM) {
+        if (analysis->subprograms != NULL) {
+          analysis->subprograms[analysis->subprogram_count] = item;
+        }
+        analysis->subprogram_count++;
+      } else if (item->kind == AST_DECLARATION && item->token.name != MINI_CONST_ID) {
+        if (analysis->globals != NULL) {
+          analysis->globals[analysis->global_count] = item;
+        }
+        analysis->global_count++;
+      }
+    }
+  }
+}
+
+static void add_call_edge(MiniEffectAnalysis *analysis, MiniAstNode *callee) {
+  MiniAstNode **found = find_node(analysis->subprograms, analysis->subprogram_count, callee);
+  if (found == NULL) {
+    return;
+  }
+  if (analysis->edge_count == analysis->edge_capacity) {
+    size_t capacity = analysis->edge_capacity == 0 ? 64 : analysis->edge_capacity * 2;
+    MiniCallEdge *edges = realloc(analysis->edges, capacity * sizeof(MiniCallEdge));
+    if (edges == NULL) {
+      printf("add_call_edge: Memory Error: Failed to reallocate memory for calls\n");
+      analysis->status = REALLOCATION_FAIL;
+      return;
+    }
+    analysis->edges = edges;
+    analysis->edge_capacity = capacity;
+  }
+  analysis->edges[analysis->edge_count++] = (MiniCallEdge){analysis->caller, (uint32_t) (found - analysis->subprograms)};
+}
+
+// Effects of using the variable node names: a module variable, or an external one
+static uint8_t variable_effects(MiniEffectAnalysis *analysis, MiniAstNode *node, uint8_t effect) {
+  if (node->declaration == NULL) {
+    return node->token.name == MINI_EXT_ID || node->token.name == C_ID ? effect : 0;
+  }
+  return find_node(analysis->globals, analysis->global_count, node->declaration) != NULL ? effect : 0;
+}
+
+// Effects of the subprogram's own statements. Those of the subprograms it calls are added
+// afterwards, when all are known
+static MiniVisitAction enter_effect_node(MiniAstNode *node, int depth, void *context) {
+  (void) depth;
+  MiniEffectAnalysis *analysis = context;
+  MiniAstNode *subprogram = analysis->subprograms[analysis->caller];
+  switch (node->kind) {
+    case AST_NAME:
+    case AST_CASE:
+      subprogram->effects |= variable_effects(analysis, node, EFFECT_READS_GLOBALS);
+      break;
+    case AST_ASSIGNMENT:
+      subprogram->effects |= variable_effects(analysis, node, EFFECT_WRITES_GLOBALS);
+      break;
+    case AST_INCREMENT:
+      subprogram->effects |= variable_effects(analysis, node, EFFECT_READS_GLOBALS | EFFECT_WRITES_GLOBALS);
+      break;
+    case AST_UNARY:
+      // A pointer may lead anywhere
+      if (node->op == DEREFERENCE) {
+        subprogram->effects |= EFFECT_READS_GLOBALS;
+      }
+      break;
+    case AST_IO:
+      subprogram->effects |= EFFECT_IO;
+      break;
+    case AST_CALL:
+      if (node->declaration == NULL) {
+        subprogram->effects |= EFFECT_EXTERNAL;
+      } else {
+        add_call_edge(analysis, node->declaration);
+      }
+      break;
+    default:
+      break;
+  }
+  return analysis->status == SUCCESS ? VISIT_CONTINUE : VISIT_STOP;
+}
+
+static int compare_edges(const void *first, const void *second) {
+  const MiniCallEdge *a = first;
+  const MiniCallEdge *b = second;
+  return (a->callee > b->callee) - (a->callee < b->callee);
+}
+
+// Gives every caller the effects of its callees, through any number of calls. With the
+// edges sorted by callee, a subprogram whose effects grow queues the ones that call it
+static MiniStatus propagate_effects(MiniEffectAnalysis *analysis) {
+  if (analysis->edge_count == 0) {
+    return SUCCESS;
+  }
+  size_t count = analysis->subprogram_count;
+  qsort(analysis->edges, analysis->edge_count, sizeof(MiniCallEdge), compare_edges);
+  size_t *first_edge = calloc(count + 1, sizeof(size_t));
+  uint32_t *queue = malloc(count * sizeof(uint32_t));
+  bool *queued = malloc(count * sizeof(bool));
+  if (first_edge == NULL || queue == NULL || queued == NULL) {
+    printf("propagate_effects: Memory Error: Failed to allocate memory for the call graph\n");
+    free(first_edge);
+    free(queue);
+    free(queued);
+    return ALLOCATION_FAIL;
+  }
+  for (size_t i = 0; i < analysis->edge_count; i++) {
+    first_edge[analysis->edges[i].callee + 1]++;
+  }
+  for (size_t i = 0; i < count; i++) {
+    first_edge[i + 1] += first_edge[i];
+    queue[i] = (uint32_t) i;
+    queued[i] = true;
+  }
+  // The queue is used as a ring, and never holds a subprogram twice
+  size_t head = 0;
+  size_t length = count;
+  while (length > 0) {
+    uint32_t callee = queue[head];
+    head = (head + 1) % count;
+    length--;
+    queued[callee] = false;
+    uint8_t effects = analysis->subprograms[callee]->effects;
+    for (size_t i = first_edge[callee]; i < first_edge[callee + 1]; i++) {
+      MiniAstNode *caller = analysis->subprograms[analysis->edges[i].caller];
+      if ((caller->effects | effects) != caller->effects) {
+        caller->effects |= effects;
+        if (!queued[analysis->edges[i].caller]) {
+          queue[(head + length) % count] = analysis->edges[i].caller;
+          length++;
+          queued[analysis->edges[i].caller] = true;
+        }
+      }
+    }
+  }
+  free(first_edge);
+  free(queue);
+  free(queued);
+  return SUCCESS;
+}
+
+MiniStatus find_subprogram_effects(MiniAst *ast, size_t *pure_count) {
+  MiniEffectAnalysis analysis;
+  memset(&analysis, 0, sizeof(MiniEffectAnalysis));
+  analysis.status = SUCCESS;
+  collect_items(ast, &analysis);
+  analysis.subprograms = malloc((analysis.subprogram_count + 1) * sizeof(MiniAstNode *));
+  analysis.globals = malloc((analysis.global_count + 1) * sizeof(MiniAstNode *));
+  if (analysis.subprograms == NULL || analysis.globals == NULL) {
+    printf("find_subprogram_effects: Memory Error: Failed to allocate memory for module items\n");
+    free(analysis.subprograms);
+    free(analysis.globals);
+    return ALLOCATION_FAIL;
+  }
+  collect_items(ast, &analysis);
+  qsort(analysis.subprograms, analysis.subprogram_count, sizeof(MiniAstNode *), compare_nodes);
+  qsort(analysis.globals, analysis.global_count, sizeof(MiniAstNode *), compare_nodes);
+
+  // The subprograms loaded from summaries have no bodies but keep the effects found when
+  // their modules were compiled
+  MiniAstVisitor visitor = {enter_effect_node, NULL, &analysis};
+  for (size_t i = 0; i < analysis.subprogram_count && analysis.status == SUCCESS; i++) {
+    MiniAstNode *subprogram = analysis.subprograms[i];
+    if (subprogram->effects & EFFECT_KNOWN) {
+      continue;
+    }
+    subprogram->effects = EFFECT_KNOWN;
+    analysis.caller = (uint32_t) i;
+    MiniStatus status = walk_ast(subprogram, &visitor);
+    analysis.status = analysis.status == SUCCESS ? status : analysis.status;
+  }
+  if (analysis.status == SUCCESS) {
+    analysis.status = propagate_effects(&analysis);
+  }
+  *pure_count = 0;
+  for (size_t i = 0; i < analysis.subprogram_count; i++) {
+    *pure_count += analysis.subprograms[i]->effects == EFFECT_KNOWN;
+  }
+  free(analysis.subprograms);
+  free(analysis.globals);
+  free(analysis.edges);
+  return analysis.status;
+}
@@ -0,0 +1,788 @@
+/* 
+  =======================================================================
+  This file is part of Minimal (mnml) - A *.mini source to C compiler for 
+  the Minimal programming language
+
+  Written in 2025 by approx-error
+
+  Minimal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Minimal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+  ======================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "inc/retcodes.h"
+#include "inc/tokens.h"
+#include "inc/ast.h"
+#include "inc/semantic.h"
+
+// Constants whose values are worked out while working out the value of another constant,
+// which happens when a module item refers to a constant declared after it. Deeper chains
+// are left to run time instead of growing the stack
+#define FOLD_MAX_NESTING 256
+
+typedef struct minimal_fold {
+  bool module_items; // Subprogram bodies are left out, and constants are worked out on demand
+  bool evaluate_calls;
+  int nesting;
+  size_t folded_count;
+  size_t evaluated_count;
+  MiniStatus status;
+} MiniFold;
+
+static bool is_constant_declaration(const MiniAstNode *node) {
+  return node != NULL && node->kind == AST_DECLARATION && node->token.name == MINI_CONST_ID;
+}
+
+static bool is_known(const MiniConstant *constant) {
+  return constant->kind == CONSTANT_INT || constant->kind == CONSTANT_FLOAT || constant->kind == CONSTANT_BOOL;
+}
+
+static bool is_number(const MiniConstant *constant) {
+  return constant->kind == CONSTANT_INT || constant->kind == CONSTANT_FLOAT;
+}
+
+static double float_value(const MiniConstant *constant) {
+  return constant->kind == CONSTANT_INT ? (double) constant->value.int_value : constant->value.float_value;
+}
+
+static MiniConstant int_constant(int64_t value) {
+  MiniConstant constant = {.kind = CONSTANT_INT};
+  constant.value.int_value = value;
+  return constant;
+}
+
+// Infinities and NaNs are left to run time
+static MiniConstant float_constant(double value) {
+  MiniConstant constant = {.kind = isfinite(value) ? CONSTANT_FLOAT : CONSTANT_NONE};
+  constant.value.float_value = value;
+  return constant;
+}
+
+static MiniConstant bool_constant(bool value) {
+  MiniConstant constant = {.kind = CONSTANT_BOOL};
+  constant.value.int_value = value;
+  return constant;
+}
+
+static const MiniConstant NO_CONSTANT = {.kind = CONSTANT_NONE};
+
+static bool is_float_type(MiniTypeId id) {
+  const MiniType *type = id == MINIMAL_NO_TYPE ? NULL : get_type(id);
+  return type != NULL && type->kind == FLOAT && type->pointer_depth == 0;
+}
+
+static MiniConstant literal_constant(const MiniToken *token) {
+  switch (token->name) {
+    case INT_LITERAL: return int_constant(token->value.int_value);
+    case FLOAT_LITERAL: return float_constant(token->value.float_value);
+    case TRUE: return bool_constant(true);
+    case FALSE: return bool_constant(false);
+    default: return NO_CONSTANT;
+  }
+}
+
+// Integer operations that would overflow or divide by zero are left to run time
+static MiniConstant fold_int_arithmetic(MiniTokenName op, int64_t left, int64_t right) {
+  int64_t result;
+  switch (op) {
+    case PLUS:
+      return __builtin_add_overflow(left, right, &result) ? NO_CONSTANT : int_constant(result);
+    case MINUS:
+      return __builtin_sub_overflow(left, right, &result) ? NO_CONSTANT : int_constant(result);
+    case TIMES:
+      return __builtin_mul_overflow(left, right, &result) ? NO_CONSTANT : int_constant(result);
+    case DIV:
+    case MOD:
+      if (right == 0 || (left == INT64_MIN && right == -1)) {
+        return NO_CONSTANT;
+      }
+      return int_constant(op == DIV ? left / right : left % right);
+    case POW:
+      if (right < 0) {
+        return NO_CONSTANT;
+      }
+      result = 1;
+      while (right > 0) {
+        if ((right & 1) && __builtin_mul_overflow(result, left, &result)) {
+          return NO_CONSTANT;
+        }
+        right >>= 1;
+        if (right > 0 && __builtin_mul_overflow(left, left, &left)) {
+          return NO_CONSTANT;
+        }
+      }
+      return int_constant(result);
+    default:
+      return NO_CONSTANT;
+  }
+}
+
+static MiniConstant fold_float_arithmetic(MiniTokenName op, double left, double right) {
+  switch (op) {
+    case PLUS: return float_constant(left + right);
+    case MINUS: return float_constant(left - right);
+    case TIMES: return float_constant(left * right);
+    case DIV: return right == 0.0 ? NO_CONSTANT : float_constant(left / right);
+    case POW: return float_constant(pow(left, right));
+    default: return NO_CONSTANT;
+  }
+}
+
+static MiniConstant fold_comparison(MiniTokenName op, const MiniConstant *left, const MiniConstant *right) {
+  int order;
+  if (left->kind == CONSTANT_INT && right->kind == CONSTANT_INT) {
+    order = (left->value.int_value > right->value.int_value) - (left->value.int_value < right->value.int_value);
+  } else {
+    double first = float_value(left);
+    double second = float_value(right);
+    order = (first > second) - (first < second);
+  }
+  switch (op) {
+    case EQUALS: return bool_constant(order == 0);
+    case NOT_EQUAL: return bool_constant(order != 0);
+    case LESS_THAN: return bool_constant(order < 0);
+    case GREATER_THAN: return bool_constant(order > 0);
+    case LESS_EQUAL: return bool_constant(order <= 0);
+    case GREATER_EQUAL: return bool_constant(order >= 0);
+    default: return NO_CONSTANT;
+  }
+}
+
+// The operands have been type checked, but an operand whose type was wrong may still have
+// a value, so the kinds of the values are checked again
+static MiniConstant fold_binary(MiniTokenName op, const MiniConstant *left, const MiniConstant *right) {
+  switch (op) {
+    case PLUS:
+    case MINUS:
+    case TIMES:
+    case DIV:
+    case MOD:
+    case POW:
+      if (left->kind == CONSTANT_INT && right->kind == CONSTANT_INT) {
+        return fold_int_arithmetic(op, left->value.int_value, right->value.int_value);
+      }
+      if (is_number(left) && is_number(right)) {
+        return fold_float_arithmetic(op, float_value(left), float_value(right));
+      }
+      return NO_CONSTANT;
+    case EQUALS:
+    case NOT_EQUAL:
+      if (left->kind == CONSTANT_BOOL && right->kind == CONSTANT_BOOL) {
+        return bool_constant((left->value.int_value == right->value.int_value) == (op == EQUALS));
+      }
+      // Fall through
+    case LESS_THAN:
+    case GREATER_THAN:
+    case LESS_EQUAL:
+    case GREATER_EQUAL:
+      return is_number(left) && is_number(right) ? fold_comparison(op, left, right) : NO_CONSTANT;
+    case AND:
+    case OR:
+      if (left->kind != CONSTANT_BOOL || right->kind != CONSTANT_BOOL) {
+        return NO_CONSTANT;
+      }
+      return bool_constant(op == AND ? left->value.int_value && right->value.int_value : left->value.int_value || right->value.int_value);
+    default:
+      return NO_CONSTANT;
+  }
+}
+
+static MiniConstant fold_unary(MiniTokenName op, const MiniConstant *operand) {
+  switch (op) {
+    case PLUS:
+      return is_number(operand) ? *operand : NO_CONSTANT;
+    case MINUS:
+      if (operand->kind == CONSTANT_INT) {
+        return operand->value.int_value == INT64_MIN ? NO_CONSTANT : int_constant(-operand->value.int_value);
+      }
+      return operand->kind == CONSTANT_FLOAT ? float_constant(-operand->value.float_value) : NO_CONSTANT;
+    case SQRT:
+      return is_number(operand) && float_value(operand) >= 0.0 ? float_constant(sqrt(float_value(operand))) : NO_CONSTANT;
+    case NOT:
+      return operand->kind == CONSTANT_BOOL ? bool_constant(!operand->value.int_value) : NO_CONSTANT;
+    default:
+      return NO_CONSTANT;
+  }
+}
+
+static MiniVisitAction enter_folded_node(MiniAstNode *node, int depth, void *context);
+static MiniVisitAction leave_folded_node(MiniAstNode *node, int depth, void *context);
+
+// Value of the constant declaration a name refers to. Only the module items are worked out
+// on demand: the bodies run on several threads and only read the module items
+static MiniConstant declared_constant(MiniFold *fold, MiniAstNode *node) {
+  MiniAstNode *declaration = node->declaration;
+  if (!is_constant_declaration(declaration)) {
+    return NO_CONSTANT;
+  }
+  if (declaration->constant.kind == CONSTANT_UNKNOWN && fold->module_items && fold->nesting < FOLD_MAX_NESTING) {
+    MiniAstVisitor visitor = {enter_folded_node, leave_folded_node, fold};
+    fold->nesting++;
+    MiniStatus status = walk_ast(declaration, &visitor);
+    fold->nesting--;
+    if (status != SUCCESS) {
+      fold->status = status;
+      return NO_CONSTANT;
+    }
+  }
+  if (declaration->constant.kind == CONSTANT_PENDING) {
+    semantic_error(node, "Value of constant %s depends on itself", node->token.string_repr);
+    return NO_CONSTANT;
+  }
+  if (!is_known(&declaration->constant)) {
+    return NO_CONSTANT;
+  }
+  return declaration->constant;
+}
+
+// Calls to pure subprograms whose arguments are constants are run by a small interpreter
+// once the effects of the subprograms are known. An evaluation that runs into one of these
+// limits is given up with a warning, and the call is left to run time
+#define EVALUATION_MAX_STEPS 100000
+#define EVALUATION_MAX_DEPTH 64
+#define EVALUATION_MAX_SLOTS 4096
+
+// Value of a local variable or parameter of a subprogram being run
+typedef struct minimal_slot {
+  MiniAstNode *declaration;
+  MiniConstant value;
+} MiniSlot;
+
+typedef enum minimal_run_result {
+  RUN_NEXT,
+  RUN_BREAK,
+  RUN_CONTINUE,
+  RUN_RETURN,
+  RUN_ABANDON // Not constant after all, or over a limit
+} MiniRunResult;
+
+typedef struct minimal_evaluation {
+  MiniFold *fold;
+  MiniSlot *slots;
+  size_t slot_count;
+  size_t slot_capacity;
+  size_t frame; // First slot of the innermost call
+  size_t steps;
+  int depth;
+  const char *limit; // The limit the evaluation ran into, if any
+  MiniConstant result; // Value of the last return
+} MiniEvaluation;
+
+static bool take_step(MiniEvaluation *evaluation) {
+  if (++evaluation->steps > EVALUATION_MAX_STEPS) {
+    evaluation->limit = "step";
+    return false;
+  }
+  return true;
+}
+
+static bool push_slot(MiniEvaluation *evaluation, MiniAstNode *declaration, MiniConstant value) {
+  if (evaluation->slot_count == evaluation->slot_capacity) {
+    if (evaluation->slot_capacity == EVALUATION_MAX_SLOTS) {
+      evaluation->limit = "memory";
+      return false;
+    }
+    size_t capacity = evaluation->slot_capacity == 0 ? 64 : evaluation->slot_capacity * 2;
+    MiniSlot *slots = realloc(evaluation->slots, capacity * sizeof(MiniSlot));
+    if (slots == NULL) {
+      printf("push_slot: Memory Error: Failed to reallocate memory for compile-time evaluation\n");
+      evaluation->fold->status = REALLOCATION_FAIL;
+      return false;
+    }
+    evaluation->slots = slots;
+    evaluation->slot_capacity = capacity;
+  }
+  evaluation->slots[evaluation->slot_count++] = (MiniSlot){declaration, value};
+  return true;
+}
+
+// Only the slots of the innermost call are visible
+static MiniSlot *find_slot(MiniEvaluation *evaluation, MiniAstNode *declaration) {
+  for (size_t i = evaluation->slot_count; i > evaluation->frame; i--) {
+    if (evaluation->slots[i - 1].declaration == declaration) {
+      return &evaluation->slots[i - 1];
+    }
+  }
+  return NULL;
+}
+
+// value as stored in a variable of the declared type. A <.> variable may be given an int
+// value. Types behind aliases aren't known here, so values of those aren't worked out
+static bool convert_value(MiniTypeId declared, MiniConstant *value) {
+  const MiniType *type = declared == MINIMAL_NO_TYPE ? NULL : get_type(declared);
+  if (type == NULL || type->kind == CUSTOM_T) {
+    return false;
+  }
+  if (value->kind == CONSTANT_INT && is_float_type(declared)) {
+    *value = float_constant((double) value->value.int_value);
+  }
+  return true;
+}
+
+static bool can_evaluate(const MiniAstNode *subprogram) {
+  // Subprograms loaded from summaries have no body to run
+  return subprogram != NULL && subprogram->kind == AST_SUBPROGRAM && subprogram->effects == EFFECT_KNOWN &&
+         subprogram->token.line != MINIMAL_AST_NO_LINE;
+}
+
+static bool evaluate_expression(MiniEvaluation *evaluation, MiniAstNode *node, MiniConstant *value);
+static MiniRunResult run_statement(MiniEvaluation *evaluation, MiniAstNode *node);
+
+static MiniRunResult run_block(MiniEvaluation *evaluation, MiniAstNode *first) {
+  size_t slot_count = evaluation->slot_count;
+  MiniRunResult result = RUN_NEXT;
+  for (MiniAstNode *statement = first; statement != NULL && result == RUN_NEXT; statement = statement->next) {
+    result = run_statement(evaluation, statement);
+  }
+  evaluation->slot_count = slot_count;
+  return result;
+}
+
+// Runs the subprogram call refers to. value is left unknown if it returns nothing
+static bool run_call(MiniEvaluation *evaluation, MiniAstNode *call, MiniConstant *value) {
+  MiniAstNode *subprogram = call->declaration;
+  if (!can_evaluate(subprogram)) {
+    return false;
+  }
+  if (evaluation->depth == EVALUATION_MAX_DEPTH) {
+    evaluation->limit = "call depth";
+    return false;
+  }
+  // The arguments are worked out in the frame of the caller before any parameter is bound,
+  // as a recursive call has the same parameters
+  size_t frame = evaluation->slot_count;
+  for (MiniAstNode *argument = call->list; argument != NULL; argument = argument->next) {
+    MiniConstant argument_value;
+    if (!evaluate_expression(evaluation, argument, &argument_value) || !push_slot(evaluation, NULL, argument_value)) {
+      evaluation->slot_count = frame;
+      return false;
+    }
+  }
+  size_t slot = frame;
+  for (MiniAstNode *parameter = subprogram->operands[0]; parameter != NULL; parameter = parameter->next, slot++) {
+    evaluation->slots[slot].declaration = parameter;
+    if (!convert_value(parameter->type_id, &evaluation->slots[slot].value)) {
+      evaluation->slot_count = frame;
+      return false;
+    }
+  }
+
+  size_t caller_frame = evaluation->frame;
+  evaluation->frame = frame;
+  evaluation->depth++;
+  MiniRunResult result = run_block(evaluation, subprogram->list);
+  evaluation->depth--;
+  evaluation->frame = caller_frame;
+  evaluation->slot_count = frame;
+  if (result == RUN_NEXT) {
+    *value = NO_CONSTANT;
+    return true;
+  }
+  if (result != RUN_RETURN) {
+    return false;
+  }
+  *value = evaluation->result;
+  if (value->kind == CONSTANT_INT && is_float_type(call->type_id)) {
+    *value = float_constant((double) value->value.int_value);
+  }
+  return true;
+}
+
+static bool evaluate_name(MiniEvaluation *evaluation, MiniAstNode *node, MiniConstant *value) {
+  MiniSlot *slot = find_slot(evaluation, node->declaration);
+  if (slot != NULL) {
+    *value = slot->value;
+    if (value->kind == CONSTANT_INT && is_float_type(node->type_id)) {
+      *value = float_constant((double) value->value.int_value);
+    }
+  } else if (is_constant_declaration(node->declaration) && node->declaration->constant.kind != CONSTANT_PENDING) {
+    // A constant being worked out can't be used yet, which isn't an error here
+    *value = declared_constant(evaluation->fold, node);
+  } else {
+    return false;
+  }
+  return is_known(value);
+}
+
+static bool evaluate_expression(MiniEvaluation *evaluation, MiniAstNode *node, MiniConstant *value) {
+  if (!take_step(evaluation)) {
+    return false;
+  }
+  MiniConstant left;
+  MiniConstant right;
+  switch (node->kind) {
+    case AST_LITERAL:
+      *value = literal_constant(&node->token);
+      break;
+    case AST_NAME:
+      return evaluate_name(evaluation, node, value);
+    case AST_BINARY:
+      if (!evaluate_expression(evaluation, node->operands[0], &left) || !evaluate_expression(evaluation, node->operands[1], &right)) {
+        return false;
+      }
+      *value = fold_binary(node->op, &left, &right);
+      break;
+    case AST_UNARY:
+      if (!evaluate_expression(evaluation, node->operands[0], &left)) {
+        return false;
+      }
+      *value = fold_unary(node->op, &left);
+      break;
+    case AST_CALL:
+      if (!run_call(evaluation, node, value)) {
+        return false;
+      }
+      break;
+    default:
+      return false;
+  }
+  return is_known(value);
+}
+
+static MiniTokenName increment_operator(MiniTokenName op) {
+  switch (op) {
+    case INCREMENT:
+    case PLUS_ASSIGN: return PLUS;
+    case DECREMENT:
+    case MINUS_ASSIGN: return MINUS;
+    case TIMES_ASSIGN: return TIMES;
+    case DIV_ASSIGN: return DIV;
+    case MOD_ASSIGN: return MOD;
+    default: return TOKEN_UNDETERMINED;
+  }
+}
+
+static MiniRunResult run_assignment(MiniEvaluation *evaluation, MiniAstNode *node) {
+  MiniSlot *slot = find_slot(evaluation, node->declaration);
+  MiniConstant value = int_constant(1);
+  if (slot == NULL || (node->operands[0] != NULL && !evaluate_expression(evaluation, node->operands[0], &value))) {
+    return RUN_ABANDON;
+  }
+  if (node->kind == AST_INCREMENT) {
+    if (!is_known(&slot->value)) {
+      return RUN_ABANDON;
+    }
+    value = fold_binary(increment_operator(node->op), &slot->value, &value);
+    if (!is_known(&value)) {
+      return RUN_ABANDON;
+    }
+  }
+  if (!convert_value(node->declaration->type_id, &value)) {
+    return RUN_ABANDON;
+  }
+  slot->value = value;
+  return RUN_NEXT;
+}
+
+static bool evaluate_condition(MiniEvaluation *evaluation, MiniAstNode *node, bool *condition) {
+  MiniConstant value;
+  if (!evaluate_expression(evaluation, node, &value) || value.kind != CONSTANT_BOOL) {
+    return false;
+  }
+  *condition = value.value.int_value;
+  return true;
+}
+
+// Runs the body of a loop once more, and tells whether to go on with the loop
+static bool run_loop_body(MiniEvaluation *evaluation, MiniAstNode *body, MiniRunResult *result) {
+  *result = run_block(evaluation, body);
+  if (*result == RUN_BREAK) {
+    *result = RUN_NEXT;
+    return false;
+  }
+  if (*result == RUN_CONTINUE) {
+    *result = RUN_NEXT;
+  }
+  return *result == RUN_NEXT;
+}
+
+static MiniRunResult run_loop(MiniEvaluation *evaluation, MiniAstNode *node) {
+  size_t slot_count = evaluation->slot_count;
+  MiniRunResult result = RUN_NEXT;
+  bool is_for = node->kind == AST_FOR;
+  if (is_for) {
+    result = run_statement(evaluation, node->operands[0]);
+  }
+  bool condition;
+  while (result == RUN_NEXT) {
+    if (!evaluate_condition(evaluation, node->operands[is_for ? 1 : 0], &condition)) {
+      result = RUN_ABANDON;
+    } else if (!condition || !run_loop_body(evaluation, node->list, &result)) {
+      break;
+    } else if (is_for) {
+      result = run_statement(evaluation, node->operands[2]);
+    }
+  }
+  evaluation->slot_count = slot_count;
+  return result;
+}
+
+static bool case_label(MiniEvaluation *evaluation, MiniAstNode *case_node, MiniConstant *label) {
+  if (case_node->token.category == IDENTIFIER) {
+    return evaluate_name(evaluation, case_node, label);
+  }
+  *label = literal_constant(&case_node->token);
+  return is_known(label);
+}
+
+// The cases fall through to the next one unless they break. Strings have no constant value,
+// so switches on them are left to run time
+static MiniRunResult run_switch(MiniEvaluation *evaluation, MiniAstNode *node) {
+  MiniConstant value;
+  if (node->operands[1] != NULL || !evaluate_expression(evaluation, node->operands[0], &value) || value.kind != CONSTANT_INT) {
+    return RUN_ABANDON;
+  }
+  MiniAstNode *match = NULL;
+  for (MiniAstNode *case_node = node->list; case_node != NULL && (match == NULL || match->token.name == DEFAULT); case_node = case_node->next) {
+    MiniConstant label;
+    if (case_node->token.name == DEFAULT) {
+      match = match == NULL ? case_node : match;
+    } else if (!case_label(evaluation, case_node, &label) || label.kind != CONSTANT_INT) {
+      return RUN_ABANDON;
+    } else if (label.value.int_value == value.value.int_value) {
+      match = case_node;
+    }
+  }
+  for (MiniAstNode *case_node = match; case_node != NULL; case_node = case_node->next) {
+    MiniRunResult result = run_block(evaluation, case_node->list);
+    if (result == RUN_BREAK) {
+      return RUN_NEXT;
+    }
+    if (result != RUN_NEXT) {
+      return result;
+    }
+  }
+  return RUN_NEXT;
+}
+
+static MiniRunResult run_statement(MiniEvaluation *evaluation, MiniAstNode *node) {
+  if (!take_step(evaluation)) {
+    return RUN_ABANDON;
+  }
+  MiniConstant value = NO_CONSTANT;
+  bool condition;
+  switch (node->kind) {
+    case AST_DECLARATION:
+      // A variable without a value can't be read until it is assigned to
+      if (node->operands[0] != NULL && !evaluate_expression(evaluation, node->operands[0], &value)) {
+        return RUN_ABANDON;
+      }
+      if (!convert_value(node->type_id, &value) || !push_slot(evaluation, node, value)) {
+        return RUN_ABANDON;
+      }
+      return RUN_NEXT;
+    case AST_ASSIGNMENT:
+    case AST_INCREMENT:
+      return run_assignment(evaluation, node);
+    case AST_IF:
+      if (!evaluate_condition(evaluation, node->operands[0], &condition)) {
+        return RUN_ABANDON;
+      }
+      if (condition) {
+        return run_statement(evaluation, node->operands[1]);
+      }
+      return node->operands[2] == NULL ? RUN_NEXT : run_statement(evaluation, node->operands[2]);
+    case AST_ELSE:
+    case AST_BLOCK:
+      return run_block(evaluation, node->list);
+    case AST_FOR:
+    case AST_WHILE:
+      return run_loop(evaluation, node);
+    case AST_SWITCH:
+      return run_switch(evaluation, node);
+    case AST_RETURN:
+      if (node->operands[0] != NULL && !evaluate_expression(evaluation, node->operands[0], &value)) {
+        return RUN_ABANDON;
+      }
+      evaluation->result = value;
+      return RUN_RETURN;
+    case AST_BREAK:
+      return RUN_BREAK;
+    case AST_CONTINUE:
+      return RUN_CONTINUE;
+    case AST_CALL:
+      return run_call(evaluation, node, &value) ? RUN_NEXT : RUN_ABANDON;
+    default:
+      return RUN_ABANDON;
+  }
+}
+
+// Value of a call to a pure subprogram with constant arguments, or NO_CONSTANT if it can't
+// be worked out at compile time
+static MiniConstant evaluate_call(MiniFold *fold, MiniAstNode *call) {
+  if (!can_evaluate(call->declaration)) {
+    return NO_CONSTANT;
+  }
+  for (MiniAstNode *argument = call->list; argument != NULL; argument = argument->next) {
+    if (!is_known(&argument->constant)) {
+      return NO_CONSTANT;
+    }
+  }
+  MiniEvaluation evaluation;
+  memset(&evaluation, 0, sizeof(MiniEvaluation));
+  evaluation.fold = fold;
+  MiniConstant value;
+  bool evaluated = run_call(&evaluation, call, &value);
+  free(evaluation.slots);
+  if (!evaluated) {
+    if (evaluation.limit != NULL && fold->status == SUCCESS) {
+      semantic_warning(call, "Compile-time evaluation of %s given up at the %s limit", call->token.string_repr, evaluation.limit);
+    }
+    return NO_CONSTANT;
+  }
+  if (!is_known(&value)) {
+    return NO_CONSTANT;
+  }
+  fold->evaluated_count++;
+  return value;
+}
+
+static MiniVisitAction enter_folded_node(MiniAstNode *node, int depth, void *context) {
+  (void) depth;
+  MiniFold *fold = context;
+  if (node->kind == AST_SUBPROGRAM && fold->module_items) {
+    return VISIT_SKIP;
+  }
+  if (is_constant_declaration(node)) {
+    // Worked out already because something before it refers to it
+    if (node->constant.kind != CONSTANT_UNKNOWN) {
+      return VISIT_SKIP;
+    }
+    node->constant.kind = CONSTANT_PENDING;
+  }
+  return VISIT_CONTINUE;
+}
+
+// Every operand has its value by the time the node using it is left
+static MiniVisitAction leave_folded_node(MiniAstNode *node, int depth, void *context) {
+  (void) depth;
+  MiniFold *fold = context;
+  switch (node->kind) {
+    case AST_LITERAL:
+      node->constant = literal_constant(&node->token);
+      break;
+    case AST_NAME:
+      node->constant = declared_constant(fold, node);
+      break;
+    case AST_CASE:
+      if (node->token.category == IDENTIFIER) {
+        node->constant = declared_constant(fold, node);
+      } else if (node->token.name != DEFAULT) {
+        node->constant = literal_constant(&node->token);
+      }
+      break;
+    case AST_BINARY:
+      node->constant = fold_binary(node->op, &node->operands[0]->constant, &node->operands[1]->constant);
+      break;
+    case AST_UNARY:
+      node->constant = fold_unary(node->op, &node->operands[0]->constant);
+      break;
+    case AST_CALL:
+      node->constant = fold->evaluate_calls ? evaluate_call(fold, node) : NO_CONSTANT;
+      break;
+    case AST_DECLARATION:
+      if (node->constant.kind == CONSTANT_PENDING) {
+        MiniAstNode *value = node->operands[0];
+        node->constant = value != NULL && is_known(&value->constant) ? value->constant : NO_CONSTANT;
+        // A <%> constant may be given an int value
+        if (node->constant.kind == CONSTANT_INT && is_float_type(node->type_id)) {
+          node->constant = float_constant((double) node->constant.value.int_value);
+        }
+      }
+      return fold->status == SUCCESS ? VISIT_CONTINUE : VISIT_STOP;
+    default:
+      return fold->status == SUCCESS ? VISIT_CONTINUE : VISIT_STOP;
+  }
+  if (is_known(&node->constant)) {
+    fold->folded_count++;
+  }
+  return fold->status == SUCCESS ? VISIT_CONTINUE : VISIT_STOP;
+}
+
+static MiniStatus fold_constants(MiniFold *fold, MiniAstNode *root) {
+  MiniAstVisitor visitor = {enter_folded_node, leave_folded_node, fold};
+  MiniStatus status = walk_ast(root, &visitor);
+  return status != SUCCESS ? status : fold->status;
+}
+
+static MiniStatus fold_body(MiniFold *fold, MiniAstNode *body) {
+  if (body->kind == AST_SUBPROGRAM) {
+    return fold_constants(fold, body);
+  }
+  for (MiniAstNode *statement = body->list; statement != NULL; statement = statement->next) {
+    MiniStatus status = fold_constants(fold, statement);
+    if (status != SUCCESS) return status;
+  }
+  return SUCCESS;
+}
+
+MiniStatus fold_module_constants(MiniAstNode *module, size_t *folded_count) {
+  MiniFold fold = {.module_items = true, .status = SUCCESS};
+  MiniStatus status = fold_constants(&fold, module);
+  *folded_count += fold.folded_count;
+  return status;
+}
+
+MiniStatus fold_body_constants(MiniAstNode *body, size_t *folded_count) {
+  MiniFold fold = {.module_items = false, .status = SUCCESS};
+  MiniStatus status = fold_body(&fold, body);
+  *folded_count += fold.folded_count;
+  return status;
+}
+
+static MiniVisitAction forget_constant(MiniAstNode *node, int depth, void *context) {
+  (void) depth;
+  (void) context;
+  node->constant.kind = CONSTANT_UNKNOWN;
+  return VISIT_CONTINUE;
+}
+
+static MiniAstNode *program_module(MiniAstNode *file) {
+  MiniAstNode *module = file->kind == AST_MAIN ? file->operands[0] : file;
+  return module != NULL && module->kind == AST_MODULE ? module : NULL;
+}
+
+MiniStatus evaluate_constant_calls(MiniAst *ast, size_t *evaluated_count) {
+  *evaluated_count = 0;
+  // Values found without the calls may depend on them, so everything is folded afresh
+  MiniAstVisitor forget = {forget_constant, NULL, NULL};
+  MiniStatus status = walk_ast(ast->root, &forget);
+  MiniFold fold = {.module_items = true, .evaluate_calls = true, .status = SUCCESS};
+  for (MiniAstNode *file = ast->root->list; file != NULL && status == SUCCESS; file = file->next) {
+    MiniAstNode *module = program_module(file);
+    if (module != NULL) {
+      status = fold_constants(&fold, module);
+    }
+  }
+  fold.module_items = false;
+  for (MiniAstNode *file = ast->root->list; file != NULL && status == SUCCESS; file = file->next) {
+    MiniAstNode *module = program_module(file);
+    for (MiniAstNode *item = module == NULL ? NULL : module->list; item != NULL && status == SUCCESS; item = item->next) {
+      if (item->kind == AST_SUBPROGRAM) {
+        status = fold_body(&fold, item);
+      }
+    }
+    if (status == SUCCESS && file->kind == AST_MAIN) {
+      status = fold_body(&fold, file);
+    }
+  }
+  *evaluated_count = fold.evaluated_count;
+  return status;
+}
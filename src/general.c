@@ -54,18 +54,26 @@ MiniStatus help(char *argv0) {
   puts("  --pre            preprocess only before stopping");
   puts("  --lex            preprocess and perform lexical analysis (tokenization) before stopping");
   puts("  --syn            preprocess and perform lexical and syntactic analysis (parsing) before stopping");
+  puts("  --ast            preprocess, parse and lower the syntax tree to an abstract syntax tree before stopping");
   puts("  --sem            preprocess and perform lexical, syntactic and semantic analysis before stopping");
   puts("  --cgen           produce a single C source file from the input files (This is the default behaviour)");
   puts("  --ir             produce an intermediate representation for the program before stopping");
   puts("  --asm            produce assembler output for the program before stopping");
   puts("  --obj            produce compiled object files for the program before stopping");
   puts("  --exe            produce an executable for the program before stopping");
+  puts("  --stream         lex on a separate thread while parsing, keeping only a few tokens in memory at a time");
+  puts("  --table          parse with the table generated from grammar/minimal.grammar");
+  puts("  --lex-threads=<n>    lex large files on at most <n> threads instead of one per processor");
+  puts("  --parse-threads=<n>  parse module files on at most <n> threads instead of one per processor");
+  puts("  --reparse=<file>     then take the edits of <file>, an edited copy of the input, parsing again only what they change");
+  puts("  --report-dead    list the subprograms, constants and type aliases the main program can't reach");
   puts("");
   puts("The default output file is always of the form <name>.<ext> where <name> is the name of the minimal");
   puts("source code file which contains the main function and <ext> is an extension which depends on the chosen flag:");
   puts("  --pre: <ext> = prep");
   puts("  --lex: <ext> = toke");
   puts("  --syn: <ext> = pars");
+  puts("  --ast: <ext> = ast");
   puts("  --sem: <ext> = sema");
   puts(" --cgen: <ext> = c");
   puts("   --ir: <ext> = ir");
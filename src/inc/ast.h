@@ -0,0 +1,197 @@
+/*
+  =======================================================================
+  This file is part of Minimal (mnml) - A *.mini source to C compiler for
+  the Minimal programming language
+
+  Written in 2025 by approx-error
+
+  Minimal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Minimal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+  ======================================================================
+*/
+
+#ifndef MINIMAL_AST_H
+#define MINIMAL_AST_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "retcodes.h"
+#include "tokens.h"
+#include "syntax.h"
+
+// Abstract syntax tree: the syntax tree without punctuation, helper non-terminals and the
+// nesting of recursive rules. Every node is one construct of the program, and the comment
+// next to each kind lists what it keeps in its fields. Fields not listed are unused.
+// Operands and list are in source order when taken in that order
+typedef enum minimal_ast_kind {
+  AST_PROGRAM, // list: modules and main programs in source order
+  AST_MODULE, // token: name. op: IMPORT if it was loaded from a summary. list: imports, type aliases, declarations and subprograms
+  AST_MAIN, // token: name. op: ARGV if it takes arguments. operands[0]: AST_MODULE of the main file or NULL. list: body
+  AST_IMPORT, // token: module name or file string. op: IMPORT, M_IMPORT or C_IMPORT
+  AST_TYPE_ALIAS, // token: the custom type. type_id: the aliased type
+  AST_SUBPROGRAM, // token: name. type_id: return type. operands[0]: first AST_PARAMETER (linked by next). list: body
+  AST_PARAMETER, // token: name. type_id
+  AST_DECLARATION, // token: name. type_id. operands[0]: initial value or NULL
+  AST_ASSIGNMENT, // token: target. operands[0]: value
+  AST_INCREMENT, // token: target. op: INCREMENT, DECREMENT or a compound assignment. operands[0]: value of a compound assignment
+  AST_IO, // operands[0]: source. operands[1]: destination
+  AST_BREAK,
+  AST_CONTINUE,
+  AST_RETURN, // operands[0]: value
+  AST_CALL, // token: subprogram name. list: arguments
+  AST_IF, // operands[0]: condition. operands[1]: AST_BLOCK of the body. operands[2]: AST_IF of an else-if, AST_ELSE or NULL
+  AST_ELSE, // list: body
+  AST_SWITCH, // operands[0]: value. operands[1]: AST_BLOCK of the statements before the first case or NULL. list: AST_CASEs
+  AST_CASE, // token: label (DEFAULT for the default case). list: body
+  AST_BLOCK, // list: statements
+  AST_FOR, // operands[0]: AST_DECLARATION. operands[1]: condition. operands[2]: AST_INCREMENT. list: body
+  AST_WHILE, // operands[0]: condition. list: body
+  AST_LIST, // list: elements
+  AST_DICT, // list: AST_PAIRs
+  AST_PAIR, // operands[0]: key. operands[1]: value
+  AST_BINARY, // op. operands[0]: left. operands[1]: right
+  AST_UNARY, // op. operands[0]: operand
+  AST_NAME, // token: identifier
+  AST_LITERAL // token: literal or literal keyword (T, F, N, ...)
+} MiniAstKind;
+
+#define MINIMAL_AST_OPERANDS 3
+
+// What the semantic analysis knows of the value of an expression at compile time
+typedef enum minimal_constant_kind {
+  CONSTANT_UNKNOWN = 0, // Not worked out (yet)
+  CONSTANT_PENDING, // Being worked out, for a constant declaration
+  CONSTANT_NONE, // Only known at run time
+  CONSTANT_INT,
+  CONSTANT_FLOAT,
+  CONSTANT_BOOL
+} MiniConstantKind;
+
+typedef struct minimal_constant {
+  MiniConstantKind kind;
+  MiniLitValue value; // int_value is 0 or 1 for CONSTANT_BOOL
+} MiniConstant;
+
+// How a switch finds the case of its value. Switches whose labels aren't all known at compile
+// time, or that have too few of them for a table to pay off, compare the labels in order
+typedef enum minimal_switch_strategy {
+  SWITCH_IF_CHAIN = 0,
+  SWITCH_JUMP_TABLE, // One slot per value from the lowest label to the highest
+  SWITCH_BINARY_SEARCH, // Over the labels sorted by value
+  SWITCH_PERFECT_HASH // The slot of a value holds the only label that can match it, an int or a string
+} MiniSwitchStrategy;
+
+// How a list or dict literal can be emitted as read-only static data, which it can be if its
+// elements are all known at compile time, and the table a switch is lowered to. A dict key or
+// switch label with a perfect hash is found in two steps: the high 32 bits of static_key_hash()
+// of it with seed & (bucket_count - 1) pick its bucket, and static_key_hash() of it with the
+// displacement of the bucket as the seed & (slot_count - 1) picks its slot. Without a perfect
+// hash the slot is static_key_hash() of it with seed & (slot_count - 1), or the next free one
+typedef struct minimal_static_layout {
+  bool is_static;
+  bool perfect; // AST_DICT, AST_SWITCH: no two keys share a slot, so a lookup compares a single key
+  MiniSwitchStrategy strategy; // AST_SWITCH
+  uint32_t slot_count; // Slots of the hash table, a power of two, or of the jump table. Labels of a binary search
+  uint32_t seed;
+  uint32_t bucket_count; // Buckets of a perfect hash, a power of two
+  uint32_t *displacements; // One per bucket of a perfect hash, freed with the AST
+  int64_t low; // AST_SWITCH: the label of the first slot of a jump table
+} MiniStaticLayout;
+
+// What running a subprogram can do besides returning a value, or'ed together. A subprogram
+// with none of them is pure. EFFECT_KNOWN tells that the others have been worked out
+typedef enum minimal_effect {
+  EFFECT_READS_GLOBALS = 1 << 0, // Reads module or external variables, or memory through a pointer
+  EFFECT_WRITES_GLOBALS = 1 << 1, // Assigns to module or external variables
+  EFFECT_IO = 1 << 2, // Reads or writes a stream
+  EFFECT_EXTERNAL = 1 << 3, // Calls C or external subprograms, whose effects aren't known
+  EFFECT_KNOWN = 1 << 7
+} MiniEffect;
+
+// token.line of the nodes loaded from a module summary, which doesn't keep lines
+#define MINIMAL_AST_NO_LINE UINT32_MAX
+
+typedef struct minimal_ast_node {
+  MiniAstKind kind;
+  MiniTokenName op; // TOKEN_UNDETERMINED if the kind doesn't use it
+  MiniToken token; // string_repr is NULL if the kind doesn't use it. next_token is unused
+  MiniSymbolId symbol; // Interned token.string_repr if the token is an identifier
+  MiniTypeId type_id;
+  // Set by the semantic analysis on AST_NAME, AST_ASSIGNMENT, AST_INCREMENT and AST_CALL: the
+  // AST_DECLARATION, AST_PARAMETER or AST_SUBPROGRAM the name refers to. NULL for external
+  // names and names that couldn't be resolved
+  struct minimal_ast_node *declaration;
+  // Set by the semantic analysis on expressions and on the declarations of constants
+  // (MINI_CONST_ID names) whose initial value is known at compile time
+  MiniConstant constant;
+  // Set by the semantic analysis on the module items (subprograms, declarations and type
+  // aliases) that the main program can reach. Every item is reachable in a program without one
+  bool reachable;
+  // Set by the semantic analysis on AST_SUBPROGRAM: its MiniEffects, with those of the
+  // subprograms it calls
+  uint8_t effects;
+  // Set by the semantic analysis on AST_LIST, AST_DICT and AST_SWITCH
+  MiniStaticLayout layout;
+  struct minimal_ast_node *operands[MINIMAL_AST_OPERANDS];
+  struct minimal_ast_node *list; // First node of a list linked by next
+  struct minimal_ast_node *next;
+} MiniAstNode;
+
+// Nodes are allocated in blocks that are freed all at once with free_ast()
+#define MINIMAL_AST_BLOCK_SIZE 1024
+
+typedef struct minimal_ast_block {
+  struct minimal_ast_block *next;
+  size_t used;
+  MiniAstNode nodes[MINIMAL_AST_BLOCK_SIZE];
+} MiniAstBlock;
+
+typedef struct minimal_ast {
+  MiniAstNode *root; // AST_PROGRAM
+  MiniAstBlock *blocks;
+  size_t node_count;
+} MiniAst;
+
+// What walk_ast() does after a hook returns. VISIT_SKIP from pre skips the node's children
+// (post is still called for it), from post it is the same as VISIT_CONTINUE
+typedef enum minimal_visit_action {
+  VISIT_CONTINUE = 0,
+  VISIT_SKIP,
+  VISIT_STOP
+} MiniVisitAction;
+
+// Either hook may be NULL. depth is 0 for the node walk_ast() starts from
+typedef struct minimal_ast_visitor {
+  MiniVisitAction (*pre)(MiniAstNode *node, int depth, void *context);
+  MiniVisitAction (*post)(MiniAstNode *node, int depth, void *context);
+  void *context;
+} MiniAstVisitor;
+
+// Visits root and everything below it in source order: the operands (with the nodes linked
+// to them by next), then the list. Nodes linked to root itself by next are not visited.
+// The walk keeps its own stack, so the depth of the tree doesn't matter
+MiniStatus walk_ast(MiniAstNode *root, const MiniAstVisitor *visitor);
+
+// Builds ast from a valid syntax tree. The AST takes over the token strings of the tree
+// (they are set to NULL in the tree), so the tree can be freed right afterwards. The AST
+// is written to output_file if write_file is set. Like generate_ast(), an empty
+// output_file gets the name of input_file with its extension replaced
+MiniStatus lower_syntax_tree(char *input_file, char *output_file, MiniSyntaxTree *root, MiniAst *ast, int write_file, int verbose);
+// Allocates a zeroed node of kind in ast. A token string put into the node is freed by free_ast()
+MiniAstNode *alloc_ast_node(MiniAst *ast, MiniAstKind kind, MiniStatus *status);
+void free_ast(MiniAst *ast);
+void file_print_ast(FILE *file_ptr, MiniAstNode *node, int indent_multiplier);
+
+#endif
@@ -0,0 +1,67 @@
+/*
+  =======================================================================
+  This file is part of Minimal (mnml) - A *.mini source to C compiler for
+  the Minimal programming language
+
+  Written in 2025 by approx-error
+
+  Minimal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Minimal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+  ======================================================================
+*/
+
+#ifndef MINIMAL_LL_TABLE_H
+#define MINIMAL_LL_TABLE_H
+
+#include <stdint.h>
+#include "tokens.h"
+#include "syntax.h"
+
+// Tables generated by tools/llgen from grammar/minimal.grammar into obj/grammar-table.c
+
+// Terminals are token indices (see MINIMAL_TOKEN_INDEX), plus one for the end of input
+#define LL_END_OF_INPUT MINIMAL_TOKEN_INDEX_COUNT
+#define LL_TERMINAL_COUNT (MINIMAL_TOKEN_INDEX_COUNT + 1)
+
+// A grammar symbol is a terminal, or LL_NONTERM_BASE + the index of a non-terminal in
+// ll_nonterms. LL_CHILD_FLAG marks a symbol written with '>' in the grammar
+typedef uint16_t MiniGramSymbol;
+
+#define LL_NONTERM_BASE 128
+#define LL_CHILD_FLAG 0x8000
+#define LL_SYMBOL_MASK 0x7fff
+
+// Predict table entries: 0 is a syntax error, otherwise the index of the production to
+// expand plus one. With LL_SECOND_TOKEN set, the rest is a row of ll_second_predict that
+// has to be indexed with the token after the current one to find the production
+#define LL_SECOND_TOKEN 0x8000
+
+typedef struct minimal_grammar_nonterminal {
+  MiniNonTerm node; // NON_TERM_UNDETERMINED for helper rules, which don't get a node
+  const char *name;
+} MiniGramNonTerm;
+
+typedef struct minimal_grammar_production {
+  uint16_t lhs;
+  uint16_t first_symbol; // Index into ll_symbols
+  uint16_t length;
+} MiniGramProduction;
+
+extern const MiniGramNonTerm ll_nonterms[];
+extern const MiniGramProduction ll_productions[];
+extern const MiniGramSymbol ll_symbols[];
+extern const uint16_t ll_predict[][LL_TERMINAL_COUNT];
+extern const uint16_t ll_second_predict[][LL_TERMINAL_COUNT];
+extern const uint16_t ll_start;
+
+#endif
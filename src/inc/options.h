@@ -23,6 +23,8 @@
 #ifndef MINIMAL_OPTIONS_H
 #define MINIMAL_OPTIONS_H
 
+#include <getopt.h>
+
 extern int verbose_flag;
 extern int preprocess_flag;
 extern int tokenize_flag;
@@ -32,13 +34,22 @@ extern int irgen_flag;
 extern int asm_flag;
 extern int compile_flag;
 extern int link_flag;
+extern int stream_flag;
+extern int table_flag;
+extern int ast_flag;
+extern int report_dead_flag;
+extern long lex_thread_count;
+extern long parse_thread_count;
 
 
 enum option_identifiers {
   USAGE = 1,
   HELP,
   VERSION,
-  INFO
+  INFO,
+  LEX_THREADS,
+  PARSE_THREADS,
+  REPARSE
 };
 
 extern struct option minimal_options[];
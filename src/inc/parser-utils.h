@@ -27,29 +27,80 @@
 #include "tokens.h"
 #include "syntax.h"
 
-MiniStatus match_terminals(MiniToken *cur_tok, MiniTokenName *targets, MiniTokenName *match);
-MiniStatus match_terminal_cats(MiniToken *cur_tok, MiniTokenCat *targets, MiniTokenCat *match);
+// Set of token names (TOKEN_BIT) or token categories (CATEGORY_BIT). Every decision point
+// of the parser tests the current token against one of these with a single bit test
+typedef unsigned __int128 MiniTokenSet;
+
+#define TOKEN_BIT(name) ((MiniTokenSet)1 << MINIMAL_TOKEN_INDEX(name))
+#define CATEGORY_BIT(category) ((MiniTokenSet)1 << (category))
+
+#define MINIMAL_CATEGORY_COUNT (UNCLASSIFIABLE + 1)
+
+_Static_assert(MINIMAL_TOKEN_INDEX_COUNT <= 128, "token names don't fit in a MiniTokenSet");
+_Static_assert(MINIMAL_CATEGORY_COUNT <= 128, "token categories don't fit in a MiniTokenSet");
+
+// On a match, *match is set to the name or category of the current token, otherwise to
+// TOKEN_UNDETERMINED or CATEGORY_UNDETERMINED. match may be NULL if the caller doesn't need it
+MiniStatus match_terminals(MiniToken *cur_tok, MiniTokenSet targets, MiniTokenName *match);
+MiniStatus match_terminal_cats(MiniToken *cur_tok, MiniTokenSet targets, MiniTokenCat *match);
 
 MiniSyntaxTree *add_term_node(MiniSyntaxTree *cur_node, MiniToken *cur_tok, MiniRelation rel, MiniStatus *status);
 MiniSyntaxTree *add_nonterm_node(MiniSyntaxTree *cur_node, MiniNonTerm name, MiniRelation rel, MiniStatus *status);
 
 MiniSyntaxTree *match_and_add_term_node(
-  MiniSyntaxTree *cur_node, MiniToken *cur_tok, MiniTokenName *names,
+  MiniSyntaxTree *cur_node, MiniToken *cur_tok, MiniTokenSet names,
   MiniRelation rel, MiniTokenName *match, MiniStatus *status
 );
 
+// names and rels are -1 terminated arrays: the tokens have to match in this order
 MiniSyntaxTree *match_and_add_term_node_seq(
   MiniSyntaxTree *cur_node, MiniToken *cur_tok, MiniToken **tok_carrier,
   MiniTokenName *names, MiniRelation *rels, MiniTokenName *non_match, MiniStatus *status 
 );
 
+// If match is NULL, corresp_nonterms points to the single non-terminal to add. Otherwise it is
+// a table of MINIMAL_TOKEN_INDEX_COUNT non-terminals indexed by MINIMAL_TOKEN_INDEX(name)
 MiniSyntaxTree *match_and_add_nonterm_node(
-  MiniSyntaxTree *cur_node, MiniToken *cur_tok, MiniTokenName *names,
-  MiniNonTerm *corresp_nonterms, MiniRelation rel, MiniTokenName *match, MiniStatus *status  
+  MiniSyntaxTree *cur_node, MiniToken *cur_tok, MiniTokenSet names,
+  const MiniNonTerm *corresp_nonterms, MiniRelation rel, MiniTokenName *match, MiniStatus *status  
 );
 
+// Same as above with a table of MINIMAL_CATEGORY_COUNT non-terminals indexed by category
 MiniSyntaxTree *match_cat_and_add_nonterm_node(
-  MiniSyntaxTree *current_node, MiniToken *current_tok, MiniTokenCat *cats,
-  MiniNonTerm *corresp_nonterms, MiniRelation rel, MiniTokenCat *match, MiniStatus *status  
+  MiniSyntaxTree *current_node, MiniToken *current_tok, MiniTokenSet cats,
+  const MiniNonTerm *corresp_nonterms, MiniRelation rel, MiniTokenCat *match, MiniStatus *status  
 );
+
+// Parse errors go through parse_error(), which prefixes "Parse Error: Line <n>: " with the
+// line of the token the parser last reached and prints each distinct message once per line,
+// up to MINIMAL_MAX_PARSE_ERRORS messages. parse_error_count() counts every error, printed
+// or not
+#define MINIMAL_MAX_PARSE_ERRORS 25
+
+void parse_error(const char *format, ...) __attribute__((format(printf, 1, 2)));
+int parse_error_count(void);
+int printed_parse_error_count(void);
+void reset_parse_errors(void);
+
+// Parse errors of a worker thread. collect_parse_errors() makes parse_error() on the calling
+// thread add to log instead of printing (NULL goes back to printing). report_parse_errors()
+// then prints the log on the thread the parse was started from, as if the errors had
+// happened there, and empties it
+typedef struct minimal_parse_error_log {
+  char *messages[MINIMAL_MAX_PARSE_ERRORS];
+  int message_count; // Distinct messages
+  int error_count;
+} MiniParseErrorLog;
+
+void collect_parse_errors(MiniParseErrorLog *log);
+void report_parse_errors(MiniParseErrorLog *log);
+void free_parse_error_log(MiniParseErrorLog *log);
+
+// Panic mode recovery after a parse error in the construct starting at start. Skips to the
+// next SEMICOLON, which is consumed, or TERM_KW token, which is left for the enclosing
+// construct. If block is set, start opens a block (branch or subprogram) and the whole
+// block is skipped instead, up to and including its terminator. Returns VALID_CONSTRUCT
+// with *tok_carrier set to where parsing can go on, LAST_TOKEN if the input ran out, or
+// PARSE_ERROR if there is nothing to skip because start is itself a TERM_KW token
+MiniStatus synchronize(MiniToken *start, bool block, MiniToken **tok_carrier);
 #endif
@@ -40,7 +40,10 @@ typedef enum return_codes {
   NONMATCHING_CATEGORY,
   LAST_TOKEN,
   VALID_CONSTRUCT,
-  INVALID_CONSTRUCT
+  INVALID_CONSTRUCT,
+  LITERAL_OUT_OF_RANGE,
+  THREAD_FAIL,
+  SEMANTIC_ERROR
 } MiniStatus;
 
 #endif
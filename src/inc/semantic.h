@@ -0,0 +1,129 @@
+/*
+  =======================================================================
+  This file is part of Minimal (mnml) - A *.mini source to C compiler for
+  the Minimal programming language
+
+  Written in 2025 by approx-error
+
+  Minimal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Minimal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+  ======================================================================
+*/
+
+#ifndef MINIMAL_SEMANTIC_H
+#define MINIMAL_SEMANTIC_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "retcodes.h"
+#include "ast.h"
+
+// Resolves every name in ast to its declaration (see MiniAstNode.declaration) and reports
+// names that are undeclared, declared twice in the same scope or used as the wrong kind of
+// thing, then checks the types. The module items are analysed first, then the bodies of the
+// subprograms and of the main program on a pool of threads. Returns SEMANTIC_ERROR if there
+// were any errors. The resolved AST is written to output_file if write_file is set. Like
+// lower_syntax_tree(), an empty output_file gets the name of input_file with its extension
+// replaced. Imported modules that aren't in ast are loaded from their summaries in the
+// directory of output_file, and if write_file is set the summaries of the modules in ast
+// are written there
+MiniStatus analyse_semantics(char *input_file, char *output_file, MiniAst *ast, int write_file, int verbose);
+
+// Type checking, in two steps. prepare_type_check() collects the type aliases of ast and
+// works out what every custom type stands for, after which check is only read: the module
+// items and the bodies can then be checked on several threads at once. Checking infers the
+// type of every expression into its type_id, with aliases replaced by the types they stand
+// for, and checks it against where the value goes. Needs the names to be resolved.
+// typed_count is set to the number of expressions given a type
+typedef struct minimal_type_check MiniTypeCheck;
+
+MiniStatus prepare_type_check(MiniAst *ast, MiniTypeCheck **check);
+// Everything in module but the subprogram bodies
+MiniStatus check_module_types(const MiniTypeCheck *check, MiniAstNode *module, size_t *typed_count);
+// body is an AST_SUBPROGRAM (with its parameters) or the body of an AST_MAIN
+MiniStatus check_body_types(const MiniTypeCheck *check, MiniAstNode *body, size_t *typed_count);
+void free_type_check(MiniTypeCheck *check);
+
+// Constant folding, after the type check and in the same two steps. Works out the value of
+// every expression made of literals, constants (MINI_CONST_ID names) and operators whose
+// value is known at compile time into its constant, and of every constant declaration.
+// Values that would overflow, divide by zero or aren't finite are left to run time.
+// folded_count is increased by the number of expressions given a value
+MiniStatus fold_module_constants(MiniAstNode *module, size_t *folded_count);
+MiniStatus fold_body_constants(MiniAstNode *body, size_t *folded_count);
+// Folds the whole of ast again, once the effects of the subprograms are known, this time
+// also running the calls to pure subprograms whose arguments are constants. Runs that take
+// too many steps, calls or variables are given up with a warning. evaluated_count is set to
+// the number of calls replaced by their values
+MiniStatus evaluate_constant_calls(MiniAst *ast, size_t *evaluated_count);
+
+// Lays out the list and dict literals whose elements are all literals or constants (see
+// MiniAstNode.layout), after the calls are evaluated. Dicts get a two-level perfect hash, with
+// a displacement per bucket of keys, in the smallest table that one is found for within a few
+// tries. Switches with enough labels known at compile time get a jump table if the labels are
+// ints and dense, a binary search over int labels if there are few of them, and a perfect
+// hash over the labels, ints or strings, if not. static_count is set to the number of
+// collections laid out and switch_count to the number of switches given a table
+MiniStatus lay_out_static_data(MiniAst *ast, size_t *static_count, size_t *switch_count);
+// Hash of a dict key or switch label in a static table. The bytes of an int or bool key are its int64_t
+// value in little endian order, those of a float key the same for the bits of its double,
+// and those of a string key the text between its quotes as written
+uint64_t static_key_hash(const unsigned char *bytes, size_t length, uint32_t seed);
+
+// Whole program reachability, once the rest of the analysis has succeeded. Follows the names
+// and declared types from the main program through the module items (see
+// MiniAstNode.reachable), across every module. dead_count is set to the number of items of
+// the modules in ast (not loaded from summaries) that can't be reached.
+// report_dead_items() lists them
+MiniStatus find_reachable_items(MiniAst *ast, size_t *dead_count);
+void report_dead_items(MiniAst *ast);
+
+// Works out the effects of every subprogram (see MiniAstNode.effects) from its statements and
+// the subprograms it calls, recursion included. The subprograms loaded from summaries keep
+// their effects. pure_count is set to the number of pure subprograms
+MiniStatus find_subprogram_effects(MiniAst *ast, size_t *pure_count);
+
+// Prints a semantic error about the construct node starts and counts it. Thread local like
+// the parse errors. semantic_error_once() is for errors about something used in several
+// places, such as an undefined type: only the first of the same errors is reported
+void semantic_error(MiniAstNode *node, const char *format, ...) __attribute__((format(printf, 2, 3)));
+void semantic_error_once(MiniAstNode *node, const char *format, ...) __attribute__((format(printf, 2, 3)));
+int semantic_error_count(void);
+// A warning doesn't count as an error and is printed right away, so it is only for the parts
+// of the analysis that run on one thread
+void semantic_warning(MiniAstNode *node, const char *format, ...) __attribute__((format(printf, 2, 3)));
+void reset_semantic_errors(void);
+
+// Semantic errors of a part of the analysis. collect_semantic_errors() makes the errors on
+// the calling thread go to log instead of being printed (NULL goes back to printing).
+// report_semantic_errors() then prints the errors of all the logs merged in source order,
+// as if they had happened on the calling thread, and empties the logs
+typedef struct minimal_semantic_error {
+  uint32_t line;
+  bool once;
+  char *message;
+} MiniSemanticError;
+
+typedef struct minimal_semantic_error_log {
+  MiniSemanticError *errors;
+  size_t error_count;
+  size_t capacity;
+  size_t lost_count; // Errors that are counted but couldn't be stored for lack of memory
+} MiniSemanticErrorLog;
+
+void collect_semantic_errors(MiniSemanticErrorLog *log);
+MiniStatus report_semantic_errors(MiniSemanticErrorLog *logs, size_t log_count);
+void free_semantic_error_log(MiniSemanticErrorLog *log);
+
+#endif
@@ -0,0 +1,47 @@
+/* 
+  =======================================================================
+  This file is part of Minimal (mnml) - A *.mini source to C compiler for 
+  the Minimal programming language
+
+  Written in 2025 by approx-error
+
+  Minimal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Minimal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+  ======================================================================
+*/
+
+#ifndef MINIMAL_SUMMARY_H
+#define MINIMAL_SUMMARY_H
+
+#include "retcodes.h"
+#include "ast.h"
+
+// Interface summaries (.mnmi files): what a module exports, in a compact binary form. The
+// summary of a module holds its imports, type aliases, declarations with their initial
+// values and the signatures and effects of its subprograms, but no subprogram bodies or line
+// numbers, so it only changes when the interface of the module does
+#define MINIMAL_SUMMARY_EXTENSION ".mnmi"
+#define MINIMAL_SUMMARY_VERSION 3
+
+// Writes the summary of every module defined in ast (not the module of a main file, nor
+// the modules loaded from summaries) to directory/<module>.mnmi. A summary that is already
+// up to date isn't rewritten, so its modification time tells when the interface changed
+MiniStatus write_module_summaries(MiniAst *ast, const char *directory, int verbose);
+
+// Appends an AST_MODULE to ast for every module that is imported with :: but not defined
+// in ast and has a summary in directory, including the modules the loaded ones import.
+// Loaded modules have op set to IMPORT. Imports without a summary are left for the
+// semantic analysis to report
+MiniStatus load_module_summaries(MiniAst *ast, const char *directory, int verbose);
+
+#endif
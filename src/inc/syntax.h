@@ -94,6 +94,7 @@ typedef enum minimal_nonterminal_constructs {
 } MiniNonTerm;
 
 
+const char *construct_category_name(int construct, int type);
 void print_construct_category(int construct, int type);
 void file_print_construct_category(FILE *file_ptr, int construct, int type);
 
@@ -136,6 +137,7 @@ typedef struct minimal_syntax_tree {
   MiniConsType data_type;
   struct minimal_syntax_tree *child;
   struct minimal_syntax_tree *sibling;
+  struct minimal_syntax_tree *parent; // Node whose child chain this node is on, NULL at the root
 } MiniSyntaxTree;
 
 typedef enum minimal_node_relation {
@@ -155,10 +157,27 @@ MiniGramCons *alloc_gram_construct(MiniStatus *status);
 MiniSyntaxTree *alloc_syntax_tree(MiniStatus *status);
 MiniStatus init_syntax_tree(MiniSyntaxTree *tree, MiniGramCons *constr, MiniConsType type);
 void free_syntax_tree(MiniSyntaxTree *tree);
+void free_syntax_tree_nodes(MiniSyntaxTree *tree);
 void add_node(MiniSyntaxTree *target_node, MiniSyntaxTree *new_node, MiniRelation relation);
 void print_syntax_tree(MiniSyntaxTree *tree, int indent_multiplier);
 void file_print_syntax_tree(FILE *file_ptr, MiniSyntaxTree *tree, int indent_multilplier);
 
-MiniStatus generate_ast(char *input_file, char *output_file, MiniHeadToken *head_token, MiniSyntaxTree *root, int verbose);
+// table_parse() is the table-driven parser of table-parser.c, generate_ast() uses it instead
+// of the recursive descent parser when table is set
+MiniStatus table_parse(MiniSyntaxTree *root, MiniToken *first);
+// An edit of the preprocessed source: removed_lines lines starting at first_line (counting
+// from 0) are replaced with the added_lines strings of lines
+typedef struct minimal_text_edit {
+  uint32_t first_line;
+  uint32_t removed_lines;
+  char **lines;
+  uint32_t added_lines;
+} MiniTextEdit;
+
+MiniStatus reparse_edit(MiniSyntaxTree *root, MiniHeadToken *head_token, MiniTextEdit *edit, int verbose);
+// Turns the token list and tree of the preprocessed file old_file into those of new_file with
+// reparse_edit() and writes the tree to output_file (<new_file>.pars if empty)
+MiniStatus reparse_file(char *old_file, char *new_file, char *output_file, MiniHeadToken *head_token, MiniSyntaxTree *root, int verbose);
+MiniStatus generate_ast(char *input_file, char *output_file, MiniHeadToken *head_token, MiniSyntaxTree *root, int table, int verbose);
 
 #endif
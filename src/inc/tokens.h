@@ -23,7 +23,10 @@
 #ifndef MINIMAL_TOKEN_H
 #define MINIMAL_TOKEN_H
 
+#include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
 #include "retcodes.h"
 
 typedef enum token_categories {
@@ -170,6 +173,23 @@ typedef enum token_names {
   NOT_DETERMINED = 10000
 } MiniTokenName;
 
+// Token names are spaced out in blocks of 100, so they can't index a table or a bit set
+// directly. MINIMAL_TOKEN_INDEX packs them into 0..MINIMAL_TOKEN_INDEX_COUNT - 1 by adding
+// the offset inside a block to the number of names in all the blocks before it. It is a
+// constant expression so that it can be used in static initializers; at run time
+// token_index() does the same with a table lookup. New names must be added here as well
+#define MINIMAL_TOKEN_INDEX_COUNT 89
+
+#define MINIMAL_TOKEN_BLOCK_BASE(block) ( \
+  (block) == 0 ? 0 : (block) == 10 ? 4 : (block) == 11 ? 16 : (block) == 12 ? 18 : \
+  (block) == 13 ? 19 : (block) == 14 ? 28 : (block) == 15 ? 33 : (block) == 16 ? 37 : \
+  (block) == 17 ? 41 : (block) == 20 ? 47 : (block) == 30 ? 58 : (block) == 31 ? 64 : \
+  (block) == 32 ? 67 : (block) == 33 ? 73 : (block) == 34 ? 75 : (block) == 35 ? 81 : \
+  (block) == 36 ? 83 : (block) == 40 ? 84 : (block) == 90 ? 87 : (block) == 100 ? 88 : \
+  MINIMAL_TOKEN_INDEX_COUNT)
+
+#define MINIMAL_TOKEN_INDEX(name) (MINIMAL_TOKEN_BLOCK_BASE((name) / 100) + (name) % 100)
+
 extern const size_t MINIMAL_IDENTIFIER_MAX_LEN;
 extern const char *NO_SEMICOLON_AFTER;
 
@@ -194,29 +214,142 @@ extern const char *MINIMAL_COMP_OP[];
 extern const char *MINIMAL_BIN_LOG_OP[];
 extern const char *MINIMAL_UNA_LOG_OP[];
 
+// Binary value of a numeric literal, decoded once by the lexer so that later
+// stages never have to re-parse string_repr. Which member is valid depends on
+// the token name (INT_LITERAL or FLOAT_LITERAL). Zero for all other tokens
+typedef union minimal_literal_value {
+  int64_t int_value;
+  double float_value;
+} MiniLitValue;
+
+// Index of an interned type in the type table. Two type keywords denote the same type
+// exactly when their ids are equal, so types are compared without looking at the table
+typedef uint32_t MiniTypeId;
+
+#define MINIMAL_NO_TYPE 0
+
+// Index of an interned identifier in the symbol table. Ids are dense, counting up from 1 in
+// the order names are first interned, so later stages can index arrays with them
+typedef uint32_t MiniSymbolId;
+
+#define MINIMAL_NO_SYMBOL 0
+
+// Structured form of a type keyword. Every member is itself an interned type, so
+// [#^] is a LIST_T whose single member is the id of <#> with a pointer depth of 1
+typedef struct minimal_type {
+  MiniTokenName kind; // VOID, INT, FLOAT, STR, BOOL, STREAM, CUSTOM_T, LIST_T, DICT_T, ENUM_T, UNION_T or STRUCT_T
+  uint32_t pointer_depth;
+  uint32_t member_count;
+  uint32_t key_count; // DICT_T: the first key_count members are the key types, the rest are value types
+  MiniTypeId *members;
+  char *name; // CUSTOM_T: the name between the angle brackets
+  uint64_t hash;
+} MiniType;
+
 typedef struct minimal_token_specification {
   char *string_repr;
   MiniTokenCat category;
   MiniTokenName name;
+  MiniLitValue value;
+  MiniTypeId type_id; // Interned type of a TYPE_KW token, MINIMAL_NO_TYPE for all other tokens
+  uint32_t line; // Line of the preprocessed file the token is on, counting from 0
+  bool in_tree; // A syntax tree node shares string_repr and is responsible for freeing it
+  struct minimal_syntax_tree *node; // That node, for finding the constructs an edit is in
+  uint16_t mark_count; // How many times the parser has marked the token, see mark_token()
   struct minimal_token_specification *next_token;
 } MiniToken;
 
 typedef struct minimal_head_token_spec {
   uint64_t token_count;
   MiniToken *head;
+  MiniToken *tail; // Last token of the list so that appending doesn't have to walk it
 } MiniHeadToken;
 
+// Capacity of the hand-off ring between the lexer thread and the parser in streaming mode.
+// Must be a power of two
+#define MINIMAL_TOKEN_RING_SIZE 1024
+
+// How many already consumed tokens are always kept linked behind the parser in streaming mode,
+// for the parse functions that keep the token before the one they are on. Older tokens are
+// freed as new ones arrive, up to the oldest marked one (see mark_token())
+#define MINIMAL_TOKEN_LOOKBEHIND 8
+
+// Bounded queue through which a lexer thread hands tokens to the parser. The parser never
+// sees the queue directly: next_token() pulls from it whenever it runs off the end of the
+// token list it was given, so the parser code is the same in streaming and batch mode
+typedef struct minimal_token_stream {
+  MiniToken *ring[MINIMAL_TOKEN_RING_SIZE];
+  size_t first;
+  size_t count;
+  bool closed; // The lexer has produced its last token
+  bool draining; // The parser has stopped pulling, the lexer discards the rest of its tokens
+  MiniStatus lex_status;
+  MiniHeadToken *window; // Tokens pulled by the parser that haven't been freed yet
+  pthread_mutex_t lock;
+  pthread_cond_t not_empty;
+  pthread_cond_t not_full;
+  pthread_t lexer_thread;
+} MiniTokenStream;
+
+// Operation counter for the complexity fuzzer (tools/fuzz.c). Building with
+// -DMINIMAL_WORK_COUNT makes COUNT_WORK() add to mini_work_count at the steps the lexer and
+// parsers repeat per character, token and node. Otherwise it compiles to nothing
+#ifdef MINIMAL_WORK_COUNT
+extern uint64_t mini_work_count;
+#define COUNT_WORK(amount) __atomic_add_fetch(&mini_work_count, (uint64_t)(amount), __ATOMIC_RELAXED)
+#else
+#define COUNT_WORK(amount) ((void)0)
+#endif
+
 // Token functions:
 char *desc_token(MiniTokenName name);
+int token_index(MiniTokenName name);
 MiniToken *alloc_token(MiniStatus *status);
 MiniStatus init_token(MiniToken *token, char *string, int category, int name);
 void add_token(MiniHeadToken *head_token, MiniToken *new_token);
+void append_tokens(MiniHeadToken *head_token, MiniHeadToken *tail_tokens);
+void splice_tokens(MiniHeadToken *head_token, MiniToken *before, MiniToken *after, MiniHeadToken *replacement);
 bool last_token(MiniToken *current_token);
+MiniToken *first_token(MiniHeadToken *head_token);
+MiniToken *peek_token(MiniToken *current_token);
 MiniToken *next_token(MiniToken *current_token, MiniStatus *status);
+// Line of the token first_token() or next_token() last returned on the calling thread
+uint32_t reached_token_line(void);
+// A parse function that goes back to a token after moving past it (to recover from an error
+// or after scanning ahead) marks it first, so that streaming mode keeps it and every token
+// after it, and unmarks it once it is done with it
+void mark_token(MiniToken *token);
+void unmark_token(MiniToken *token);
 void print_tokens(MiniHeadToken *head_token);
 void free_tokens(MiniHeadToken *head_token);
 
+// Token stream functions:
+MiniStatus init_token_stream(MiniTokenStream *stream, MiniHeadToken *window);
+void push_tokens(MiniTokenStream *stream, MiniHeadToken *tokens);
+void close_token_stream(MiniTokenStream *stream, MiniStatus lex_status);
+void attach_token_stream(MiniTokenStream *stream);
+bool token_stream_attached(void);
+void drain_token_stream(MiniTokenStream *stream);
+void free_token_stream(MiniTokenStream *stream);
+
+// Type table functions:
+MiniStatus intern_type_keyword(char *keyword, MiniTypeId *id);
+MiniStatus intern_pointer_type(MiniTypeId id, uint32_t pointer_depth, MiniTypeId *result);
+const MiniType *get_type(MiniTypeId id);
+MiniTypeId last_type_id(void); // Types in use have the ids from 1 to this
+void file_print_type(FILE *file_ptr, MiniTypeId id);
+void free_type_table(void);
+
+// Symbol table functions:
+MiniStatus intern_symbol(const char *name, MiniSymbolId *id);
+const char *symbol_name(MiniSymbolId id);
+uint32_t symbol_count(void);
+void free_symbol_table(void);
+
 // Lexer functions:
 MiniStatus tokenize(char *input_file, char *output_file, MiniHeadToken *head_token, int verbose);
+MiniStatus start_tokenize_stream(char *input_file, char *output_file, MiniTokenStream *stream, int verbose);
+MiniStatus finish_tokenize_stream(MiniTokenStream *stream);
+MiniStatus tokenize_text_lines(char **lines, int line_count, int first_line, MiniHeadToken *head_token);
 
 #endif
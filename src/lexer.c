@@ -25,10 +25,13 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
-#include <ctype.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
 #include "inc/retcodes.h"
 #include "inc/preprocessor.h"
 #include "inc/tokens.h"
+#include "inc/options.h"
 
 // XXX: If need new symbols, maybe use '&' since it only has 1 use at the moment
 // Also backticks ` and apostrophes ' are not currently used
@@ -91,6 +94,59 @@ const char *MINIMAL_COMP_OP[] = {"=", "~=", "<", ">", "<=", ">="};
 const char *MINIMAL_BIN_LOG_OP[] = {"V", "&"};
 const char *MINIMAL_UNA_LOG_OP[] = {"~"};
 
+// Character classes of Minimal source text. Every byte maps to a set of these flags in
+// MINIMAL_CHAR_CLASSES so each lexer predicate costs one table load and one mask per character.
+// Unlike <ctype.h> the table doesn't depend on the C locale and bytes >= 0x80 have no class.
+// The CC_TYPE_* entries must be kept in sync with MINIMAL_VAR_KW_BEGIN_SYMBOLS and
+// MINIMAL_VAR_KW_MID_SYMBOLS above
+enum minimal_char_classes {
+  CC_UPPER = 1 << 0,
+  CC_LOWER = 1 << 1,
+  CC_DIGIT = 1 << 2,
+  CC_SPACE = 1 << 3,
+  CC_UNDERSCORE = 1 << 4,
+  CC_TYPE_BEGIN = 1 << 5,
+  CC_TYPE_MID = 1 << 6
+};
+
+static const uint8_t MINIMAL_CHAR_CLASSES[256] = {
+  ['\t'] = CC_SPACE, ['\n'] = CC_SPACE, ['\v'] = CC_SPACE, ['\f'] = CC_SPACE, ['\r'] = CC_SPACE,
+  [' '] = CC_SPACE, ['"'] = CC_TYPE_MID, ['#'] = CC_TYPE_MID, ['%'] = CC_TYPE_MID,
+  [','] = CC_TYPE_MID, ['0'] = CC_DIGIT, ['1'] = CC_DIGIT, ['2'] = CC_DIGIT, ['3'] = CC_DIGIT,
+  ['4'] = CC_DIGIT, ['5'] = CC_DIGIT, ['6'] = CC_DIGIT, ['7'] = CC_DIGIT, ['8'] = CC_DIGIT,
+  ['9'] = CC_DIGIT, [':'] = CC_TYPE_MID, ['<'] = CC_TYPE_BEGIN,
+  ['A'] = CC_UPPER, ['B'] = CC_UPPER | CC_TYPE_MID, ['C'] = CC_UPPER, ['D'] = CC_UPPER,
+  ['E'] = CC_UPPER | CC_TYPE_MID, ['F'] = CC_UPPER, ['G'] = CC_UPPER, ['H'] = CC_UPPER,
+  ['I'] = CC_UPPER, ['J'] = CC_UPPER, ['K'] = CC_UPPER, ['L'] = CC_UPPER, ['M'] = CC_UPPER,
+  ['N'] = CC_UPPER, ['O'] = CC_UPPER, ['P'] = CC_UPPER, ['Q'] = CC_UPPER, ['R'] = CC_UPPER,
+  ['S'] = CC_UPPER | CC_TYPE_MID, ['T'] = CC_UPPER, ['U'] = CC_UPPER | CC_TYPE_MID,
+  ['V'] = CC_UPPER, ['W'] = CC_UPPER, ['X'] = CC_UPPER, ['Y'] = CC_UPPER, ['Z'] = CC_UPPER,
+  ['['] = CC_TYPE_BEGIN, ['^'] = CC_TYPE_MID, ['_'] = CC_UNDERSCORE,
+  ['a'] = CC_LOWER, ['b'] = CC_LOWER, ['c'] = CC_LOWER, ['d'] = CC_LOWER, ['e'] = CC_LOWER,
+  ['f'] = CC_LOWER, ['g'] = CC_LOWER, ['h'] = CC_LOWER, ['i'] = CC_LOWER, ['j'] = CC_LOWER,
+  ['k'] = CC_LOWER, ['l'] = CC_LOWER, ['m'] = CC_LOWER, ['n'] = CC_LOWER, ['o'] = CC_LOWER,
+  ['p'] = CC_LOWER, ['q'] = CC_LOWER, ['r'] = CC_LOWER, ['s'] = CC_LOWER, ['t'] = CC_LOWER,
+  ['u'] = CC_LOWER, ['v'] = CC_LOWER, ['w'] = CC_LOWER, ['x'] = CC_LOWER, ['y'] = CC_LOWER,
+  ['z'] = CC_LOWER, ['{'] = CC_TYPE_BEGIN,
+};
+
+static bool has_class(char symbol, uint8_t classes) {
+  return (MINIMAL_CHAR_CLASSES[(unsigned char)symbol] & classes) != 0;
+}
+
+// The closing symbol that matches an opening type keyword symbol ('<' -> '>' etc.)
+static char closing_type_symbol(char begin) {
+  switch (begin) {
+    case '<':
+      return '>';
+    case '[':
+      return ']';
+    case '{':
+      return '}';
+  }
+  return '\0';
+}
+
 
 static bool is_comment(char *string) {
   if (strlen(string) < 2) {
@@ -110,11 +166,11 @@ static bool is_identifier(char *candidate) {
   size_t len = strlen(candidate);
   if (len == 0) {
     return false;
-  } else if (isupper(candidate[0])) {
+  } else if (has_class(candidate[0], CC_UPPER)) {
     if (len == 1) {
       return false;
     } else if (len == 2) {
-      if (isupper(candidate[1]) || isdigit(candidate[1])) {
+      if (has_class(candidate[1], CC_UPPER | CC_DIGIT)) {
         return true;
       } else {
         return false;
@@ -122,21 +178,21 @@ static bool is_identifier(char *candidate) {
     } else {
       if (candidate[0] == 'C' && candidate[1] == ':') {
         for (size_t i = 2; i < len; i++) {
-          if (!isdigit(candidate[i]) && !islower(candidate[i]) && candidate[i] != '_') {
+          if (!has_class(candidate[i], CC_DIGIT | CC_LOWER | CC_UNDERSCORE)) {
             return false;
           }
         }
         return true;
       } else if (len - 2 <= MINIMAL_IDENTIFIER_MAX_LEN && candidate[0] == 'M' && candidate[1] == ':') {
         for (size_t i = 2; i < len; i++) {
-          if (!isdigit(candidate[i]) && !islower(candidate[i])) {
+          if (!has_class(candidate[i], CC_DIGIT | CC_LOWER)) {
             return false;
           }
         }
         return true;
       } else if (len <= MINIMAL_IDENTIFIER_MAX_LEN) {
         for (size_t i = 1; i < len; i++) {
-          if (!isupper(candidate[i]) && !isdigit(candidate[i])) {
+          if (!has_class(candidate[i], CC_UPPER | CC_DIGIT)) {
             return false;
           }
         }
@@ -145,10 +201,10 @@ static bool is_identifier(char *candidate) {
         return false;
       }
     }
-  } else if (islower(candidate[0])) {
+  } else if (has_class(candidate[0], CC_LOWER)) {
     if (len <= MINIMAL_IDENTIFIER_MAX_LEN) {
       for (size_t i = 1; i < len; i++) {
-        if (!islower(candidate[i]) && !isdigit(candidate[i])) {
+        if (!has_class(candidate[i], CC_LOWER | CC_DIGIT)) {
           return false;
         }
       }
@@ -165,19 +221,7 @@ static bool is_type_keyword(char *candidate) {
   size_t len = strlen(candidate);
   char begin = candidate[0];
 
-  size_t begin_count = strlen(MINIMAL_VAR_KW_BEGIN_SYMBOLS);
-  size_t mid_count = strlen(MINIMAL_VAR_KW_MID_SYMBOLS);
-  size_t end_count = strlen(MINIMAL_VAR_KW_END_SYMBOLS);
-  
-  int begin_id = -1;
-  for (size_t i = 0; i < begin_count; i++) {
-    if (MINIMAL_VAR_KW_BEGIN_SYMBOLS[i] == begin) {
-      begin_id = i;
-      break;
-    }
-  }
-
-  if (begin_id == -1) {
+  if (!has_class(begin, CC_TYPE_BEGIN)) {
     return false;
   }
 
@@ -194,30 +238,12 @@ static bool is_type_keyword(char *candidate) {
   }
   
   char end = candidate[end_position];
-  int end_id = -1;
-  for (size_t i = 0; i < end_count; i++) {
-    if (MINIMAL_VAR_KW_END_SYMBOLS[i] == end) {
-      end_id = i;
-      break;
-    }
-  }
-
-  if (end_id == -1) {
-    return false;
-  }
-
-  if (begin_id != end_id) {
+  if (end != closing_type_symbol(begin)) {
     return false;
   }
   
   for (int i = 1; i < end_position; i++) {
-    bool valid = false;
-    for (size_t j = 0; j < mid_count; j++) {
-      if (candidate[i] == MINIMAL_VAR_KW_MID_SYMBOLS[j]) {
-        valid = true;
-      }
-    }
-    if (!valid) {
+    if (!has_class(candidate[i], CC_TYPE_MID)) {
       return false;
     }
   }
@@ -235,13 +261,13 @@ static bool is_custom_type_kw(char *candidate) {
     return false;
   }
 
-  if (!(islower(candidate[1]))) {
+  if (!has_class(candidate[1], CC_LOWER)) {
     return false;
   }
   if (length == 3) return true;
 
   for (size_t i = 2; i < length - 1; i++) {
-    if (!(islower(candidate[i]) || isdigit(candidate[i]))) {
+    if (!has_class(candidate[i], CC_LOWER | CC_DIGIT)) {
       return false;
     }
   }
@@ -414,7 +440,7 @@ static bool is_number(char *candidate) {
     i = 0;
   }
   for (i = i; i < len; i++) {
-    if (!isdigit(candidate[i])) {
+    if (!has_class(candidate[i], CC_DIGIT)) {
       switch (candidate[i]) {
         case '.':
           if (decimal_found) {
@@ -470,7 +496,7 @@ static MiniTokenCat categorize_token(char *token) {
     return UNCLASSIFIABLE;
   }
 
-  if (len == 1 && isspace(token[0])) {
+  if (len == 1 && has_class(token[0], CC_SPACE)) {
     return WHITESPACE;
   }
 
@@ -478,7 +504,7 @@ static MiniTokenCat categorize_token(char *token) {
     return COMMENT;
   }
 
-  if (isalpha(token[0]) || token[0] == '_') {
+  if (has_class(token[0], CC_UPPER | CC_LOWER | CC_UNDERSCORE)) {
     if (is_identifier(token)) {
       return IDENTIFIER;
     } else {
@@ -495,7 +521,7 @@ static MiniTokenCat categorize_token(char *token) {
     }
   }
 
-  if (isdigit(token[0]) || (token[0] == '-' && isdigit(token[1]))) {
+  if (has_class(token[0], CC_DIGIT) || (token[0] == '-' && has_class(token[1], CC_DIGIT))) {
     if (is_number(token)) {
       return LITERAL;
     } else {
@@ -574,6 +600,152 @@ static MiniTokenCat categorize_token(char *token) {
   return UNCLASSIFIABLE;
 }
 
+// Length of the longest entry of keywords that text starts with, 0 if there is none
+static size_t longest_keyword(char *text, size_t length, const char **keywords, size_t count) {
+  size_t longest = 0;
+  for (size_t i = 0; i < count; i++) {
+    size_t keyword_length = strlen(keywords[i]);
+    if (keyword_length > longest && keyword_length <= length && strncmp(text, keywords[i], keyword_length) == 0) {
+      longest = keyword_length;
+    }
+  }
+  return longest;
+}
+
+#define LONGEST_KEYWORD(text, length, keywords) longest_keyword(text, length, keywords, sizeof(keywords) / sizeof(char *))
+
+// Number of characters from start in classes
+static size_t class_run(char *text, size_t start, size_t length, uint8_t classes) {
+  size_t end = start;
+  while (end < length && has_class(text[end], classes)) {
+    end++;
+  }
+  return end - start;
+}
+
+static size_t identifier_length(char *text, size_t length) {
+  size_t run;
+  if (has_class(text[0], CC_LOWER)) {
+    run = 1 + class_run(text, 1, length, CC_LOWER | CC_DIGIT);
+    return run < MINIMAL_IDENTIFIER_MAX_LEN ? run : MINIMAL_IDENTIFIER_MAX_LEN;
+  }
+  if (!has_class(text[0], CC_UPPER) || length < 2) {
+    return 0;
+  }
+  if (text[1] == ':' && text[0] == 'C') {
+    run = class_run(text, 2, length, CC_DIGIT | CC_LOWER | CC_UNDERSCORE);
+    return run == 0 ? 0 : 2 + run;
+  }
+  if (text[1] == ':' && text[0] == 'M') {
+    run = class_run(text, 2, length, CC_DIGIT | CC_LOWER);
+    if (run > MINIMAL_IDENTIFIER_MAX_LEN) run = MINIMAL_IDENTIFIER_MAX_LEN;
+    return run == 0 ? 0 : 2 + run;
+  }
+  run = 1 + class_run(text, 1, length, CC_UPPER | CC_DIGIT);
+  if (run < 2) return 0;
+  return run < MINIMAL_IDENTIFIER_MAX_LEN ? run : MINIMAL_IDENTIFIER_MAX_LEN;
+}
+
+static size_t number_length(char *text, size_t length) {
+  bool decimal_found = false;
+  bool exp_found = false;
+  size_t end = text[0] == '-' ? 1 : 0;
+  for (; end < length; end++) {
+    if (has_class(text[end], CC_DIGIT)) continue;
+    if (text[end] == '.' && !decimal_found) {
+      decimal_found = true;
+    } else if (text[end] == 'e' && !exp_found) {
+      exp_found = true;
+    } else {
+      break;
+    }
+  }
+  return end;
+}
+
+// A string is closed by its second unescaped quote and can go on to the last escaped quote
+// before a third one, like is_string() counts them
+static size_t string_length(char *text, size_t length) {
+  size_t longest = 0;
+  for (size_t end = 1; end < length; end++) {
+    if (text[end] != '"') continue;
+    bool escaped = text[end - 1] == '\\';
+    if (longest == 0 && !escaped) {
+      longest = end + 1;
+    } else if (longest != 0 && escaped) {
+      longest = end + 1;
+    } else if (longest != 0) {
+      break;
+    }
+  }
+  return longest;
+}
+
+static size_t type_keyword_length(char *text, size_t length) {
+  size_t longest = 0;
+  if (has_class(text[0], CC_TYPE_BEGIN)) {
+    size_t end = 1 + class_run(text, 1, length, CC_TYPE_MID);
+    if (end < length && text[end] == closing_type_symbol(text[0])) {
+      for (end++; end < length && text[end] == '^'; end++);
+      longest = end;
+    }
+  }
+  if (text[0] == '<' && length > 1 && has_class(text[1], CC_LOWER)) {
+    size_t end = 2 + class_run(text, 2, length, CC_LOWER | CC_DIGIT);
+    if (end < length && text[end] == '>' && end + 1 > longest) {
+      longest = end + 1;
+    }
+  }
+  return longest;
+}
+
+// Length of the longest prefix of text that categorize_token() classifies, 0 if there is none.
+// The categories are tried in the same order as there, each in a single scan, so lexing a line
+// takes time linear in its length instead of trying every prefix of what is left of it
+static size_t classifiable_length(char *text, size_t length) {
+  if (length == 0) {
+    return 0;
+  }
+  if (length >= 2 && text[0] == '/' && text[1] == '/') {
+    return length;
+  }
+  if (has_class(text[0], CC_UPPER | CC_LOWER | CC_UNDERSCORE)) {
+    size_t longest = identifier_length(text, length);
+    size_t keyword = text[0] == 'C' || text[0] == 'M' ? LONGEST_KEYWORD(text, length, MINIMAL_CONTROL_KWDS)
+                                                      : LONGEST_KEYWORD(text, length, MINIMAL_LITERAL_KWDS);
+    return keyword > longest ? keyword : longest;
+  }
+  if (has_class(text[0], CC_DIGIT) || (text[0] == '-' && length > 1 && has_class(text[1], CC_DIGIT))) {
+    return number_length(text, length);
+  }
+  if (text[0] == '"') {
+    return string_length(text, length);
+  }
+
+  size_t longest = has_class(text[0], CC_SPACE) ? 1 : 0;
+  size_t candidates[] = {
+    type_keyword_length(text, length),
+    LONGEST_KEYWORD(text, length, MINIMAL_BRANCH_KWDS),
+    LONGEST_KEYWORD(text, length, MINIMAL_TERM_KWDS),
+    LONGEST_KEYWORD(text, length, MINIMAL_CONTROL_KWDS),
+    LONGEST_KEYWORD(text, length, MINIMAL_PROGRAM_BLOCK_KWDS),
+    LONGEST_KEYWORD(text, length, MINIMAL_LITERAL_KWDS),
+    LONGEST_KEYWORD(text, length, MINIMAL_PAREN_SEP),
+    LONGEST_KEYWORD(text, length, MINIMAL_PUNCT_SEP),
+    LONGEST_KEYWORD(text, length, MINIMAL_BIN_MATH_OP),
+    LONGEST_KEYWORD(text, length, MINIMAL_UNA_MATH_OP),
+    LONGEST_KEYWORD(text, length, MINIMAL_BIN_ASSIGN_OP),
+    LONGEST_KEYWORD(text, length, MINIMAL_UNA_ASSIGN_OP),
+    LONGEST_KEYWORD(text, length, MINIMAL_COMP_OP),
+    LONGEST_KEYWORD(text, length, MINIMAL_BIN_LOG_OP),
+    LONGEST_KEYWORD(text, length, MINIMAL_UNA_LOG_OP)
+  };
+  for (size_t i = 0; i < sizeof(candidates) / sizeof(candidates[0]); i++) {
+    if (candidates[i] > longest) longest = candidates[i];
+  }
+  return longest;
+}
+
 static MiniTokenName name_identifier(char *token) {
   char first = token[0];
   switch (first) {
@@ -582,7 +754,7 @@ static MiniTokenName name_identifier(char *token) {
     case 'C':
       return C_ID; 
     default:
-      if (isupper(first)) {
+      if (has_class(first, CC_UPPER)) {
         return MINI_CONST_ID;
       } else {
         return MINI_ID;
@@ -591,7 +763,8 @@ static MiniTokenName name_identifier(char *token) {
 }
 
 static MiniTokenName name_type(char *token) {
-  // TODO: Implement a type namer for arbitratry types. Perhaps at semantic analysis stage?
+  // Only picks the coarse token name. The full structure of the type, including member
+  // types and pointer depth, is interned by intern_type_keyword() in types.c
   char first = token[0];
   char second = token[1];
   switch (first) {
@@ -938,15 +1111,378 @@ static MiniTokenName name_token(char *token, MiniTokenCat category) {
       return name_literal(token);
     default:
       return name_irrelevant(token);
-  } 
+  }
+}
+
+// Powers of ten that are exactly representable as doubles. A decimal mantissa below 2^53
+// multiplied or divided by one of these is correctly rounded (Clinger's fast path)
+static const double EXACT_POWERS_OF_TEN[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+static const int MAX_EXACT_POWER_OF_TEN = 22;
+static const uint64_t MAX_EXACT_MANTISSA = (uint64_t)1 << 53;
+static const int MAX_MANTISSA_DIGITS = 19; // Any 19 digit number fits in a uint64_t
+static const int MAX_EXPONENT = 100000; // Exponent digits saturate here, the result is 0 or inf anyway
+
+// Reads the digits after an 'e' that is_number() allows. The exponent is never negative
+static int decode_exponent(char *digits, size_t *index) {
+  int exponent = 0;
+  size_t i = *index;
+  for (; has_class(digits[i], CC_DIGIT); i++) {
+    if (exponent < MAX_EXPONENT) {
+      exponent = exponent * 10 + (digits[i] - '0');
+    }
+  }
+  *index = i;
+  return exponent;
 }
 
+static MiniStatus decode_int_literal(char *literal, int64_t *value) {
+  bool negative = literal[0] == '-';
+  size_t i = negative ? 1 : 0;
+  uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+  uint64_t result = 0;
 
+  for (; has_class(literal[i], CC_DIGIT); i++) {
+    uint64_t digit = literal[i] - '0';
+    if (result > (limit - digit) / 10) {
+      return LITERAL_OUT_OF_RANGE;
+    }
+    result = result * 10 + digit;
+  }
 
-MiniStatus tokenize(char *input_file, char *output_file, MiniHeadToken *head_token, int verbose) {
-  if (verbose) {
-    printf("Beginning tokenization\n");
+  if (literal[i] == 'e') {
+    i++;
+    int exponent = decode_exponent(literal, &i);
+    for (int j = 0; j < exponent && result != 0; j++) {
+      if (result > limit / 10) {
+        return LITERAL_OUT_OF_RANGE;
+      }
+      result *= 10;
+    }
+  }
+
+  if (literal[i] != '\0') {
+    return INVALID_SYNTAX;
   }
+
+  if (negative) {
+    *value = result == 0 ? 0 : -(int64_t)(result - 1) - 1;
+  } else {
+    *value = (int64_t)result;
+  }
+  return SUCCESS;
+}
+
+static MiniStatus decode_float_literal(char *literal, double *value) {
+  bool negative = literal[0] == '-';
+  size_t i = negative ? 1 : 0;
+  uint64_t mantissa = 0;
+  int mantissa_digits = 0;
+  int exponent = 0;
+  bool point_found = false;
+  bool truncated = false;
+
+  for (;; i++) {
+    char current = literal[i];
+    if (has_class(current, CC_DIGIT)) {
+      if (mantissa == 0 && current == '0') {
+        // Leading zeros aren't significant
+        if (point_found) exponent--;
+      } else if (mantissa_digits < MAX_MANTISSA_DIGITS) {
+        mantissa = mantissa * 10 + (current - '0');
+        mantissa_digits++;
+        if (point_found) exponent--;
+      } else {
+        truncated = true;
+        if (!point_found) exponent++;
+      }
+    } else if (current == '.' && !point_found) {
+      point_found = true;
+    } else {
+      break;
+    }
+  }
+
+  if (literal[i] == 'e') {
+    i++;
+    exponent += decode_exponent(literal, &i);
+  }
+
+  if (literal[i] != '\0') {
+    return INVALID_SYNTAX;
+  }
+
+  double result;
+  if (!truncated && mantissa <= MAX_EXACT_MANTISSA
+      && exponent >= -MAX_EXACT_POWER_OF_TEN && exponent <= MAX_EXACT_POWER_OF_TEN) {
+    result = (double)mantissa;
+    if (exponent < 0) {
+      result /= EXACT_POWERS_OF_TEN[-exponent];
+    } else {
+      result *= EXACT_POWERS_OF_TEN[exponent];
+    }
+    if (negative) result = -result;
+  } else {
+    // Slow path: long mantissas and large exponents are left to the C library, which
+    // rounds correctly. The format has already been validated above
+    result = strtod(literal, NULL);
+  }
+
+  if (isinf(result)) {
+    return LITERAL_OUT_OF_RANGE;
+  }
+  *value = result;
+  return SUCCESS;
+}
+
+// Decodes the binary value of a numeric literal token so later stages can use it directly
+static MiniStatus decode_literal(char *token, MiniTokenName name, MiniLitValue *value) {
+  if (name == INT_LITERAL) {
+    return decode_int_literal(token, &value->int_value);
+  } else if (name == FLOAT_LITERAL) {
+    return decode_float_literal(token, &value->float_value);
+  }
+  value->int_value = 0;
+  return SUCCESS;
+}
+
+
+
+// Preprocessed files at least this big are split into chunks that are lexed in parallel
+static const long PARALLEL_LEX_THRESHOLD = 1 << 20;
+#define MAX_LEX_THREADS 16
+
+// A contiguous run of preprocessed lines that is lexed independently of the rest of the file.
+// The token listing and any diagnostics are collected in memory and only written out once all
+// chunks are done, in file order, so that the result is identical to lexing the file serially
+typedef struct minimal_lex_chunk {
+  char *begin;
+  char *end;
+  int first_line;
+  FILE *output_ptr;
+  char *output_text;
+  size_t output_size;
+  FILE *message_ptr;
+  char *message_text;
+  size_t message_size;
+  MiniHeadToken tokens;
+  MiniStatus status;
+} MiniLexChunk;
+
+// Tokenizes one preprocessed line by repeatedly taking the longest classifiable prefix of what
+// remains of it (see classifiable_length()). The token listing goes to output_ptr, if any, and
+// diagnostics to message_ptr. Type keywords are only interned if intern_types is set
+static MiniStatus lex_line(char *line_buffer, size_t line_length, int line_count, FILE *output_ptr, FILE *message_ptr, MiniHeadToken *head_token, bool intern_types) {
+  int category;
+  int name;
+  char substring_buffer[line_length + 1]; // substring_buffer needs to be able to hold line_length printable characters
+                                          // and thus one more slot is required for the null terminator
+  size_t starting_index = 0;
+  while (starting_index < line_length) {
+    char *copy = line_buffer + starting_index;
+    size_t copy_amount = classifiable_length(copy, line_length - starting_index);
+    COUNT_WORK(copy_amount + 1);
+    if (copy_amount == 0) {
+      snprintf(substring_buffer, 2, "%s", copy);
+      fprintf(message_ptr, "Lexical error: Unclassifiable token beginning with %s approximately on line %d\n", substring_buffer, line_count + 1);
+      return INVALID_SYNTAX;
+    }
+    memcpy(substring_buffer, copy, copy_amount);
+    substring_buffer[copy_amount] = '\0';
+    category = categorize_token(substring_buffer);
+    name = name_token(substring_buffer, category);
+    MiniLitValue value;
+    MiniStatus decode_status = decode_literal(substring_buffer, name, &value);
+    if (decode_status == LITERAL_OUT_OF_RANGE) {
+      fprintf(message_ptr, "Lexical error: Numeric literal %s out of range on line %d\n", substring_buffer, line_count + 1);
+      return LITERAL_OUT_OF_RANGE;
+    } else if (decode_status != SUCCESS) {
+      fprintf(message_ptr, "Lexical error: Malformed numeric literal %s on line %d\n", substring_buffer, line_count + 1);
+      return INVALID_SYNTAX;
+    }
+    MiniTypeId type_id = MINIMAL_NO_TYPE;
+    if (category == TYPE_KW && intern_types) {
+      MiniStatus intern_status = intern_type_keyword(substring_buffer, &type_id);
+      if (intern_status == INVALID_SYNTAX) {
+        fprintf(message_ptr, "Lexical error: Malformed type keyword %s on line %d\n", substring_buffer, line_count + 1);
+        return INVALID_SYNTAX;
+      } else if (intern_status != SUCCESS) {
+        return intern_status;
+      }
+    }
+    fprintf(message_ptr, "DEBUG: Token: %s, Category: %d, Name: %d\n", substring_buffer, category, name);
+    //printf("Category: %d\n", category);
+    if (output_ptr != NULL) {
+      fprintf(output_ptr, "%d:%lu %s %d %d", line_count + 1, starting_index, substring_buffer, category, name);
+      // Numeric literals are listed with the value they decode to, floats to the last bit
+      if (name == INT_LITERAL) {
+        fprintf(output_ptr, " = %lld", (long long) value.int_value);
+      } else if (name == FLOAT_LITERAL) {
+        fprintf(output_ptr, " = %.17g", value.float_value);
+      }
+      fputc('\n', output_ptr);
+    }
+    if (category != COMMENT && category != WHITESPACE) {
+      MiniStatus status;
+      MiniToken *new_token = alloc_token(&status);
+      if (status != SUCCESS) return status;
+      status = init_token(new_token, substring_buffer, category, name);
+      if (status != SUCCESS) return status;
+      new_token->value = value;
+      new_token->type_id = type_id;
+      new_token->line = line_count;
+      add_token(head_token, new_token);
+    }
+    starting_index += copy_amount;
+  }
+  return SUCCESS;
+}
+
+// Reads the next line of [cursor, end) into line_buffer exactly like
+// fgets(line_buffer, MAX_LINE_LENGTH + 2, ...) would, so that the chunked lexer sees the same
+// lines as the serial one. line_buffer may be NULL to only skip the line. Returns NULL at the end
+static char *read_buffer_line(char *line_buffer, char *cursor, char *end) {
+  if (cursor >= end) {
+    return NULL;
+  }
+  size_t max_length = MAX_LINE_LENGTH + 1;
+  if ((size_t)(end - cursor) < max_length) {
+    max_length = end - cursor;
+  }
+  char *newline = memchr(cursor, '\n', max_length);
+  size_t length = newline ? (size_t)(newline - cursor) + 1 : max_length;
+  if (line_buffer != NULL) {
+    memcpy(line_buffer, cursor, length);
+    line_buffer[length] = '\0';
+  }
+  return cursor + length;
+}
+
+static void *lex_chunk(void *argument) {
+  MiniLexChunk *chunk = argument;
+  char line_buffer[MAX_LINE_LENGTH + 2];
+  int line_count = chunk->first_line;
+  char *cursor = chunk->begin;
+  chunk->status = SUCCESS;
+  while ((cursor = read_buffer_line(line_buffer, cursor, chunk->end)) != NULL) {
+    size_t line_length = strcspn(line_buffer, "\n");
+    line_buffer[line_length] = '\0';
+    chunk->status = lex_line(line_buffer, line_length, line_count, chunk->output_ptr, chunk->message_ptr, &chunk->tokens, false);
+    if (chunk->status != SUCCESS) {
+      break;
+    }
+    line_count++;
+  }
+  return NULL;
+}
+
+// Interns the type keywords among the tokens of a chunk. The chunks leave this to the join,
+// which goes through them in file order, so the type ids come out the same as when the file
+// is lexed on one thread, whichever chunk finishes first
+static MiniStatus intern_chunk_types(MiniHeadToken *tokens) {
+  for (MiniToken *token = tokens->head; token != NULL; token = token->next_token) {
+    if (token->category != TYPE_KW) continue;
+    MiniStatus status = intern_type_keyword(token->string_repr, &token->type_id);
+    if (status == INVALID_SYNTAX) {
+      printf("Lexical error: Malformed type keyword %s on line %u\n", token->string_repr, token->line + 1);
+      return status;
+    } else if (status != SUCCESS) return status;
+  }
+  return SUCCESS;
+}
+
+static char *read_whole_file(FILE *input_ptr, long *size, MiniStatus *status) {
+  fseek(input_ptr, 0, SEEK_END);
+  *size = ftell(input_ptr);
+  rewind(input_ptr);
+  char *buffer = malloc(*size);
+  if (buffer == NULL) {
+    printf("tokenize: Memory Error: Failed to allocate space for preprocessed file contents\n");
+    *status = ALLOCATION_FAIL;
+    return NULL;
+  }
+  *size = fread(buffer, 1, *size, input_ptr);
+  *status = SUCCESS;
+  return buffer;
+}
+
+// Splits a large preprocessed file into one chunk per thread at line boundaries, lexes the chunks
+// concurrently and concatenates the results in file order. Lexing stops at the first chunk that
+// fails, exactly where the serial lexer would have stopped
+static MiniStatus tokenize_parallel(FILE *input_ptr, FILE *output_ptr, MiniHeadToken *head_token, long thread_count) {
+  MiniStatus status;
+  long size;
+  char *buffer = read_whole_file(input_ptr, &size, &status);
+  if (status != SUCCESS) return status;
+  char *end = buffer + size;
+
+  MiniLexChunk chunks[MAX_LEX_THREADS];
+  pthread_t threads[MAX_LEX_THREADS];
+  bool thread_started[MAX_LEX_THREADS];
+  long chunk_size = size / thread_count;
+  char *cursor = buffer;
+  int line_count = 0;
+  for (long i = 0; i < thread_count; i++) {
+    MiniLexChunk *chunk = &chunks[i];
+    memset(chunk, 0, sizeof(MiniLexChunk));
+    chunk->begin = cursor;
+    chunk->first_line = line_count;
+    // Line numbers are needed up front for the listing, so count the lines while looking for
+    // the chunk boundary. This is a memchr per line which is cheap compared to lexing it
+    char *goal = (i == thread_count - 1) ? end : buffer + (i + 1) * chunk_size;
+    while (cursor < goal) {
+      cursor = read_buffer_line(NULL, cursor, end);
+      line_count++;
+    }
+    chunk->end = cursor;
+    chunk->output_ptr = open_memstream(&chunk->output_text, &chunk->output_size);
+    chunk->message_ptr = open_memstream(&chunk->message_text, &chunk->message_size);
+    if (chunk->output_ptr == NULL || chunk->message_ptr == NULL) {
+      printf("tokenize: Memory Error: Failed to allocate space for chunk output\n");
+      if (chunk->output_ptr != NULL) fclose(chunk->output_ptr);
+      if (chunk->message_ptr != NULL) fclose(chunk->message_ptr);
+      free(chunk->output_text);
+      free(chunk->message_text);
+      // Chunks that were already started still need to be joined before giving up
+      thread_count = i;
+      status = ALLOCATION_FAIL;
+      break;
+    }
+    thread_started[i] = pthread_create(&threads[i], NULL, lex_chunk, chunk) == 0;
+    if (!thread_started[i]) {
+      lex_chunk(chunk);
+    }
+  }
+
+  for (long i = 0; i < thread_count; i++) {
+    if (thread_started[i]) {
+      pthread_join(threads[i], NULL);
+    }
+    fclose(chunks[i].output_ptr);
+    fclose(chunks[i].message_ptr);
+  }
+
+  for (long i = 0; i < thread_count; i++) {
+    MiniLexChunk *chunk = &chunks[i];
+    if (status == SUCCESS) {
+      fwrite(chunk->output_text, 1, chunk->output_size, output_ptr);
+      fwrite(chunk->message_text, 1, chunk->message_size, stdout);
+      status = intern_chunk_types(&chunk->tokens);
+      append_tokens(head_token, &chunk->tokens);
+      if (status == SUCCESS) status = chunk->status;
+    } else {
+      free_tokens(&chunk->tokens);
+    }
+    free(chunk->output_text);
+    free(chunk->message_text);
+  }
+  free(buffer);
+  return status;
+}
+
+static void default_token_file(char *input_file, char *output_file) {
   size_t filename_len = strlen(input_file);
   if (output_file[0] == '\0') {
     strcpy(output_file, input_file);
@@ -955,6 +1491,11 @@ MiniStatus tokenize(char *input_file, char *output_file, MiniHeadToken *head_tok
     output_file[filename_len - 2] = 'k';
     output_file[filename_len - 1] = 'e';
   }
+}
+
+// Lexes input_file line by line. Without a stream the tokens are added to head_token.
+// With a stream, each line's tokens are pushed to it as soon as the line is done
+static MiniStatus tokenize_lines(char *input_file, char *output_file, MiniHeadToken *head_token, MiniTokenStream *stream, int verbose) {
   if (verbose) {
     printf("Output file: %s\n", output_file);
   }
@@ -967,56 +1508,49 @@ MiniStatus tokenize(char *input_file, char *output_file, MiniHeadToken *head_tok
   input_ptr = fopen(input_file, "r");
   if (input_ptr == NULL) {
     printf("File Error: Preprocessed file %s couldn't be found!\n", input_file);
-    fclose(input_ptr);
     fclose(output_ptr);
     return FILE_NOT_FOUND;
   }
 
+  MiniStatus status;
+  long thread_count = lex_thread_count > 0 ? lex_thread_count : sysconf(_SC_NPROCESSORS_ONLN);
+  if (thread_count > MAX_LEX_THREADS) {
+    thread_count = MAX_LEX_THREADS;
+  }
+  fseek(input_ptr, 0, SEEK_END);
+  long file_size = ftell(input_ptr);
+  rewind(input_ptr);
+  if (stream == NULL && file_size >= PARALLEL_LEX_THRESHOLD && thread_count > 1) {
+    status = tokenize_parallel(input_ptr, output_ptr, head_token, thread_count);
+    fclose(input_ptr);
+    fclose(output_ptr);
+    if (status == SUCCESS && verbose) {
+      printf("Tokenization complete\n");
+    }
+    return status;
+  }
 
+  MiniHeadToken line_tokens = {.token_count = 0, .head = NULL, .tail = NULL};
   int line_count = 0;
   size_t line_length;
-  int category;
-  int name;
   while (fgets(line_buffer, MAX_LINE_LENGTH + 2, input_ptr) != NULL) {
     line_length = strcspn(line_buffer, "\n");
     line_buffer[line_length] = '\0';
-    char substring_buffer[line_length + 1]; // substring_buffer needs to be able to hold line_length printable characters
-                                            // and thus one more slot is required for the null terminator
-    size_t starting_index = 0;
-    for (size_t i = 0; i < line_length; i++) {
-      if (starting_index >= line_length) {
-        break;
-      }
-      size_t copy_amount = line_length - i - starting_index;
-      char *copy = line_buffer + starting_index;
-      strncpy(substring_buffer, copy, copy_amount);
-      substring_buffer[copy_amount] = '\0';
-      //printf("DEBUG: Current substring: %s\n", substring_buffer);
-      category = categorize_token(substring_buffer);
-      if (category == UNCLASSIFIABLE) {
-        if (copy_amount <= 1) {
-          printf("Lexical error: Unclassifiable token beginning with %s approximately on line %d\n", substring_buffer, line_count + 1);
-          fclose(input_ptr);
-          fclose(output_ptr);
-          return INVALID_SYNTAX;
-        }
+    if (stream == NULL) {
+      status = lex_line(line_buffer, line_length, line_count, output_ptr, stdout, head_token, true);
+    } else {
+      status = lex_line(line_buffer, line_length, line_count, output_ptr, stdout, &line_tokens, true);
+      if (status == SUCCESS) {
+        push_tokens(stream, &line_tokens);
       } else {
-        name = name_token(substring_buffer, category);
-        printf("DEBUG: Token: %s, Category: %d, Name: %d\n", substring_buffer, category, name);
-        //printf("Category: %d\n", category);
-        fprintf(output_ptr, "%d:%lu %s %d %d\n", line_count + 1, starting_index, substring_buffer, category, name); 
-        if (category != COMMENT && category != WHITESPACE) {
-          MiniStatus status;
-          MiniToken *new_token = alloc_token(&status);
-          if (status != SUCCESS) return status;
-          status = init_token(new_token, substring_buffer, category, name);
-          if (status != SUCCESS) return status;
-          add_token(head_token, new_token);
-        }
-        starting_index += line_length - i - starting_index;
-        i = -1;
+        free_tokens(&line_tokens);
       }
     }
+    if (status != SUCCESS) {
+      fclose(input_ptr);
+      fclose(output_ptr);
+      return status;
+    }
     line_count++;
   }
 
@@ -1033,5 +1567,85 @@ MiniStatus tokenize(char *input_file, char *output_file, MiniHeadToken *head_tok
   }
   return SUCCESS;
 }
-  
 
+MiniStatus tokenize(char *input_file, char *output_file, MiniHeadToken *head_token, int verbose) {
+  if (verbose) {
+    printf("Beginning tokenization\n");
+  }
+  default_token_file(input_file, output_file);
+  return tokenize_lines(input_file, output_file, head_token, NULL, verbose);
+}
+
+// Lexes lines that are already in memory, numbering them from first_line, for reparsing an
+// edited region. Nothing is written to the .toke file. On failure no tokens are added
+MiniStatus tokenize_text_lines(char **lines, int line_count, int first_line, MiniHeadToken *head_token) {
+  MiniHeadToken line_tokens = {.token_count = 0, .head = NULL, .tail = NULL};
+  for (int i = 0; i < line_count; i++) {
+    size_t line_length = strcspn(lines[i], "\n");
+    if (line_length > MAX_LINE_LENGTH) {
+      printf("Lexical error: Line %d is longer than %zu characters\n", first_line + i + 1, MAX_LINE_LENGTH);
+      free_tokens(&line_tokens);
+      return LINE_TOO_LONG;
+    }
+    char line_buffer[line_length + 1];
+    memcpy(line_buffer, lines[i], line_length);
+    line_buffer[line_length] = '\0';
+    MiniStatus status = lex_line(line_buffer, line_length, first_line + i, NULL, stdout, &line_tokens, true);
+    if (status != SUCCESS) {
+      free_tokens(&line_tokens);
+      return status;
+    }
+  }
+  append_tokens(head_token, &line_tokens);
+  return SUCCESS;
+}
+
+typedef struct minimal_lex_job {
+  char *input_file;
+  char *output_file;
+  MiniTokenStream *stream;
+  int verbose;
+} MiniLexJob;
+
+static void *lex_into_stream(void *arg) {
+  MiniLexJob *job = arg;
+  MiniStatus status = tokenize_lines(job->input_file, job->output_file, NULL, job->stream, job->verbose);
+  close_token_stream(job->stream, status);
+  free(job);
+  return NULL;
+}
+
+// Starts lexing input_file on a separate thread. The tokens are pulled by next_token()
+// on the calling thread, so that parsing can begin before lexing has finished and the
+// whole token list never has to be in memory at once
+MiniStatus start_tokenize_stream(char *input_file, char *output_file, MiniTokenStream *stream, int verbose) {
+  if (verbose) {
+    printf("Beginning tokenization (streaming)\n");
+  }
+  default_token_file(input_file, output_file);
+
+  MiniLexJob *job = malloc(sizeof(MiniLexJob));
+  if (job == NULL) {
+    printf("start_tokenize_stream: Memory Error: Failed to allocate memory for lexer job\n");
+    return ALLOCATION_FAIL;
+  }
+  job->input_file = input_file;
+  job->output_file = output_file;
+  job->stream = stream;
+  job->verbose = verbose;
+  if (pthread_create(&stream->lexer_thread, NULL, lex_into_stream, job) != 0) {
+    printf("start_tokenize_stream: Thread Error: Failed to start lexer thread\n");
+    free(job);
+    return THREAD_FAIL;
+  }
+  attach_token_stream(stream);
+  return SUCCESS;
+}
+
+// Lets the lexer thread run to the end of the file and returns its status
+MiniStatus finish_tokenize_stream(MiniTokenStream *stream) {
+  attach_token_stream(NULL);
+  drain_token_stream(stream);
+  pthread_join(stream->lexer_thread, NULL);
+  return stream->lex_status;
+}
@@ -46,6 +46,8 @@
 #include "inc/preprocessor.h"
 #include "inc/tokens.h"
 #include "inc/syntax.h"
+#include "inc/ast.h"
+#include "inc/semantic.h"
 
 #define FILENAME_SIZE 51
 
@@ -104,7 +106,9 @@ int main(int argc, char *argv[]) {
 
   char output_file[FILENAME_SIZE] = {'\0'};
   char main_file[FILENAME_SIZE] = {'\0'};
+  char reparse_input[FILENAME_SIZE] = {'\0'};
   size_t length;
+  char *end;
 
   int cmd;
 
@@ -140,6 +144,29 @@ int main(int argc, char *argv[]) {
         }
         strcpy(output_file, optarg);
         break;
+      case LEX_THREADS:
+        lex_thread_count = strtol(optarg, &end, 10);
+        if (*optarg == '\0' || *end != '\0' || lex_thread_count < 1) {
+          printf("main: Error: --lex-threads takes a positive number of threads\n");
+          valid_args = false;
+        }
+        break;
+      case PARSE_THREADS:
+        parse_thread_count = strtol(optarg, &end, 10);
+        if (*optarg == '\0' || *end != '\0' || parse_thread_count < 1) {
+          printf("main: Error: --parse-threads takes a positive number of threads\n");
+          valid_args = false;
+        }
+        break;
+      case REPARSE:
+        length = strlen(optarg);
+        if (length > FILENAME_SIZE - 1) {
+          printf("main: Error: Maximum filename length is %d\n", FILENAME_SIZE - 1);
+          valid_args = false;
+          break;
+        }
+        strcpy(reparse_input, optarg);
+        break;
       case '?':
         break;
     }
@@ -161,6 +188,11 @@ int main(int argc, char *argv[]) {
   strcpy(main_file, argv[argc - 1]);
 
   int input_file_count = argc - optind; 
+  // The edited copy stands for the whole input, and reparsing needs every token in memory
+  if (reparse_input[0] != '\0' && (input_file_count > 1 || stream_flag)) {
+    printf("main: Error: --reparse takes a single input file and can't be used with --stream\n");
+    return INVALID_ARG;
+  }
   MiniStatus status;
   char **input_files = alloc_input(input_file_count, &status); 
   if (status != SUCCESS) return status;
@@ -184,15 +216,28 @@ int main(int argc, char *argv[]) {
 
   if (preprocess_flag) return SUCCESS;
 
-  MiniHeadToken head_token = {.token_count = 0, .head = NULL};
+  MiniHeadToken head_token = {.token_count = 0, .head = NULL, .tail = NULL};
   char token_file[FILENAME_SIZE - 1] = {'\0'};
   if (tokenize_flag) {
     strcpy(token_file, output_file);
   }
-  status = tokenize(prep_file, token_file, &head_token, verbose_flag);
-  if (status != SUCCESS || tokenize_flag) {
-    free_tokens(&head_token);
-    return status;
+  MiniTokenStream token_stream;
+  bool streaming = stream_flag && !tokenize_flag;
+  if (streaming) {
+    status = init_token_stream(&token_stream, &head_token);
+    if (status != SUCCESS) return status;
+    status = start_tokenize_stream(prep_file, token_file, &token_stream, verbose_flag);
+    if (status != SUCCESS) {
+      free_token_stream(&token_stream);
+      return status;
+    }
+  } else {
+    status = tokenize(prep_file, token_file, &head_token, verbose_flag);
+    if (status != SUCCESS || tokenize_flag) {
+      free_tokens(&head_token);
+      free_type_table();
+      return status;
+    }
   }
 
   /*
@@ -205,16 +250,37 @@ int main(int argc, char *argv[]) {
   if (parse_flag) {
     strcpy(parse_file, output_file);
   }
-  status = generate_ast(token_file, parse_file, &head_token, &syntax_tree_root, verbose_flag);
+  status = generate_ast(token_file, parse_file, &head_token, &syntax_tree_root, table_flag, verbose_flag);
+  if (streaming) {
+    // A lexical error truncates the token stream, so it takes precedence over
+    // whatever the parser made of the truncated input
+    MiniStatus lex_status = finish_tokenize_stream(&token_stream);
+    free_token_stream(&token_stream);
+    if (lex_status != SUCCESS) {
+      status = lex_status;
+    }
+  }
+  if (status == VALID_CONSTRUCT && reparse_input[0] != '\0') {
+    char *edited_files[] = {reparse_input};
+    char edited_prep_file[FILENAME_SIZE - 1] = {'\0'};
+    status = preprocess(edited_files, 1, reparse_input, edited_prep_file, verbose_flag);
+    if (status == SUCCESS) {
+      // Later stages name their output files after the edited copy
+      strcpy(parse_file, parse_flag ? output_file : "");
+      status = reparse_file(prep_file, edited_prep_file, parse_file, &head_token, &syntax_tree_root, verbose_flag);
+    }
+  }
   if (status != VALID_CONSTRUCT) {
     free_tokens(&head_token);
     free_syntax_tree(syntax_tree_root.child);
+    free_type_table();
     return status;
   }
 
   if (parse_flag) {
     free_tokens(&head_token);
     free_syntax_tree(syntax_tree_root.child);
+    free_type_table();
     return SUCCESS;
   }
 
@@ -223,10 +289,34 @@ int main(int argc, char *argv[]) {
   }
   free_tokens(&head_token);
 
-  if (semantic_flag) {
-    printf("Semantic analysis and beyond not implemented yet\n");
+  // Later stages only see the AST, so the syntax tree can go as soon as it's lowered
+  MiniAst ast;
+  char ast_file[FILENAME_SIZE - 1] = {'\0'};
+  if (ast_flag) {
+    strcpy(ast_file, output_file);
   }
+  status = lower_syntax_tree(parse_file, ast_file, &syntax_tree_root, &ast, ast_flag, verbose_flag);
   free_syntax_tree(syntax_tree_root.child);
+  if (status != SUCCESS || ast_flag) {
+    free_ast(&ast);
+    free_type_table();
+    free_symbol_table();
+    return status;
+  }
+
+  // Nothing past the semantic analysis is implemented yet, so it only runs when asked for
+  if (semantic_flag || report_dead_flag) {
+    char sema_file[FILENAME_SIZE - 1] = {'\0'};
+    strcpy(sema_file, output_file);
+    status = analyse_semantics(parse_file, sema_file, &ast, semantic_flag, verbose_flag);
+    if (status == SUCCESS && report_dead_flag) {
+      report_dead_items(&ast);
+    }
+  }
+  free_ast(&ast);
+  free_type_table();
+  free_symbol_table();
+  if (status != SUCCESS) return status;
 
   return SUCCESS;
 }
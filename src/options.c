@@ -34,6 +34,12 @@ int irgen_flag = 0;
 int asmgen_flag = 0;
 int compile_flag = 0;
 int link_flag = 1;
+int stream_flag = 0;
+int table_flag = 0;
+int ast_flag = 0;
+int report_dead_flag = 0;
+long lex_thread_count = 0; // 0: one per processor
+long parse_thread_count = 0; // 0: one per processor
 
 struct option minimal_options[] = {
   // General
@@ -52,7 +58,14 @@ struct option minimal_options[] = {
   {"asm", no_argument, &asmgen_flag, 1},
   {"obj", no_argument, &compile_flag, 1},
   {"exe", no_argument, &link_flag, 1},
+  {"stream", no_argument, &stream_flag, 1},
+  {"table", no_argument, &table_flag, 1},
+  {"ast", no_argument, &ast_flag, 1},
+  {"report-dead", no_argument, &report_dead_flag, 1},
   // Options
   {"output", required_argument, 0, 'o'},
+  {"lex-threads", required_argument, 0, LEX_THREADS},
+  {"parse-threads", required_argument, 0, PARSE_THREADS},
+  {"reparse", required_argument, 0, REPARSE},
   {0, 0, 0, 0}
 };
@@ -21,11 +21,15 @@
 */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <stdint.h>
+#include <stdarg.h>
 
 #include "inc/retcodes.h"
 #include "inc/tokens.h"
 #include "inc/syntax.h"
+#include "inc/parser-utils.h"
 
 static MiniTokenName match_terminal(MiniToken *current_tok, MiniTokenName target) {
   if (current_tok->name == target) {
@@ -35,57 +39,40 @@ static MiniTokenName match_terminal(MiniToken *current_tok, MiniTokenName target
   }
 }
 
-static MiniTokenCat match_terminal_category(MiniToken *current_tok, MiniTokenCat target) {
-  if (current_tok->category == target) {
-    return target;
-  } else {
-    return CATEGORY_UNDETERMINED;
-  }
+static bool in_token_set(MiniToken *current_tok, MiniTokenSet targets) {
+  int index = token_index(current_tok->name);
+  return index >= 0 && (targets >> index) & 1;
 }
 
-MiniStatus match_terminals(MiniToken *current_tok, MiniTokenName *targets, MiniTokenName *match) {
-  MiniTokenName result;
-  if (match == NULL) {
-    result = match_terminal(current_tok, *targets);
-    if (result != TOKEN_UNDETERMINED) {
-      return SUCCESS;
-    }
-    return NONMATCHING_TOKEN;
-  }
+static bool in_category_set(MiniToken *current_tok, MiniTokenSet targets) {
+  MiniTokenCat category = current_tok->category;
+  return category >= 0 && category < MINIMAL_CATEGORY_COUNT && (targets >> category) & 1;
+}
 
-  MiniTokenName *cur_name = targets;
-  while (*cur_name != -1) {
-    result = match_terminal(current_tok, *cur_name);
-    if (result != TOKEN_UNDETERMINED) {
-      *match = result;
-      return SUCCESS;
-    }
-    cur_name++;
+// Both return LAST_TOKEN when the input has run out before current_tok
+MiniStatus match_terminals(MiniToken *current_tok, MiniTokenSet targets, MiniTokenName *match) {
+  if (last_token(current_tok)) {
+    if (match != NULL) *match = TOKEN_UNDETERMINED;
+    return LAST_TOKEN;
+  }
+  if (in_token_set(current_tok, targets)) {
+    if (match != NULL) *match = current_tok->name;
+    return SUCCESS;
   }
-  *match = *cur_name;
+  if (match != NULL) *match = TOKEN_UNDETERMINED;
   return NONMATCHING_TOKEN;
 }
 
-MiniStatus match_terminal_cats(MiniToken *current_tok, MiniTokenCat *targets, MiniTokenCat *match) {
-  MiniTokenCat result;
-  if (match == NULL) {
-    result = match_terminal_category(current_tok, *targets);
-    if (result != CATEGORY_UNDETERMINED) {
-      return SUCCESS;
-    }
-    return NONMATCHING_CATEGORY;
+MiniStatus match_terminal_cats(MiniToken *current_tok, MiniTokenSet targets, MiniTokenCat *match) {
+  if (last_token(current_tok)) {
+    if (match != NULL) *match = CATEGORY_UNDETERMINED;
+    return LAST_TOKEN;
   }
-
-  MiniTokenCat *cur_name = targets;
-  while (*cur_name != -1) {
-    result = match_terminal_category(current_tok, *cur_name);
-    if (result != CATEGORY_UNDETERMINED) {
-      *match = result;
-      return SUCCESS;
-    }
-    cur_name++;
+  if (in_category_set(current_tok, targets)) {
+    if (match != NULL) *match = current_tok->category;
+    return SUCCESS;
   }
-  *match = *cur_name;
+  if (match != NULL) *match = CATEGORY_UNDETERMINED;
   return NONMATCHING_CATEGORY;
 }
 
@@ -112,6 +99,8 @@ MiniSyntaxTree *add_term_node(MiniSyntaxTree *current_node, MiniToken *current_t
   }
 
   add_node(current_node, new_node, rel);
+  current_token->in_tree = true;
+  current_token->node = new_node;
   *exit_status = SUCCESS;
   return new_node;
 } 
@@ -143,46 +132,23 @@ MiniSyntaxTree *add_nonterm_node(MiniSyntaxTree *current_node, MiniNonTerm name,
   return new_node;
 }
 
-MiniSyntaxTree *match_and_add_term_node(MiniSyntaxTree *current_node, MiniToken *current_token, MiniTokenName *names, MiniRelation rel, MiniTokenName *match, MiniStatus *exit_status) {
+MiniSyntaxTree *match_and_add_term_node(MiniSyntaxTree *current_node, MiniToken *current_token, MiniTokenSet names, MiniRelation rel, MiniTokenName *match, MiniStatus *exit_status) {
   MiniStatus status;
-  MiniTokenName result;
   MiniSyntaxTree *new_node;
 
-  if (match == NULL) {
-    result = match_terminal(current_token, *names);
-    if (result != TOKEN_UNDETERMINED) {
-      new_node = add_term_node(current_node, current_token, rel, &status);
-      if (status != SUCCESS) {
-        *exit_status = status;
-        return NULL;
-      }
-      *exit_status = SUCCESS;
-      return new_node;
-    } else {
-      *exit_status = NONMATCHING_TOKEN;
-      return NULL;
-    }
-  } 
+  status = match_terminals(current_token, names, match);
+  if (status != SUCCESS) {
+    *exit_status = status;
+    return NULL;
+  }
 
-  MiniTokenName *cur_name = names;
-  while (*cur_name != -1) {
-    result = match_terminal(current_token, *cur_name);
-    if (result != TOKEN_UNDETERMINED) {
-      new_node = add_term_node(current_node, current_token, rel, &status);
-      if (status != SUCCESS) {
-        *exit_status = status;
-        *match = *cur_name;
-        return NULL;
-      }
-      *exit_status = SUCCESS;
-      *match = result;
-      return new_node;
-    }
-    cur_name++;
+  new_node = add_term_node(current_node, current_token, rel, &status);
+  if (status != SUCCESS) {
+    *exit_status = status;
+    return NULL;
   }
-  *exit_status = NONMATCHING_TOKEN;
-  *match = *cur_name;
-  return NULL;
+  *exit_status = SUCCESS;
+  return new_node;
 } 
 
 MiniSyntaxTree *match_and_add_term_node_seq(MiniSyntaxTree *current_node, MiniToken *current_tok, MiniToken **tok_carrier, MiniTokenName *names, MiniRelation *rels, MiniTokenName *non_match, MiniStatus *exit_status) {
@@ -227,90 +193,174 @@ MiniSyntaxTree *match_and_add_term_node_seq(MiniSyntaxTree *current_node, MiniTo
   return cur_node;
 }
 
-MiniSyntaxTree *match_and_add_nonterm_node(MiniSyntaxTree *current_node, MiniToken *current_tok, MiniTokenName *names, MiniNonTerm *corresp_nonterms, MiniRelation rel, MiniTokenName *match, MiniStatus *exit_status) {
+MiniSyntaxTree *match_and_add_nonterm_node(MiniSyntaxTree *current_node, MiniToken *current_tok, MiniTokenSet names, const MiniNonTerm *corresp_nonterms, MiniRelation rel, MiniTokenName *match, MiniStatus *exit_status) {
   MiniStatus status;
-  MiniTokenName result;
   MiniSyntaxTree *new_node;
 
-  if (match == NULL) {
-    result = match_terminal(current_tok, *names);
-    if (result != TOKEN_UNDETERMINED) {
-      new_node = add_nonterm_node(current_node, *corresp_nonterms, rel, &status);
-      if (status != SUCCESS) {
-        *exit_status = status;
-        return NULL;
-      }
-      *exit_status = SUCCESS;
-      return new_node;
-    } else {
-      *exit_status = NONMATCHING_TOKEN;
-      return NULL;
-    }
-  } 
+  status = match_terminals(current_tok, names, match);
+  if (status != SUCCESS) {
+    *exit_status = status;
+    return NULL;
+  }
 
-  MiniTokenName *cur_name = names;
-  MiniNonTerm *cur_correspondence = corresp_nonterms;
-  while (*cur_name != -1) {
-    result = match_terminal(current_tok, *cur_name);
-    if (result != TOKEN_UNDETERMINED) {
-      new_node = add_nonterm_node(current_node, *cur_correspondence, rel, &status);
-      if (status != SUCCESS) {
-        *exit_status = status;
-        *match = *cur_name;
-        return NULL;
-      }
-      *exit_status = SUCCESS;
-      *match = *cur_name;
-      return new_node;
-    }
-    cur_name++;
-    cur_correspondence++;
+  MiniNonTerm nonterm = (match == NULL) ? *corresp_nonterms : corresp_nonterms[token_index(current_tok->name)];
+  new_node = add_nonterm_node(current_node, nonterm, rel, &status);
+  if (status != SUCCESS) {
+    *exit_status = status;
+    return NULL;
   }
-  *exit_status = NONMATCHING_TOKEN;
-  *match = *cur_name;
-  return NULL;
+  *exit_status = SUCCESS;
+  return new_node;
 }
 
-MiniSyntaxTree *match_cat_and_add_nonterm_node(MiniSyntaxTree *current_node, MiniToken *current_tok, MiniTokenCat *cats, MiniNonTerm *corresp_nonterms, MiniRelation rel, MiniTokenCat *match, MiniStatus *exit_status) {
+MiniSyntaxTree *match_cat_and_add_nonterm_node(MiniSyntaxTree *current_node, MiniToken *current_tok, MiniTokenSet cats, const MiniNonTerm *corresp_nonterms, MiniRelation rel, MiniTokenCat *match, MiniStatus *exit_status) {
   MiniStatus status;
-  MiniTokenCat result;
   MiniSyntaxTree *new_node;
 
-  if (match == NULL) {
-    result = match_terminal_category(current_tok, *cats);
-    if (result != CATEGORY_UNDETERMINED) {
-      new_node = add_nonterm_node(current_node, *corresp_nonterms, rel, &status);
-      if (status != SUCCESS) {
-        *exit_status = status;
-        return NULL;
+  status = match_terminal_cats(current_tok, cats, match);
+  if (status != SUCCESS) {
+    *exit_status = status;
+    return NULL;
+  }
+
+  MiniNonTerm nonterm = (match == NULL) ? *corresp_nonterms : corresp_nonterms[current_tok->category];
+  new_node = add_nonterm_node(current_node, nonterm, rel, &status);
+  if (status != SUCCESS) {
+    *exit_status = status;
+    return NULL;
+  }
+  *exit_status = SUCCESS;
+  return new_node;
+}
+
+// Hashes of the messages printed so far, so that a message is only printed once per line.
+// Thread local like the rest of the parser state
+static _Thread_local uint64_t printed_errors[MINIMAL_MAX_PARSE_ERRORS];
+static _Thread_local int printed_count = 0;
+static _Thread_local int error_count = 0;
+static _Thread_local MiniParseErrorLog *error_log = NULL;
+
+static uint64_t hash_message(const char *message) {
+  uint64_t hash = 14695981039346656037ULL; // FNV-1a
+  for (const char *c = message; *c != '\0'; c++) {
+    hash ^= (unsigned char) *c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+static void log_message(MiniParseErrorLog *log, const char *message) {
+  log->error_count++;
+  for (int i = 0; i < log->message_count; i++) {
+    if (strcmp(log->messages[i], message) == 0) return;
+  }
+  if (log->message_count == MINIMAL_MAX_PARSE_ERRORS) return;
+  char *copy = strdup(message);
+  // Without memory for the text the error is still counted
+  if (copy == NULL) return;
+  log->messages[log->message_count++] = copy;
+}
+
+static void print_message(const char *message) {
+  error_count++;
+  uint64_t hash = hash_message(message);
+  for (int i = 0; i < printed_count; i++) {
+    if (printed_errors[i] == hash) return;
+  }
+  if (printed_count == MINIMAL_MAX_PARSE_ERRORS) return;
+  printed_errors[printed_count++] = hash;
+  printf("Parse Error: %s", message);
+}
+
+void parse_error(const char *format, ...) {
+  char message[512];
+  // The message starts with the line, so the same error on another line is not a repeat
+  int offset = snprintf(message, sizeof(message), "Line %u: ", reached_token_line() + 1);
+  va_list args;
+  va_start(args, format);
+  vsnprintf(message + offset, sizeof(message) - offset, format, args);
+  va_end(args);
+
+  if (error_log != NULL) {
+    log_message(error_log, message);
+  } else {
+    print_message(message);
+  }
+}
+
+void collect_parse_errors(MiniParseErrorLog *log) {
+  error_log = log;
+}
+
+void report_parse_errors(MiniParseErrorLog *log) {
+  for (int i = 0; i < log->message_count; i++) {
+    print_message(log->messages[i]);
+  }
+  // The rest were repeats or past the limit within the log, so they are here as well
+  error_count += log->error_count - log->message_count;
+  free_parse_error_log(log);
+}
+
+void free_parse_error_log(MiniParseErrorLog *log) {
+  for (int i = 0; i < log->message_count; i++) {
+    free(log->messages[i]);
+  }
+  log->message_count = 0;
+  log->error_count = 0;
+}
+
+int parse_error_count(void) {
+  return error_count;
+}
+
+int printed_parse_error_count(void) {
+  return printed_count;
+}
+
+void reset_parse_errors(void) {
+  printed_count = 0;
+  error_count = 0;
+}
+
+static bool closes_block(MiniTokenName name) {
+  return name == END_IF || name == END_SWITCH || name == END_LOOP || name == END_FUNC;
+}
+
+MiniStatus synchronize(MiniToken *start, bool block, MiniToken **tok_carrier) {
+  MiniToken *cur_tok = start;
+  MiniStatus status;
+
+  if (block) {
+    // Nested blocks are skipped along with the one start opens, so that their
+    // terminators don't end the skip early
+    int depth = 0;
+    while (!last_token(cur_tok)) {
+      if (cur_tok->category == BRANCH_KW || cur_tok->name == FUNC) {
+        depth++;
+      } else if (closes_block(cur_tok->name) && --depth == 0) {
+        *tok_carrier = next_token(cur_tok, &status);
+        if (status != SUCCESS) return LAST_TOKEN;
+        return VALID_CONSTRUCT;
+      } else if (cur_tok->name == END_MODULE || cur_tok->name == END_MAIN) {
+        break;
       }
-      *exit_status = SUCCESS;
-      return new_node;
-    } else {
-      *exit_status = NONMATCHING_CATEGORY;
-      return NULL;
+      cur_tok = peek_token(cur_tok);
     }
-  } 
-
-  MiniTokenCat *cur_cat = cats;
-  MiniNonTerm *cur_correspondence = corresp_nonterms;
-  while (*cur_cat != -1) {
-    result = match_terminal_category(current_tok, *cur_cat);
-    if (result != CATEGORY_UNDETERMINED) {
-      new_node = add_nonterm_node(current_node, *cur_correspondence, rel, &status);
-      if (status != SUCCESS) {
-        *exit_status = status;
-        *match = *cur_cat;
-        return NULL;
-      }
-      *exit_status = SUCCESS;
-      *match = *cur_cat;
-      return new_node;
+  } else {
+    while (!last_token(cur_tok) && cur_tok->name != SEMICOLON && cur_tok->category != TERM_KW) {
+      cur_tok = peek_token(cur_tok);
+    }
+    if (!last_token(cur_tok) && cur_tok->name == SEMICOLON) {
+      *tok_carrier = next_token(cur_tok, &status);
+      if (status != SUCCESS) return LAST_TOKEN;
+      return VALID_CONSTRUCT;
     }
-    cur_cat++;
-    cur_correspondence++;
   }
-  *exit_status = NONMATCHING_CATEGORY;
-  *match = *cur_cat;
-  return NULL;
+
+  if (last_token(cur_tok)) return LAST_TOKEN;
+  // Nothing was skipped, so the caller would only try the same construct at the same token again
+  if (cur_tok == start) return PARSE_ERROR;
+  // Left for the enclosing construct to match
+  *tok_carrier = cur_tok;
+  return VALID_CONSTRUCT;
 }
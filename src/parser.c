@@ -25,11 +25,14 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
 
 #include "inc/retcodes.h"
 #include "inc/tokens.h"
 #include "inc/syntax.h"
 #include "inc/parser-utils.h"
+#include "inc/options.h"
 
 static MiniStatus source(MiniSyntaxTree *, MiniToken *);
 static MiniStatus main_file(MiniSyntaxTree *, MiniToken *);
@@ -47,6 +50,7 @@ static MiniStatus list(MiniSyntaxTree *, MiniToken *, MiniToken **);
 static MiniStatus dictionary(MiniSyntaxTree *, MiniToken *, MiniToken **);
 static MiniStatus primary_expression(MiniSyntaxTree *, MiniToken *, MiniToken **);
 static MiniStatus expression(MiniSyntaxTree *, MiniToken *, MiniToken **);
+static MiniStatus arithmetic_operand(MiniSyntaxTree *, MiniToken *, MiniToken **);
 static MiniStatus arithmetic_expression(MiniSyntaxTree *, MiniToken *, MiniToken **);
 static MiniStatus logical_expression(MiniSyntaxTree *, MiniToken *, MiniToken **);
 static MiniStatus main_part(MiniSyntaxTree *, MiniToken *);
@@ -88,9 +92,9 @@ static MiniStatus declaration(MiniSyntaxTree *current_node, MiniToken *current_t
   MiniSyntaxTree *new_node;
   MiniTokenCat category = TYPE_KW;
   MiniNonTerm corresp_nonterm = TYPE_EXPR;
-  new_node = match_cat_and_add_nonterm_node(cur_node, current_token, &category, &corresp_nonterm, CHILD, NULL, &status);
+  new_node = match_cat_and_add_nonterm_node(cur_node, current_token, CATEGORY_BIT(category), &corresp_nonterm, CHILD, NULL, &status);
   if (status == NONMATCHING_CATEGORY) {
-    printf("Parse Error: Invalid declaration: Missing type keyword\n");
+    parse_error("Invalid declaration: Missing type keyword\n");
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
   
@@ -101,11 +105,11 @@ static MiniStatus declaration(MiniSyntaxTree *current_node, MiniToken *current_t
   current_token = next_token(current_token, &status);
   if (status != SUCCESS) return status;
 
-  MiniTokenName names[] = {MINI_ID, MINI_CONST_ID, -1};
+  static const MiniTokenSet names = TOKEN_BIT(MINI_ID) | TOKEN_BIT(MINI_CONST_ID);
   MiniTokenName name_match;
   new_node = match_and_add_term_node(cur_node, current_token, names, SIBLING, &name_match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid declaration: Missing %s\n", desc_token(name_match));
+    parse_error("Invalid declaration: Missing %s\n", desc_token(name_match));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -115,12 +119,12 @@ static MiniStatus declaration(MiniSyntaxTree *current_node, MiniToken *current_t
   if (status != SUCCESS) return status;
 
   MiniTokenName name = SEMICOLON;
-  status = match_terminals(current_token, &name, NULL);
+  status = match_terminals(current_token, TOKEN_BIT(name), NULL);
   if (status == NONMATCHING_TOKEN) {
     name = ASSIGN;
-    new_node = match_and_add_term_node(cur_node, current_token, &name, SIBLING, NULL, &status);
+    new_node = match_and_add_term_node(cur_node, current_token, TOKEN_BIT(name), SIBLING, NULL, &status);
     if (status == NONMATCHING_TOKEN) {
-      printf("Parse Error: Invalid Declaration: Missing %s\n", desc_token(ASSIGN));
+      parse_error("Invalid Declaration: Missing %s\n", desc_token(ASSIGN));
       return PARSE_ERROR;
     } else if (status != SUCCESS) return status;
 
@@ -130,8 +134,8 @@ static MiniStatus declaration(MiniSyntaxTree *current_node, MiniToken *current_t
     if (status != SUCCESS) return status;
 
     MiniToken *after_token2 = NULL;
-    MiniTokenName names2[] = {LEFT_BRACKET, LEFT_BRACE, -1};
-    MiniNonTerm corresp_nonterms[] = {COLLECTION, COLLECTION, -1};
+    static const MiniTokenSet names2 = TOKEN_BIT(LEFT_BRACKET) | TOKEN_BIT(LEFT_BRACE);
+    static const MiniNonTerm corresp_nonterms[MINIMAL_TOKEN_INDEX_COUNT] = {[MINIMAL_TOKEN_INDEX(LEFT_BRACKET)] = COLLECTION, [MINIMAL_TOKEN_INDEX(LEFT_BRACE)] = COLLECTION};
     new_node = match_and_add_nonterm_node(cur_node, current_token, names2, corresp_nonterms, SIBLING, &name_match, &status);      
     if (status == NONMATCHING_TOKEN) {
       new_node = add_nonterm_node(cur_node, PRIMARY_EXPRESSION, SIBLING, &status);
@@ -179,9 +183,9 @@ static MiniStatus for_loop(MiniSyntaxTree *current_node, MiniToken *current_toke
   MiniSyntaxTree *new_node;
   MiniToken *after_token = NULL;
   MiniTokenName name = LOOP;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, CHILD, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), CHILD, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid for-loop: Missing %s\n", desc_token(LOOP));
+    parse_error("Invalid for-loop: Missing %s\n", desc_token(LOOP));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
   
@@ -201,9 +205,9 @@ static MiniStatus for_loop(MiniSyntaxTree *current_node, MiniToken *current_toke
   cur_token = after_token;
 
   name = SEMICOLON;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid for-loop: Missing %s\n", desc_token(SEMICOLON));
+    parse_error("Invalid for-loop: Missing %s\n", desc_token(SEMICOLON));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -222,9 +226,9 @@ static MiniStatus for_loop(MiniSyntaxTree *current_node, MiniToken *current_toke
 
   cur_token = after_token;
 
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid for-loop: Missing %s\n", desc_token(SEMICOLON));
+    parse_error("Invalid for-loop: Missing %s\n", desc_token(SEMICOLON));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -244,9 +248,9 @@ static MiniStatus for_loop(MiniSyntaxTree *current_node, MiniToken *current_toke
   cur_token = after_token;
 
   name = COLON;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid for-loop: Missing %s\n", desc_token(COLON));
+    parse_error("Invalid for-loop: Missing %s\n", desc_token(COLON));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -266,9 +270,9 @@ static MiniStatus for_loop(MiniSyntaxTree *current_node, MiniToken *current_toke
   cur_token = after_token;
 
   name = END_LOOP;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid for-loop: Missing %s\n", desc_token(END_LOOP));
+    parse_error("Invalid for-loop: Missing %s\n", desc_token(END_LOOP));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -292,9 +296,9 @@ static MiniStatus while_loop(MiniSyntaxTree *current_node, MiniToken *current_to
   MiniSyntaxTree *new_node;
   MiniToken *after_token = NULL;
   MiniTokenName name = LOOP;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, CHILD, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), CHILD, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid while-loop: Missing %s\n", desc_token(LOOP));
+    parse_error("Invalid while-loop: Missing %s\n", desc_token(LOOP));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
   
@@ -314,9 +318,9 @@ static MiniStatus while_loop(MiniSyntaxTree *current_node, MiniToken *current_to
   cur_token = after_token;
 
   name = COLON;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid while-loop: Missing %s\n", desc_token(COLON));
+    parse_error("Invalid while-loop: Missing %s\n", desc_token(COLON));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -336,9 +340,9 @@ static MiniStatus while_loop(MiniSyntaxTree *current_node, MiniToken *current_to
   cur_token = after_token;
 
   name = END_LOOP;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid while-loop: Missing %s\n", desc_token(END_LOOP));
+    parse_error("Invalid while-loop: Missing %s\n", desc_token(END_LOOP));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -364,12 +368,12 @@ static MiniStatus loop_block(MiniSyntaxTree *current_node, MiniToken *current_to
   if (status != SUCCESS) return status;
 
   MiniSyntaxTree *new_node;
-  MiniTokenCat categories[] = {TYPE_KW, IDENTIFIER, LITERAL_KW, LITERAL, -1};
-  MiniNonTerm corresp_nonterms[] = {FOR_LOOP, WHILE_LOOP, WHILE_LOOP, WHILE_LOOP, -1};
+  static const MiniTokenSet categories = CATEGORY_BIT(TYPE_KW) | CATEGORY_BIT(IDENTIFIER) | CATEGORY_BIT(LITERAL_KW) | CATEGORY_BIT(LITERAL);
+  static const MiniNonTerm corresp_nonterms[MINIMAL_CATEGORY_COUNT] = {[TYPE_KW] = FOR_LOOP, [IDENTIFIER] = WHILE_LOOP, [LITERAL_KW] = WHILE_LOOP, [LITERAL] = WHILE_LOOP};
   MiniTokenCat match;
   new_node = match_cat_and_add_nonterm_node(current_node, current_token, categories, corresp_nonterms, CHILD, &match, &status);
   if (status == NONMATCHING_CATEGORY) {
-    printf("Parse Error: Invalid loop-block: Missing type, identifier, literal keyword or literal\n");
+    parse_error("Invalid loop-block: Missing type, identifier, literal keyword or literal\n");
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -384,7 +388,7 @@ static MiniStatus loop_block(MiniSyntaxTree *current_node, MiniToken *current_to
 }
 
 
-// <case-block> ::= "#=" (<mini-ID> | <mini-const-ID> | <mini-ext-ID> | <C-ID> | <int-literal> | <default>) ":" <sequence> ("~#" | <case-block>) 
+// <case-block> ::= "#=" (<mini-ID> | <mini-const-ID> | <mini-ext-ID> | <C-ID> | <int-literal> | <string-literal> | <default>) ":" <sequence> ("~#" | <case-block>) 
 
 static MiniStatus case_block(MiniSyntaxTree *current_node, MiniToken *current_token, MiniToken **token_carrier) {
   if (last_token(current_token)) return LAST_TOKEN;
@@ -394,9 +398,9 @@ static MiniStatus case_block(MiniSyntaxTree *current_node, MiniToken *current_to
   MiniSyntaxTree *new_node;
   MiniToken *after_token = NULL;
   MiniTokenName name = CASE;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, CHILD, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), CHILD, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid case-block: Missing %s\n", desc_token(CASE));
+    parse_error("Invalid case-block: Missing %s\n", desc_token(CASE));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
   
@@ -405,12 +409,12 @@ static MiniStatus case_block(MiniSyntaxTree *current_node, MiniToken *current_to
   cur_token = next_token(cur_token, &status);
   if (status != SUCCESS) return status;
 
-  MiniTokenName names[] = {MINI_ID, MINI_CONST_ID, MINI_EXT_ID, C_ID, INT_LITERAL, DEFAULT, -1};
+  static const MiniTokenSet names = TOKEN_BIT(MINI_ID) | TOKEN_BIT(MINI_CONST_ID) | TOKEN_BIT(MINI_EXT_ID) | TOKEN_BIT(C_ID) | TOKEN_BIT(INT_LITERAL) | TOKEN_BIT(STRING_LITERAL) | TOKEN_BIT(DEFAULT);
   MiniTokenName match;
   new_node = match_and_add_term_node(cur_node, cur_token, names, SIBLING, &match, &status);
   MiniTokenName match_keeper = match;
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid case-block: Case value must reduce to a constant\n");
+    parse_error("Invalid case-block: Case value must reduce to a constant\n");
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -420,9 +424,9 @@ static MiniStatus case_block(MiniSyntaxTree *current_node, MiniToken *current_to
   if (status != SUCCESS) return status;
  
   name = COLON;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid case-block: Missing %s\n", desc_token(COLON));
+    parse_error("Invalid case-block: Missing %s\n", desc_token(COLON));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -443,13 +447,13 @@ static MiniStatus case_block(MiniSyntaxTree *current_node, MiniToken *current_to
 
   printf("DEBUG: cur token string repr: %s\n", cur_token->string_repr);
 
-  MiniTokenName names2[] = {END_SWITCH, CASE, -1};
+  MiniTokenSet names2 = TOKEN_BIT(END_SWITCH) | TOKEN_BIT(CASE);
   if (match_keeper == DEFAULT) {
-    names2[1] = -1;
+    names2 &= ~TOKEN_BIT(CASE);
   }
   status = match_terminals(cur_token, names2, &match);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid case-block: Missing %s or %s\n", desc_token(END_SWITCH), desc_token(CASE));
+    parse_error("Invalid case-block: Missing %s or %s\n", desc_token(END_SWITCH), desc_token(CASE));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -484,9 +488,9 @@ static MiniStatus switch_block(MiniSyntaxTree *current_node, MiniToken *current_
   MiniSyntaxTree *new_node;
   MiniToken *after_token = NULL;
   MiniTokenName name = SWITCH;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, CHILD, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), CHILD, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid switch-block: Missing %s\n", desc_token(SWITCH));
+    parse_error("Invalid switch-block: Missing %s\n", desc_token(SWITCH));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
   
@@ -506,9 +510,9 @@ static MiniStatus switch_block(MiniSyntaxTree *current_node, MiniToken *current_
   cur_token = after_token;
 
   name = COLON;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid switch-block: Missing %s\n", desc_token(COLON));
+    parse_error("Invalid switch-block: Missing %s\n", desc_token(COLON));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -518,7 +522,7 @@ static MiniStatus switch_block(MiniSyntaxTree *current_node, MiniToken *current_
   if (status != SUCCESS) return status;
 
   name = CASE;
-  status = match_terminals(cur_token, &name, NULL);
+  status = match_terminals(cur_token, TOKEN_BIT(name), NULL);
   if (status == NONMATCHING_TOKEN) {
     new_node = add_nonterm_node(cur_node, SEQUENCE, SIBLING, &status);
     if (status != SUCCESS) return status;
@@ -548,11 +552,11 @@ static MiniStatus logical_expression(MiniSyntaxTree *current_node, MiniToken *cu
   MiniToken *cur_token = current_token;
   MiniSyntaxTree *new_node;
   //MiniToken *after_token = NULL;
-  MiniTokenName names[] = {TRUE, FALSE, NUL, -1};
+  static const MiniTokenSet names = TOKEN_BIT(TRUE) | TOKEN_BIT(FALSE) | TOKEN_BIT(NUL);
   MiniTokenName match;
   new_node = match_and_add_term_node(cur_node, cur_token, names, CHILD, &match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("TEMPORARY: Parse Error: Invalid logical expression: Missing %s, %s or %s\n", desc_token(TRUE), desc_token(FALSE), desc_token(NUL));
+    parse_error("TEMPORARY: Invalid logical expression: Missing %s, %s or %s\n", desc_token(TRUE), desc_token(FALSE), desc_token(NUL));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -580,7 +584,7 @@ static MiniStatus else_block(MiniSyntaxTree *current_node, MiniToken *current_to
   MiniTokenName match;
   new_node = match_and_add_term_node_seq(cur_node, cur_token, &after_token, names, rels, &match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid else-block: Missing %s\n", desc_token(match));
+    parse_error("Invalid else-block: Missing %s\n", desc_token(match));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
   
@@ -598,9 +602,9 @@ static MiniStatus else_block(MiniSyntaxTree *current_node, MiniToken *current_to
   cur_token = after_token;
   
   MiniTokenName name = END_IF;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid else-block: Missing %s\n", desc_token(END_IF));
+    parse_error("Invalid else-block: Missing %s\n", desc_token(END_IF));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -624,9 +628,9 @@ static MiniStatus elif_block(MiniSyntaxTree *current_node, MiniToken *current_to
   MiniSyntaxTree *new_node;
   MiniToken *after_token = NULL;
   MiniTokenName name = ELSE_IF;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, CHILD, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), CHILD, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid else-if-block: Missing %s\n", desc_token(ELSE_IF));
+    parse_error("Invalid else-if-block: Missing %s\n", desc_token(ELSE_IF));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
   
@@ -646,9 +650,9 @@ static MiniStatus elif_block(MiniSyntaxTree *current_node, MiniToken *current_to
   cur_token = after_token;
 
   name = COLON;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid else-if-block: Missing %s\n", desc_token(COLON));
+    parse_error("Invalid else-if-block: Missing %s\n", desc_token(COLON));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -667,11 +671,11 @@ static MiniStatus elif_block(MiniSyntaxTree *current_node, MiniToken *current_to
 
   cur_token = after_token;
 
-  MiniTokenName names[] = {END_IF, ELSE_IF, ELSE, -1};
+  static const MiniTokenSet names = TOKEN_BIT(END_IF) | TOKEN_BIT(ELSE_IF) | TOKEN_BIT(ELSE);
   MiniTokenName match;
   status = match_terminals(cur_token, names, &match);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid else-if-block: Missing %s, %s or %s\n", desc_token(END_IF), desc_token(ELSE_IF), desc_token(ELSE));
+    parse_error("Invalid else-if-block: Missing %s, %s or %s\n", desc_token(END_IF), desc_token(ELSE_IF), desc_token(ELSE));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -716,9 +720,9 @@ static MiniStatus if_block(MiniSyntaxTree *current_node, MiniToken *current_toke
   MiniSyntaxTree *new_node;
   MiniToken *after_token = NULL;
   MiniTokenName name = IF;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, CHILD, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), CHILD, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid if-block: Missing %s\n", desc_token(IF));
+    parse_error("Invalid if-block: Missing %s\n", desc_token(IF));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
   
@@ -738,9 +742,9 @@ static MiniStatus if_block(MiniSyntaxTree *current_node, MiniToken *current_toke
   cur_token = after_token;
 
   name = COLON;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid if-block: Missing %s\n", desc_token(COLON));
+    parse_error("Invalid if-block: Missing %s\n", desc_token(COLON));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -759,11 +763,11 @@ static MiniStatus if_block(MiniSyntaxTree *current_node, MiniToken *current_toke
 
   cur_token = after_token;
 
-  MiniTokenName names[] = {END_IF, ELSE_IF, ELSE, -1};
+  static const MiniTokenSet names = TOKEN_BIT(END_IF) | TOKEN_BIT(ELSE_IF) | TOKEN_BIT(ELSE);
   MiniTokenName match;
   status = match_terminals(cur_token, names, &match);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid if-block: Missing %s, %s or %s\n", desc_token(END_IF), desc_token(ELSE_IF), desc_token(ELSE));
+    parse_error("Invalid if-block: Missing %s, %s or %s\n", desc_token(END_IF), desc_token(ELSE_IF), desc_token(ELSE));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -803,12 +807,12 @@ static MiniStatus branch(MiniSyntaxTree *current_node, MiniToken *current_token,
 
   MiniStatus status;
   MiniSyntaxTree *new_node;
-  MiniTokenName names[] = {IF, SWITCH, LOOP, -1};
-  MiniNonTerm corresp_nonterms[] = {IF_BLOCK, SWITCH_BLOCK, LOOP_BLOCK, -1};
+  static const MiniTokenSet names = TOKEN_BIT(IF) | TOKEN_BIT(SWITCH) | TOKEN_BIT(LOOP);
+  static const MiniNonTerm corresp_nonterms[MINIMAL_TOKEN_INDEX_COUNT] = {[MINIMAL_TOKEN_INDEX(IF)] = IF_BLOCK, [MINIMAL_TOKEN_INDEX(SWITCH)] = SWITCH_BLOCK, [MINIMAL_TOKEN_INDEX(LOOP)] = LOOP_BLOCK};
   MiniTokenName match;
   new_node = match_and_add_nonterm_node(current_node, current_token, names, corresp_nonterms, CHILD, &match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid branch: Missing %s, %s or %s\n", desc_token(IF), desc_token(SWITCH), desc_token(LOOP));
+    parse_error("Invalid branch: Missing %s, %s or %s\n", desc_token(IF), desc_token(SWITCH), desc_token(LOOP));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -846,7 +850,7 @@ static MiniStatus argument_list(MiniSyntaxTree *current_node, MiniToken *current
   cur_token = after_token;
 
   MiniTokenName name = COMMA;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
     *token_carrier = cur_token;
     return VALID_CONSTRUCT;
@@ -877,9 +881,9 @@ static MiniStatus function_call(MiniSyntaxTree *current_node, MiniToken *current
   MiniToken *after_token = NULL;
   MiniSyntaxTree *new_node;
   MiniTokenName name = CALL;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, CHILD, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), CHILD, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid function call: Missing %s\n", desc_token(CALL));
+    parse_error("Invalid function call: Missing %s\n", desc_token(CALL));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
  
@@ -888,11 +892,11 @@ static MiniStatus function_call(MiniSyntaxTree *current_node, MiniToken *current
   cur_token = next_token(cur_token, &status);
   if (status != SUCCESS) return status;
 
-  MiniTokenName names[] = {MINI_ID, MINI_EXT_ID, C_ID, -1};
+  static const MiniTokenSet names = TOKEN_BIT(MINI_ID) | TOKEN_BIT(MINI_EXT_ID) | TOKEN_BIT(C_ID);
   MiniTokenName match;
   new_node = match_and_add_term_node(cur_node, cur_token, names, SIBLING, &match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid function call: Missing function name\n");
+    parse_error("Invalid function call: Missing function name\n");
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -902,9 +906,9 @@ static MiniStatus function_call(MiniSyntaxTree *current_node, MiniToken *current
   if (status != SUCCESS) return status;
 
   name = LEFT_PAREN;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid function call: Missing %s\n", desc_token(LEFT_PAREN));
+    parse_error("Invalid function call: Missing %s\n", desc_token(LEFT_PAREN));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
  
@@ -914,7 +918,7 @@ static MiniStatus function_call(MiniSyntaxTree *current_node, MiniToken *current
   if (status != SUCCESS) return status;
 
   name = RIGHT_PAREN;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == SUCCESS) {
     cur_node = new_node;
 
@@ -936,9 +940,9 @@ static MiniStatus function_call(MiniSyntaxTree *current_node, MiniToken *current
 
   cur_token = after_token;
 
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid function call: Missing %s\n", desc_token(RIGHT_PAREN));
+    parse_error("Invalid function call: Missing %s\n", desc_token(RIGHT_PAREN));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -958,11 +962,11 @@ static MiniStatus flow_control(MiniSyntaxTree *current_node, MiniToken *current_
 
   MiniStatus status;
   MiniSyntaxTree *new_node;
-  MiniTokenName names[] = {BREAK, CONTINUE, RETURN, -1};
+  static const MiniTokenSet names = TOKEN_BIT(BREAK) | TOKEN_BIT(CONTINUE) | TOKEN_BIT(RETURN);
   MiniTokenName match;
   new_node = match_and_add_term_node(current_node, current_token, names, CHILD, &match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid flow control statement: Missing %s, %s or %s\n", desc_token(BREAK), desc_token(CONTINUE), desc_token(RETURN));
+    parse_error("Invalid flow control statement: Missing %s, %s or %s\n", desc_token(BREAK), desc_token(CONTINUE), desc_token(RETURN));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -995,9 +999,9 @@ static MiniStatus input_output_control(MiniSyntaxTree *current_node, MiniToken *
   MiniToken *cur_token = current_token;
   MiniSyntaxTree *new_node = NULL;
   MiniTokenName name = READ_WRITE;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, CHILD, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), CHILD, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid input/output statement: Missing %s\n", desc_token(READ_WRITE));
+    parse_error("Invalid input/output statement: Missing %s\n", desc_token(READ_WRITE));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -1006,11 +1010,11 @@ static MiniStatus input_output_control(MiniSyntaxTree *current_node, MiniToken *
   cur_token = next_token(cur_token, &status);
   if (status != SUCCESS) return status;
 
-  MiniTokenName names[] = {STDIO, MINI_ID, MINI_CONST_ID, MINI_EXT_ID, C_ID, STRING_LITERAL, -1};
+  static const MiniTokenSet names = TOKEN_BIT(STDIO) | TOKEN_BIT(MINI_ID) | TOKEN_BIT(MINI_CONST_ID) | TOKEN_BIT(MINI_EXT_ID) | TOKEN_BIT(C_ID) | TOKEN_BIT(STRING_LITERAL);
   MiniTokenName match;
   new_node = match_and_add_term_node(cur_node, cur_token, names, SIBLING, &match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid input/output statement: Missing source for reading/writing\n");
+    parse_error("Invalid input/output statement: Missing source for reading/writing\n");
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -1020,9 +1024,9 @@ static MiniStatus input_output_control(MiniSyntaxTree *current_node, MiniToken *
   if (status != SUCCESS) return status;
 
   name = REDIRECT;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid input/output statement: Missing %s\n", desc_token(REDIRECT));
+    parse_error("Invalid input/output statement: Missing %s\n", desc_token(REDIRECT));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -1031,10 +1035,10 @@ static MiniStatus input_output_control(MiniSyntaxTree *current_node, MiniToken *
   cur_token = next_token(cur_token, &status);
   if (status != SUCCESS) return status;
 
-  MiniTokenName names2[] = {STDIO, MINI_ID, MINI_EXT_ID, C_ID, -1};
+  static const MiniTokenSet names2 = TOKEN_BIT(STDIO) | TOKEN_BIT(MINI_ID) | TOKEN_BIT(MINI_EXT_ID) | TOKEN_BIT(C_ID);
   new_node = match_and_add_term_node(cur_node, cur_token, names2, SIBLING, &match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid input/output statement: Missing destination for reading/writing\n");
+    parse_error("Invalid input/output statement: Missing destination for reading/writing\n");
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -1054,12 +1058,12 @@ static MiniStatus control(MiniSyntaxTree *current_node, MiniToken *current_token
 
   MiniStatus status;
   MiniSyntaxTree *new_node;
-  MiniTokenName names[] = {READ_WRITE, CALL, RETURN, BREAK, CONTINUE, -1};
-  MiniNonTerm corresp_nonterms[] = {IN_OUT_CTRL, FUNC_CALL, FLOW_CTRL, FLOW_CTRL, FLOW_CTRL, -1};
+  static const MiniTokenSet names = TOKEN_BIT(READ_WRITE) | TOKEN_BIT(CALL) | TOKEN_BIT(RETURN) | TOKEN_BIT(BREAK) | TOKEN_BIT(CONTINUE);
+  static const MiniNonTerm corresp_nonterms[MINIMAL_TOKEN_INDEX_COUNT] = {[MINIMAL_TOKEN_INDEX(READ_WRITE)] = IN_OUT_CTRL, [MINIMAL_TOKEN_INDEX(CALL)] = FUNC_CALL, [MINIMAL_TOKEN_INDEX(RETURN)] = FLOW_CTRL, [MINIMAL_TOKEN_INDEX(BREAK)] = FLOW_CTRL, [MINIMAL_TOKEN_INDEX(CONTINUE)] = FLOW_CTRL};
   MiniTokenName match;
   new_node = match_and_add_nonterm_node(current_node, current_token, names, corresp_nonterms, CHILD, &match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid control statement: Missing %s, %s, %s, %s or %s\n", desc_token(READ_WRITE), desc_token(CALL), desc_token(RETURN), desc_token(BREAK), desc_token(CONTINUE));
+    parse_error("Invalid control statement: Missing %s, %s, %s, %s or %s\n", desc_token(READ_WRITE), desc_token(CALL), desc_token(RETURN), desc_token(BREAK), desc_token(CONTINUE));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -1085,13 +1089,13 @@ static MiniStatus incrementation(MiniSyntaxTree *current_node, MiniToken *curren
   MiniToken *cur_token = current_token;
   //MiniToken *after_token = NULL;
   MiniSyntaxTree *new_node;
-  MiniTokenName names[] = {MINI_ID, MINI_EXT_ID, C_ID, INCREMENT, DECREMENT, -1};
+  static const MiniTokenSet names = TOKEN_BIT(MINI_ID) | TOKEN_BIT(MINI_EXT_ID) | TOKEN_BIT(C_ID) | TOKEN_BIT(INCREMENT) | TOKEN_BIT(DECREMENT);
   // Could also be done with MiniTokenCat categories[] = {IDENTIFIER, UNA_ASSIGN_OP, -1};
   // but then would have to manually add the matching token
   MiniTokenName match;
   new_node = match_and_add_term_node(cur_node, cur_token, names, CHILD, &match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid incrementation: Missing identifier or increment/decrement operator\n");
+    parse_error("Invalid incrementation: Missing identifier or increment/decrement operator\n");
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -1101,10 +1105,10 @@ static MiniStatus incrementation(MiniSyntaxTree *current_node, MiniToken *curren
   if (status != SUCCESS) return status;
 
   if (match == INCREMENT || match == DECREMENT) {
-    MiniTokenName names2[] = {MINI_ID, MINI_CONST_ID, C_ID, -1};
+    static const MiniTokenSet names2 = TOKEN_BIT(MINI_ID) | TOKEN_BIT(MINI_CONST_ID) | TOKEN_BIT(C_ID);
     new_node = match_and_add_term_node(cur_node, cur_token, names2, SIBLING, &match, &status);
     if (status == NONMATCHING_TOKEN) {
-      printf("Parse Error: Invalid incrementation: Missing identifier after increment/decrement operator\n");
+      parse_error("Invalid incrementation: Missing identifier after increment/decrement operator\n");
       return PARSE_ERROR;
     } else if (status != SUCCESS) return status;
 
@@ -1117,13 +1121,12 @@ static MiniStatus incrementation(MiniSyntaxTree *current_node, MiniToken *curren
     return VALID_CONSTRUCT;
   }
 
-  MiniTokenName names3[] = {PLUS_ASSIGN, MINUS_ASSIGN, TIMES_ASSIGN, DIV_ASSIGN,MOD_ASSIGN,
-                            INCREMENT, DECREMENT, -1};
+  static const MiniTokenSet names3 = TOKEN_BIT(PLUS_ASSIGN) | TOKEN_BIT(MINUS_ASSIGN) | TOKEN_BIT(TIMES_ASSIGN) | TOKEN_BIT(DIV_ASSIGN) | TOKEN_BIT(MOD_ASSIGN) | TOKEN_BIT(INCREMENT) | TOKEN_BIT(DECREMENT);
   // Could also be done with MiniTokenCat categories = {BIN_ASSIGN_OP, UNA_ASSIGN_OP, -1}
   // but then would have to manually add the matching token
   new_node = match_and_add_term_node(cur_node, cur_token, names3, SIBLING, &match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid incrementation: Missing reassignment/increment/decrement operator\n");
+    parse_error("Invalid incrementation: Missing reassignment/increment/decrement operator\n");
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -1155,11 +1158,11 @@ static MiniStatus assignment(MiniSyntaxTree *current_node, MiniToken *current_to
   MiniToken *cur_token = current_token;
   //MiniToken *after_token = NULL;
   MiniSyntaxTree *new_node;
-  MiniTokenName names[] = {MINI_ID, MINI_EXT_ID, C_ID, -1};
+  static const MiniTokenSet names = TOKEN_BIT(MINI_ID) | TOKEN_BIT(MINI_EXT_ID) | TOKEN_BIT(C_ID);
   MiniTokenName match;
   new_node = match_and_add_term_node(cur_node, cur_token, names, CHILD, &match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid assignment specification: Missing %s, %s or %s\n", desc_token(MINI_ID), desc_token(MINI_EXT_ID), desc_token(C_ID));
+    parse_error("Invalid assignment specification: Missing %s, %s or %s\n", desc_token(MINI_ID), desc_token(MINI_EXT_ID), desc_token(C_ID));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -1169,9 +1172,9 @@ static MiniStatus assignment(MiniSyntaxTree *current_node, MiniToken *current_to
   if (status != SUCCESS) return status;
 
   MiniTokenName name = ASSIGN;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid Assignment specification: Missing %s\n", desc_token(ASSIGN));
+    parse_error("Invalid Assignment specification: Missing %s\n", desc_token(ASSIGN));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -1180,9 +1183,8 @@ static MiniStatus assignment(MiniSyntaxTree *current_node, MiniToken *current_to
   cur_token = next_token(cur_token, &status);
   if (status != SUCCESS) return status;
 
-  names[0] = LEFT_BRACKET;
-  names[1] = LEFT_BRACE;
-  status = match_terminals(cur_token, names, &match);
+  static const MiniTokenSet names2 = TOKEN_BIT(LEFT_BRACKET) | TOKEN_BIT(LEFT_BRACE);
+  status = match_terminals(cur_token, names2, &match);
   if (status == NONMATCHING_TOKEN) {
     new_node = add_nonterm_node(cur_node, PRIMARY_EXPRESSION, SIBLING, &status);
     if (status != SUCCESS) return status;
@@ -1211,7 +1213,7 @@ static MiniStatus designation(MiniSyntaxTree *current_node, MiniToken *current_t
   if (status != SUCCESS) return status;
 
   MiniTokenName name = ASSIGN;
-  status = match_terminals(current_token, &name, NULL);
+  status = match_terminals(current_token, TOKEN_BIT(name), NULL);
   if (status == NONMATCHING_TOKEN) {
     new_node = add_nonterm_node(current_node, INCREMENTATION, CHILD, &status);
     if (status != SUCCESS) return status;
@@ -1239,8 +1241,8 @@ static MiniStatus statement(MiniSyntaxTree *current_node, MiniToken *current_tok
   MiniToken *cur_token = current_token;
   MiniToken *after_token = NULL;
   MiniSyntaxTree *new_node;
-  MiniTokenCat categories[] = {TYPE_KW, CONTROL_KW, -1};
-  MiniNonTerm corresp_nonterms[] = {DECLARATION, CONTROL, -1};
+  static const MiniTokenSet categories = CATEGORY_BIT(TYPE_KW) | CATEGORY_BIT(CONTROL_KW);
+  static const MiniNonTerm corresp_nonterms[MINIMAL_CATEGORY_COUNT] = {[TYPE_KW] = DECLARATION, [CONTROL_KW] = CONTROL};
   MiniTokenCat match;
   new_node = match_cat_and_add_nonterm_node(cur_node, cur_token, categories, corresp_nonterms, CHILD, &match, &status);
   if (status == NONMATCHING_CATEGORY) {
@@ -1266,9 +1268,9 @@ static MiniStatus statement(MiniSyntaxTree *current_node, MiniToken *current_tok
   cur_token = after_token;
 
   MiniTokenName name = SEMICOLON;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid statement: Missing %s\n", desc_token(SEMICOLON));
+    parse_error("Invalid statement: Missing %s\n", desc_token(SEMICOLON));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -1294,14 +1296,20 @@ static MiniStatus sequence(MiniSyntaxTree *current_node, MiniToken *current_toke
   MiniSyntaxTree *new_node;
   MiniTokenCat category = BRANCH_KW;
   MiniNonTerm corresp_nonterm = BRANCH;
-  new_node = match_cat_and_add_nonterm_node(cur_node, cur_token, &category, &corresp_nonterm, CHILD, NULL, &status);
+  new_node = match_cat_and_add_nonterm_node(cur_node, cur_token, CATEGORY_BIT(category), &corresp_nonterm, CHILD, NULL, &status);
   if (status == NONMATCHING_CATEGORY) {
     new_node = add_nonterm_node(cur_node, STATEMENT, CHILD, &status);
     if (status != SUCCESS) return status;
 
     cur_node = new_node;
 
+    // Recovery goes back to the start of the statement
+    mark_token(cur_token);
     status = statement(cur_node, cur_token, &after_token);
+    if (status == PARSE_ERROR) {
+      status = synchronize(cur_token, false, &after_token);
+    }
+    unmark_token(cur_token);
     if (status != VALID_CONSTRUCT) return status;
 
   } else if (status != SUCCESS) {
@@ -1309,14 +1317,19 @@ static MiniStatus sequence(MiniSyntaxTree *current_node, MiniToken *current_toke
   } else {
     cur_node = new_node;
 
+    mark_token(cur_token);
     status = branch(cur_node, cur_token, &after_token);
+    if (status == PARSE_ERROR) {
+      status = synchronize(cur_token, true, &after_token);
+    }
+    unmark_token(cur_token);
     if (status != VALID_CONSTRUCT) return status;
   }
 
   cur_token = after_token;
 
   category = TERM_KW;
-  status = match_terminal_cats(cur_token, &category, NULL);
+  status = match_terminal_cats(cur_token, CATEGORY_BIT(category), NULL);
   if (status == NONMATCHING_CATEGORY) {
     new_node = add_nonterm_node(cur_node, SEQUENCE, SIBLING, &status);
     if (status != SUCCESS) return status;
@@ -1346,16 +1359,16 @@ static MiniStatus main_part(MiniSyntaxTree *current_node, MiniToken *current_tok
   
   new_node = match_and_add_term_node_seq(cur_node, current_token, &after_token, names, rels, &non_match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid main part specification: Missing %s\n", desc_token(non_match));
+    parse_error("Invalid main part specification: Missing %s\n", desc_token(non_match));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
   cur_node = new_node;
 
-  MiniTokenName names2[] = {ARGV, COLON, -1};
+  static const MiniTokenSet names2 = TOKEN_BIT(ARGV) | TOKEN_BIT(COLON);
   MiniTokenName match;
   new_node = match_and_add_term_node(cur_node, after_token, names2, SIBLING, &match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid main part specification: Missing %s\n", desc_token(COLON));
+    parse_error("Invalid main part specification: Missing %s\n", desc_token(COLON));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -1365,9 +1378,9 @@ static MiniStatus main_part(MiniSyntaxTree *current_node, MiniToken *current_tok
 
   if (match == ARGV) {
     MiniTokenName name = COLON;
-    new_node = match_and_add_term_node(cur_node, after_token, &name, SIBLING, NULL, &status);
+    new_node = match_and_add_term_node(cur_node, after_token, TOKEN_BIT(name), SIBLING, NULL, &status);
     if (status == NONMATCHING_TOKEN) {
-      printf("Parse Error: Invalid main part specification: Missing %s\n", desc_token(COLON));
+      parse_error("Invalid main part specification: Missing %s\n", desc_token(COLON));
       return PARSE_ERROR;
     } else if (status != SUCCESS) return status;
     cur_node = new_node;
@@ -1385,27 +1398,103 @@ static MiniStatus main_part(MiniSyntaxTree *current_node, MiniToken *current_tok
   if (status != VALID_CONSTRUCT) return status;
 
   MiniTokenName name = END_MAIN;
-  new_node = match_and_add_term_node(cur_node, after_token2, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, after_token2, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid main part specification: Missing %s\n", desc_token(END_MAIN));
+    parse_error("Invalid main part specification: Missing %s\n", desc_token(END_MAIN));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
   after_token2 = next_token(after_token2, &status);
   if (status != LAST_TOKEN) {
-    printf("Parse Error: Extra token(s) following end of main part\n");
+    parse_error("Extra token(s) following end of main part\n");
     return PARSE_ERROR;
   }
 
   return VALID_CONSTRUCT;
 }
 
-// XXX: Left off here
-// <arith-operand> ::= <mini-ID> | <mini-const-ID> | <mini-ext-ID> | <C-id> | <int-lit> | <float-lit> | <func-call> | "(" <arithmetic-expr> ")"
+// <arith-operand> ::= <mini-ID> | <mini-const-ID> | <mini-ext-ID> | <C-id> | <int-lit> | <float-lit> | <func-call>
+
+static MiniStatus arithmetic_operand(MiniSyntaxTree *current_node, MiniToken *current_token, MiniToken **token_carrier) {
+  if (last_token(current_token)) return LAST_TOKEN;
+
+  MiniStatus status;
+  MiniSyntaxTree *new_node;
+  if (current_token->name == CALL) {
+    new_node = add_nonterm_node(current_node, FUNC_CALL, CHILD, &status);
+    if (status != SUCCESS) return status;
+
+    return function_call(new_node, current_token, token_carrier);
+  }
+
+  static const MiniTokenSet names = TOKEN_BIT(MINI_ID) | TOKEN_BIT(MINI_CONST_ID) | TOKEN_BIT(MINI_EXT_ID) | TOKEN_BIT(C_ID) | TOKEN_BIT(INT_LITERAL) | TOKEN_BIT(FLOAT_LITERAL);
+  MiniTokenName match;
+  match_and_add_term_node(current_node, current_token, names, CHILD, &match, &status);
+  if (status == NONMATCHING_TOKEN) {
+    parse_error("Invalid arithmetic operand: Missing identifier, number or function call\n");
+    return PARSE_ERROR;
+  } else if (status != SUCCESS) return status;
+
+  MiniToken *cur_token = next_token(current_token, &status);
+  if (status != SUCCESS) return status;
 
+  *token_carrier = cur_token;
+  return VALID_CONSTRUCT;
+}
 
 // <arithmetic-expr> ::= <arith-operand> <bin-arith-oper> <arith-operand> | <una-arith-oper> <arith-operand> | <arith-operand>
-//                       | <indexing> | <sizeof>
+
+static MiniStatus arithmetic_expression(MiniSyntaxTree *current_node, MiniToken *current_token, MiniToken **token_carrier) {
+  if (last_token(current_token)) return LAST_TOKEN;
+
+  MiniStatus status;
+  MiniSyntaxTree *cur_node = current_node;
+  MiniToken *cur_token = current_token;
+  MiniSyntaxTree *new_node;
+  MiniToken *after_token = NULL;
+
+  static const MiniTokenSet unary = TOKEN_BIT(SQRT) | TOKEN_BIT(DEREFERENCE) | TOKEN_BIT(ADDRESS);
+  MiniTokenName match;
+  new_node = match_and_add_term_node(cur_node, cur_token, unary, CHILD, &match, &status);
+  if (status == SUCCESS) {
+    cur_node = new_node;
+
+    cur_token = next_token(cur_token, &status);
+    if (status != SUCCESS) return status;
+
+    new_node = add_nonterm_node(cur_node, ARITH_OPERAND, SIBLING, &status);
+    if (status != SUCCESS) return status;
+
+    return arithmetic_operand(new_node, cur_token, token_carrier);
+  } else if (status != NONMATCHING_TOKEN) return status;
+
+  new_node = add_nonterm_node(cur_node, ARITH_OPERAND, CHILD, &status);
+  if (status != SUCCESS) return status;
+
+  cur_node = new_node;
+  status = arithmetic_operand(cur_node, cur_token, &after_token);
+  if (status != VALID_CONSTRUCT) return status;
+
+  cur_token = after_token;
+
+  // A lone operand is all there is if no operator follows it
+  static const MiniTokenSet binary = TOKEN_BIT(PLUS) | TOKEN_BIT(MINUS) | TOKEN_BIT(TIMES) | TOKEN_BIT(DIV) | TOKEN_BIT(MOD) | TOKEN_BIT(POW);
+  new_node = match_and_add_term_node(cur_node, cur_token, binary, SIBLING, &match, &status);
+  if (status == NONMATCHING_TOKEN) {
+    *token_carrier = cur_token;
+    return VALID_CONSTRUCT;
+  } else if (status != SUCCESS) return status;
+
+  cur_node = new_node;
+
+  cur_token = next_token(cur_token, &status);
+  if (status != SUCCESS) return status;
+
+  new_node = add_nonterm_node(cur_node, ARITH_OPERAND, SIBLING, &status);
+  if (status != SUCCESS) return status;
+
+  return arithmetic_operand(new_node, cur_token, token_carrier);
+}
 
 
 // <logical-expr> ::= <logical-operand> <bin-log-oper> <logical-operand> 
@@ -1422,11 +1511,13 @@ static MiniStatus expression(MiniSyntaxTree *current_node, MiniToken *current_to
   MiniToken *after_token = NULL;
 
   MiniTokenName name = LEFT_PAREN;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, CHILD, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), CHILD, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
     bool logical_expr = false;
     MiniToken *temp_token = cur_token;
     status = SUCCESS;
+    // The scan moves past cur_token, which the expression is then parsed from
+    mark_token(cur_token);
     while (status == SUCCESS && temp_token->category != PUNCT_SEP) {
       MiniTokenCat cur_cat = temp_token->category;
       if (cur_cat == COMP_OP || cur_cat == BIN_LOG_OP || cur_cat == UNA_LOG_OP) {
@@ -1436,23 +1527,16 @@ static MiniStatus expression(MiniSyntaxTree *current_node, MiniToken *current_to
       temp_token = next_token(temp_token, &status);
     }    
 
-    if (status != SUCCESS) return status;
-
-    if (logical_expr) {
-      new_node = add_nonterm_node(cur_node, LOGICAL_EXPR, CHILD, &status);
-      if (status != SUCCESS) return status;
-      
-      cur_node = new_node;
-
-      return logical_expression(cur_node, cur_token, token_carrier);
-    } else {
-      new_node = add_nonterm_node(cur_node, ARITHMETIC_EXPR, CHILD, &status);
-      if (status != SUCCESS) return status;
-
-      cur_node = new_node;
-
-      return arithmetic_expression(cur_node, cur_token, token_carrier);
+    if (status == SUCCESS) {
+      new_node = add_nonterm_node(cur_node, logical_expr ? LOGICAL_EXPR : ARITHMETIC_EXPR, CHILD, &status);
     }
+    if (status == SUCCESS && logical_expr) {
+      status = logical_expression(new_node, cur_token, token_carrier);
+    } else if (status == SUCCESS) {
+      status = arithmetic_expression(new_node, cur_token, token_carrier);
+    }
+    unmark_token(cur_token);
+    return status;
   } else if (status != SUCCESS) return status;
   
   cur_node = new_node;
@@ -1464,14 +1548,14 @@ static MiniStatus expression(MiniSyntaxTree *current_node, MiniToken *current_to
 
   cur_node = new_node;
   status = primary_expression(cur_node, cur_token, &after_token);
-  if (status != SUCCESS) return status;
+  if (status != VALID_CONSTRUCT) return status;
 
   cur_token = after_token;
 
   name = RIGHT_PAREN;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid Expression: Missing %s\n", desc_token(RIGHT_PAREN));
+    parse_error("Invalid Expression: Missing %s\n", desc_token(RIGHT_PAREN));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -1497,8 +1581,9 @@ static MiniStatus primary_expression(MiniSyntaxTree *current_node, MiniToken *cu
   MiniToken *temp_token = next_token(cur_token, &status);
   if (status != SUCCESS) return status;
 
-  MiniToken names[] = {SEMICOLON, COLON, -1};
-  MiniToken match;
+  // A lone operand is followed by what can follow a primary expression
+  static const MiniTokenSet names = TOKEN_BIT(SEMICOLON) | TOKEN_BIT(COLON) | TOKEN_BIT(COMMA) | TOKEN_BIT(RIGHT_PAREN);
+  MiniTokenName match;
   status = match_terminals(temp_token, names, &match);
   if (status == NONMATCHING_TOKEN) {
     new_node = add_nonterm_node(cur_node, EXPRESSION, CHILD, &status);
@@ -1509,10 +1594,10 @@ static MiniStatus primary_expression(MiniSyntaxTree *current_node, MiniToken *cu
     return expression(cur_node, cur_token, token_carrier);
   } else if (status != SUCCESS) return status;
 
-  MiniTokenName names2[] = {MINI_ID, MINI_CONST_ID, MINI_EXT_ID, C_ID, INT_LITERAL, FLOAT_LITERAL, STRING_LITERAL, TRUE, FALSE, NUL, -1};
+  static const MiniTokenSet names2 = TOKEN_BIT(MINI_ID) | TOKEN_BIT(MINI_CONST_ID) | TOKEN_BIT(MINI_EXT_ID) | TOKEN_BIT(C_ID) | TOKEN_BIT(INT_LITERAL) | TOKEN_BIT(FLOAT_LITERAL) | TOKEN_BIT(STRING_LITERAL) | TOKEN_BIT(TRUE) | TOKEN_BIT(FALSE) | TOKEN_BIT(NUL);
   new_node = match_and_add_term_node(cur_node, cur_token, names2, CHILD, &match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid primary expression: Missing identifier, literal or keyword literal\n");
+    parse_error("Invalid primary expression: Missing identifier, literal or keyword literal\n");
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -1534,11 +1619,11 @@ static MiniStatus dictionary(MiniSyntaxTree *current_node, MiniToken *current_to
 
   MiniSyntaxTree *new_node;
   MiniSyntaxTree *cur_node = current_node;
-  MiniTokenName names[] = {INT_LITERAL, FLOAT_LITERAL, STRING_LITERAL, TRUE, FALSE, MINI_CONST_ID, -1};
+  static const MiniTokenSet names = TOKEN_BIT(INT_LITERAL) | TOKEN_BIT(FLOAT_LITERAL) | TOKEN_BIT(STRING_LITERAL) | TOKEN_BIT(TRUE) | TOKEN_BIT(FALSE) | TOKEN_BIT(MINI_CONST_ID);
   MiniTokenName match;
   new_node = match_and_add_term_node(cur_node, cur_token, names, CHILD, &match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid dictionary: %s is not a valid dictionary key\nNote: Dictionary key must be %s, %s, %s, %s, %s or %s\n", cur_token->string_repr, desc_token(INT_LITERAL), desc_token(FLOAT_LITERAL), desc_token(STRING_LITERAL), desc_token(TRUE), desc_token(FALSE), desc_token(MINI_CONST_ID));
+    parse_error("Invalid dictionary: %s is not a valid dictionary key\nNote: Dictionary key must be %s, %s, %s, %s, %s or %s\n", cur_token->string_repr, desc_token(INT_LITERAL), desc_token(FLOAT_LITERAL), desc_token(STRING_LITERAL), desc_token(TRUE), desc_token(FALSE), desc_token(MINI_CONST_ID));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -1548,9 +1633,9 @@ static MiniStatus dictionary(MiniSyntaxTree *current_node, MiniToken *current_to
   if (status != SUCCESS) return status;
 
   MiniTokenName name = COLON;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid dictionary: Missing %s\n", desc_token(COLON));
+    parse_error("Invalid dictionary: Missing %s\n", desc_token(COLON));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
   
@@ -1559,10 +1644,10 @@ static MiniStatus dictionary(MiniSyntaxTree *current_node, MiniToken *current_to
   cur_token = next_token(cur_token, &status);
   if (status != SUCCESS) return status;
 
-  MiniTokenName names2[] = {INT_LITERAL, FLOAT_LITERAL, STRING_LITERAL, MINI_CONST_ID, -1};
+  static const MiniTokenSet names2 = TOKEN_BIT(INT_LITERAL) | TOKEN_BIT(FLOAT_LITERAL) | TOKEN_BIT(STRING_LITERAL) | TOKEN_BIT(MINI_CONST_ID);
   new_node = match_and_add_term_node(cur_node, cur_token, names2, SIBLING, &match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid dictionary: %s is not a valid dictionary value\nNote: Dictionary value must be %s, %s, %s or %s\n", cur_token->string_repr, desc_token(INT_LITERAL), desc_token(FLOAT_LITERAL), desc_token(STRING_LITERAL), desc_token(MINI_CONST_ID));
+    parse_error("Invalid dictionary: %s is not a valid dictionary value\nNote: Dictionary value must be %s, %s, %s or %s\n", cur_token->string_repr, desc_token(INT_LITERAL), desc_token(FLOAT_LITERAL), desc_token(STRING_LITERAL), desc_token(MINI_CONST_ID));
     return PARSE_ERROR;
   }
 
@@ -1572,7 +1657,7 @@ static MiniStatus dictionary(MiniSyntaxTree *current_node, MiniToken *current_to
   if (status != SUCCESS) return status;
 
   name = COMMA;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
     *token_carrier = cur_token;
     return VALID_CONSTRUCT;
@@ -1601,11 +1686,11 @@ static MiniStatus list(MiniSyntaxTree *current_node, MiniToken *current_token, M
 
   MiniSyntaxTree *new_node;
   MiniSyntaxTree *cur_node = current_node;
-  MiniTokenName names[] = {INT_LITERAL, FLOAT_LITERAL, STRING_LITERAL, TRUE, FALSE, MINI_CONST_ID, -1};
+  static const MiniTokenSet names = TOKEN_BIT(INT_LITERAL) | TOKEN_BIT(FLOAT_LITERAL) | TOKEN_BIT(STRING_LITERAL) | TOKEN_BIT(TRUE) | TOKEN_BIT(FALSE) | TOKEN_BIT(MINI_CONST_ID);
   MiniTokenName match;
   new_node = match_and_add_term_node(cur_node, cur_token, names, CHILD, &match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid list: %s is not a valid list element\nNote: List element must be %s, %s, %s, %s, %s or %s\n", cur_token->string_repr, desc_token(INT_LITERAL), desc_token(FLOAT_LITERAL), desc_token(STRING_LITERAL), desc_token(TRUE), desc_token(FALSE), desc_token(MINI_CONST_ID));
+    parse_error("Invalid list: %s is not a valid list element\nNote: List element must be %s, %s, %s, %s, %s or %s\n", cur_token->string_repr, desc_token(INT_LITERAL), desc_token(FLOAT_LITERAL), desc_token(STRING_LITERAL), desc_token(TRUE), desc_token(FALSE), desc_token(MINI_CONST_ID));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -1615,7 +1700,7 @@ static MiniStatus list(MiniSyntaxTree *current_node, MiniToken *current_token, M
   if (status != SUCCESS) return status;
 
   MiniTokenName name = COMMA;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
     *token_carrier = cur_token;
     return VALID_CONSTRUCT;
@@ -1645,9 +1730,9 @@ static MiniStatus collection(MiniSyntaxTree *current_node, MiniToken *current_to
   MiniSyntaxTree *new_node;
   MiniSyntaxTree *cur_node = current_node;
   MiniTokenName name = LEFT_BRACKET;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, CHILD, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), CHILD, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid collection: Missing %s\n", desc_token(LEFT_BRACKET));
+    parse_error("Invalid collection: Missing %s\n", desc_token(LEFT_BRACKET));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -1656,39 +1741,40 @@ static MiniStatus collection(MiniSyntaxTree *current_node, MiniToken *current_to
   cur_token = next_token(cur_token, &status);
   if (status != SUCCESS) return status;
 
-  MiniToken current_holder = *cur_token;
+  MiniToken *current_holder = cur_token;
 
   cur_token = next_token(cur_token, &status);
   if (status != SUCCESS) return status;
 
   MiniToken *after_token = NULL;
-  MiniTokenName names[] = {COMMA, COLON, -1};
+  // A list of one element ends right after it
+  static const MiniTokenSet names = TOKEN_BIT(COMMA) | TOKEN_BIT(COLON) | TOKEN_BIT(RIGHT_BRACKET);
   MiniTokenName match;
   status = match_terminals(cur_token, names, &match);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid collection: Missing %s or %s\n", desc_token(COMMA), desc_token(COLON));
+    parse_error("Invalid collection: Missing %s, %s or %s\n", desc_token(COMMA), desc_token(COLON), desc_token(RIGHT_BRACKET));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
-  if (match == COMMA) {
+  if (match == COMMA || match == RIGHT_BRACKET) {
     new_node = add_nonterm_node(cur_node, LIST, SIBLING, &status); 
     
     cur_node = new_node;
-    status = list(cur_node, &current_holder, &after_token);
+    status = list(cur_node, current_holder, &after_token);
     
   } else if (match == COLON) {
     new_node = add_nonterm_node(cur_node, DICT, SIBLING, &status);
     
     cur_node = new_node;
-    status = dictionary(cur_node, &current_holder, &after_token);
+    status = dictionary(cur_node, current_holder, &after_token);
   }
 
   if (status != VALID_CONSTRUCT) return status;
 
   name = RIGHT_BRACKET;
-  new_node = match_and_add_term_node(cur_node, after_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, after_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid collection: Missing %s\n", desc_token(RIGHT_BRACKET));
+    parse_error("Invalid collection: Missing %s\n", desc_token(RIGHT_BRACKET));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
   
@@ -1707,11 +1793,11 @@ static MiniStatus type(MiniSyntaxTree *current_node, MiniToken *current_token) {
   if (last_token(current_token)) return LAST_TOKEN;
 
   MiniStatus status;
-  MiniTokenName names[] = {VOID, INT, FLOAT, STR, BOOL, STREAM, LIST_T, DICT_T, ENUM_T, UNION_T, STRUCT_T, CUSTOM_T, -1};
+  static const MiniTokenSet names = TOKEN_BIT(VOID) | TOKEN_BIT(INT) | TOKEN_BIT(FLOAT) | TOKEN_BIT(STR) | TOKEN_BIT(BOOL) | TOKEN_BIT(STREAM) | TOKEN_BIT(LIST_T) | TOKEN_BIT(DICT_T) | TOKEN_BIT(ENUM_T) | TOKEN_BIT(UNION_T) | TOKEN_BIT(STRUCT_T) | TOKEN_BIT(CUSTOM_T);
   MiniTokenName match;
   match_and_add_term_node(current_node, current_token, names, CHILD, &match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid type: %s is not recognized as a type\n", current_token->string_repr);
+    parse_error("Invalid type: %s is not recognized as a type\n", current_token->string_repr);
     return PARSE_ERROR;
   }
   return VALID_CONSTRUCT;
@@ -1729,9 +1815,9 @@ static MiniStatus parameter_list(MiniSyntaxTree *current_node, MiniToken *curren
   //MiniToken *after_token = NULL;
   MiniTokenCat category = TYPE_KW;
   MiniNonTerm corresp_nonterm = TYPE_EXPR;
-  new_node = match_cat_and_add_nonterm_node(cur_node, cur_token, &category, &corresp_nonterm, CHILD, NULL, &status);
+  new_node = match_cat_and_add_nonterm_node(cur_node, cur_token, CATEGORY_BIT(category), &corresp_nonterm, CHILD, NULL, &status);
   if (status == NONMATCHING_CATEGORY) {
-    printf("Parse Error: Invalid parameter list specification: Missing type keyword\n");
+    parse_error("Invalid parameter list specification: Missing type keyword\n");
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -1744,9 +1830,9 @@ static MiniStatus parameter_list(MiniSyntaxTree *current_node, MiniToken *curren
   if (status != SUCCESS) return status;
 
   MiniTokenName name = MINI_ID;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid parameter list specification: Missing %s\n", desc_token(MINI_ID));
+    parse_error("Invalid parameter list specification: Missing %s\n", desc_token(MINI_ID));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -1756,7 +1842,7 @@ static MiniStatus parameter_list(MiniSyntaxTree *current_node, MiniToken *curren
   if (status != SUCCESS) return status;
 
   name = COMMA;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
     *token_carrier = cur_token;
     return VALID_CONSTRUCT;
@@ -1769,9 +1855,9 @@ static MiniStatus parameter_list(MiniSyntaxTree *current_node, MiniToken *curren
   if (status != SUCCESS) return status;
 
   corresp_nonterm = PARAM_LIST;
-  new_node = match_cat_and_add_nonterm_node(cur_node, cur_token, &category, &corresp_nonterm, SIBLING, NULL, &status);
+  new_node = match_cat_and_add_nonterm_node(cur_node, cur_token, CATEGORY_BIT(category), &corresp_nonterm, SIBLING, NULL, &status);
   if (status == NONMATCHING_CATEGORY) {
-    printf("Parse Error: Invalid parameter list specification: Missing type keyword after comma\n");
+    parse_error("Invalid parameter list specification: Missing type keyword after comma\n");
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -1795,7 +1881,7 @@ static MiniStatus subprogram(MiniSyntaxTree *current_node, MiniToken *current_to
   MiniTokenName match;
   new_node = match_and_add_term_node_seq(cur_node, cur_token, &after_token, names, rels, &match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid subprogram specification: Missing %s\n", desc_token(match));
+    parse_error("Invalid subprogram specification: Missing %s\n", desc_token(match));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -1806,7 +1892,7 @@ static MiniStatus subprogram(MiniSyntaxTree *current_node, MiniToken *current_to
 
   MiniTokenCat category = TYPE_KW;
   MiniNonTerm corresp_nonterm = PARAM_LIST;
-  new_node = match_cat_and_add_nonterm_node(cur_node, cur_token, &category, &corresp_nonterm, SIBLING, NULL, &status);
+  new_node = match_cat_and_add_nonterm_node(cur_node, cur_token, CATEGORY_BIT(category), &corresp_nonterm, SIBLING, NULL, &status);
   if (status == SUCCESS) {
     new_node = cur_node;
 
@@ -1820,7 +1906,7 @@ static MiniStatus subprogram(MiniSyntaxTree *current_node, MiniToken *current_to
   MiniRelation rels2[] = {SIBLING, SIBLING, -1};
   new_node = match_and_add_term_node_seq(cur_node, cur_token, &after_token, names2, rels2, &match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid subprogram specification: Missing %s\n", desc_token(match));
+    parse_error("Invalid subprogram specification: Missing %s\n", desc_token(match));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -1830,9 +1916,9 @@ static MiniStatus subprogram(MiniSyntaxTree *current_node, MiniToken *current_to
   if (last_token(cur_token)) return LAST_TOKEN;
   
   corresp_nonterm = TYPE_EXPR;
-  new_node = match_cat_and_add_nonterm_node(cur_node, cur_token, &category, &corresp_nonterm, SIBLING, NULL, &status);
+  new_node = match_cat_and_add_nonterm_node(cur_node, cur_token, CATEGORY_BIT(category), &corresp_nonterm, SIBLING, NULL, &status);
   if (status == NONMATCHING_CATEGORY) {
-    printf("Parse Error: Invalid subprogram specification: Missing return type\n");
+    parse_error("Invalid subprogram specification: Missing return type\n");
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -1844,9 +1930,9 @@ static MiniStatus subprogram(MiniSyntaxTree *current_node, MiniToken *current_to
   if (status != SUCCESS) return status;
 
   MiniTokenName name = COLON;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid subprogram specification: Missing %s\n", desc_token(COLON));
+    parse_error("Invalid subprogram specification: Missing %s\n", desc_token(COLON));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -1864,9 +1950,9 @@ static MiniStatus subprogram(MiniSyntaxTree *current_node, MiniToken *current_to
   cur_token = after_token;
   
   name = END_FUNC;
-  new_node = match_and_add_term_node(cur_node, cur_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, cur_token, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status != SUCCESS) {
-    printf("Parse Error: Invalid subprgram specification: Missing %s\n", desc_token(END_FUNC));
+    parse_error("Invalid subprgram specification: Missing %s\n", desc_token(END_FUNC));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -1907,7 +1993,7 @@ static right_value(MiniSyntaxTree *current_node, MiniToken *current_token, MiniT
   new_node = match_and_add_term_node(cur_node, current_keeper, names, CHILD, &match, &status);
   if (status == NONMATCHING_TOKEN) {
     // XXX: Left off here
-    printf("Parse Error: Invalid Rvalue: %s\n", current_token->string_repr);
+    parse_error("Invalid Rvalue: %s\n", current_token->string_repr);
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -1932,9 +2018,9 @@ static MiniStatus module_declaration(MiniSyntaxTree *current_node, MiniToken *cu
   MiniTokenCat category = TYPE_KW;
   MiniNonTerm corresp_nonterm = TYPE_EXPR;
   //MiniTokenCat match;
-  new_node = match_cat_and_add_nonterm_node(cur_node, current_token, &category, &corresp_nonterm, CHILD, NULL, &status);
+  new_node = match_cat_and_add_nonterm_node(cur_node, current_token, CATEGORY_BIT(category), &corresp_nonterm, CHILD, NULL, &status);
   if (status == NONMATCHING_CATEGORY) {
-    printf("Parse Error: Invalid Module Declaration: Missing type keyword\n");
+    parse_error("Invalid Module Declaration: Missing type keyword\n");
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
   
@@ -1945,7 +2031,7 @@ static MiniStatus module_declaration(MiniSyntaxTree *current_node, MiniToken *cu
   current_token = next_token(current_token, &status);
   if (status != SUCCESS) return status;
 
-  MiniTokenName names[] = {MINI_ID, MINI_CONST_ID, -1};
+  static const MiniTokenSet names = TOKEN_BIT(MINI_ID) | TOKEN_BIT(MINI_CONST_ID);
   /*
   if (after_token) {
     new_node = match_and_add_term_node(cur_node, after_token, names, SIBLING, &match, &status);
@@ -1956,7 +2042,7 @@ static MiniStatus module_declaration(MiniSyntaxTree *current_node, MiniToken *cu
   MiniTokenName name_match;
   new_node = match_and_add_term_node(cur_node, current_token, names, SIBLING, &name_match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid Module Declaration: Missing %s\n", desc_token(name_match));
+    parse_error("Invalid Module Declaration: Missing %s\n", desc_token(name_match));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -1980,7 +2066,7 @@ static MiniStatus module_declaration(MiniSyntaxTree *current_node, MiniToken *cu
     new_node = match_and_add_term_node(cur_node, current_token, &name, SIBLING, NULL, &status);
   }
   */
-  new_node = match_and_add_term_node(cur_node, current_token, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, current_token, TOKEN_BIT(name), SIBLING, NULL, &status);
 
   if (status == NONMATCHING_TOKEN) {
     name = ASSIGN;
@@ -1991,9 +2077,9 @@ static MiniStatus module_declaration(MiniSyntaxTree *current_node, MiniToken *cu
       new_node = match_and_add_term_node(cur_node, current_token, &name, SIBLING, NULL, &status);
     }
     */
-    new_node = match_and_add_term_node(cur_node, current_token, &name, SIBLING, NULL, &status);
+    new_node = match_and_add_term_node(cur_node, current_token, TOKEN_BIT(name), SIBLING, NULL, &status);
     if (status == NONMATCHING_TOKEN) {
-      printf("Parse Error: Invalid Module Declaration: Missing %s\n", desc_token(ASSIGN));
+      parse_error("Invalid Module Declaration: Missing %s\n", desc_token(ASSIGN));
       return PARSE_ERROR;
     } else if (status != SUCCESS) return status;
 
@@ -2010,8 +2096,8 @@ static MiniStatus module_declaration(MiniSyntaxTree *current_node, MiniToken *cu
     */
 
     MiniToken *after_token2 = NULL;
-    MiniTokenName names2[] = {LEFT_BRACKET, LEFT_BRACE, -1};
-    MiniNonTerm corresp_nonterms[] = {COLLECTION, COLLECTION, -1};
+    static const MiniTokenSet names2 = TOKEN_BIT(LEFT_BRACKET) | TOKEN_BIT(LEFT_BRACE);
+    static const MiniNonTerm corresp_nonterms[MINIMAL_TOKEN_INDEX_COUNT] = {[MINIMAL_TOKEN_INDEX(LEFT_BRACKET)] = COLLECTION, [MINIMAL_TOKEN_INDEX(LEFT_BRACE)] = COLLECTION};
     /*
     if (after_token) {
       new_node = match_and_add_nonterm_node(cur_node, after_token, names2, corresp_nonterms, SIBLING, &match, &status);      
@@ -2054,9 +2140,9 @@ static MiniStatus module_declaration(MiniSyntaxTree *current_node, MiniToken *cu
     }
 
     name = SEMICOLON;
-    new_node = match_and_add_term_node(cur_node, after_token2, &name, SIBLING, NULL, &status);
+    new_node = match_and_add_term_node(cur_node, after_token2, TOKEN_BIT(name), SIBLING, NULL, &status);
     if (status == NONMATCHING_TOKEN) {
-      printf("Parse Error: Invalid Module Declaration: Missing %s\n", desc_token(SEMICOLON));
+      parse_error("Invalid Module Declaration: Missing %s\n", desc_token(SEMICOLON));
       return PARSE_ERROR;
     } else if (status != SUCCESS) return status;
 
@@ -2110,7 +2196,7 @@ static MiniStatus custom_type(MiniSyntaxTree *current_node, MiniToken *current_t
   MiniTokenName non_match;
   new_node = match_and_add_term_node_seq(cur_node, current_token, &after_token, names, rels, &non_match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid custom type: Missing %s\n", desc_token(non_match));
+    parse_error("Invalid custom type: Missing %s\n", desc_token(non_match));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -2130,9 +2216,9 @@ static MiniStatus type_aliasing(MiniSyntaxTree *current_node, MiniToken *current
   MiniSyntaxTree *new_node;
   MiniTokenCat name = TYPE_KW;
   MiniNonTerm corresp_nonterm = TYPE_EXPR;
-  new_node = match_cat_and_add_nonterm_node(cur_node, current_token, &name, &corresp_nonterm, CHILD, NULL, &status);
+  new_node = match_cat_and_add_nonterm_node(cur_node, current_token, CATEGORY_BIT(name), &corresp_nonterm, CHILD, NULL, &status);
   if (status == NONMATCHING_CATEGORY) {
-    printf("Parse Error: Invalid type aliasing: Missing type keyword to alias\n");
+    parse_error("Invalid type aliasing: Missing type keyword to alias\n");
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -2146,9 +2232,9 @@ static MiniStatus type_aliasing(MiniSyntaxTree *current_node, MiniToken *current
 
   MiniTokenName name2 = REDIRECT;
   MiniTokenName match;
-  new_node = match_and_add_term_node(cur_node, current_token, &name2, SIBLING, &match, &status);
+  new_node = match_and_add_term_node(cur_node, current_token, TOKEN_BIT(name2), SIBLING, &match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid type aliasing: Missing %s\n", desc_token(REDIRECT));
+    parse_error("Invalid type aliasing: Missing %s\n", desc_token(REDIRECT));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -2158,9 +2244,9 @@ static MiniStatus type_aliasing(MiniSyntaxTree *current_node, MiniToken *current
   cur_node = new_node;
 
   name2 = CUSTOM_T;
-  new_node = match_and_add_term_node(cur_node, current_token, &name2, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, current_token, TOKEN_BIT(name2), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid type aliasing: Missing %s\n", desc_token(CUSTOM_T));
+    parse_error("Invalid type aliasing: Missing %s\n", desc_token(CUSTOM_T));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -2176,9 +2262,9 @@ static MiniStatus type_aliasing(MiniSyntaxTree *current_node, MiniToken *current
   */
 
   name2 = SEMICOLON;
-  new_node = match_and_add_term_node(cur_node, current_token, &name2, SIBLING, &match, &status);
+  new_node = match_and_add_term_node(cur_node, current_token, TOKEN_BIT(name2), SIBLING, &match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid type aliasing: Missing %s\n", desc_token(SEMICOLON));
+    parse_error("Invalid type aliasing: Missing %s\n", desc_token(SEMICOLON));
   } else if (status != SUCCESS) return status;
 
   current_token = next_token(current_token, &status);
@@ -2197,10 +2283,10 @@ static MiniStatus import(MiniSyntaxTree *current_node, MiniToken *current_token,
   MiniSyntaxTree *cur_node = current_node;
   MiniSyntaxTree *new_node;
   MiniTokenName match;
-  MiniTokenName names[] = {IMPORT, M_IMPORT, C_IMPORT, -1};
+  static const MiniTokenSet names = TOKEN_BIT(IMPORT) | TOKEN_BIT(M_IMPORT) | TOKEN_BIT(C_IMPORT);
   new_node = match_and_add_term_node(cur_node, current_token, names, CHILD, &match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid import statement: Missing %s, %s or %s\n",
+    parse_error("Invalid import statement: Missing %s, %s or %s\n",
         desc_token(IMPORT), desc_token(M_IMPORT), desc_token(C_IMPORT));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
@@ -2219,7 +2305,7 @@ static MiniStatus import(MiniSyntaxTree *current_node, MiniToken *current_token,
   }
   new_node = match_and_add_term_node_seq(cur_node, current_token, &after_token, names2, rels, &non_match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid import statement: Missing %s\n", desc_token(non_match));
+    parse_error("Invalid import statement: Missing %s\n", desc_token(non_match));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -2242,27 +2328,32 @@ static MiniStatus module_sequence(MiniSyntaxTree *current_node, MiniToken *curre
   MiniSyntaxTree *cur_node = current_node;
   MiniSyntaxTree *new_node;
   MiniTokenName match;
-  MiniTokenName names[] = {IMPORT, M_IMPORT, C_IMPORT, FUNC, -1};
-  MiniNonTerm corresp_nonterms[] = {IMPORTING, IMPORTING, IMPORTING, SUBPROGRAM, -1};
-  MiniTokenName names2[] = {REDIRECT, MINI_ID, MINI_CONST_ID, -1};
-  MiniNonTerm corresp_nonterms2[] = {TYPE_ALIASING, MODULE_DECLARATION, MODULE_DECLARATION, -1};
+  static const MiniTokenSet names = TOKEN_BIT(IMPORT) | TOKEN_BIT(M_IMPORT) | TOKEN_BIT(C_IMPORT) | TOKEN_BIT(FUNC);
+  static const MiniNonTerm corresp_nonterms[MINIMAL_TOKEN_INDEX_COUNT] = {[MINIMAL_TOKEN_INDEX(IMPORT)] = IMPORTING, [MINIMAL_TOKEN_INDEX(M_IMPORT)] = IMPORTING, [MINIMAL_TOKEN_INDEX(C_IMPORT)] = IMPORTING, [MINIMAL_TOKEN_INDEX(FUNC)] = SUBPROGRAM};
+  static const MiniTokenSet names2 = TOKEN_BIT(REDIRECT) | TOKEN_BIT(MINI_ID) | TOKEN_BIT(MINI_CONST_ID);
+  static const MiniNonTerm corresp_nonterms2[MINIMAL_TOKEN_INDEX_COUNT] = {[MINIMAL_TOKEN_INDEX(REDIRECT)] = TYPE_ALIASING, [MINIMAL_TOKEN_INDEX(MINI_ID)] = MODULE_DECLARATION, [MINIMAL_TOKEN_INDEX(MINI_CONST_ID)] = MODULE_DECLARATION};
 
   new_node = match_and_add_nonterm_node(cur_node, current_token, names, corresp_nonterms, CHILD, &match, &status);
   if (status == NONMATCHING_TOKEN) {
-    temp_token = current_token->next_token;
+    temp_token = peek_token(current_token);
     new_node = match_and_add_nonterm_node(cur_node, temp_token, names2, corresp_nonterms2, CHILD, &match, &status);
     if (status == NONMATCHING_TOKEN) {
-      printf("Parse Error: Invalid module sequence: Should start with\n%s,\n%s,\n%s,\n%s or\ntype keyword\n",
+      parse_error("Invalid module sequence: Should start with\n%s,\n%s,\n%s,\n%s or\ntype keyword\n",
         desc_token(IMPORT), desc_token(M_IMPORT), desc_token(C_IMPORT), desc_token(FUNC));
       return PARSE_ERROR;
     } else if (status != SUCCESS) return status;
     cur_node = new_node;
 
+    mark_token(current_token);
     if (match == REDIRECT) {
       status = type_aliasing(cur_node, current_token, &after_token);
     } else {
       status = module_declaration(cur_node, current_token, &after_token);
     }
+    if (status == PARSE_ERROR) {
+      status = synchronize(current_token, false, &after_token);
+    }
+    unmark_token(current_token);
     if (status != VALID_CONSTRUCT) return status;
 
     if (last_token(after_token)) return LAST_TOKEN;
@@ -2271,11 +2362,11 @@ static MiniStatus module_sequence(MiniSyntaxTree *current_node, MiniToken *curre
     status2 = NONMATCHING_TOKEN;
     status = match_terminals(after_token, names, &match);
     if (status == NONMATCHING_TOKEN) {
-      if (last_token(after_token->next_token)) {
+      if (last_token(peek_token(after_token))) {
         *token_carrier = after_token;
         return VALID_CONSTRUCT;  
       }
-      status2 = match_terminals(after_token->next_token, names2, &match);
+      status2 = match_terminals(peek_token(after_token), names2, &match);
     }
 
     if (status == SUCCESS || status2 == SUCCESS) {
@@ -2291,6 +2382,7 @@ static MiniStatus module_sequence(MiniSyntaxTree *current_node, MiniToken *curre
   } else if (status != SUCCESS) return status;
   cur_node = new_node;
 
+  mark_token(current_token);
   if (match == IMPORT || match == M_IMPORT || match == C_IMPORT) {
     status = import(cur_node, current_token, &after_token);    
   } else if (match == FUNC) {
@@ -2298,6 +2390,10 @@ static MiniStatus module_sequence(MiniSyntaxTree *current_node, MiniToken *curre
   } else {
     status = module_declaration(cur_node, current_token, &after_token);
   }
+  if (status == PARSE_ERROR) {
+    status = synchronize(current_token, match == FUNC, &after_token);
+  }
+  unmark_token(current_token);
   if (status != VALID_CONSTRUCT) return status;
 
   if (last_token(after_token)) return LAST_TOKEN;
@@ -2305,11 +2401,11 @@ static MiniStatus module_sequence(MiniSyntaxTree *current_node, MiniToken *curre
   status2 = NONMATCHING_TOKEN;
   status = match_terminals(after_token, names, &match);
   if (status == NONMATCHING_TOKEN) {
-    if (last_token(after_token->next_token)) {
+    if (last_token(peek_token(after_token))) {
       *token_carrier = after_token;
       return VALID_CONSTRUCT;  
     }
-    status2 = match_terminals(after_token->next_token, names2, &match);
+    status2 = match_terminals(peek_token(after_token), names2, &match);
   }
 
   if (status == SUCCESS || status2 == SUCCESS) {
@@ -2338,7 +2434,7 @@ static MiniStatus module_part(MiniSyntaxTree *current_node, MiniToken *current_t
   
   new_node = match_and_add_term_node_seq(cur_node, current_token, &after_token, names, rels, &non_match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid module part specification: Missing %s\n", desc_token(non_match));
+    parse_error("Invalid module part specification: Missing %s\n", desc_token(non_match));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
   cur_node = new_node;
@@ -2352,13 +2448,13 @@ static MiniStatus module_part(MiniSyntaxTree *current_node, MiniToken *current_t
   if (status != VALID_CONSTRUCT) return status;
 
   MiniTokenName name = END_MODULE;
-  new_node = match_and_add_term_node(cur_node, after_token2, &name, SIBLING, NULL, &status);
+  new_node = match_and_add_term_node(cur_node, after_token2, TOKEN_BIT(name), SIBLING, NULL, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid module part specification: Missing %s\n", desc_token(END_MODULE));
+    parse_error("Invalid module part specification: Missing %s\n", desc_token(END_MODULE));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
-  if (last_token(after_token2->next_token)) {
+  if (last_token(peek_token(after_token2))) {
     *token_carrier = NULL;
     return VALID_CONSTRUCT;
   }
@@ -2380,9 +2476,9 @@ static MiniStatus module_file(MiniSyntaxTree *current_node, MiniToken *current_t
   MiniSyntaxTree *cur_node = current_node;
   MiniSyntaxTree *new_node;
   
-  new_node = match_and_add_nonterm_node(cur_node, current_token, &name, &corresp_nonterm, CHILD, NULL, &status);
+  new_node = match_and_add_nonterm_node(cur_node, current_token, TOKEN_BIT(name), &corresp_nonterm, CHILD, NULL, &status);
   if (status == PARSE_ERROR) {
-    printf("Parse Error: Invalid module file: Missing %s\n", desc_token(MODULE)); 
+    parse_error("Invalid module file: Missing %s\n", desc_token(MODULE)); 
     return PARSE_ERROR;
   }
   if (status != SUCCESS) return status;
@@ -2408,11 +2504,11 @@ static MiniStatus main_file(MiniSyntaxTree *current_node, MiniToken *current_tok
   if (status != SUCCESS) return status;
 
   MiniTokenName match;
-  MiniTokenName names[] = {MAIN, MODULE, -1};
-  MiniNonTerm corresp_nonterms[] = {MAIN_PART, MODULE_PART, -1};
+  static const MiniTokenSet names = TOKEN_BIT(MAIN) | TOKEN_BIT(MODULE);
+  static const MiniNonTerm corresp_nonterms[MINIMAL_TOKEN_INDEX_COUNT] = {[MINIMAL_TOKEN_INDEX(MAIN)] = MAIN_PART, [MINIMAL_TOKEN_INDEX(MODULE)] = MODULE_PART};
   new_node = match_and_add_nonterm_node(cur_node, current_token, names, corresp_nonterms, SIBLING, &match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid main file specification: Missing %s or %s\n", desc_token(MAIN), desc_token(MODULE));
+    parse_error("Invalid main file specification: Missing %s or %s\n", desc_token(MAIN), desc_token(MODULE));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
   cur_node = new_node;
@@ -2427,9 +2523,9 @@ static MiniStatus main_file(MiniSyntaxTree *current_node, MiniToken *current_tok
   
   MiniTokenName name = MAIN;
   MiniNonTerm corresp_nonterm = MAIN_PART;
-  new_node = match_and_add_nonterm_node(cur_node, after_token, &name, &corresp_nonterm, SIBLING, NULL, &status);
+  new_node = match_and_add_nonterm_node(cur_node, after_token, TOKEN_BIT(name), &corresp_nonterm, SIBLING, NULL, &status);
   if (status == PARSE_ERROR) {
-    printf("Parse Error: Invalid main file specification: Missing %s\n", desc_token(MAIN));
+    parse_error("Invalid main file specification: Missing %s\n", desc_token(MAIN));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
 
@@ -2446,11 +2542,11 @@ static MiniStatus source(MiniSyntaxTree *current_node, MiniToken *current_token)
   MiniSyntaxTree *new_node;
 
   MiniTokenName match;
-  MiniTokenName names[] = {MODULE, MAIN_DECLARATION, -1};
-  MiniNonTerm corresp_nonterms[] = {MODULE_FILE, MAIN_FILE, -1};
+  static const MiniTokenSet names = TOKEN_BIT(MODULE) | TOKEN_BIT(MAIN_DECLARATION);
+  static const MiniNonTerm corresp_nonterms[MINIMAL_TOKEN_INDEX_COUNT] = {[MINIMAL_TOKEN_INDEX(MODULE)] = MODULE_FILE, [MINIMAL_TOKEN_INDEX(MAIN_DECLARATION)] = MAIN_FILE};
   new_node = match_and_add_nonterm_node(cur_node, current_token, names, corresp_nonterms, CHILD, &match, &status);
   if (status == NONMATCHING_TOKEN) {
-    printf("Parse Error: Invalid source specification: Should begin with %s or %s\n", desc_token(MODULE), desc_token(MAIN_DECLARATION));
+    parse_error("Invalid source specification: Should begin with %s or %s\n", desc_token(MODULE), desc_token(MAIN_DECLARATION));
     return PARSE_ERROR;
   } else if (status != SUCCESS) return status;
   cur_node = new_node;
@@ -2474,10 +2570,200 @@ static MiniStatus source(MiniSyntaxTree *current_node, MiniToken *current_token)
   return VALID_CONSTRUCT;
 }
 
-MiniStatus generate_ast(char *input_file, char *output_file, MiniHeadToken *head_token, MiniSyntaxTree *root, int verbose) {
+#define MAX_PARSE_THREADS 16
+#define PARSE_UNITS_INITIAL_CAPACITY 16
+
+// A module file or the main file. Nothing in one of them changes how another one parses,
+// so each is parsed on its own and the results are put together in source order
+typedef struct minimal_parse_unit {
+  MiniToken *first;
+  MiniToken *after; // First token of the next unit, NULL for the last one
+  MiniSyntaxTree *node; // The MODULE_FILE or MAIN_FILE node the unit is parsed into
+  MiniParseErrorLog errors;
+  MiniStatus status;
+} MiniParseUnit;
+
+typedef struct minimal_parse_worker {
+  MiniParseUnit *units;
+  size_t unit_count;
+  size_t first_unit;
+  size_t stride;
+} MiniParseWorker;
+
+// Splits the tokens into units with a linear scan: a module file runs from MODULE to the
+// END_MODULE after it, and the main file runs to the end of the input. Returns the number
+// of units, or 0 if the tokens aren't laid out like that. Such input is left to source(),
+// which reports the problem where it is
+static size_t find_parse_units(MiniToken *first, MiniParseUnit **units_out, MiniStatus *status) {
+  size_t capacity = PARSE_UNITS_INITIAL_CAPACITY;
+  size_t count = 0;
+  MiniParseUnit *units = malloc(capacity * sizeof(MiniParseUnit));
+  if (units == NULL) {
+    printf("generate_ast: Memory Error: Failed to allocate memory for parse units\n");
+    *status = ALLOCATION_FAIL;
+    return 0;
+  }
+  *status = SUCCESS;
+
+  MiniToken *cur_token = first;
+  while (!last_token(cur_token)) {
+    if (cur_token->name != MODULE && cur_token->name != MAIN_DECLARATION) break;
+    if (count == capacity) {
+      capacity *= 2;
+      MiniParseUnit *grown = realloc(units, capacity * sizeof(MiniParseUnit));
+      if (grown == NULL) {
+        printf("generate_ast: Memory Error: Failed to grow parse unit array\n");
+        free(units);
+        *status = REALLOCATION_FAIL;
+        return 0;
+      }
+      units = grown;
+    }
+    MiniParseUnit *unit = &units[count++];
+    memset(unit, 0, sizeof(MiniParseUnit));
+    unit->first = cur_token;
+    if (cur_token->name == MAIN_DECLARATION) {
+      *units_out = units;
+      return count;
+    }
+    while (!last_token(cur_token) && cur_token->name != END_MODULE) {
+      cur_token = cur_token->next_token;
+    }
+    if (last_token(cur_token)) break;
+    cur_token = cur_token->next_token;
+    unit->after = cur_token;
+  }
+
+  if (!last_token(cur_token) || count == 0) {
+    free(units);
+    return 0;
+  }
+  *units_out = units;
+  return count;
+}
+
+static void parse_unit(MiniParseUnit *unit) {
+  collect_parse_errors(&unit->errors);
+  if (unit->first->name == MAIN_DECLARATION) {
+    unit->status = main_file(unit->node, unit->first);
+  } else {
+    MiniToken *after_token = NULL;
+    unit->status = module_file(unit->node, unit->first, &after_token);
+    if (unit->status == VALID_CONSTRUCT && after_token != unit->after) {
+      parse_error("Invalid module file: Should end with its first %s\n", desc_token(END_MODULE));
+      unit->status = PARSE_ERROR;
+    }
+  }
+  collect_parse_errors(NULL);
+}
+
+static void *parse_units(void *worker_ptr) {
+  MiniParseWorker *worker = worker_ptr;
+  for (size_t i = worker->first_unit; i < worker->unit_count; i += worker->stride) {
+    parse_unit(&worker->units[i]);
+  }
+  return NULL;
+}
+
+// Parses the units on thread_count threads, at most one per unit, into the same tree that
+// source() would build: the SOURCE chain and the MODULE_FILE/MAIN_FILE nodes are added up
+// front and each worker fills in the subtrees of its units. Like source(), the result is that of the first unit
+// that fails, and the units after it are dropped from the tree along with their errors
+static MiniStatus parse_parallel(MiniSyntaxTree *root, MiniParseUnit *units, size_t unit_count, long thread_count) {
+  MiniStatus status;
+  MiniSyntaxTree *source_node = root;
+  for (size_t i = 0; i < unit_count; i++) {
+    if (i > 0) {
+      source_node = add_nonterm_node(units[i - 1].node, SOURCE, SIBLING, &status);
+      if (status != SUCCESS) return status;
+    }
+    MiniNonTerm file = units[i].first->name == MAIN_DECLARATION ? MAIN_FILE : MODULE_FILE;
+    units[i].node = add_nonterm_node(source_node, file, CHILD, &status);
+    if (status != SUCCESS) return status;
+  }
+
+  MiniParseWorker workers[MAX_PARSE_THREADS];
+  pthread_t threads[MAX_PARSE_THREADS];
+  bool thread_started[MAX_PARSE_THREADS];
+  for (long i = 0; i < thread_count; i++) {
+    workers[i] = (MiniParseWorker) {.units = units, .unit_count = unit_count, .first_unit = i, .stride = thread_count};
+    thread_started[i] = pthread_create(&threads[i], NULL, parse_units, &workers[i]) == 0;
+    if (!thread_started[i]) {
+      parse_units(&workers[i]);
+    }
+  }
+  for (long i = 0; i < thread_count; i++) {
+    if (thread_started[i]) {
+      pthread_join(threads[i], NULL);
+    }
+  }
+
+  status = VALID_CONSTRUCT;
+  for (size_t i = 0; i < unit_count; i++) {
+    if (status != VALID_CONSTRUCT) {
+      free_parse_error_log(&units[i].errors);
+      continue;
+    }
+    report_parse_errors(&units[i].errors);
+    status = units[i].status;
+    if (status != VALID_CONSTRUCT) {
+      free_syntax_tree(units[i].node->sibling);
+      units[i].node->sibling = NULL;
+    }
+  }
+  return status;
+}
+
+// Module files are parsed in parallel when there are several top level units and the whole
+// token list is already there. Otherwise, and when the units can't be told apart up front,
+// the source is parsed on the calling thread
+static MiniStatus parse_source(MiniSyntaxTree *root, MiniToken *first, int verbose) {
+  long thread_count = parse_thread_count > 0 ? parse_thread_count : sysconf(_SC_NPROCESSORS_ONLN);
+  if (thread_count > MAX_PARSE_THREADS) {
+    thread_count = MAX_PARSE_THREADS;
+  }
+  if (thread_count < 2 || token_stream_attached()) {
+    return source(root, first);
+  }
+
+  MiniStatus status;
+  MiniParseUnit *units = NULL;
+  size_t unit_count = find_parse_units(first, &units, &status);
+  if (status != SUCCESS) return status;
+  if (unit_count < 2) {
+    free(units);
+    return source(root, first);
+  }
+  if ((size_t) thread_count > unit_count) {
+    thread_count = unit_count;
+  }
+  status = parse_parallel(root, units, unit_count, thread_count);
   if (verbose) {
-    printf("Beginning parsing\n");
+    printf("Parsed %zu top level units on %ld threads\n", unit_count, thread_count);
+  }
+  free(units);
+  return status;
+}
+
+// Recovered errors leave the constructs around them valid, so the result alone
+// doesn't tell whether there were any
+static MiniStatus finish_parse_errors(MiniStatus status) {
+  int error_count = parse_error_count();
+  if (error_count > 0) {
+    int hidden = error_count - printed_parse_error_count();
+    if (hidden > 0) {
+      printf("Parse Error: %d repeated error(s) or error(s) past the first %d not shown\n", hidden, MINIMAL_MAX_PARSE_ERRORS);
+    }
+    if (error_count > 1) {
+      printf("%d parse errors in total\n", error_count);
+    }
+    if (status == VALID_CONSTRUCT) status = PARSE_ERROR;
   }
+  return status;
+}
+
+// <name>.pars for the .toke or .prep file input_file, unless output_file is already set
+static void default_parse_file(char *input_file, char *output_file) {
   size_t len = strlen(input_file);
   if (output_file[0] == '\0') {
     strcpy(output_file, input_file);
@@ -2486,6 +2772,410 @@ MiniStatus generate_ast(char *input_file, char *output_file, MiniHeadToken *head
     output_file[len - 2] = 'r';
     output_file[len - 1] = 's';
   }
+}
+
+// Reparseable constructs can only be nested a few levels deep (a statement in a subprogram)
+#define MAX_REPARSE_DEPTH 8
+
+typedef struct minimal_reparse_candidate {
+  MiniSyntaxTree *node;
+  MiniSyntaxTree *first_node; // First and last token node of the construct
+  MiniSyntaxTree *last_node;
+  MiniToken *first; // Their tokens in the token list, first is NULL if the edit replaces it
+  MiniToken *after; // Token following the construct in the token list
+  bool first_replaced;
+  bool found;
+} MiniReparseCandidate;
+
+static bool reparseable(MiniSyntaxTree *node) {
+  if (node->data_type != NON_TERMINAL) return false;
+  MiniNonTerm construct = node->data.non_terminal;
+  return construct == SUBPROGRAM || construct == MODULE_DECLARATION || construct == STATEMENT;
+}
+
+// Subprograms and module declarations are module items, so no reparseable construct is
+// around them. Statements don't nest either, they are only ever inside a subprogram
+static bool outermost_construct(MiniSyntaxTree *node) {
+  MiniNonTerm construct = node->data.non_terminal;
+  return construct == SUBPROGRAM || construct == MODULE_DECLARATION;
+}
+
+static bool ends_search(MiniSyntaxTree *node) {
+  return node->data.non_terminal == MAIN_PART || node->data.non_terminal == MODULE_PART;
+}
+
+// The innermost reparseable construct around node, found through the parent links, or NULL
+static MiniSyntaxTree *enclosing_construct(MiniSyntaxTree *node) {
+  if (reparseable(node) && outermost_construct(node)) return NULL;
+  for (node = node->parent; node != NULL && !ends_search(node); node = node->parent) {
+    if (reparseable(node)) return node;
+  }
+  return NULL;
+}
+
+// Whether the token node is inside construct. The walk up stops at the first construct that
+// can't be inside construct
+static bool encloses(MiniSyntaxTree *construct, MiniSyntaxTree *node) {
+  bool outermost = outermost_construct(construct);
+  for (node = node->parent; node != NULL && !ends_search(node); node = node->parent) {
+    if (node == construct) return true;
+    if (reparseable(node) && (outermost_construct(node) || !outermost)) return false;
+  }
+  return false;
+}
+
+// The reparseable construct that the token node is the first token of, or NULL. Only empty
+// nonterminals can come before it on the way down from the construct, so the walk up stops
+// at the first node that has a token or a nonempty nonterminal before it
+static MiniSyntaxTree *started_construct(MiniSyntaxTree *node) {
+  for (MiniSyntaxTree *parent = node->parent; parent != NULL && !ends_search(parent); node = parent, parent = parent->parent) {
+    for (MiniSyntaxTree *earlier = parent->child; earlier != node; earlier = earlier->sibling) {
+      if (earlier->data_type == TOKEN || earlier->child != NULL) return NULL;
+    }
+    if (reparseable(parent)) return parent;
+  }
+  return NULL;
+}
+
+// The first token node under construct in source order, or NULL if there is none
+static MiniSyntaxTree *first_token_node(MiniSyntaxTree *construct) {
+  MiniSyntaxTree *node = construct->child;
+  while (node != NULL) {
+    if (node->data_type == TOKEN) return node;
+    if (node->child != NULL) {
+      node = node->child;
+      continue;
+    }
+    while (node->sibling == NULL) {
+      node = node->parent;
+      if (node == construct) return NULL;
+    }
+    node = node->sibling;
+  }
+  return NULL;
+}
+
+// The last token node under construct, or NULL. Every reparseable construct ends with a
+// token of its own, so this only goes down the last child chain
+static MiniSyntaxTree *last_token_node(MiniSyntaxTree *construct) {
+  MiniSyntaxTree *node = construct;
+  while (node != NULL && node->data_type != TOKEN) {
+    MiniSyntaxTree *last = NULL;
+    for (MiniSyntaxTree *child = node->child; child != NULL; child = child->sibling) {
+      if (child->data_type == TOKEN || child->child != NULL) last = child;
+    }
+    node = last;
+  }
+  return node;
+}
+
+// Hands the strings of [first, after) back to the token list, for tokens whose nodes are
+// about to be freed with free_syntax_tree_nodes()
+static void release_tokens(MiniToken *first, MiniToken *after) {
+  for (MiniToken *token = first; token != after; token = token->next_token) {
+    token->in_tree = false;
+    token->node = NULL;
+  }
+}
+
+// Whether the parent of the construct node would still parse [first, after) as that kind of
+// construct and go on from after. sequence() and module_sequence() pick the construct from
+// its first tokens, which the edit may have changed, and then decide from after and the token
+// following it whether another statement or module item comes next or their end
+static bool fits_parent(MiniSyntaxTree *node, MiniToken *first, MiniToken *after) {
+  static const MiniTokenSet item_starts = TOKEN_BIT(IMPORT) | TOKEN_BIT(M_IMPORT) | TOKEN_BIT(C_IMPORT) | TOKEN_BIT(FUNC);
+  static const MiniTokenSet item_names = TOKEN_BIT(REDIRECT) | TOKEN_BIT(MINI_ID) | TOKEN_BIT(MINI_CONST_ID);
+  if (node->data.non_terminal == STATEMENT) {
+    static const MiniTokenSet follower_cats = CATEGORY_BIT(TERM_KW) | CATEGORY_BIT(BRANCH_KW) | CATEGORY_BIT(TYPE_KW) | CATEGORY_BIT(CONTROL_KW);
+    static const MiniTokenSet follower_names = TOKEN_BIT(MINI_ID) | TOKEN_BIT(MINI_EXT_ID) | TOKEN_BIT(C_ID);
+    return first->category != BRANCH_KW
+      && (match_terminal_cats(after, follower_cats, NULL) == SUCCESS || match_terminals(after, follower_names, NULL) == SUCCESS);
+  }
+  if (node->data.non_terminal == SUBPROGRAM) {
+    if (first->name != FUNC) return false;
+  } else if (match_terminals(first, item_starts, NULL) == SUCCESS
+    || match_terminals(peek_token(first), TOKEN_BIT(MINI_ID) | TOKEN_BIT(MINI_CONST_ID), NULL) != SUCCESS) {
+    return false;
+  }
+  return match_terminals(after, TOKEN_BIT(END_MODULE) | item_starts, NULL) == SUCCESS
+    || (after != NULL && match_terminals(peek_token(after), item_names, NULL) == SUCCESS);
+}
+
+// Parses [first, after) into node again. Fails if the tokens don't form a single construct
+// of the same kind that ends exactly at after, or if its parent wouldn't take it there (see
+// fits_parent()), in which case node is left without children
+static MiniStatus reparse_construct(MiniSyntaxTree *node, MiniToken *first, MiniToken *after) {
+  free_syntax_tree_nodes(node->child);
+  node->child = NULL;
+  release_tokens(first, after);
+  if (!fits_parent(node, first, after)) return PARSE_ERROR;
+
+  MiniParseErrorLog errors = {.message_count = 0, .error_count = 0};
+  MiniToken *after_token = NULL;
+  MiniStatus status;
+  collect_parse_errors(&errors);
+  if (node->data.non_terminal == SUBPROGRAM) {
+    status = subprogram(node, first, &after_token);
+  } else if (node->data.non_terminal == MODULE_DECLARATION) {
+    status = module_declaration(node, first, &after_token);
+  } else {
+    status = statement(node, first, &after_token);
+  }
+  collect_parse_errors(NULL);
+
+  if (status != VALID_CONSTRUCT || after_token != after) {
+    free_parse_error_log(&errors);
+    free_syntax_tree_nodes(node->child);
+    node->child = NULL;
+    release_tokens(first, after);
+    return PARSE_ERROR;
+  }
+  reset_parse_errors();
+  report_parse_errors(&errors);
+  return VALID_CONSTRUCT;
+}
+
+static MiniStatus reparse_all(MiniSyntaxTree *root, MiniHeadToken *head_token) {
+  free_syntax_tree_nodes(root->child);
+  root->child = NULL;
+  release_tokens(head_token->head, NULL);
+  reset_parse_errors();
+  return finish_parse_errors(parse_source(root, head_token->head, 0));
+}
+
+// Applies edit to the token list and the tree parsed from it. Only the edited lines are
+// lexed again and only the smallest subprogram, module declaration or statement around
+// them is parsed again, its siblings and everything else are kept as they are. If that
+// construct doesn't parse to the same kind of construct ending at the same token, one that
+// its parent would take there, the ones around it are tried, and as a last resort the whole source is parsed again. Parse errors
+// and the result only cover what was parsed again, errors reported earlier for the rest of
+// the source still stand. The token list must be complete (not streamed) and every token
+// in the tree must still have its node, so the tree can't be one that a parse gave up on
+MiniStatus reparse_edit(MiniSyntaxTree *root, MiniHeadToken *head_token, MiniTextEdit *edit, int verbose) {
+  MiniHeadToken new_tokens = {.token_count = 0, .head = NULL, .tail = NULL};
+  MiniStatus status = tokenize_text_lines(edit->lines, edit->added_lines, edit->first_line, &new_tokens);
+  if (status != SUCCESS) return status;
+
+  uint32_t end_line = edit->first_line + edit->removed_lines;
+  int64_t line_delta = (int64_t) edit->added_lines - edit->removed_lines;
+
+  // Tokens are in line order, so the replaced ones are a single run between before and after.
+  // Statements are only ever inside module items, so the constructs around the edit start
+  // at the latest module item and statement started before it, or among the replaced tokens
+  MiniToken *before = NULL;
+  MiniToken *after = head_token->head;
+  MiniToken *item_start = NULL;
+  MiniToken *statement_start = NULL;
+  while (after != NULL && after->line < edit->first_line) {
+    MiniSyntaxTree *started = (after->node == NULL) ? NULL : started_construct(after->node);
+    if (started != NULL && outermost_construct(started)) {
+      item_start = after;
+    } else if (started != NULL) {
+      statement_start = after;
+    }
+    before = after;
+    after = after->next_token;
+  }
+  MiniToken *replaced = after;
+  while (after != NULL && after->line < end_line) {
+    after = after->next_token;
+  }
+  // The damaged tokens are the replaced ones, or the ones around an insertion
+  MiniToken *damage_first = replaced;
+  MiniToken *damage_end = after;
+  if (replaced == after) {
+    damage_first = (before == NULL) ? after : before;
+    damage_end = (after == NULL) ? NULL : after->next_token;
+  }
+
+  // The candidates are the constructs around the first damaged token in the tree that are
+  // around every other damaged token as well, innermost first
+  MiniSyntaxTree *start = NULL;
+  for (MiniToken *token = damage_first; token != damage_end && start == NULL; token = token->next_token) {
+    start = token->node;
+  }
+  MiniReparseCandidate candidates[MAX_REPARSE_DEPTH];
+  int candidate_count = 0;
+  MiniSyntaxTree *construct = (start == NULL) ? NULL : enclosing_construct(start);
+  for (; construct != NULL && candidate_count < MAX_REPARSE_DEPTH; construct = enclosing_construct(construct)) {
+    bool inside = true;
+    for (MiniToken *token = damage_first; token != damage_end && inside; token = token->next_token) {
+      if (token->node != NULL) inside = encloses(construct, token->node);
+    }
+    MiniReparseCandidate candidate = {
+      .node = construct, .first_node = first_token_node(construct), .last_node = last_token_node(construct),
+      .first = NULL, .after = NULL, .first_replaced = false, .found = false
+    };
+    if (inside && candidate.first_node != NULL && candidate.last_node != NULL) {
+      if (statement_start != NULL && statement_start->node == candidate.first_node) {
+        candidate.first = statement_start;
+      } else if (item_start != NULL && item_start->node == candidate.first_node) {
+        candidate.first = item_start;
+      }
+      candidates[candidate_count++] = candidate;
+    }
+  }
+
+  // Their last tokens are found going on from the damage, up to the end of the outermost one.
+  // A first token that wasn't before the edit must be among the replaced tokens
+  int found_count = 0;
+  bool in_replaced = false;
+  for (MiniToken *token = damage_first; token != NULL && found_count < candidate_count; token = token->next_token) {
+    if (token == after) {
+      in_replaced = false;
+    } else if (token == replaced) {
+      in_replaced = true;
+    }
+    for (int i = 0; i < candidate_count; i++) {
+      MiniReparseCandidate *candidate = &candidates[i];
+      if (token->node == candidate->first_node && in_replaced) {
+        candidate->first_replaced = true;
+      }
+      if (token->node == candidate->last_node) {
+        // A construct that ends among the replaced tokens ends before some of the damage
+        candidate->found = !in_replaced || token->next_token == after;
+        candidate->after = token->next_token;
+        found_count++;
+      }
+    }
+  }
+  splice_tokens(head_token, before, after, &new_tokens);
+  // The tree's copies of the tokens after the edit move along with them
+  for (MiniToken *token = after; token != NULL; token = token->next_token) {
+    token->line = (uint32_t) (token->line + line_delta);
+    if (token->node != NULL) {
+      token->node->data.token.line = token->line;
+    }
+  }
+
+  MiniToken *edit_first = (before == NULL) ? head_token->head : before->next_token;
+  for (int i = 0; i < candidate_count; i++) {
+    MiniReparseCandidate *candidate = &candidates[i];
+    if (!candidate->found || (candidate->first == NULL && !candidate->first_replaced)) continue;
+    // A first token among the replaced ones is gone, the construct now starts after before
+    MiniToken *first = (candidate->first == NULL) ? edit_first : candidate->first;
+    if (first == NULL || first == candidate->after) continue;
+    if (reparse_construct(candidate->node, first, candidate->after) == VALID_CONSTRUCT) {
+      if (verbose) {
+        printf("Reparsed the construct starting on line %u\n", first->line + 1);
+      }
+      return finish_parse_errors(VALID_CONSTRUCT);
+    }
+  }
+
+  if (verbose) {
+    printf("Reparsed the whole source\n");
+  }
+  return reparse_all(root, head_token);
+}
+
+// Reads a preprocessed file into a buffer and points lines at its lines, without their
+// line breaks. Both are freed by the caller
+static char *read_text_lines(char *file, char ***lines, uint32_t *line_count, MiniStatus *status) {
+  FILE *input_ptr = fopen(file, "r");
+  if (input_ptr == NULL) {
+    printf("reparse_file: File Error: Preprocessed file %s couldn't be found!\n", file);
+    *status = FILE_NOT_FOUND;
+    return NULL;
+  }
+  fseek(input_ptr, 0, SEEK_END);
+  long size = ftell(input_ptr);
+  rewind(input_ptr);
+  char *buffer = malloc(size + 1);
+  if (buffer == NULL) {
+    printf("reparse_file: Memory Error: Failed to allocate space for preprocessed file contents\n");
+    fclose(input_ptr);
+    *status = ALLOCATION_FAIL;
+    return NULL;
+  }
+  size = fread(buffer, 1, size, input_ptr);
+  fclose(input_ptr);
+  buffer[size] = '\0';
+
+  uint32_t count = 0;
+  for (long i = 0; i < size; i++) {
+    if (buffer[i] == '\n' || i == size - 1) count++;
+  }
+  *lines = malloc((count + 1) * sizeof(char *));
+  if (*lines == NULL) {
+    printf("reparse_file: Memory Error: Failed to allocate memory for line array\n");
+    free(buffer);
+    *status = ALLOCATION_FAIL;
+    return NULL;
+  }
+  count = 0;
+  for (char *line = buffer; line < buffer + size; ) {
+    (*lines)[count++] = line;
+    char *newline = strchr(line, '\n');
+    if (newline == NULL) break;
+    *newline = '\0';
+    line = newline + 1;
+  }
+  *line_count = count;
+  *status = SUCCESS;
+  return buffer;
+}
+
+MiniStatus reparse_file(char *old_file, char *new_file, char *output_file, MiniHeadToken *head_token, MiniSyntaxTree *root, int verbose) {
+  if (verbose) {
+    printf("Beginning reparsing\n");
+  }
+  MiniStatus status;
+  char **old_lines;
+  char **new_lines;
+  uint32_t old_count;
+  uint32_t new_count;
+  char *old_text = read_text_lines(old_file, &old_lines, &old_count, &status);
+  if (status != SUCCESS) return status;
+  char *new_text = read_text_lines(new_file, &new_lines, &new_count, &status);
+  if (status != SUCCESS) {
+    free(old_lines);
+    free(old_text);
+    return status;
+  }
+
+  // The edit is everything between the lines the two files begin and end with
+  uint32_t prefix = 0;
+  while (prefix < old_count && prefix < new_count && strcmp(old_lines[prefix], new_lines[prefix]) == 0) {
+    prefix++;
+  }
+  uint32_t suffix = 0;
+  while (suffix < old_count - prefix && suffix < new_count - prefix && strcmp(old_lines[old_count - suffix - 1], new_lines[new_count - suffix - 1]) == 0) {
+    suffix++;
+  }
+  MiniTextEdit edit = {
+    .first_line = prefix, .removed_lines = old_count - prefix - suffix,
+    .lines = new_lines + prefix, .added_lines = new_count - prefix - suffix
+  };
+  if (verbose) {
+    printf("Replacing %u line(s) from line %u with %u line(s)\n", edit.removed_lines, edit.first_line + 1, edit.added_lines);
+  }
+  reset_parse_errors();
+  status = reparse_edit(root, head_token, &edit, verbose);
+  free(old_lines);
+  free(old_text);
+  free(new_lines);
+  free(new_text);
+
+  default_parse_file(new_file, output_file);
+  if (verbose) {
+    printf("Output file: %s\n", output_file);
+  }
+  FILE *output_ptr = fopen(output_file, "w");
+  fprintf(output_ptr, "// Indentation increase = child node to the one above\n// Indentation same = sibling node to the one above\n\n");
+  file_print_syntax_tree(output_ptr, root, 0);
+  fclose(output_ptr);
+  if (verbose) {
+    printf("Reparsing complete\n");
+  }
+  return status;
+}
+
+MiniStatus generate_ast(char *input_file, char *output_file, MiniHeadToken *head_token, MiniSyntaxTree *root, int table, int verbose) {
+  if (verbose) {
+    printf("Beginning parsing\n");
+  }
+  default_parse_file(input_file, output_file);
   if (verbose) {
     printf("Output file: %s\n", output_file);
   }
@@ -2498,9 +3188,16 @@ MiniStatus generate_ast(char *input_file, char *output_file, MiniHeadToken *head
     printf("AST generation from file not implemented yet\n");
     return PARSE_ERROR;
   }
-  MiniToken *current_token = head_token->head;
+  MiniToken *current_token = first_token(head_token);
 
-  MiniStatus status = source(root, current_token);
+  reset_parse_errors();
+  MiniStatus status;
+  if (table) {
+    status = table_parse(root, current_token);
+  } else {
+    status = parse_source(root, current_token, verbose);
+  }
+  status = finish_parse_errors(status);
   
   file_print_syntax_tree(output_ptr, root, 0);
   fclose(output_ptr);
@@ -0,0 +1,240 @@
+/* 
+  =======================================================================
+  This file is part of Minimal (mnml) - A *.mini source to C compiler for 
+  the Minimal programming language
+
+  Written in 2025 by approx-error
+
+  Minimal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Minimal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+  ======================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "inc/retcodes.h"
+#include "inc/tokens.h"
+#include "inc/ast.h"
+#include "inc/semantic.h"
+
+typedef struct minimal_reach {
+  // Items reached whose own references are still to be followed
+  MiniAstNode **pending;
+  size_t pending_count;
+  size_t pending_capacity;
+  // Indexed by type id: the alias of each custom type, and whether the type is used
+  MiniAstNode **aliases;
+  bool *used_types;
+  uint32_t type_capacity;
+  MiniStatus status;
+} MiniReach;
+
+static MiniStatus reserve_reach_types(MiniReach *reach, MiniTypeId id) {
+  if (id < reach->type_capacity) {
+    return SUCCESS;
+  }
+  uint32_t capacity = reach->type_capacity == 0 ? 64 : reach->type_capacity;
+  while (capacity <= id) {
+    capacity *= 2;
+  }
+  MiniAstNode **aliases = realloc(reach->aliases, capacity * sizeof(MiniAstNode *));
+  if (aliases == NULL) {
+    printf("reserve_reach_types: Memory Error: Failed to reallocate memory for type aliases\n");
+    return REALLOCATION_FAIL;
+  }
+  reach->aliases = aliases;
+  bool *used_types = realloc(reach->used_types, capacity * sizeof(bool));
+  if (used_types == NULL) {
+    printf("reserve_reach_types: Memory Error: Failed to reallocate memory for used types\n");
+    return REALLOCATION_FAIL;
+  }
+  reach->used_types = used_types;
+  memset(aliases + reach->type_capacity, 0, (capacity - reach->type_capacity) * sizeof(MiniAstNode *));
+  memset(used_types + reach->type_capacity, 0, (capacity - reach->type_capacity) * sizeof(bool));
+  reach->type_capacity = capacity;
+  return SUCCESS;
+}
+
+static void reach_item(MiniReach *reach, MiniAstNode *item) {
+  if (item->reachable || reach->status != SUCCESS) {
+    return;
+  }
+  item->reachable = true;
+  if (reach->pending_count == reach->pending_capacity) {
+    size_t capacity = reach->pending_capacity == 0 ? 64 : reach->pending_capacity * 2;
+    MiniAstNode **pending = realloc(reach->pending, capacity * sizeof(MiniAstNode *));
+    if (pending == NULL) {
+      printf("reach_item: Memory Error: Failed to reallocate memory for reachable items\n");
+      reach->status = REALLOCATION_FAIL;
+      return;
+    }
+    reach->pending = pending;
+    reach->pending_capacity = capacity;
+  }
+  reach->pending[reach->pending_count++] = item;
+}
+
+// Marks id used, along with its member types and the aliases it goes through
+static void reach_type(MiniReach *reach, MiniTypeId id) {
+  if (id == MINIMAL_NO_TYPE || reach->status != SUCCESS) {
+    return;
+  }
+  reach->status = reserve_reach_types(reach, id);
+  if (reach->status != SUCCESS || reach->used_types[id]) {
+    return;
+  }
+  reach->used_types[id] = true;
+  const MiniType *type = get_type(id);
+  for (uint32_t i = 0; i < type->member_count; i++) {
+    reach_type(reach, type->members[i]);
+  }
+  if (type->kind != CUSTOM_T) {
+    return;
+  }
+  // Aliases are declared for the custom type without pointers
+  MiniTypeId base;
+  reach->status = intern_pointer_type(id, 0, &base);
+  if (reach->status != SUCCESS) return;
+  reach->status = reserve_reach_types(reach, base);
+  if (reach->status != SUCCESS) return;
+  reach->used_types[base] = true;
+  MiniAstNode *alias = reach->aliases[base];
+  if (alias != NULL) {
+    reach_type(reach, alias->type_id);
+  }
+}
+
+static MiniVisitAction enter_reached_node(MiniAstNode *node, int depth, void *context) {
+  (void) depth;
+  MiniReach *reach = context;
+  switch (node->kind) {
+    case AST_SUBPROGRAM:
+    case AST_PARAMETER:
+    case AST_DECLARATION:
+      // Declared types are the only ones that still name aliases
+      node->reachable = true;
+      reach_type(reach, node->type_id);
+      break;
+    default:
+      break;
+  }
+  if (node->declaration != NULL) {
+    reach_item(reach, node->declaration);
+  }
+  return reach->status == SUCCESS ? VISIT_CONTINUE : VISIT_STOP;
+}
+
+static MiniAstNode *program_module(MiniAstNode *file) {
+  MiniAstNode *module = file->kind == AST_MAIN ? file->operands[0] : file;
+  return module != NULL && module->kind == AST_MODULE ? module : NULL;
+}
+
+// Subprograms, declarations and aliases of the modules compiled (rather than loaded from a
+// summary) that the main program can't reach
+static size_t count_dead_items(MiniAst *ast, FILE *file_ptr) {
+  size_t count = 0;
+  for (MiniAstNode *file = ast->root->list; file != NULL; file = file->next) {
+    MiniAstNode *module = program_module(file);
+    if (module == NULL || module->op == IMPORT) {
+      continue;
+    }
+    for (MiniAstNode *item = module->list; item != NULL; item = item->next) {
+      if (item->kind == AST_IMPORT || item->reachable) {
+        continue;
+      }
+      count++;
+      if (file_ptr == NULL) {
+        continue;
+      }
+      const char *kind = "type alias";
+      if (item->kind == AST_SUBPROGRAM) {
+        kind = "subprogram";
+      } else if (item->kind == AST_DECLARATION) {
+        kind = item->token.name == MINI_CONST_ID ? "constant" : "variable";
+      }
+      fprintf(file_ptr, "Dead %s %s in module %s (line %u)\n", kind, item->token.string_repr, module->token.string_repr, item->token.line + 1);
+    }
+  }
+  return count;
+}
+
+MiniStatus find_reachable_items(MiniAst *ast, size_t *dead_count) {
+  MiniReach reach;
+  memset(&reach, 0, sizeof(MiniReach));
+  reach.status = SUCCESS;
+  bool has_main = false;
+  for (MiniAstNode *file = ast->root->list; file != NULL && reach.status == SUCCESS; file = file->next) {
+    has_main = has_main || file->kind == AST_MAIN;
+    MiniAstNode *module = program_module(file);
+    for (MiniAstNode *item = module == NULL ? NULL : module->list; item != NULL; item = item->next) {
+      if (item->kind == AST_TYPE_ALIAS) {
+        reach.status = reserve_reach_types(&reach, item->token.type_id);
+        if (reach.status == SUCCESS && reach.aliases[item->token.type_id] == NULL) {
+          reach.aliases[item->token.type_id] = item;
+        }
+      }
+    }
+  }
+
+  // Without a main program the modules are a library, all of which may be used
+  MiniAstVisitor visitor = {enter_reached_node, NULL, &reach};
+  for (MiniAstNode *file = ast->root->list; file != NULL && reach.status == SUCCESS; file = file->next) {
+    MiniAstNode *module = program_module(file);
+    if (!has_main) {
+      for (MiniAstNode *item = module == NULL ? NULL : module->list; item != NULL; item = item->next) {
+        item->reachable = true;
+      }
+    } else if (file->kind == AST_MAIN) {
+      for (MiniAstNode *statement = file->list; statement != NULL && reach.status == SUCCESS; statement = statement->next) {
+        MiniStatus status = walk_ast(statement, &visitor);
+        reach.status = reach.status == SUCCESS ? status : reach.status;
+      }
+    }
+  }
+  // Each item is walked once, when it is first reached
+  while (reach.pending_count > 0 && reach.status == SUCCESS) {
+    MiniAstNode *item = reach.pending[--reach.pending_count];
+    MiniStatus status = walk_ast(item, &visitor);
+    reach.status = reach.status == SUCCESS ? status : reach.status;
+  }
+
+  if (has_main && reach.status == SUCCESS) {
+    for (MiniAstNode *file = ast->root->list; file != NULL; file = file->next) {
+      MiniAstNode *module = program_module(file);
+      for (MiniAstNode *item = module == NULL ? NULL : module->list; item != NULL; item = item->next) {
+        if (item->kind == AST_TYPE_ALIAS) {
+          item->reachable = item->token.type_id < reach.type_capacity && reach.used_types[item->token.type_id];
+        } else if (item->kind == AST_IMPORT) {
+          item->reachable = true;
+        }
+      }
+    }
+  }
+  free(reach.pending);
+  free(reach.aliases);
+  free(reach.used_types);
+  if (reach.status != SUCCESS) {
+    return reach.status;
+  }
+  *dead_count = count_dead_items(ast, NULL);
+  return SUCCESS;
+}
+
+void report_dead_items(MiniAst *ast) {
+  size_t count = count_dead_items(ast, stdout);
+  printf("%zu dead module item(s)\n", count);
+}
@@ -20,10 +20,796 @@
   ======================================================================
 */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "inc/retcodes.h"
+#include "inc/tokens.h"
+#include "inc/ast.h"
+#include "inc/semantic.h"
+#include "inc/summary.h"
+
 // To analyze:
-// variable type matches value
-// list type matches value(s)
-// dict type matches value(s)
 // dict no repeat keys
-// no redeclaration
 //
+
+#define NO_BINDING UINT32_MAX
+
+// A declaration visible from where the walk is. Bindings form a stack in the order they
+// were made, innermost[symbol] is the index of the most recent binding of a symbol and
+// shadowed the index of the binding it hides. Leaving a scope pops the bindings made since
+// the scope's mark and restores what they hid, so a scope costs as much as the names
+// declared in it and looking a name up is a single array access
+typedef struct minimal_binding {
+  MiniAstNode *declaration;
+  uint32_t depth; // Number of scopes that were open when the binding was made
+  uint32_t shadowed;
+} MiniBinding;
+
+typedef struct minimal_scopes {
+  uint32_t *innermost; // Indexed by symbol id
+  MiniBinding *bindings;
+  uint32_t binding_count;
+  uint32_t binding_capacity;
+  uint32_t *marks; // binding_count when each open scope was entered
+  uint32_t depth;
+  uint32_t mark_capacity;
+  int item_depth; // Walk depth of the items of the module being walked, -1 outside of modules
+  bool module_items; // Walking the module items, which leaves the subprogram bodies out
+  MiniAstNode **modules; // Indexed by symbol id. Only read once collected, by every thread
+  size_t resolved_count;
+  size_t scope_count;
+  MiniStatus status;
+} MiniScopes;
+
+static _Thread_local int error_count = 0;
+static _Thread_local MiniSemanticErrorLog *error_log = NULL;
+
+// Nodes that don't keep a token (returns, collections, operations...) are on the line of
+// the first token below them
+static uint32_t node_line(MiniAstNode *node) {
+  while (node->token.string_repr == NULL) {
+    MiniAstNode *first = node->operands[0] != NULL ? node->operands[0] : node->list;
+    if (first == NULL) break;
+    node = first;
+  }
+  return node->token.line;
+}
+
+static void log_error(MiniSemanticErrorLog *log, uint32_t line, bool once, const char *message) {
+  if (log->error_count == log->capacity) {
+    size_t capacity = log->capacity == 0 ? 8 : log->capacity * 2;
+    MiniSemanticError *errors = realloc(log->errors, capacity * sizeof(MiniSemanticError));
+    if (errors == NULL) {
+      log->lost_count++;
+      return;
+    }
+    log->errors = errors;
+    log->capacity = capacity;
+  }
+  char *copy = strdup(message);
+  // Without memory for the text the error is still counted
+  if (copy == NULL) {
+    log->lost_count++;
+    return;
+  }
+  log->errors[log->error_count++] = (MiniSemanticError){line, once, copy};
+}
+
+static void add_error(MiniAstNode *node, bool once, const char *format, va_list args) {
+  char message[512];
+  vsnprintf(message, sizeof(message), format, args);
+  if (error_log != NULL) {
+    log_error(error_log, node_line(node), once, message);
+    return;
+  }
+  printf("Semantic Error: Line %u: %s\n", node_line(node) + 1, message);
+  error_count++;
+}
+
+void semantic_error(MiniAstNode *node, const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  add_error(node, false, format, args);
+  va_end(args);
+}
+
+// Repeats are only left out when the errors are collected
+void semantic_error_once(MiniAstNode *node, const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  add_error(node, true, format, args);
+  va_end(args);
+}
+
+void semantic_warning(MiniAstNode *node, const char *format, ...) {
+  char message[512];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(message, sizeof(message), format, args);
+  va_end(args);
+  printf("Semantic Warning: Line %u: %s\n", node_line(node) + 1, message);
+}
+
+void collect_semantic_errors(MiniSemanticErrorLog *log) {
+  error_log = log;
+}
+
+typedef struct minimal_error_order {
+  uint32_t line;
+  size_t order; // Position among the errors of all the logs, which breaks ties
+  MiniSemanticError *error;
+} MiniErrorOrder;
+
+static int compare_errors(const void *first, const void *second) {
+  const MiniErrorOrder *a = first;
+  const MiniErrorOrder *b = second;
+  if (a->line != b->line) {
+    return a->line < b->line ? -1 : 1;
+  }
+  return a->order < b->order ? -1 : a->order > b->order;
+}
+
+static bool reported_before(MiniErrorOrder *sorted, size_t index) {
+  for (size_t i = 0; i < index; i++) {
+    if (sorted[i].error->once && strcmp(sorted[i].error->message, sorted[index].error->message) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+MiniStatus report_semantic_errors(MiniSemanticErrorLog *logs, size_t log_count) {
+  size_t total = 0;
+  for (size_t i = 0; i < log_count; i++) {
+    total += logs[i].error_count;
+    error_count += logs[i].lost_count;
+  }
+  MiniStatus status = SUCCESS;
+  MiniErrorOrder *sorted = malloc((total == 0 ? 1 : total) * sizeof(MiniErrorOrder));
+  if (sorted == NULL) {
+    printf("report_semantic_errors: Memory Error: Failed to allocate memory for sorting errors\n");
+    error_count += total;
+    status = ALLOCATION_FAIL;
+  } else {
+    size_t order = 0;
+    for (size_t i = 0; i < log_count; i++) {
+      for (size_t j = 0; j < logs[i].error_count; j++, order++) {
+        sorted[order] = (MiniErrorOrder){logs[i].errors[j].line, order, &logs[i].errors[j]};
+      }
+    }
+    qsort(sorted, total, sizeof(MiniErrorOrder), compare_errors);
+    for (size_t i = 0; i < total; i++) {
+      if (sorted[i].error->once && reported_before(sorted, i)) {
+        continue;
+      }
+      printf("Semantic Error: Line %u: %s\n", sorted[i].line + 1, sorted[i].error->message);
+      error_count++;
+    }
+    free(sorted);
+  }
+  for (size_t i = 0; i < log_count; i++) {
+    free_semantic_error_log(&logs[i]);
+  }
+  return status;
+}
+
+void free_semantic_error_log(MiniSemanticErrorLog *log) {
+  for (size_t i = 0; i < log->error_count; i++) {
+    free(log->errors[i].message);
+  }
+  free(log->errors);
+  log->errors = NULL;
+  log->error_count = 0;
+  log->capacity = 0;
+  log->lost_count = 0;
+}
+
+int semantic_error_count(void) {
+  return error_count;
+}
+
+void reset_semantic_errors(void) {
+  error_count = 0;
+}
+
+// Names from M:: and C:: imports are declared in files the compiler doesn't read
+static bool is_external(MiniAstNode *node) {
+  return node->token.name == MINI_EXT_ID || node->token.name == C_ID;
+}
+
+static MiniStatus open_scope(MiniScopes *scopes) {
+  if (scopes->depth == scopes->mark_capacity) {
+    uint32_t capacity = scopes->mark_capacity == 0 ? 32 : scopes->mark_capacity * 2;
+    uint32_t *marks = realloc(scopes->marks, capacity * sizeof(uint32_t));
+    if (marks == NULL) {
+      printf("open_scope: Memory Error: Failed to reallocate memory for scope marks\n");
+      return REALLOCATION_FAIL;
+    }
+    scopes->marks = marks;
+    scopes->mark_capacity = capacity;
+  }
+  scopes->marks[scopes->depth++] = scopes->binding_count;
+  scopes->scope_count++;
+  return SUCCESS;
+}
+
+static void close_scope(MiniScopes *scopes) {
+  uint32_t mark = scopes->marks[--scopes->depth];
+  while (scopes->binding_count > mark) {
+    MiniBinding *binding = &scopes->bindings[--scopes->binding_count];
+    scopes->innermost[binding->declaration->symbol] = binding->shadowed;
+  }
+}
+
+// Makes declaration visible in the innermost scope. If check is set, a declaration of the
+// same name in that scope is an error and the new one is left out
+static MiniStatus bind(MiniScopes *scopes, MiniAstNode *declaration, bool check) {
+  if (declaration->symbol == MINIMAL_NO_SYMBOL || is_external(declaration)) {
+    return SUCCESS;
+  }
+  uint32_t shadowed = scopes->innermost[declaration->symbol];
+  if (check && shadowed != NO_BINDING && scopes->bindings[shadowed].depth == scopes->depth) {
+    semantic_error(declaration, "%s is already declared on line %u in the same scope",
+                   declaration->token.string_repr, scopes->bindings[shadowed].declaration->token.line + 1);
+    return SUCCESS;
+  }
+  if (scopes->binding_count == scopes->binding_capacity) {
+    uint32_t capacity = scopes->binding_capacity == 0 ? 256 : scopes->binding_capacity * 2;
+    MiniBinding *bindings = realloc(scopes->bindings, capacity * sizeof(MiniBinding));
+    if (bindings == NULL) {
+      printf("bind: Memory Error: Failed to reallocate memory for bindings\n");
+      return REALLOCATION_FAIL;
+    }
+    scopes->bindings = bindings;
+    scopes->binding_capacity = capacity;
+  }
+  scopes->bindings[scopes->binding_count] = (MiniBinding){declaration, scopes->depth, shadowed};
+  scopes->innermost[declaration->symbol] = scopes->binding_count++;
+  return SUCCESS;
+}
+
+// Module level declarations and subprograms, which are visible in the whole module
+// regardless of their order
+static MiniStatus bind_module_items(MiniScopes *scopes, MiniAstNode *module, bool check) {
+  for (MiniAstNode *item = module->list; item != NULL; item = item->next) {
+    if (item->kind == AST_DECLARATION || item->kind == AST_SUBPROGRAM) {
+      MiniStatus status = bind(scopes, item, check);
+      if (status != SUCCESS) return status;
+    }
+  }
+  return SUCCESS;
+}
+
+// The items of the modules imported with :: make up the outer scope of a module and its own
+// items the scope inside it, so they hide imported names. Imports aren't transitive. If two
+// imported modules have an item of the same name, the later import hides the earlier one.
+// Errors are only reported if check is set, the body tasks enter modules checked already
+static MiniStatus enter_module(MiniScopes *scopes, MiniAstNode *module, bool check) {
+  MiniStatus status = open_scope(scopes);
+  if (status != SUCCESS) return status;
+  for (MiniAstNode *item = module->list; item != NULL; item = item->next) {
+    if (item->kind != AST_IMPORT || item->op != IMPORT) {
+      continue;
+    }
+    MiniAstNode *imported = item->symbol == MINIMAL_NO_SYMBOL ? NULL : scopes->modules[item->symbol];
+    if (imported == NULL && check) {
+      semantic_error(item, "Imported module %s is not defined", item->token.string_repr);
+    } else if (imported != NULL && imported != module) {
+      status = bind_module_items(scopes, imported, false);
+      if (status != SUCCESS) return status;
+    }
+  }
+  status = open_scope(scopes);
+  if (status != SUCCESS) return status;
+  return bind_module_items(scopes, module, check);
+}
+
+static MiniAstNode *resolve(MiniScopes *scopes, MiniAstNode *node) {
+  if (node->symbol == MINIMAL_NO_SYMBOL || is_external(node)) {
+    return NULL;
+  }
+  uint32_t binding = scopes->innermost[node->symbol];
+  if (binding == NO_BINDING) {
+    semantic_error(node, "%s is not declared", node->token.string_repr);
+    return NULL;
+  }
+  node->declaration = scopes->bindings[binding].declaration;
+  scopes->resolved_count++;
+  return node->declaration;
+}
+
+static MiniVisitAction enter_node(MiniAstNode *node, int depth, void *context) {
+  MiniScopes *scopes = context;
+  MiniAstNode *declaration;
+  MiniStatus status = SUCCESS;
+  switch (node->kind) {
+    case AST_MODULE:
+      scopes->item_depth = depth + 1;
+      status = enter_module(scopes, node, true);
+      break;
+    case AST_SUBPROGRAM:
+      if (scopes->module_items) {
+        return VISIT_SKIP;
+      }
+      status = open_scope(scopes);
+      break;
+    case AST_BLOCK:
+    case AST_ELSE:
+    case AST_CASE:
+    case AST_FOR:
+    case AST_WHILE:
+      // A case label is outside of the case's own scope
+      if (node->kind == AST_CASE && node->token.category == IDENTIFIER) {
+        declaration = resolve(scopes, node);
+        if (declaration != NULL && declaration->kind == AST_SUBPROGRAM) {
+          semantic_error(node, "Subprogram %s is used as a value", node->token.string_repr);
+        }
+      }
+      status = open_scope(scopes);
+      break;
+    case AST_NAME:
+      declaration = resolve(scopes, node);
+      if (declaration != NULL && declaration->kind == AST_SUBPROGRAM) {
+        semantic_error(node, "Subprogram %s is used as a value", node->token.string_repr);
+      }
+      break;
+    case AST_ASSIGNMENT:
+    case AST_INCREMENT:
+      declaration = resolve(scopes, node);
+      if (declaration != NULL && declaration->kind == AST_SUBPROGRAM) {
+        semantic_error(node, "Subprogram %s is assigned to", node->token.string_repr);
+      } else if (declaration != NULL && declaration->token.name == MINI_CONST_ID) {
+        semantic_error(node, "Constant %s is assigned to", node->token.string_repr);
+      }
+      break;
+    case AST_CALL:
+      declaration = resolve(scopes, node);
+      if (declaration != NULL && declaration->kind != AST_SUBPROGRAM) {
+        semantic_error(node, "%s is called but is not a subprogram", node->token.string_repr);
+      }
+      break;
+    default:
+      break;
+  }
+  if (status != SUCCESS) {
+    scopes->status = status;
+    return VISIT_STOP;
+  }
+  return VISIT_CONTINUE;
+}
+
+static MiniVisitAction leave_node(MiniAstNode *node, int depth, void *context) {
+  MiniScopes *scopes = context;
+  MiniStatus status = SUCCESS;
+  switch (node->kind) {
+    case AST_MODULE:
+      scopes->item_depth = -1;
+      close_scope(scopes);
+      close_scope(scopes);
+      break;
+    case AST_SUBPROGRAM:
+      if (!scopes->module_items) {
+        close_scope(scopes);
+      }
+      break;
+    case AST_BLOCK:
+    case AST_ELSE:
+    case AST_CASE:
+    case AST_FOR:
+    case AST_WHILE:
+      close_scope(scopes);
+      break;
+    case AST_DECLARATION:
+      // A local declaration is only visible after itself, so its initial value can't refer
+      // to it. Module items have been bound on entering the module
+      if (depth != scopes->item_depth) {
+        status = bind(scopes, node, true);
+      }
+      break;
+    case AST_PARAMETER:
+      status = bind(scopes, node, true);
+      break;
+    default:
+      break;
+  }
+  if (status != SUCCESS) {
+    scopes->status = status;
+    return VISIT_STOP;
+  }
+  return VISIT_CONTINUE;
+}
+
+// The module of a top level node of the program: a module file or the main file's module
+static MiniAstNode *file_module(MiniAstNode *file) {
+  MiniAstNode *module = file->kind == AST_MAIN ? file->operands[0] : file;
+  return module != NULL && module->kind == AST_MODULE ? module : NULL;
+}
+
+// Finds the AST_MODULE of every module name, so that imports can refer to modules defined
+// later or in other files
+static void collect_modules(MiniScopes *scopes, MiniAst *ast) {
+  for (MiniAstNode *file = ast->root->list; file != NULL; file = file->next) {
+    MiniAstNode *module = file_module(file);
+    if (module == NULL || module->symbol == MINIMAL_NO_SYMBOL) {
+      continue;
+    }
+    MiniAstNode *previous = scopes->modules[module->symbol];
+    if (previous != NULL) {
+      semantic_error(module, "Module %s is already defined on line %u", module->token.string_repr, previous->token.line + 1);
+      continue;
+    }
+    scopes->modules[module->symbol] = module;
+  }
+}
+
+static MiniStatus init_scopes(MiniScopes *scopes, size_t table_size, MiniAstNode **modules) {
+  memset(scopes, 0, sizeof(MiniScopes));
+  scopes->innermost = malloc(table_size * sizeof(uint32_t));
+  if (scopes->innermost == NULL) {
+    printf("analyse_semantics: Memory Error: Failed to allocate memory for symbol tables\n");
+    return ALLOCATION_FAIL;
+  }
+  memset(scopes->innermost, 0xFF, table_size * sizeof(uint32_t)); // NO_BINDING everywhere
+  scopes->item_depth = -1;
+  scopes->modules = modules;
+  scopes->status = SUCCESS;
+  return SUCCESS;
+}
+
+static void free_scopes(MiniScopes *scopes) {
+  free(scopes->innermost);
+  free(scopes->bindings);
+  free(scopes->marks);
+}
+
+#define MAX_SEMANTIC_THREADS 16
+
+// The body of a subprogram or of the main program. A body only sees the module items and
+// its own declarations, so once the items have been analysed every body can be analysed
+// on its own
+typedef struct minimal_body_task {
+  MiniAstNode *body; // AST_SUBPROGRAM or AST_MAIN
+  MiniAstNode *module; // Module the body is in, NULL for a main program without one
+  MiniSemanticErrorLog *errors;
+  MiniStatus status;
+} MiniBodyTask;
+
+// Workers take the next task from a shared counter until there are none left, so a thread
+// that gets small bodies takes more of them. Tasks are in source order and a worker takes
+// them in increasing order, so it enters each module once and keeps its items bound in the
+// outer scopes for the bodies after
+typedef struct minimal_body_worker {
+  MiniBodyTask *tasks;
+  size_t task_count;
+  size_t *next_task;
+  const MiniTypeCheck *types;
+  MiniScopes scopes;
+  MiniAstNode *module; // Module whose items are bound
+  bool entered;
+  size_t typed_count;
+  size_t folded_count;
+} MiniBodyWorker;
+
+// Fills tasks (if not NULL) with the bodies of ast in source order and returns how many there are
+static size_t find_body_tasks(MiniAst *ast, MiniBodyTask *tasks, MiniSemanticErrorLog *logs) {
+  size_t count = 0;
+  for (MiniAstNode *file = ast->root->list; file != NULL; file = file->next) {
+    MiniAstNode *module = file_module(file);
+    for (MiniAstNode *item = module == NULL ? NULL : module->list; item != NULL; item = item->next) {
+      if (item->kind != AST_SUBPROGRAM) continue;
+      if (tasks != NULL) {
+        tasks[count] = (MiniBodyTask){item, module, &logs[count], SUCCESS};
+      }
+      count++;
+    }
+    if (file->kind == AST_MAIN) {
+      if (tasks != NULL) {
+        tasks[count] = (MiniBodyTask){file, module, &logs[count], SUCCESS};
+      }
+      count++;
+    }
+  }
+  return count;
+}
+
+static MiniStatus check_body(MiniBodyWorker *worker, MiniBodyTask *task) {
+  MiniScopes *scopes = &worker->scopes;
+  MiniStatus status;
+  if (!worker->entered || worker->module != task->module) {
+    while (scopes->depth > 0) {
+      close_scope(scopes);
+    }
+    // The module scopes were counted when the module items were analysed
+    size_t scope_count = scopes->scope_count;
+    if (task->module != NULL) {
+      status = enter_module(scopes, task->module, false);
+      if (status != SUCCESS) return status;
+    }
+    scopes->scope_count = scope_count;
+    worker->module = task->module;
+    worker->entered = true;
+  }
+
+  scopes->status = SUCCESS;
+  MiniAstVisitor visitor = {enter_node, leave_node, scopes};
+  if (task->body->kind == AST_SUBPROGRAM) {
+    status = walk_ast(task->body, &visitor);
+  } else {
+    status = open_scope(scopes);
+    for (MiniAstNode *statement = task->body->list; statement != NULL && status == SUCCESS; statement = statement->next) {
+      status = walk_ast(statement, &visitor);
+      if (status == SUCCESS) {
+        status = scopes->status;
+      }
+    }
+    if (status == SUCCESS) {
+      close_scope(scopes);
+    }
+  }
+  if (status == SUCCESS) {
+    status = scopes->status;
+  }
+  if (status != SUCCESS) return status;
+  status = check_body_types(worker->types, task->body, &worker->typed_count);
+  if (status != SUCCESS) return status;
+  return fold_body_constants(task->body, &worker->folded_count);
+}
+
+// Every worker claims the next body from one shared counter. This stands in for per-worker
+// deques with stealing on purpose: a body is the smallest unit there is, so claiming them
+// one at a time already balances the load, and one relaxed add per body costs nothing next
+// to checking it
+static void *check_bodies(void *worker_ptr) {
+  MiniBodyWorker *worker = worker_ptr;
+  size_t i;
+  while ((i = __atomic_fetch_add(worker->next_task, 1, __ATOMIC_RELAXED)) < worker->task_count) {
+    MiniBodyTask *task = &worker->tasks[i];
+    collect_semantic_errors(task->errors);
+    task->status = check_body(worker, task);
+    collect_semantic_errors(NULL);
+  }
+  return NULL;
+}
+
+// Runs the tasks on up to one thread per processor, or on the calling thread if there is
+// only one to run them on. The counts of all the workers are added to the ones given
+static MiniStatus check_bodies_parallel(MiniBodyTask *tasks, size_t task_count, MiniAstNode **modules, size_t table_size, const MiniTypeCheck *types,
+                                        size_t *resolved_count, size_t *scope_count, size_t *typed_count, size_t *folded_count) {
+  long thread_count = sysconf(_SC_NPROCESSORS_ONLN);
+  if (thread_count < 1) {
+    thread_count = 1;
+  }
+  if (thread_count > MAX_SEMANTIC_THREADS) {
+    thread_count = MAX_SEMANTIC_THREADS;
+  }
+  if ((size_t) thread_count > task_count) {
+    thread_count = (long) task_count;
+  }
+
+  size_t next_task = 0;
+  MiniBodyWorker workers[MAX_SEMANTIC_THREADS];
+  pthread_t threads[MAX_SEMANTIC_THREADS];
+  bool thread_started[MAX_SEMANTIC_THREADS];
+  MiniStatus status = SUCCESS;
+  long worker_count = 0;
+  for (; worker_count < thread_count; worker_count++) {
+    MiniBodyWorker *worker = &workers[worker_count];
+    memset(worker, 0, sizeof(MiniBodyWorker));
+    status = init_scopes(&worker->scopes, table_size, modules);
+    if (status != SUCCESS) {
+      free_scopes(&worker->scopes);
+      break;
+    }
+    worker->tasks = tasks;
+    worker->task_count = task_count;
+    worker->next_task = &next_task;
+    worker->types = types;
+  }
+  if (status == SUCCESS) {
+    for (long i = 0; i < worker_count; i++) {
+      thread_started[i] = worker_count > 1 && pthread_create(&threads[i], NULL, check_bodies, &workers[i]) == 0;
+    }
+    // Whatever isn't taken by the threads that started is done here
+    for (long i = 0; i < worker_count; i++) {
+      if (!thread_started[i]) {
+        check_bodies(&workers[i]);
+      }
+    }
+    for (long i = 0; i < worker_count; i++) {
+      if (thread_started[i]) {
+        pthread_join(threads[i], NULL);
+      }
+    }
+  }
+  for (long i = 0; i < worker_count; i++) {
+    *resolved_count += workers[i].scopes.resolved_count;
+    *scope_count += workers[i].scopes.scope_count;
+    *typed_count += workers[i].typed_count;
+    *folded_count += workers[i].folded_count;
+    free_scopes(&workers[i].scopes);
+  }
+  for (size_t i = 0; i < task_count && status == SUCCESS; i++) {
+    status = tasks[i].status;
+  }
+  return status;
+}
+
+static MiniStatus write_semantics(char *output_file, MiniAst *ast, int verbose) {
+  if (verbose) {
+    printf("Output file: %s\n", output_file);
+  }
+  FILE *output_ptr = fopen(output_file, "w");
+  if (output_ptr == NULL) {
+    printf("analyse_semantics: Error: Failed to open %s\n", output_file);
+    return FILE_NOT_FOUND;
+  }
+  fprintf(output_ptr, "// Indentation increase = operand or list item of the node above\n");
+  fprintf(output_ptr, "// Resolved names are followed by the line they are declared on\n\n");
+  file_print_ast(output_ptr, ast->root, 0);
+  fclose(output_ptr);
+  return SUCCESS;
+}
+
+MiniStatus analyse_semantics(char *input_file, char *output_file, MiniAst *ast, int write_file, int verbose) {
+  if (verbose) {
+    printf("Beginning semantic analysis\n");
+  }
+  if (output_file[0] == '\0') {
+    strcpy(output_file, input_file);
+    char *extension = strrchr(output_file, '.');
+    if (extension != NULL) {
+      strcpy(extension, ".sema");
+    }
+  }
+  // Module summaries are read from and written to the directory of the output file
+  char *separator = strrchr(output_file, '/');
+  size_t directory_length = separator == NULL ? 1 : (size_t) (separator - output_file);
+  char directory[directory_length + 1];
+  if (separator == NULL) {
+    strcpy(directory, ".");
+  } else {
+    memcpy(directory, output_file, directory_length);
+    directory[directory_length] = '\0';
+  }
+  // Loading comes first because it interns the names of the loaded modules
+  MiniStatus status = load_module_summaries(ast, directory, verbose);
+  if (status != SUCCESS) {
+    return status;
+  }
+
+  size_t table_size = (size_t) symbol_count() + 1;
+  MiniAstNode **modules = calloc(table_size, sizeof(MiniAstNode *));
+  if (modules == NULL) {
+    printf("analyse_semantics: Memory Error: Failed to allocate memory for symbol tables\n");
+    return ALLOCATION_FAIL;
+  }
+  MiniScopes scopes;
+  status = init_scopes(&scopes, table_size, modules);
+  scopes.module_items = true;
+  reset_semantic_errors();
+
+  // The first pass goes through the module items and leaves the bodies for later. Types are
+  // checked even if some names couldn't be resolved. Those names have no type, which every
+  // check lets through, so their errors aren't repeated
+  MiniSemanticErrorLog item_errors = {.errors = NULL, .error_count = 0, .capacity = 0, .lost_count = 0};
+  collect_semantic_errors(&item_errors);
+  collect_modules(&scopes, ast);
+  for (MiniAstNode *file = ast->root->list; file != NULL && status == SUCCESS; file = file->next) {
+    MiniAstNode *module = file_module(file);
+    if (module != NULL) {
+      MiniAstVisitor visitor = {enter_node, leave_node, &scopes};
+      status = walk_ast(module, &visitor);
+      if (status == SUCCESS) {
+        status = scopes.status;
+      }
+    }
+  }
+  MiniTypeCheck *types = NULL;
+  if (status == SUCCESS) {
+    status = prepare_type_check(ast, &types);
+  }
+  size_t typed_count = 0;
+  for (MiniAstNode *file = ast->root->list; file != NULL && status == SUCCESS; file = file->next) {
+    MiniAstNode *module = file_module(file);
+    if (module != NULL) {
+      status = check_module_types(types, module, &typed_count);
+    }
+  }
+  // Constants of one module may be worked out while folding another that imports them
+  size_t folded_count = 0;
+  for (MiniAstNode *file = ast->root->list; file != NULL && status == SUCCESS; file = file->next) {
+    MiniAstNode *module = file_module(file);
+    if (module != NULL) {
+      status = fold_module_constants(module, &folded_count);
+    }
+  }
+  collect_semantic_errors(NULL);
+  size_t resolved_count = scopes.resolved_count;
+  size_t scope_count = scopes.scope_count;
+  free_scopes(&scopes);
+
+  // The second pass analyses the bodies, each with its own error log. The logs are merged
+  // by line afterwards, so the errors come out in the same order however the bodies ran
+  size_t task_count = status == SUCCESS ? find_body_tasks(ast, NULL, NULL) : 0;
+  MiniBodyTask *tasks = malloc((task_count + 1) * sizeof(MiniBodyTask));
+  MiniSemanticErrorLog *logs = calloc(task_count + 1, sizeof(MiniSemanticErrorLog));
+  if (status == SUCCESS && (tasks == NULL || logs == NULL)) {
+    printf("analyse_semantics: Memory Error: Failed to allocate memory for body tasks\n");
+    status = ALLOCATION_FAIL;
+  }
+  if (status == SUCCESS) {
+    find_body_tasks(ast, tasks, logs + 1);
+    status = check_bodies_parallel(tasks, task_count, modules, table_size, types, &resolved_count, &scope_count, &typed_count, &folded_count);
+  }
+  if (logs != NULL) {
+    logs[0] = item_errors;
+    MiniStatus report_status = report_semantic_errors(logs, task_count + 1);
+    status = status == SUCCESS ? report_status : status;
+  } else {
+    free_semantic_error_log(&item_errors);
+  }
+  free(logs);
+  free(tasks);
+  if (types != NULL) {
+    free_type_check(types);
+  }
+  free(modules);
+  if (status != SUCCESS) {
+    return status;
+  }
+  if (verbose) {
+    printf("Resolved %zu names in %zu scopes\n", resolved_count, scope_count);
+    printf("Typed %zu expressions\n", typed_count);
+    printf("Folded %zu constant expressions\n", folded_count);
+    printf("Analysed %zu bodies\n", task_count);
+  }
+
+  int total = semantic_error_count();
+  if (total > 0) {
+    if (total > 1) {
+      printf("%d semantic errors in total\n", total);
+    }
+    return SEMANTIC_ERROR;
+  }
+
+  size_t dead_count = 0;
+  status = find_reachable_items(ast, &dead_count);
+  if (status != SUCCESS) return status;
+  size_t pure_count = 0;
+  status = find_subprogram_effects(ast, &pure_count);
+  if (status != SUCCESS) return status;
+  size_t evaluated_count = 0;
+  if (pure_count > 0) {
+    status = evaluate_constant_calls(ast, &evaluated_count);
+    if (status != SUCCESS) return status;
+  }
+  size_t static_count = 0;
+  size_t switch_count = 0;
+  status = lay_out_static_data(ast, &static_count, &switch_count);
+  if (status != SUCCESS) return status;
+  if (verbose) {
+    printf("Found %zu dead module items\n", dead_count);
+    printf("Found %zu pure subprograms\n", pure_count);
+    printf("Evaluated %zu calls at compile time\n", evaluated_count);
+    printf("Laid out %zu constant collections as static data\n", static_count);
+    printf("Lowered %zu switches to tables\n", switch_count);
+  }
+
+  if (write_file) {
+    status = write_semantics(output_file, ast, verbose);
+    if (status != SUCCESS) return status;
+    status = write_module_summaries(ast, directory, verbose);
+    if (status != SUCCESS) return status;
+  }
+  if (verbose) {
+    printf("Semantic analysis complete\n");
+  }
+  return SUCCESS;
+}
@@ -0,0 +1,479 @@
+/* 
+  =======================================================================
+  This file is part of Minimal (mnml) - A *.mini source to C compiler for 
+  the Minimal programming language
+
+  Written in 2025 by approx-error
+
+  Minimal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Minimal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+  ======================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "inc/retcodes.h"
+#include "inc/tokens.h"
+#include "inc/ast.h"
+#include "inc/semantic.h"
+
+// Seeds tried for each table size, and how many times the smallest size a table can double
+// while looking for a perfect hash. Tables without one fall back to linear probing
+#define STATIC_SEED_TRIES 64
+#define STATIC_SIZE_DOUBLINGS 2
+// Keys per bucket of a perfect hash, on average, and displacements tried for each bucket
+#define STATIC_BUCKET_KEYS 4
+#define STATIC_DISPLACEMENT_TRIES 4096
+// Constants initialised with constants, followed to the literal they stand for
+#define STATIC_MAX_ALIASING 64
+// Fewest labels for a switch to be lowered to a table, and to a hash table rather than a
+// binary search. A jump table is used if at least SWITCH_MIN_DENSITY percent of its slots
+// hold a label, and it has no more than SWITCH_MAX_JUMP_SLOTS
+#define SWITCH_MIN_TABLE_LABELS 4
+#define SWITCH_MIN_HASH_LABELS 16
+#define SWITCH_MIN_DENSITY 40
+#define SWITCH_MAX_JUMP_SLOTS 65536
+
+typedef struct minimal_static_key {
+  MiniConstantKind kind; // CONSTANT_NONE for strings
+  const unsigned char *bytes;
+  size_t length;
+  unsigned char number[8];
+} MiniStaticKey;
+
+typedef struct minimal_static_layouts {
+  MiniStaticKey *keys;
+  size_t key_capacity;
+  bool *used; // Slots taken while trying a layout
+  size_t used_capacity;
+  // The keys of bucket b of a perfect hash are bucket_keys[bucket_starts[b]] up to
+  // bucket_keys[bucket_starts[b + 1]]. There are at most as many buckets as keys
+  uint32_t *bucket_starts;
+  uint32_t *bucket_keys;
+  uint32_t *displacements;
+  size_t bucket_capacity;
+  int64_t *labels;
+  size_t label_capacity;
+  size_t static_count;
+  size_t switch_count; // Switches lowered to a table
+  MiniStatus status;
+} MiniStaticLayouts;
+
+uint64_t static_key_hash(const unsigned char *bytes, size_t length, uint32_t seed) {
+  uint64_t hash = 14695981039346656037ULL ^ seed;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  // The low bits pick the slot, so the high ones are mixed into them
+  return hash ^ (hash >> 29);
+}
+
+static bool is_known(const MiniConstant *constant) {
+  return constant->kind == CONSTANT_INT || constant->kind == CONSTANT_FLOAT || constant->kind == CONSTANT_BOOL;
+}
+
+// The literal a collection element or case label stands for: itself, or the initial value of
+// the constant it names
+static MiniAstNode *element_literal(MiniAstNode *node) {
+  for (int i = 0; i < STATIC_MAX_ALIASING && node != NULL; i++) {
+    if (node->kind == AST_LITERAL || (node->kind == AST_CASE && node->token.category != IDENTIFIER)) {
+      return node;
+    }
+    MiniAstNode *declaration = node->declaration;
+    if ((node->kind != AST_NAME && node->kind != AST_CASE) || declaration == NULL || declaration->kind != AST_DECLARATION ||
+        declaration->token.name != MINI_CONST_ID) {
+      return NULL;
+    }
+    node = declaration->operands[0];
+  }
+  return NULL;
+}
+
+// Fills in key with the bytes static_key_hash() takes for element. Returns false if element
+// isn't known at compile time
+static bool element_key(MiniAstNode *element, MiniStaticKey *key) {
+  const MiniConstant *constant = &element->constant;
+  if (constant->kind == CONSTANT_INT || constant->kind == CONSTANT_BOOL || constant->kind == CONSTANT_FLOAT) {
+    uint64_t bits;
+    memcpy(&bits, &constant->value, sizeof(bits));
+    for (size_t i = 0; i < 8; i++) {
+      key->number[i] = (unsigned char) (bits >> (8 * i));
+    }
+    key->kind = constant->kind;
+    key->bytes = key->number;
+    key->length = 8;
+    return true;
+  }
+  MiniAstNode *literal = element_literal(element);
+  if (literal == NULL || literal->token.name != STRING_LITERAL) {
+    return false;
+  }
+  size_t length = strlen(literal->token.string_repr);
+  key->kind = CONSTANT_NONE;
+  key->bytes = (const unsigned char *) literal->token.string_repr + 1;
+  key->length = length >= 2 ? length - 2 : 0;
+  return true;
+}
+
+static bool same_key(const MiniStaticKey *first, const MiniStaticKey *second) {
+  return first->kind == second->kind && first->length == second->length && memcmp(first->bytes, second->bytes, first->length) == 0;
+}
+
+static bool reserve_layout_space(MiniStaticLayouts *layouts, size_t key_count, size_t slot_count) {
+  if (key_count > layouts->key_capacity) {
+    MiniStaticKey *keys = realloc(layouts->keys, key_count * sizeof(MiniStaticKey));
+    if (keys == NULL) {
+      printf("reserve_layout_space: Memory Error: Failed to reallocate memory for dict keys\n");
+      layouts->status = REALLOCATION_FAIL;
+      return false;
+    }
+    layouts->keys = keys;
+    layouts->key_capacity = key_count;
+  }
+  if (slot_count > layouts->used_capacity) {
+    bool *used = realloc(layouts->used, slot_count * sizeof(bool));
+    if (used == NULL) {
+      printf("reserve_layout_space: Memory Error: Failed to reallocate memory for dict slots\n");
+      layouts->status = REALLOCATION_FAIL;
+      return false;
+    }
+    layouts->used = used;
+    layouts->used_capacity = slot_count;
+  }
+  if (key_count + 1 > layouts->bucket_capacity) {
+    uint32_t **arrays[] = {&layouts->bucket_starts, &layouts->bucket_keys, &layouts->displacements};
+    for (size_t i = 0; i < sizeof(arrays) / sizeof(arrays[0]); i++) {
+      uint32_t *indices = realloc(*arrays[i], (key_count + 1) * sizeof(uint32_t));
+      if (indices == NULL) {
+        printf("reserve_layout_space: Memory Error: Failed to reallocate memory for hash buckets\n");
+        layouts->status = REALLOCATION_FAIL;
+        return false;
+      }
+      *arrays[i] = indices;
+    }
+    layouts->bucket_capacity = key_count + 1;
+  }
+  return true;
+}
+
+static uint32_t key_bucket(const MiniStaticKey *key, uint32_t bucket_count, uint32_t seed) {
+  return (uint32_t) (static_key_hash(key->bytes, key->length, seed) >> 32) & (bucket_count - 1);
+}
+
+static uint32_t key_slot(const MiniStaticKey *key, uint32_t slot_count, uint32_t displacement) {
+  return (uint32_t) static_key_hash(key->bytes, key->length, displacement) & (slot_count - 1);
+}
+
+// Groups the keys by the bucket seed puts them in. Returns the most keys in a bucket
+static uint32_t fill_buckets(MiniStaticLayouts *layouts, size_t key_count, uint32_t bucket_count, uint32_t seed) {
+  uint32_t *starts = layouts->bucket_starts;
+  memset(starts, 0, (bucket_count + 1) * sizeof(uint32_t));
+  for (size_t i = 0; i < key_count; i++) {
+    starts[key_bucket(&layouts->keys[i], bucket_count, seed) + 1]++;
+  }
+  uint32_t largest = 0;
+  for (uint32_t bucket = 0; bucket < bucket_count; bucket++) {
+    largest = starts[bucket + 1] > largest ? starts[bucket + 1] : largest;
+    starts[bucket + 1] += starts[bucket];
+  }
+  // Adding the keys moves the start of each bucket to that of the next one
+  for (size_t i = 0; i < key_count; i++) {
+    layouts->bucket_keys[starts[key_bucket(&layouts->keys[i], bucket_count, seed)]++] = (uint32_t) i;
+  }
+  memmove(starts + 1, starts, bucket_count * sizeof(uint32_t));
+  starts[0] = 0;
+  return largest;
+}
+
+// Looks for a displacement that puts every key of bucket in a free slot of its own
+static bool place_bucket(MiniStaticLayouts *layouts, uint32_t bucket, uint32_t slot_count) {
+  uint32_t first = layouts->bucket_starts[bucket];
+  uint32_t last = layouts->bucket_starts[bucket + 1];
+  for (uint32_t displacement = 0; displacement < STATIC_DISPLACEMENT_TRIES; displacement++) {
+    uint32_t i = first;
+    for (; i < last; i++) {
+      uint32_t slot = key_slot(&layouts->keys[layouts->bucket_keys[i]], slot_count, displacement);
+      if (layouts->used[slot]) {
+        break;
+      }
+      layouts->used[slot] = true;
+    }
+    if (i == last) {
+      layouts->displacements[bucket] = displacement;
+      return true;
+    }
+    while (i > first) {
+      i--;
+      layouts->used[key_slot(&layouts->keys[layouts->bucket_keys[i]], slot_count, displacement)] = false;
+    }
+  }
+  return false;
+}
+
+// The buckets with the most keys are placed first, while most of the slots are free
+static bool is_perfect(MiniStaticLayouts *layouts, size_t key_count, uint32_t slot_count, uint32_t bucket_count, uint32_t seed) {
+  memset(layouts->used, 0, slot_count * sizeof(bool));
+  memset(layouts->displacements, 0, bucket_count * sizeof(uint32_t));
+  uint32_t largest = fill_buckets(layouts, key_count, bucket_count, seed);
+  for (uint32_t size = largest; size > 0; size--) {
+    for (uint32_t bucket = 0; bucket < bucket_count; bucket++) {
+      uint32_t keys = layouts->bucket_starts[bucket + 1] - layouts->bucket_starts[bucket];
+      if (keys == size && !place_bucket(layouts, bucket, slot_count)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Looks for a table size from smallest up and a seed that give every key a slot of its own.
+// The keys and slots are reserved already
+static bool find_perfect_hash(MiniStaticLayouts *layouts, size_t key_count, uint32_t smallest, MiniStaticLayout *layout) {
+  uint32_t bucket_count = 1;
+  while (bucket_count * STATIC_BUCKET_KEYS < key_count) {
+    bucket_count *= 2;
+  }
+  for (uint32_t slot_count = smallest; slot_count <= smallest << STATIC_SIZE_DOUBLINGS; slot_count *= 2) {
+    for (uint32_t seed = 0; seed < STATIC_SEED_TRIES; seed++) {
+      if (!is_perfect(layouts, key_count, slot_count, bucket_count, seed)) {
+        continue;
+      }
+      uint32_t *displacements = malloc(bucket_count * sizeof(uint32_t));
+      if (displacements == NULL) {
+        printf("find_perfect_hash: Memory Error: Failed to allocate memory for displacements\n");
+        layouts->status = ALLOCATION_FAIL;
+        return false;
+      }
+      memcpy(displacements, layouts->displacements, bucket_count * sizeof(uint32_t));
+      layout->perfect = true;
+      layout->slot_count = slot_count;
+      layout->seed = seed;
+      layout->bucket_count = bucket_count;
+      layout->displacements = displacements;
+      return true;
+    }
+  }
+  return false;
+}
+
+// At most half of the slots of a hash table are taken
+static uint32_t smallest_table(size_t key_count) {
+  uint32_t smallest = 2;
+  while (smallest < 2 * key_count) {
+    smallest *= 2;
+  }
+  return smallest;
+}
+
+static void lay_out_dict(MiniStaticLayouts *layouts, MiniAstNode *dict) {
+  size_t key_count = 0;
+  for (MiniAstNode *pair = dict->list; pair != NULL; pair = pair->next) {
+    key_count++;
+  }
+  uint32_t smallest = smallest_table(key_count);
+  if (!reserve_layout_space(layouts, key_count, (size_t) smallest << STATIC_SIZE_DOUBLINGS)) {
+    return;
+  }
+  size_t i = 0;
+  for (MiniAstNode *pair = dict->list; pair != NULL; pair = pair->next, i++) {
+    MiniConstant *value = &pair->operands[1]->constant;
+    MiniStaticKey value_key;
+    if (!element_key(pair->operands[0], &layouts->keys[i]) || (!is_known(value) && !element_key(pair->operands[1], &value_key))) {
+      return;
+    }
+    // A key given twice is left to run time, where the last value wins
+    for (size_t j = 0; j < i; j++) {
+      if (same_key(&layouts->keys[i], &layouts->keys[j])) {
+        return;
+      }
+    }
+  }
+
+  dict->layout.is_static = true;
+  if (!find_perfect_hash(layouts, key_count, smallest, &dict->layout)) {
+    dict->layout.slot_count = smallest;
+  }
+}
+
+static int compare_labels(const void *first, const void *second) {
+  int64_t a = *(const int64_t *) first;
+  int64_t b = *(const int64_t *) second;
+  return (a > b) - (a < b);
+}
+
+// Sorts the int labels of a switch into layouts->labels, each once. Returns how many there
+// are, or 0 if they can't be reserved
+static size_t sort_int_labels(MiniStaticLayouts *layouts, MiniAstNode *node, size_t label_count) {
+  if (label_count > layouts->label_capacity) {
+    int64_t *labels = realloc(layouts->labels, label_count * sizeof(int64_t));
+    if (labels == NULL) {
+      printf("lay_out_switch: Memory Error: Failed to reallocate memory for case labels\n");
+      layouts->status = REALLOCATION_FAIL;
+      return 0;
+    }
+    layouts->labels = labels;
+    layouts->label_capacity = label_count;
+  }
+  size_t i = 0;
+  for (MiniAstNode *case_node = node->list; case_node != NULL; case_node = case_node->next) {
+    if (case_node->token.name != DEFAULT) {
+      layouts->labels[i++] = case_node->constant.value.int_value;
+    }
+  }
+  qsort(layouts->labels, label_count, sizeof(int64_t), compare_labels);
+  size_t unique_count = 1;
+  for (i = 1; i < label_count; i++) {
+    if (layouts->labels[i] != layouts->labels[unique_count - 1]) {
+      layouts->labels[unique_count++] = layouts->labels[i];
+    }
+  }
+  return unique_count;
+}
+
+// Keys the sorted int labels for find_perfect_hash()
+static bool key_int_labels(MiniStaticLayouts *layouts, size_t unique_count) {
+  if (!reserve_layout_space(layouts, unique_count, (size_t) smallest_table(unique_count) << STATIC_SIZE_DOUBLINGS)) {
+    return false;
+  }
+  for (size_t i = 0; i < unique_count; i++) {
+    MiniStaticKey *key = &layouts->keys[i];
+    uint64_t bits = (uint64_t) layouts->labels[i];
+    for (size_t j = 0; j < 8; j++) {
+      key->number[j] = (unsigned char) (bits >> (8 * j));
+    }
+    key->kind = CONSTANT_INT;
+    key->bytes = key->number;
+    key->length = 8;
+  }
+  return true;
+}
+
+// Keys the string labels of a switch by their text, each once. Returns how many there are, or
+// 0 if a label isn't a string known at compile time
+static size_t key_string_labels(MiniStaticLayouts *layouts, MiniAstNode *node, size_t label_count) {
+  if (!reserve_layout_space(layouts, label_count, (size_t) smallest_table(label_count) << STATIC_SIZE_DOUBLINGS)) {
+    return 0;
+  }
+  size_t unique_count = 0;
+  for (MiniAstNode *case_node = node->list; case_node != NULL; case_node = case_node->next) {
+    if (case_node->token.name == DEFAULT) {
+      continue;
+    }
+    MiniStaticKey *key = &layouts->keys[unique_count];
+    if (!element_key(case_node, key) || key->kind != CONSTANT_NONE) {
+      return 0;
+    }
+    bool repeated = false;
+    for (size_t j = 0; j < unique_count && !repeated; j++) {
+      repeated = same_key(key, &layouts->keys[j]);
+    }
+    unique_count += !repeated;
+  }
+  return unique_count;
+}
+
+// Picks the MiniSwitchStrategy of a switch from its labels, which are all ints or all strings.
+// A label given twice can only match in its first case, so it is counted once
+static void lay_out_switch(MiniStaticLayouts *layouts, MiniAstNode *node) {
+  size_t label_count = 0;
+  bool ints = true;
+  for (MiniAstNode *case_node = node->list; case_node != NULL; case_node = case_node->next) {
+    if (case_node->token.name != DEFAULT) {
+      ints = ints && case_node->constant.kind == CONSTANT_INT;
+      label_count++;
+    }
+  }
+  if (label_count < SWITCH_MIN_TABLE_LABELS) {
+    return;
+  }
+  size_t unique_count = ints ? sort_int_labels(layouts, node, label_count) : key_string_labels(layouts, node, label_count);
+  if (unique_count < SWITCH_MIN_TABLE_LABELS) {
+    return;
+  }
+
+  MiniStaticLayout *layout = &node->layout;
+  if (ints) {
+    layout->is_static = true;
+    layouts->switch_count++;
+    // Unsigned, so that the span of labels far apart doesn't overflow
+    uint64_t span = (uint64_t) layouts->labels[unique_count - 1] - (uint64_t) layouts->labels[0];
+    if (span < SWITCH_MAX_JUMP_SLOTS && unique_count * 100 >= (span + 1) * SWITCH_MIN_DENSITY) {
+      layout->strategy = SWITCH_JUMP_TABLE;
+      layout->slot_count = (uint32_t) span + 1;
+      layout->low = layouts->labels[0];
+      return;
+    }
+    layout->strategy = SWITCH_BINARY_SEARCH;
+    layout->slot_count = (uint32_t) unique_count;
+    if (unique_count < SWITCH_MIN_HASH_LABELS || !key_int_labels(layouts, unique_count)) {
+      return;
+    }
+  }
+  // String labels have no order to search in, so they are hashed however few they are. A
+  // lookup then compares the text of the one label in the slot of the value
+  if (!find_perfect_hash(layouts, unique_count, smallest_table(unique_count), layout)) {
+    return;
+  }
+  if (!layout->is_static) {
+    layout->is_static = true;
+    layouts->switch_count++;
+  }
+  layout->strategy = SWITCH_PERFECT_HASH;
+}
+
+static MiniVisitAction lay_out_node(MiniAstNode *node, int depth, void *context) {
+  (void) depth;
+  MiniStaticLayouts *layouts = context;
+  if (node->kind == AST_LIST) {
+    MiniStaticKey key;
+    bool known = true;
+    for (MiniAstNode *element = node->list; element != NULL && known; element = element->next) {
+      known = is_known(&element->constant) || element_key(element, &key);
+    }
+    node->layout = (MiniStaticLayout){.is_static = known, .perfect = false, .slot_count = 0, .seed = 0};
+  } else if (node->kind == AST_DICT) {
+    node->layout = (MiniStaticLayout){.is_static = false, .perfect = false, .slot_count = 0, .seed = 0};
+    lay_out_dict(layouts, node);
+  } else if (node->kind == AST_SWITCH) {
+    // The cases may hold collections of their own
+    node->layout = (MiniStaticLayout){.is_static = false, .strategy = SWITCH_IF_CHAIN};
+    lay_out_switch(layouts, node);
+    return layouts->status == SUCCESS ? VISIT_CONTINUE : VISIT_STOP;
+  } else {
+    return VISIT_CONTINUE;
+  }
+  layouts->static_count += node->layout.is_static;
+  return layouts->status == SUCCESS ? VISIT_SKIP : VISIT_STOP;
+}
+
+MiniStatus lay_out_static_data(MiniAst *ast, size_t *static_count, size_t *switch_count) {
+  MiniStaticLayouts layouts;
+  memset(&layouts, 0, sizeof(MiniStaticLayouts));
+  layouts.status = SUCCESS;
+  MiniAstVisitor visitor = {lay_out_node, NULL, &layouts};
+  MiniStatus status = walk_ast(ast->root, &visitor);
+  free(layouts.keys);
+  free(layouts.used);
+  free(layouts.labels);
+  free(layouts.bucket_starts);
+  free(layouts.bucket_keys);
+  free(layouts.displacements);
+  *static_count = layouts.static_count;
+  *switch_count = layouts.switch_count;
+  return status != SUCCESS ? status : layouts.status;
+}
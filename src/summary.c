@@ -0,0 +1,434 @@
+/* 
+  =======================================================================
+  This file is part of Minimal (mnml) - A *.mini source to C compiler for 
+  the Minimal programming language
+
+  Written in 2025 by approx-error
+
+  Minimal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Minimal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+  ======================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <limits.h>
+
+#include "inc/retcodes.h"
+#include "inc/tokens.h"
+#include "inc/ast.h"
+#include "inc/summary.h"
+
+// Layout of a summary, with every integer little endian:
+//   "MNMI", version (1 byte), FNV-1a hash of everything after the header (8 bytes)
+//   the AST_MODULE node
+// A node is its kind (1 byte), op, token name and token category (4 bytes each), token
+// value (8 bytes), token string, token type and declared type, then for each operand and
+// for the list the number of nodes linked by next (4 bytes) and those nodes. A string is
+// its length (4 bytes, NO_STRING for none) and its characters, a type is its keyword.
+// Subprogram bodies aren't written. Imports are, as the initial values can use their items
+#define SUMMARY_MAGIC "MNMI"
+#define SUMMARY_HEADER_SIZE 13
+#define NO_STRING UINT32_MAX
+#define SUMMARY_MAX_DEPTH 4096
+
+typedef struct minimal_summary_buffer {
+  unsigned char *bytes;
+  size_t length;
+  size_t capacity;
+  size_t position; // Where reading continues
+  MiniStatus status; // INVALID_SYNTAX once reading goes past the end or finds something malformed
+} MiniSummaryBuffer;
+
+static uint64_t summary_hash(const unsigned char *bytes, size_t length) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+static bool summary_path(char *path, const char *directory, const char *name) {
+  int length = snprintf(path, PATH_MAX, "%s/%s%s", directory, name, MINIMAL_SUMMARY_EXTENSION);
+  return length > 0 && length < PATH_MAX;
+}
+
+static void put_bytes(MiniSummaryBuffer *buffer, const void *bytes, size_t length) {
+  if (buffer->status != SUCCESS) {
+    return;
+  }
+  if (buffer->length + length > buffer->capacity) {
+    size_t capacity = buffer->capacity == 0 ? 256 : buffer->capacity;
+    while (capacity < buffer->length + length) {
+      capacity *= 2;
+    }
+    unsigned char *bytes_grown = realloc(buffer->bytes, capacity);
+    if (bytes_grown == NULL) {
+      printf("put_bytes: Memory Error: Failed to reallocate memory for a summary\n");
+      buffer->status = REALLOCATION_FAIL;
+      return;
+    }
+    buffer->bytes = bytes_grown;
+    buffer->capacity = capacity;
+  }
+  memcpy(buffer->bytes + buffer->length, bytes, length);
+  buffer->length += length;
+}
+
+static void put_integer(MiniSummaryBuffer *buffer, uint64_t value, size_t size) {
+  unsigned char bytes[8];
+  for (size_t i = 0; i < size; i++) {
+    bytes[i] = (unsigned char) (value >> (8 * i));
+  }
+  put_bytes(buffer, bytes, size);
+}
+
+static void put_string(MiniSummaryBuffer *buffer, const char *string, size_t length) {
+  if (string == NULL) {
+    put_integer(buffer, NO_STRING, 4);
+    return;
+  }
+  put_integer(buffer, length, 4);
+  put_bytes(buffer, string, length);
+}
+
+static void put_type(MiniSummaryBuffer *buffer, MiniTypeId id) {
+  if (id == MINIMAL_NO_TYPE) {
+    put_string(buffer, NULL, 0);
+    return;
+  }
+  char *text = NULL;
+  size_t length = 0;
+  FILE *stream = open_memstream(&text, &length);
+  if (stream == NULL) {
+    printf("put_type: Memory Error: Failed to open a stream for a type keyword\n");
+    buffer->status = ALLOCATION_FAIL;
+    return;
+  }
+  file_print_type(stream, id);
+  fclose(stream);
+  put_string(buffer, text, length);
+  free(text);
+}
+
+// Expressions are typed again after loading, only the declared types are kept
+static bool declares_type(MiniAstKind kind) {
+  return kind == AST_TYPE_ALIAS || kind == AST_DECLARATION || kind == AST_PARAMETER || kind == AST_SUBPROGRAM;
+}
+
+static void put_node(MiniSummaryBuffer *buffer, MiniAstNode *node);
+
+static void put_chain(MiniSummaryBuffer *buffer, MiniAstNode *first) {
+  uint32_t count = 0;
+  for (MiniAstNode *node = first; node != NULL; node = node->next) {
+    count++;
+  }
+  put_integer(buffer, count, 4);
+  for (MiniAstNode *node = first; node != NULL; node = node->next) {
+    put_node(buffer, node);
+  }
+}
+
+static void put_node(MiniSummaryBuffer *buffer, MiniAstNode *node) {
+  put_integer(buffer, node->kind, 1);
+  put_integer(buffer, (uint32_t) node->op, 4);
+  put_integer(buffer, (uint32_t) node->token.name, 4);
+  put_integer(buffer, (uint32_t) node->token.category, 4);
+  put_integer(buffer, (uint64_t) node->token.value.int_value, 8);
+  const char *string = node->token.string_repr;
+  put_string(buffer, string, string == NULL ? 0 : strlen(string));
+  put_type(buffer, node->token.type_id);
+  put_type(buffer, declares_type(node->kind) ? node->type_id : MINIMAL_NO_TYPE);
+  if (node->kind == AST_SUBPROGRAM) {
+    put_integer(buffer, node->effects, 1);
+  }
+  for (int i = 0; i < MINIMAL_AST_OPERANDS; i++) {
+    put_chain(buffer, node->operands[i]);
+  }
+  put_chain(buffer, node->kind == AST_SUBPROGRAM ? NULL : node->list);
+}
+
+// Returns FILE_NOT_FOUND without a message if path doesn't exist
+static MiniStatus read_summary(const char *path, MiniSummaryBuffer *buffer) {
+  FILE *file_ptr = fopen(path, "rb");
+  if (file_ptr == NULL) {
+    return FILE_NOT_FOUND;
+  }
+  unsigned char chunk[4096];
+  size_t count;
+  while ((count = fread(chunk, 1, sizeof(chunk), file_ptr)) > 0) {
+    put_bytes(buffer, chunk, count);
+  }
+  fclose(file_ptr);
+  return buffer->status;
+}
+
+static MiniStatus write_summary(MiniAstNode *module, const char *directory, int verbose) {
+  char path[PATH_MAX];
+  if (!summary_path(path, directory, module->token.string_repr)) {
+    printf("write_module_summaries: Error: The summary path of %s is too long\n", module->token.string_repr);
+    return INVALID_ARG;
+  }
+  MiniSummaryBuffer summary = {.bytes = NULL, .length = 0, .capacity = 0, .position = 0, .status = SUCCESS};
+  put_bytes(&summary, SUMMARY_MAGIC, 4);
+  put_integer(&summary, MINIMAL_SUMMARY_VERSION, 1);
+  put_integer(&summary, 0, 8); // Filled in once the rest is written
+  put_node(&summary, module);
+  if (summary.status != SUCCESS) {
+    free(summary.bytes);
+    return summary.status;
+  }
+  uint64_t hash = summary_hash(summary.bytes + SUMMARY_HEADER_SIZE, summary.length - SUMMARY_HEADER_SIZE);
+  for (size_t i = 0; i < 8; i++) {
+    summary.bytes[5 + i] = (unsigned char) (hash >> (8 * i));
+  }
+
+  MiniSummaryBuffer existing = {.bytes = NULL, .length = 0, .capacity = 0, .position = 0, .status = SUCCESS};
+  bool unchanged = read_summary(path, &existing) == SUCCESS && existing.length == summary.length &&
+                   memcmp(existing.bytes, summary.bytes, summary.length) == 0;
+  free(existing.bytes);
+  MiniStatus status = SUCCESS;
+  if (!unchanged) {
+    FILE *output_ptr = fopen(path, "wb");
+    if (output_ptr == NULL) {
+      printf("write_module_summaries: Error: Failed to open %s\n", path);
+      status = FILE_NOT_FOUND;
+    } else {
+      if (fwrite(summary.bytes, 1, summary.length, output_ptr) != summary.length) {
+        printf("write_module_summaries: Error: Failed to write %s\n", path);
+        status = FILE_NOT_FOUND;
+      }
+      fclose(output_ptr);
+    }
+  }
+  if (status == SUCCESS && verbose) {
+    printf("Summary file: %s (%s, hash %016llx)\n", path, unchanged ? "unchanged" : "written", (unsigned long long) hash);
+  }
+  free(summary.bytes);
+  return status;
+}
+
+MiniStatus write_module_summaries(MiniAst *ast, const char *directory, int verbose) {
+  for (MiniAstNode *file = ast->root->list; file != NULL; file = file->next) {
+    if (file->kind != AST_MODULE || file->op == IMPORT || file->token.string_repr == NULL) {
+      continue;
+    }
+    MiniStatus status = write_summary(file, directory, verbose);
+    if (status != SUCCESS) return status;
+  }
+  return SUCCESS;
+}
+
+static uint64_t take_integer(MiniSummaryBuffer *buffer, size_t size) {
+  if (buffer->status != SUCCESS || buffer->length - buffer->position < size) {
+    buffer->status = buffer->status == SUCCESS ? INVALID_SYNTAX : buffer->status;
+    return 0;
+  }
+  uint64_t value = 0;
+  for (size_t i = 0; i < size; i++) {
+    value |= (uint64_t) buffer->bytes[buffer->position + i] << (8 * i);
+  }
+  buffer->position += size;
+  return value;
+}
+
+// Returns a new string, or NULL if there is none or reading it failed
+static char *take_string(MiniSummaryBuffer *buffer) {
+  uint64_t length = take_integer(buffer, 4);
+  if (buffer->status != SUCCESS || length == NO_STRING) {
+    return NULL;
+  }
+  if (buffer->length - buffer->position < length) {
+    buffer->status = INVALID_SYNTAX;
+    return NULL;
+  }
+  char *string = malloc(length + 1);
+  if (string == NULL) {
+    printf("take_string: Memory Error: Failed to allocate memory for a summary string\n");
+    buffer->status = ALLOCATION_FAIL;
+    return NULL;
+  }
+  memcpy(string, buffer->bytes + buffer->position, length);
+  string[length] = '\0';
+  buffer->position += length;
+  return string;
+}
+
+static MiniTypeId take_type(MiniSummaryBuffer *buffer) {
+  char *keyword = take_string(buffer);
+  MiniTypeId id = MINIMAL_NO_TYPE;
+  if (keyword != NULL) {
+    MiniStatus status = intern_type_keyword(keyword, &id);
+    if (status != SUCCESS) {
+      buffer->status = status == INVALID_SYNTAX || status == INVALID_ARG ? INVALID_SYNTAX : status;
+    }
+    free(keyword);
+  }
+  return id;
+}
+
+static MiniAstNode *take_node(MiniAst *ast, MiniSummaryBuffer *buffer, int depth);
+
+static MiniAstNode *take_chain(MiniAst *ast, MiniSummaryBuffer *buffer, int depth) {
+  uint64_t count = take_integer(buffer, 4);
+  MiniAstNode *first = NULL;
+  MiniAstNode **link = &first;
+  for (uint64_t i = 0; i < count && buffer->status == SUCCESS; i++) {
+    *link = take_node(ast, buffer, depth);
+    if (*link == NULL) break;
+    link = &(*link)->next;
+  }
+  return first;
+}
+
+// The module is the only node at depth 0 and imports are only among its items. Programs and
+// main programs never appear in a summary
+static MiniAstNode *take_node(MiniAst *ast, MiniSummaryBuffer *buffer, int depth) {
+  uint64_t kind = take_integer(buffer, 1);
+  if (buffer->status != SUCCESS) {
+    return NULL;
+  }
+  if (depth > SUMMARY_MAX_DEPTH || kind > AST_LITERAL || kind == AST_PROGRAM || kind == AST_MAIN ||
+      (kind == AST_IMPORT && depth != 1) || (kind == AST_MODULE) != (depth == 0)) {
+    buffer->status = INVALID_SYNTAX;
+    return NULL;
+  }
+  MiniAstNode *node = alloc_ast_node(ast, (MiniAstKind) kind, &buffer->status);
+  if (node == NULL) {
+    return NULL;
+  }
+  node->op = (MiniTokenName) (int32_t) take_integer(buffer, 4);
+  node->token.name = (MiniTokenName) (int32_t) take_integer(buffer, 4);
+  node->token.category = (MiniTokenCat) (int32_t) take_integer(buffer, 4);
+  node->token.value.int_value = (int64_t) take_integer(buffer, 8);
+  node->token.line = MINIMAL_AST_NO_LINE;
+  node->token.string_repr = take_string(buffer);
+  node->token.type_id = take_type(buffer);
+  node->type_id = take_type(buffer);
+  if (kind == AST_SUBPROGRAM) {
+    node->effects = (uint8_t) take_integer(buffer, 1);
+  }
+  if (buffer->status == SUCCESS && node->token.category == IDENTIFIER && node->token.string_repr != NULL) {
+    buffer->status = intern_symbol(node->token.string_repr, &node->symbol);
+  }
+  for (int i = 0; i < MINIMAL_AST_OPERANDS; i++) {
+    node->operands[i] = take_chain(ast, buffer, depth + 1);
+  }
+  node->list = take_chain(ast, buffer, depth + 1);
+  return node;
+}
+
+static MiniStatus load_summary(MiniAst *ast, const char *directory, const char *name, MiniAstNode **module, int verbose) {
+  char path[PATH_MAX];
+  if (!summary_path(path, directory, name)) {
+    return FILE_NOT_FOUND;
+  }
+  MiniSummaryBuffer summary = {.bytes = NULL, .length = 0, .capacity = 0, .position = 0, .status = SUCCESS};
+  MiniStatus status = read_summary(path, &summary);
+  if (status != SUCCESS) {
+    free(summary.bytes);
+    return status;
+  }
+  uint64_t hash = 0;
+  if (summary.length < SUMMARY_HEADER_SIZE || memcmp(summary.bytes, SUMMARY_MAGIC, 4) != 0 ||
+      summary.bytes[4] != MINIMAL_SUMMARY_VERSION) {
+    summary.status = INVALID_SYNTAX;
+  } else {
+    summary.position = 5;
+    hash = take_integer(&summary, 8);
+    if (hash != summary_hash(summary.bytes + SUMMARY_HEADER_SIZE, summary.length - SUMMARY_HEADER_SIZE)) {
+      summary.status = INVALID_SYNTAX;
+    }
+  }
+  *module = take_node(ast, &summary, 0);
+  if (summary.status == SUCCESS && (summary.position != summary.length || (*module)->token.string_repr == NULL ||
+                                    strcmp((*module)->token.string_repr, name) != 0)) {
+    summary.status = INVALID_SYNTAX;
+  }
+  free(summary.bytes);
+  if (summary.status == INVALID_SYNTAX) {
+    printf("load_module_summaries: Error: %s is not a valid summary of module %s\n", path, name);
+  }
+  if (summary.status != SUCCESS) {
+    return summary.status;
+  }
+  (*module)->op = IMPORT;
+  if (verbose) {
+    printf("Loaded summary file: %s (hash %016llx)\n", path, (unsigned long long) hash);
+  }
+  return SUCCESS;
+}
+
+// Marks symbol as a module that is defined or has been looked for. Returns whether it was
+// marked already. known grows as loading interns new symbols
+static bool mark_known(bool **known, size_t *known_size, MiniSymbolId symbol, MiniStatus *status) {
+  if (symbol >= *known_size) {
+    size_t size = (size_t) symbol_count() + 1;
+    bool *known_grown = realloc(*known, size * sizeof(bool));
+    if (known_grown == NULL) {
+      printf("load_module_summaries: Memory Error: Failed to reallocate memory for module names\n");
+      *status = REALLOCATION_FAIL;
+      return true;
+    }
+    memset(known_grown + *known_size, 0, (size - *known_size) * sizeof(bool));
+    *known = known_grown;
+    *known_size = size;
+  }
+  bool marked = (*known)[symbol];
+  (*known)[symbol] = true;
+  return marked;
+}
+
+MiniStatus load_module_summaries(MiniAst *ast, const char *directory, int verbose) {
+  bool *known = NULL; // Indexed by symbol id
+  size_t known_size = 0;
+  MiniStatus status = SUCCESS;
+  MiniAstNode **link = &ast->root->list;
+  for (MiniAstNode *file = ast->root->list; file != NULL && status == SUCCESS; file = file->next) {
+    MiniAstNode *module = file->kind == AST_MAIN ? file->operands[0] : file;
+    if (module != NULL && module->kind == AST_MODULE) {
+      mark_known(&known, &known_size, module->symbol, &status);
+    }
+    link = &file->next;
+  }
+
+  // Loaded modules are appended to the list, so their own imports are loaded in turn
+  for (MiniAstNode *file = ast->root->list; file != NULL && status == SUCCESS; file = file->next) {
+    MiniAstNode *module = file->kind == AST_MAIN ? file->operands[0] : file;
+    if (module == NULL || module->kind != AST_MODULE) {
+      continue;
+    }
+    for (MiniAstNode *item = module->list; item != NULL; item = item->next) {
+      if (item->kind != AST_IMPORT || item->op != IMPORT || item->symbol == MINIMAL_NO_SYMBOL ||
+          mark_known(&known, &known_size, item->symbol, &status)) {
+        if (status != SUCCESS) break;
+        continue;
+      }
+      MiniAstNode *loaded = NULL;
+      status = load_summary(ast, directory, item->token.string_repr, &loaded, verbose);
+      if (status == FILE_NOT_FOUND) {
+        status = SUCCESS;
+        continue;
+      }
+      if (status != SUCCESS) break;
+      *link = loaded;
+      link = &loaded->next;
+    }
+  }
+  free(known);
+  return status;
+}
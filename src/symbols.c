@@ -0,0 +1,158 @@
+/* 
+  =======================================================================
+  This file is part of Minimal (mnml) - A *.mini source to C compiler for 
+  the Minimal programming language
+
+  Written in 2025 by approx-error
+
+  Minimal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Minimal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+  ======================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "inc/tokens.h"
+#include "inc/retcodes.h"
+
+// Interned identifier names. Identifiers are interned while lowering, which runs on one
+// thread, and only looked up afterwards, so unlike the type table this one has no lock
+typedef struct minimal_symbol {
+  char *name;
+  uint64_t hash;
+} MiniSymbol;
+
+static MiniSymbol *symbols = NULL; // symbols[id - 1]
+static uint32_t symbols_used = 0;
+static uint32_t symbols_capacity = 0;
+
+// Open addressing hash index from a name to its id. 0 marks an empty slot
+static MiniSymbolId *symbol_index = NULL;
+static size_t symbol_index_capacity = 0;
+
+static uint64_t hash_name(const char *name) {
+  uint64_t hash = 14695981039346656037ULL; // FNV-1a
+  for (const char *c = name; *c != '\0'; c++) {
+    hash ^= (unsigned char) *c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+static void insert_symbol_index(MiniSymbolId id) {
+  size_t mask = symbol_index_capacity - 1;
+  size_t slot = symbols[id - 1].hash & mask;
+  while (symbol_index[slot] != MINIMAL_NO_SYMBOL) {
+    slot = (slot + 1) & mask;
+  }
+  symbol_index[slot] = id;
+}
+
+static MiniStatus grow_symbol_index(void) {
+  size_t capacity = symbol_index_capacity == 0 ? 256 : symbol_index_capacity * 2;
+  MiniSymbolId *index = calloc(capacity, sizeof(MiniSymbolId));
+  if (index == NULL) {
+    printf("grow_symbol_index: Memory Error: Failed to allocate memory for symbol index\n");
+    return ALLOCATION_FAIL;
+  }
+  free(symbol_index);
+  symbol_index = index;
+  symbol_index_capacity = capacity;
+  for (MiniSymbolId id = 1; id <= symbols_used; id++) {
+    insert_symbol_index(id);
+  }
+  return SUCCESS;
+}
+
+// Returns the id of name, adding a copy of it to the table if it isn't there yet
+MiniStatus intern_symbol(const char *name, MiniSymbolId *id) {
+  uint64_t hash = hash_name(name);
+  if (symbol_index_capacity > 0) {
+    size_t mask = symbol_index_capacity - 1;
+    size_t slot = hash & mask;
+    while (symbol_index[slot] != MINIMAL_NO_SYMBOL) {
+      MiniSymbol *symbol = &symbols[symbol_index[slot] - 1];
+      if (symbol->hash == hash && strcmp(symbol->name, name) == 0) {
+        *id = symbol_index[slot];
+        return SUCCESS;
+      }
+      slot = (slot + 1) & mask;
+    }
+  }
+
+  if (symbols_used == UINT32_MAX - 1) {
+    printf("intern_symbol: Error: Too many distinct identifiers\n");
+    return ALLOCATION_FAIL;
+  }
+  if (symbols_used == symbols_capacity) {
+    uint32_t capacity = symbols_capacity == 0 ? 128 : symbols_capacity * 2;
+    MiniSymbol *grown = realloc(symbols, capacity * sizeof(MiniSymbol));
+    if (grown == NULL) {
+      printf("intern_symbol: Memory Error: Failed to reallocate memory for symbol table\n");
+      return REALLOCATION_FAIL;
+    }
+    symbols = grown;
+    symbols_capacity = capacity;
+  }
+  char *copy = malloc((strlen(name) + 1) * sizeof(char));
+  if (copy == NULL) {
+    printf("intern_symbol: Memory Error: Failed to allocate memory for symbol name\n");
+    return ALLOCATION_FAIL;
+  }
+  strcpy(copy, name);
+  symbols[symbols_used] = (MiniSymbol){copy, hash};
+  symbols_used++;
+
+  // The index is kept at most half full
+  if ((size_t) symbols_used * 2 > symbol_index_capacity) {
+    MiniStatus status = grow_symbol_index();
+    if (status != SUCCESS) {
+      symbols_used--;
+      free(copy);
+      return status;
+    }
+  } else {
+    insert_symbol_index(symbols_used);
+  }
+  *id = symbols_used;
+  return SUCCESS;
+}
+
+// id must have been returned by intern_symbol()
+const char *symbol_name(MiniSymbolId id) {
+  if (id == MINIMAL_NO_SYMBOL) {
+    return NULL;
+  }
+  return symbols[id - 1].name;
+}
+
+// Every id returned so far is at most this
+uint32_t symbol_count(void) {
+  return symbols_used;
+}
+
+void free_symbol_table(void) {
+  for (uint32_t i = 0; i < symbols_used; i++) {
+    free(symbols[i].name);
+  }
+  free(symbols);
+  symbols = NULL;
+  symbols_used = 0;
+  symbols_capacity = 0;
+  free(symbol_index);
+  symbol_index = NULL;
+  symbol_index_capacity = 0;
+}
@@ -24,6 +24,8 @@
 #include <string.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
 
 #include "inc/retcodes.h"
 #include "inc/tokens.h"
@@ -32,166 +34,101 @@
 //const int VARIABLE_LIST_INCREMENT = 10;
 const int TREE_INDENT_WIDTH = 2;
 
-void print_construct_category(int construct, int type) {
+// Name of a token category (type TOKEN) or non-terminal (type NON_TERMINAL), NULL for any
+// other type
+const char *construct_category_name(int construct, int type) {
   if (type == TOKEN) {
     switch (construct) {
-      case IDENTIFIER: printf("Identifier"); return;
-      case TYPE_KW: printf("Type Keyword"); return;
-      case BRANCH_KW: printf("Branch Keyword"); return;
-      case TERM_KW: printf("Terminating Keyword"); return;
-      case CONTROL_KW: printf("Control Keyword"); return;
-      case PROGRAM_BLOCK_KW: printf("Program Block Keyword"); return;
-      case LITERAL_KW: printf("Literal Keyword"); return;
-      case PAREN_SEP: printf("Parenthetical Separator"); return;
-      case PUNCT_SEP: printf("Punctuational Separator"); return;
-      case BIN_MATH_OP: printf("Binary Math Operator"); return;
-      case UNA_MATH_OP: printf("Unary Math Operator"); return;
-      case BIN_ASSIGN_OP: printf("Binary Assignment Operator"); return;
-      case UNA_ASSIGN_OP: printf("Unary Assignment Operator"); return;
-      case COMP_OP: printf("Comparison Operator"); return;
-      case BIN_LOG_OP: printf("Binary Logical Operator"); return;
-      case UNA_LOG_OP: printf("Unary Logical Operator"); return;
-      case LITERAL: printf("Literal"); return;
-      default: printf("Unclassifiable"); return;
+      case IDENTIFIER: return "Identifier";
+      case TYPE_KW: return "Type Keyword";
+      case BRANCH_KW: return "Branch Keyword";
+      case TERM_KW: return "Terminating Keyword";
+      case CONTROL_KW: return "Control Keyword";
+      case PROGRAM_BLOCK_KW: return "Program Block Keyword";
+      case LITERAL_KW: return "Literal Keyword";
+      case PAREN_SEP: return "Parenthetical Separator";
+      case PUNCT_SEP: return "Punctuational Separator";
+      case BIN_MATH_OP: return "Binary Math Operator";
+      case UNA_MATH_OP: return "Unary Math Operator";
+      case BIN_ASSIGN_OP: return "Binary Assignment Operator";
+      case UNA_ASSIGN_OP: return "Unary Assignment Operator";
+      case COMP_OP: return "Comparison Operator";
+      case BIN_LOG_OP: return "Binary Logical Operator";
+      case UNA_LOG_OP: return "Unary Logical Operator";
+      case LITERAL: return "Literal";
+      default: return "Unclassifiable";
     }
   } else if (type == NON_TERMINAL) {
     switch (construct) {
-      case SOURCE: printf("Source"); return;
-      case MAIN_FILE: printf("Main File"); return;
-      case MODULE_FILE: printf("Module File"); return;
-      case MAIN_PART: printf("Main Part"); return;
-      case MODULE_PART: printf("Module Part"); return;
-      case SEQUENCE: printf("Sequence"); return;
-      case MODULE_SEQUENCE: printf("Module Sequence"); return;
-      case STATEMENT: printf("Statement"); return;
-      case BRANCH: printf("Branch"); return;
-      case IMPORTING: printf("Import"); return;
-      case TYPE_ALIASING: printf("Type Alias"); return;
-      case SUBPROGRAM: printf("Subprogram"); return;
-      case MODULE_DECLARATION: printf("Module Declaration"); return;
-      case DECLARATION: printf("Declaration"); return;
-      case DESIGNATION: printf("Designation"); return;
-      case CONTROL: printf("Control"); return;
-      case IF_BLOCK: printf("If-Block"); return;
-      case SWITCH_BLOCK: printf("Switch-Block"); return;
-      case LOOP_BLOCK: printf("Loop-Block"); return;
-      case FILE_IMPORT: printf("Minimal Module Import"); return;
-      case M_FILE_IMPORT: printf("Minimal Stdlib Import"); return;
-      case C_FILE_IMPORT: printf("C Import"); return;
-      case TYPE_EXPR: printf("Type Expression"); return;
-      case PARAM_LIST: printf("Parameter List"); return;
-      case COLLECTION: printf("Collection"); return;
-      case PRIMARY_EXPRESSION: printf("Primary Expression"); return;
-      case ASSIGNMENT: printf("Assignment"); return;
-      case INCREMENTATION: printf("Incrementation"); return;
-      case IN_OUT_CTRL: printf("Input/Output -Control"); return;
-      case FLOW_CTRL: printf("Flow Control"); return;
-      case FUNC_CALL: printf("Function Call"); return;
-      case ELIF_BLOCK: printf("Else If -Block"); return;
-      case ELSE_BLOCK: printf("Else-Block"); return;
-      case CASE_BLOCK: printf("Case-Block"); return;
-      case FOR_LOOP: printf("For-Loop"); return;
-      case WHILE_LOOP: printf("While-Loop"); return;
-      case EXPRESSION: printf("Expression"); return;
-      case INDEXING: printf("Indexing"); return;
-      case SIZEOF: printf("Sizeof"); return;
-      case ARGUMENT_LIST: printf("Argument List"); return;
-      case LIST: printf("List"); return;
-      case DICT: printf("Associative Array"); return;
-      case ARITHMETIC_EXPR: printf("Arithmetic Expression"); return;
-      case STRING_EXPR: printf("String Expression"); return;
-      case LOGICAL_EXPR: printf("Logical Expression"); return;
-      case ARITH_OPERAND: printf("Arithmetic Operand"); return;
-      case STRING_OPERAND: printf("String Operand"); return;
-      case LOGICAL_OPERAND: printf("Logical Operand"); return;
-      default: printf("Unclassifiable"); return;
+      case SOURCE: return "Source";
+      case MAIN_FILE: return "Main File";
+      case MODULE_FILE: return "Module File";
+      case MAIN_PART: return "Main Part";
+      case MODULE_PART: return "Module Part";
+      case SEQUENCE: return "Sequence";
+      case MODULE_SEQUENCE: return "Module Sequence";
+      case STATEMENT: return "Statement";
+      case BRANCH: return "Branch";
+      case IMPORTING: return "Import";
+      case TYPE_ALIASING: return "Type Alias";
+      case SUBPROGRAM: return "Subprogram";
+      case MODULE_DECLARATION: return "Module Declaration";
+      case DECLARATION: return "Declaration";
+      case DESIGNATION: return "Designation";
+      case CONTROL: return "Control";
+      case IF_BLOCK: return "If-Block";
+      case SWITCH_BLOCK: return "Switch-Block";
+      case LOOP_BLOCK: return "Loop-Block";
+      case FILE_IMPORT: return "Minimal Module Import";
+      case M_FILE_IMPORT: return "Minimal Stdlib Import";
+      case C_FILE_IMPORT: return "C Import";
+      case TYPE_EXPR: return "Type Expression";
+      case PARAM_LIST: return "Parameter List";
+      case COLLECTION: return "Collection";
+      case PRIMARY_EXPRESSION: return "Primary Expression";
+      case ASSIGNMENT: return "Assignment";
+      case INCREMENTATION: return "Incrementation";
+      case IN_OUT_CTRL: return "Input/Output -Control";
+      case FLOW_CTRL: return "Flow Control";
+      case FUNC_CALL: return "Function Call";
+      case ELIF_BLOCK: return "Else If -Block";
+      case ELSE_BLOCK: return "Else-Block";
+      case CASE_BLOCK: return "Case-Block";
+      case FOR_LOOP: return "For-Loop";
+      case WHILE_LOOP: return "While-Loop";
+      case EXPRESSION: return "Expression";
+      case INDEXING: return "Indexing";
+      case SIZEOF: return "Sizeof";
+      case ARGUMENT_LIST: return "Argument List";
+      case LIST: return "List";
+      case DICT: return "Associative Array";
+      case ARITHMETIC_EXPR: return "Arithmetic Expression";
+      case LOGICAL_EXPR: return "Logical Expression";
+      case ARITH_OPERAND: return "Arithmetic Operand";
+      case STRING_OPERAND: return "String Operand";
+      case LOGICAL_OPERAND: return "Logical Operand";
+      default: return "Unclassifiable";
     }
+  }
+  return NULL;
+}
 
-  } else {
+void print_construct_category(int construct, int type) {
+  const char *name = construct_category_name(construct, type);
+  if (name == NULL) {
     printf("Invalid type!\n");
+    return;
   }
-  return;
+  printf("%s", name);
 }
 
 void file_print_construct_category(FILE *file_ptr, int construct, int type) {
-  if (type == TOKEN) {
-    switch (construct) {
-      case IDENTIFIER: fprintf(file_ptr, "Identifier"); return;
-      case TYPE_KW: fprintf(file_ptr, "Type Keyword"); return;
-      case BRANCH_KW: fprintf(file_ptr, "Branch Keyword"); return;
-      case TERM_KW: fprintf(file_ptr, "Terminating Keyword"); return;
-      case CONTROL_KW: fprintf(file_ptr, "Control Keyword"); return;
-      case PROGRAM_BLOCK_KW: fprintf(file_ptr, "Program Block Keyword"); return;
-      case LITERAL_KW: fprintf(file_ptr, "Literal Keyword"); return;
-      case PAREN_SEP: fprintf(file_ptr, "Parenthetical Separator"); return;
-      case PUNCT_SEP: fprintf(file_ptr, "Punctuational Separator"); return;
-      case BIN_MATH_OP: fprintf(file_ptr, "Binary Math Operator"); return;
-      case UNA_MATH_OP: fprintf(file_ptr, "Unary Math Operator"); return;
-      case BIN_ASSIGN_OP: fprintf(file_ptr, "Binary Assignment Operator"); return;
-      case UNA_ASSIGN_OP: fprintf(file_ptr, "Unary Assignment Operator"); return;
-      case COMP_OP: fprintf(file_ptr, "Comparison Operator"); return;
-      case BIN_LOG_OP: fprintf(file_ptr, "Binary Logical Operator"); return;
-      case UNA_LOG_OP: fprintf(file_ptr, "Unary Logical Operator"); return;
-      case LITERAL: fprintf(file_ptr, "Literal"); return;
-      default: fprintf(file_ptr, "Unclassifiable"); return;
-    }
-  } else if (type == NON_TERMINAL) {
-    switch (construct) {
-      case SOURCE: fprintf(file_ptr, "Source"); return;
-      case MAIN_FILE: fprintf(file_ptr, "Main File"); return;
-      case MODULE_FILE: fprintf(file_ptr, "Module File"); return;
-      case MAIN_PART: fprintf(file_ptr, "Main Part"); return;
-      case MODULE_PART: fprintf(file_ptr, "Module Part"); return;
-      case SEQUENCE: fprintf(file_ptr, "Sequence"); return;
-      case MODULE_SEQUENCE: fprintf(file_ptr, "Module Sequence"); return;
-      case STATEMENT: fprintf(file_ptr, "Statement"); return;
-      case BRANCH: fprintf(file_ptr, "Branch"); return;
-      case IMPORTING: fprintf(file_ptr, "Import"); return;
-      case TYPE_ALIASING: fprintf(file_ptr, "Type Alias"); return;
-      case SUBPROGRAM: fprintf(file_ptr, "Subprogram"); return;
-      case MODULE_DECLARATION: fprintf(file_ptr, "Module Declaration"); return;
-      case DECLARATION: fprintf(file_ptr, "Declaration"); return;
-      case DESIGNATION: fprintf(file_ptr, "Designation"); return;
-      case CONTROL: fprintf(file_ptr, "Control"); return;
-      case IF_BLOCK: fprintf(file_ptr, "If-Block"); return;
-      case SWITCH_BLOCK: fprintf(file_ptr, "Switch-Block"); return;
-      case LOOP_BLOCK: fprintf(file_ptr, "Loop-Block"); return;
-      case FILE_IMPORT: fprintf(file_ptr, "Minimal Module Import"); return;
-      case M_FILE_IMPORT: fprintf(file_ptr, "Minimal Stdlib Import"); return;
-      case C_FILE_IMPORT: fprintf(file_ptr, "C Import"); return;
-      case TYPE_EXPR: fprintf(file_ptr, "Type Expression"); return;
-      case PARAM_LIST: fprintf(file_ptr, "Parameter List"); return;
-      case COLLECTION: fprintf(file_ptr, "Collection"); return;
-      case PRIMARY_EXPRESSION: fprintf(file_ptr, "Primary Expression"); return;
-      case ASSIGNMENT: fprintf(file_ptr, "Assignment"); return;
-      case INCREMENTATION: fprintf(file_ptr, "Incrementation"); return;
-      case IN_OUT_CTRL: fprintf(file_ptr, "Input/Output -Control"); return;
-      case FLOW_CTRL: fprintf(file_ptr, "Flow Control"); return;
-      case FUNC_CALL: fprintf(file_ptr, "Function Call"); return;
-      case ELIF_BLOCK: fprintf(file_ptr, "Else If -Block"); return;
-      case ELSE_BLOCK: fprintf(file_ptr, "Else-Block"); return;
-      case CASE_BLOCK: fprintf(file_ptr, "Case-Block"); return;
-      case FOR_LOOP: fprintf(file_ptr, "For-Loop"); return;
-      case WHILE_LOOP: fprintf(file_ptr, "While-Loop"); return;
-      case EXPRESSION: fprintf(file_ptr, "Expression"); return;
-      case INDEXING: fprintf(file_ptr, "Indexing"); return;
-      case SIZEOF: fprintf(file_ptr, "Sizeof"); return;
-      case ARGUMENT_LIST: fprintf(file_ptr, "Argument List"); return;
-      case LIST: fprintf(file_ptr, "List"); return;
-      case DICT: fprintf(file_ptr, "Associative Array"); return;
-      case ARITHMETIC_EXPR: fprintf(file_ptr, "Arithmetic Expression"); return;
-      case STRING_EXPR: fprintf(file_ptr, "String Expression"); return;
-      case LOGICAL_EXPR: fprintf(file_ptr, "Logical Expression"); return;
-      case ARITH_OPERAND: fprintf(file_ptr, "Arithmetic Operand"); return;
-      case STRING_OPERAND: fprintf(file_ptr, "String Operand"); return;
-      case LOGICAL_OPERAND: fprintf(file_ptr, "Logical Operand"); return;
-      default: fprintf(file_ptr, "Unclassifiable"); return;
-    }
-
-  } else {
+  const char *name = construct_category_name(construct, type);
+  if (name == NULL) {
     fprintf(file_ptr, "Invalid type!\n");
+    return;
   }
-  return;
+  fprintf(file_ptr, "%s", name);
 }
 
 /*
@@ -280,7 +217,8 @@ MiniSyntaxTree *alloc_syntax_tree(MiniStatus *status) {
 // A tree node is initialized with COPIED information
 // from a token, so that the tokens can be freed
 // without affecting the tree after the tree has been
-// generated. 
+// generated. The string representation is shared, and
+// the tree takes over freeing it (see MiniToken in_tree)
 MiniStatus init_syntax_tree(MiniSyntaxTree *tree, MiniGramCons *constr, MiniConsType type) {
   if (type == TOKEN) {
     //construct_type = MINITOK;
@@ -303,68 +241,201 @@ MiniStatus init_syntax_tree(MiniSyntaxTree *tree, MiniGramCons *constr, MiniCons
   tree->data_type = type;
   tree->child = NULL;
   tree->sibling = NULL;
+  tree->parent = NULL;
   return SUCCESS;
 }
 
 void add_node(MiniSyntaxTree *target_node, MiniSyntaxTree *new_node, MiniRelation relation) {
+  COUNT_WORK(1);
   if (relation == CHILD) {
     target_node->child = new_node;
+    new_node->parent = target_node;
   } else if (relation == SIBLING){
     target_node->sibling = new_node;
+    new_node->parent = target_node->parent;
   } else {
     return;
   }
   return;
 }
 
+// Frees the tree without recursion: a node with a child is rotated so that the child takes
+// its place and the node becomes the child's last sibling, until the first node in the
+// chain has no child and can be freed
 void free_syntax_tree(MiniSyntaxTree *tree) {
-  if (tree == NULL) {
-    return;
+  while (tree != NULL) {
+    MiniSyntaxTree *child = tree->child;
+    if (child != NULL) {
+      tree->child = child->sibling;
+      child->sibling = tree;
+      tree = child;
+      continue;
+    }
+    MiniSyntaxTree *sibling = tree->sibling;
+    if (tree->data_type == TOKEN) {
+      free(tree->data.token.string_repr);
+    }
+    free(tree);
+    tree = sibling;
   }
-  free_syntax_tree(tree->child);
-  free_syntax_tree(tree->sibling);
-  free(tree);
   return;
 }
 
-void print_syntax_tree(MiniSyntaxTree *tree, int indent_multiplier) {
-  if (tree == NULL) {
-    return;
+// Frees the nodes but not the token strings they share with the token list, for when the
+// tokens outlive the tree (reparsing)
+void free_syntax_tree_nodes(MiniSyntaxTree *tree) {
+  while (tree != NULL) {
+    MiniSyntaxTree *child = tree->child;
+    if (child != NULL) {
+      tree->child = child->sibling;
+      child->sibling = tree;
+      tree = child;
+      continue;
+    }
+    MiniSyntaxTree *sibling = tree->sibling;
+    free(tree);
+    tree = sibling;
   }
-  for (int i = 0; i < indent_multiplier * TREE_INDENT_WIDTH; i++) {
-    putchar(' ');
+}
+
+// The printers gather their output here and hand it to write() in large chunks
+#define TREE_OUTPUT_BUFFER_SIZE 65536
+#define TREE_STACK_INITIAL_CAPACITY 64
+
+typedef struct minimal_tree_output {
+  int fd;
+  size_t used;
+  char data[TREE_OUTPUT_BUFFER_SIZE];
+} MiniTreeOutput;
+
+// A node still to be printed and its indentation
+typedef struct minimal_tree_position {
+  MiniSyntaxTree *node;
+  int indent_multiplier;
+} MiniTreePosition;
+
+static void flush_tree_output(MiniTreeOutput *output) {
+  size_t written = 0;
+  while (written < output->used) {
+    ssize_t result = write(output->fd, output->data + written, output->used - written);
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      printf("flush_tree_output: Error: Failed to write the syntax tree\n");
+      break;
+    }
+    written += result;
   }
-  if (tree->data_type == TOKEN) {
-    printf("["); 
-    print_construct_category(tree->data.token.category, tree->data_type);
-    printf(": %s]\n", tree->data.token.string_repr);
-  } else {
-    printf("[");
-    print_construct_category(tree->data.non_terminal, tree->data_type);
-    printf("]\n");
+  output->used = 0;
+}
+
+static void append_tree_output(MiniTreeOutput *output, const char *bytes, size_t length) {
+  while (length > 0) {
+    if (output->used == TREE_OUTPUT_BUFFER_SIZE) {
+      flush_tree_output(output);
+    }
+    size_t chunk = TREE_OUTPUT_BUFFER_SIZE - output->used;
+    if (chunk > length) {
+      chunk = length;
+    }
+    memcpy(output->data + output->used, bytes, chunk);
+    output->used += chunk;
+    bytes += chunk;
+    length -= chunk;
   }
-  print_syntax_tree(tree->child, indent_multiplier + 1);
-  print_syntax_tree(tree->sibling, indent_multiplier);
-  return;
 }
 
-void file_print_syntax_tree(FILE *file_ptr, MiniSyntaxTree *tree, int indent_multiplier) {
-  if (tree == NULL) {
+static void append_tree_indentation(MiniTreeOutput *output, size_t width) {
+  while (width > 0) {
+    if (output->used == TREE_OUTPUT_BUFFER_SIZE) {
+      flush_tree_output(output);
+    }
+    size_t chunk = TREE_OUTPUT_BUFFER_SIZE - output->used;
+    if (chunk > width) {
+      chunk = width;
+    }
+    memset(output->data + output->used, ' ', chunk);
+    output->used += chunk;
+    width -= chunk;
+  }
+}
+
+static void append_tree_string(MiniTreeOutput *output, const char *string) {
+  append_tree_output(output, string, strlen(string));
+}
+
+// Pre-order walk with an explicit stack: a node's sibling is pushed before its child, so
+// the child's subtree is written first. The stack only holds siblings that are still due,
+// so it grows with the depth of the tree, not with its size
+static void write_syntax_tree(int fd, MiniSyntaxTree *tree, int indent_multiplier) {
+  MiniTreeOutput *output = malloc(sizeof(MiniTreeOutput));
+  MiniTreePosition initial_stack[TREE_STACK_INITIAL_CAPACITY];
+  MiniTreePosition *stack = initial_stack;
+  size_t capacity = TREE_STACK_INITIAL_CAPACITY;
+  size_t count = 0;
+  if (output == NULL) {
+    printf("write_syntax_tree: Memory Error: Failed to allocate space for the output buffer\n");
     return;
   }
-  for (int i = 0; i < indent_multiplier * TREE_INDENT_WIDTH; i++) {
-    fprintf(file_ptr, " ");
+  output->fd = fd;
+  output->used = 0;
+
+  if (tree != NULL) {
+    stack[count++] = (MiniTreePosition){tree, indent_multiplier};
   }
-  if (tree->data_type == TOKEN) {
-    fprintf(file_ptr, "["); 
-    file_print_construct_category(file_ptr, tree->data.token.category, tree->data_type);
-    fprintf(file_ptr, ": %s]\n", tree->data.token.string_repr);
-  } else {
-    fprintf(file_ptr, "[");
-    file_print_construct_category(file_ptr, tree->data.non_terminal, tree->data_type);
-    fprintf(file_ptr, "]\n");
+  while (count > 0) {
+    MiniTreePosition position = stack[--count];
+    MiniSyntaxTree *node = position.node;
+
+    append_tree_indentation(output, (size_t)position.indent_multiplier * TREE_INDENT_WIDTH);
+    append_tree_output(output, "[", 1);
+    if (node->data_type == TOKEN) {
+      append_tree_string(output, construct_category_name(node->data.token.category, TOKEN));
+      append_tree_output(output, ": ", 2);
+      append_tree_string(output, node->data.token.string_repr);
+    } else {
+      append_tree_string(output, construct_category_name(node->data.non_terminal, NON_TERMINAL));
+    }
+    append_tree_output(output, "]\n", 2);
+
+    if (count + 2 > capacity) {
+      MiniTreePosition *grown = malloc(2 * capacity * sizeof(MiniTreePosition));
+      if (grown == NULL) {
+        printf("write_syntax_tree: Memory Error: Failed to grow the traversal stack\n");
+        break;
+      }
+      memcpy(grown, stack, count * sizeof(MiniTreePosition));
+      if (stack != initial_stack) {
+        free(stack);
+      }
+      stack = grown;
+      capacity *= 2;
+    }
+    if (node->sibling != NULL) {
+      stack[count++] = (MiniTreePosition){node->sibling, position.indent_multiplier};
+    }
+    if (node->child != NULL) {
+      stack[count++] = (MiniTreePosition){node->child, position.indent_multiplier + 1};
+    }
+  }
+
+  flush_tree_output(output);
+  if (stack != initial_stack) {
+    free(stack);
   }
-  file_print_syntax_tree(file_ptr, tree->child, indent_multiplier + 1);
-  file_print_syntax_tree(file_ptr, tree->sibling, indent_multiplier);
+  free(output);
+}
+
+void print_syntax_tree(MiniSyntaxTree *tree, int indent_multiplier) {
+  // Whatever stdio still holds has to go out before the tree
+  fflush(stdout);
+  write_syntax_tree(STDOUT_FILENO, tree, indent_multiplier);
+  return;
+}
+
+void file_print_syntax_tree(FILE *file_ptr, MiniSyntaxTree *tree, int indent_multiplier) {
+  fflush(file_ptr);
+  write_syntax_tree(fileno(file_ptr), tree, indent_multiplier);
   return;
 }
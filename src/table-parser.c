@@ -0,0 +1,238 @@
+/* 
+  =======================================================================
+  This file is part of Minimal (mnml) - A *.mini source to C compiler for 
+  the Minimal programming language
+
+  Written in 2025 by approx-error
+
+  Minimal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Minimal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+  ======================================================================
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "inc/retcodes.h"
+#include "inc/tokens.h"
+#include "inc/syntax.h"
+#include "inc/parser-utils.h"
+#include "inc/ll-table.h"
+
+// Table-driven counterpart of parser.c (--table). The productions and the predict table
+// come from grammar/minimal.grammar, see the comment at the top of it for how the symbols
+// of a production end up in the syntax tree
+
+#define LL_STACK_INITIAL_CAPACITY 64
+
+// One production being expanded. prev and rel say where the next symbol goes: it is
+// added to prev with the relation rel
+typedef struct minimal_ll_frame {
+  uint16_t production;
+  uint16_t position;
+  bool propagate; // Hand prev and rel back to the parent frame when done (helper rules)
+  MiniSyntaxTree *prev;
+  MiniRelation rel;
+  MiniToken *start; // First token of a construct errors are recovered from, else NULL
+} MiniLLFrame;
+
+typedef struct minimal_ll_stack {
+  MiniLLFrame *frames;
+  size_t capacity;
+  size_t height;
+} MiniLLStack;
+
+static int terminal_index(MiniToken *token) {
+  if (last_token(token)) return LL_END_OF_INPUT;
+  return token_index(token->name);
+}
+
+static const char *describe_terminal(MiniToken *token) {
+  if (last_token(token)) return "end of input";
+  return desc_token(token->name);
+}
+
+// Name of the innermost rule being expanded that gets a node, for error messages
+static const char *enclosing_rule(MiniLLStack *stack) {
+  for (size_t i = stack->height; i > 0; i--) {
+    uint16_t lhs = ll_productions[stack->frames[i - 1].production].lhs;
+    if (ll_nonterms[lhs].node != NON_TERM_UNDETERMINED) {
+      return ll_nonterms[lhs].name;
+    }
+  }
+  return ll_nonterms[ll_start].name;
+}
+
+// Returns the production to expand nonterm with, or -1 if there is none
+static int predict(uint16_t nonterm, MiniToken *token) {
+  uint16_t entry = ll_predict[nonterm][terminal_index(token)];
+  if (entry & LL_SECOND_TOKEN) {
+    MiniToken *second = last_token(token) ? NULL : peek_token(token);
+    entry = ll_second_predict[entry & ~LL_SECOND_TOKEN][terminal_index(second)];
+  }
+  return (int) entry - 1;
+}
+
+// The constructs that parser.c recovers from errors in, as sequence() and module_sequence()
+// do. A block is skipped as a whole
+static bool recovers_errors(MiniNonTerm node, bool *block) {
+  switch (node) {
+    case STATEMENT:
+    case IMPORTING:
+    case TYPE_ALIASING:
+    case MODULE_DECLARATION:
+      *block = false;
+      return true;
+    case BRANCH:
+    case SUBPROGRAM:
+      *block = true;
+      return true;
+    default:
+      return false;
+  }
+}
+
+static MiniStatus push_frame(MiniLLStack *stack, uint16_t production, MiniSyntaxTree *prev, MiniRelation rel, bool propagate, MiniToken *start) {
+  if (stack->height == stack->capacity) {
+    size_t capacity = stack->capacity == 0 ? LL_STACK_INITIAL_CAPACITY : 2 * stack->capacity;
+    MiniLLFrame *frames = realloc(stack->frames, capacity * sizeof(MiniLLFrame));
+    if (frames == NULL) {
+      printf("table_parse: Memory Error: Failed to grow the parse stack\n");
+      return REALLOCATION_FAIL;
+    }
+    stack->frames = frames;
+    stack->capacity = capacity;
+  }
+  stack->frames[stack->height++] = (MiniLLFrame) {
+    .production = production, .position = 0, .propagate = propagate, .prev = prev, .rel = rel, .start = start
+  };
+  // Recovery goes back to start, so streaming mode has to keep it
+  if (start != NULL) mark_token(start);
+  return SUCCESS;
+}
+
+static void pop_frame(MiniLLStack *stack) {
+  MiniLLFrame *frame = &stack->frames[--stack->height];
+  if (frame->start != NULL) unmark_token(frame->start);
+}
+
+// Panic mode recovery: drops the frames of the innermost construct that recovers from
+// errors and skips its tokens with synchronize(). Returns PARSE_ERROR if there is no
+// such construct or synchronize() can't skip it
+static MiniStatus recover(MiniLLStack *stack, MiniToken **tok_carrier) {
+  while (stack->height > 0 && stack->frames[stack->height - 1].start == NULL) {
+    pop_frame(stack);
+  }
+  if (stack->height == 0) return PARSE_ERROR;
+
+  MiniLLFrame *frame = &stack->frames[stack->height - 1];
+  bool block = false;
+  recovers_errors(ll_nonterms[ll_productions[frame->production].lhs].node, &block);
+  MiniToken *start = frame->start;
+  MiniToken *after = start;
+  MiniStatus status = synchronize(start, block, &after);
+  pop_frame(stack);
+  // The construct's node stays in the tree, so the parent goes on after it as usual
+  if (status != VALID_CONSTRUCT) return PARSE_ERROR;
+  *tok_carrier = after;
+  return SUCCESS;
+}
+
+static MiniStatus run_table(MiniLLStack *stack, MiniSyntaxTree *root, MiniToken *current_token) {
+  MiniStatus status;
+  int production = predict(ll_start, current_token);
+  if (production < 0) {
+    parse_error("Invalid source specification: Should begin with %s or %s\n", desc_token(MODULE), desc_token(MAIN_DECLARATION));
+    return PARSE_ERROR;
+  }
+  // The root is the node of the start symbol
+  status = push_frame(stack, production, root, CHILD, false, NULL);
+  if (status != SUCCESS) return status;
+
+  while (stack->height > 0) {
+    COUNT_WORK(1);
+    MiniLLFrame *frame = &stack->frames[stack->height - 1];
+    const MiniGramProduction *prod = &ll_productions[frame->production];
+
+    if (frame->position == prod->length) {
+      pop_frame(stack);
+      if (frame->propagate) {
+        stack->frames[stack->height - 1].prev = frame->prev;
+        stack->frames[stack->height - 1].rel = frame->rel;
+      }
+      continue;
+    }
+
+    MiniGramSymbol symbol = ll_symbols[prod->first_symbol + frame->position];
+    frame->position++;
+    bool to_child = symbol & LL_CHILD_FLAG;
+    MiniRelation rel = to_child ? CHILD : frame->rel;
+    symbol &= LL_SYMBOL_MASK;
+
+    if (symbol < LL_NONTERM_BASE) {
+      if (terminal_index(current_token) != symbol) {
+        parse_error("Invalid %s: Unexpected %s\n", enclosing_rule(stack), describe_terminal(current_token));
+        if (recover(stack, &current_token) != SUCCESS) return PARSE_ERROR;
+        continue;
+      }
+      frame->prev = add_term_node(frame->prev, current_token, rel, &status);
+      if (status != SUCCESS) return status;
+      frame->rel = SIBLING;
+      current_token = next_token(current_token, &status);
+      continue;
+    }
+
+    uint16_t nonterm = symbol - LL_NONTERM_BASE;
+    production = predict(nonterm, current_token);
+    if (production < 0) {
+      parse_error("Invalid %s: Unexpected %s\n", enclosing_rule(stack), describe_terminal(current_token));
+      if (recover(stack, &current_token) != SUCCESS) return PARSE_ERROR;
+      continue;
+    }
+
+    MiniNonTerm node = ll_nonterms[nonterm].node;
+    if (node != NON_TERM_UNDETERMINED) {
+      MiniSyntaxTree *new_node = add_nonterm_node(frame->prev, node, rel, &status);
+      if (status != SUCCESS) return status;
+      frame->prev = new_node;
+      frame->rel = SIBLING;
+      bool block;
+      status = push_frame(stack, production, new_node, CHILD, false, recovers_errors(node, &block) ? current_token : NULL);
+    } else if (to_child) {
+      // A '>' helper leaves the place of the next symbol as it was
+      status = push_frame(stack, production, frame->prev, rel, false, NULL);
+    } else {
+      status = push_frame(stack, production, frame->prev, rel, true, NULL);
+    }
+    if (status != SUCCESS) return status;
+  }
+
+  if (!last_token(current_token)) {
+    parse_error("Extra token(s) following end of main part\n");
+    return PARSE_ERROR;
+  }
+  // Errors recovered from make the caller's status PARSE_ERROR
+  return VALID_CONSTRUCT;
+}
+
+MiniStatus table_parse(MiniSyntaxTree *root, MiniToken *first) {
+  MiniLLStack stack = {.frames = NULL, .capacity = 0, .height = 0};
+  MiniStatus status = run_table(&stack, root, first);
+  while (stack.height > 0) {
+    pop_frame(&stack);
+  }
+  free(stack.frames);
+  return status;
+}
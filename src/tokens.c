@@ -28,6 +28,10 @@
 #include "inc/tokens.h"
 #include "inc/retcodes.h"
 
+#ifdef MINIMAL_WORK_COUNT
+uint64_t mini_work_count = 0;
+#endif
+
 char *desc_token(MiniTokenName name) {
   switch (name) {
     case MINI_ID: return "Minimal identifier";
@@ -123,6 +127,57 @@ char *desc_token(MiniTokenName name) {
   }
 }
 
+// The last name of every block must be directly followed by the first name of the next one
+_Static_assert(MINIMAL_TOKEN_INDEX(C_ID) + 1 == MINIMAL_TOKEN_INDEX(VOID), "token index gap after C_ID");
+_Static_assert(MINIMAL_TOKEN_INDEX(CUSTOM_T) + 1 == MINIMAL_TOKEN_INDEX(IF), "token index gap after CUSTOM_T");
+_Static_assert(MINIMAL_TOKEN_INDEX(SWITCH) + 1 == MINIMAL_TOKEN_INDEX(LOOP), "token index gap after SWITCH");
+_Static_assert(MINIMAL_TOKEN_INDEX(LOOP) + 1 == MINIMAL_TOKEN_INDEX(END_MODULE), "token index gap after LOOP");
+_Static_assert(MINIMAL_TOKEN_INDEX(END_FUNC) + 1 == MINIMAL_TOKEN_INDEX(M_IMPORT), "token index gap after END_FUNC");
+_Static_assert(MINIMAL_TOKEN_INDEX(REDIRECT) + 1 == MINIMAL_TOKEN_INDEX(CALL), "token index gap after REDIRECT");
+_Static_assert(MINIMAL_TOKEN_INDEX(CONTINUE) + 1 == MINIMAL_TOKEN_INDEX(MODULE), "token index gap after CONTINUE");
+_Static_assert(MINIMAL_TOKEN_INDEX(MAIN_DECLARATION) + 1 == MINIMAL_TOKEN_INDEX(TRUE), "token index gap after MAIN_DECLARATION");
+_Static_assert(MINIMAL_TOKEN_INDEX(DEFAULT) + 1 == MINIMAL_TOKEN_INDEX(LEFT_PAREN), "token index gap after DEFAULT");
+_Static_assert(MINIMAL_TOKEN_INDEX(PERIOD) + 1 == MINIMAL_TOKEN_INDEX(PLUS), "token index gap after PERIOD");
+_Static_assert(MINIMAL_TOKEN_INDEX(POW) + 1 == MINIMAL_TOKEN_INDEX(SQRT), "token index gap after POW");
+_Static_assert(MINIMAL_TOKEN_INDEX(ADDRESS) + 1 == MINIMAL_TOKEN_INDEX(ASSIGN), "token index gap after ADDRESS");
+_Static_assert(MINIMAL_TOKEN_INDEX(MOD_ASSIGN) + 1 == MINIMAL_TOKEN_INDEX(INCREMENT), "token index gap after MOD_ASSIGN");
+_Static_assert(MINIMAL_TOKEN_INDEX(DECREMENT) + 1 == MINIMAL_TOKEN_INDEX(EQUALS), "token index gap after DECREMENT");
+_Static_assert(MINIMAL_TOKEN_INDEX(GREATER_EQUAL) + 1 == MINIMAL_TOKEN_INDEX(AND), "token index gap after GREATER_EQUAL");
+_Static_assert(MINIMAL_TOKEN_INDEX(OR) + 1 == MINIMAL_TOKEN_INDEX(NOT), "token index gap after OR");
+_Static_assert(MINIMAL_TOKEN_INDEX(NOT) + 1 == MINIMAL_TOKEN_INDEX(INT_LITERAL), "token index gap after NOT");
+_Static_assert(MINIMAL_TOKEN_INDEX(STRING_LITERAL) + 1 == MINIMAL_TOKEN_INDEX(IRRELEVANT), "token index gap after STRING_LITERAL");
+_Static_assert(MINIMAL_TOKEN_INDEX(IRRELEVANT) + 1 == MINIMAL_TOKEN_INDEX(NOT_DETERMINED), "token index gap after IRRELEVANT");
+_Static_assert(MINIMAL_TOKEN_INDEX(NOT_DETERMINED) + 1 == MINIMAL_TOKEN_INDEX_COUNT, "MINIMAL_TOKEN_INDEX_COUNT is out of date");
+
+#define B(block) MINIMAL_TOKEN_BLOCK_BASE(block)
+
+// Index of the first name of every block of 100 names, MINIMAL_TOKEN_INDEX_COUNT for unused blocks
+static const uint8_t token_block_base[NOT_DETERMINED / 100 + 1] = {
+  B(0), B(1), B(2), B(3), B(4), B(5), B(6), B(7),
+  B(8), B(9), B(10), B(11), B(12), B(13), B(14), B(15),
+  B(16), B(17), B(18), B(19), B(20), B(21), B(22), B(23),
+  B(24), B(25), B(26), B(27), B(28), B(29), B(30), B(31),
+  B(32), B(33), B(34), B(35), B(36), B(37), B(38), B(39),
+  B(40), B(41), B(42), B(43), B(44), B(45), B(46), B(47),
+  B(48), B(49), B(50), B(51), B(52), B(53), B(54), B(55),
+  B(56), B(57), B(58), B(59), B(60), B(61), B(62), B(63),
+  B(64), B(65), B(66), B(67), B(68), B(69), B(70), B(71),
+  B(72), B(73), B(74), B(75), B(76), B(77), B(78), B(79),
+  B(80), B(81), B(82), B(83), B(84), B(85), B(86), B(87),
+  B(88), B(89), B(90), B(91), B(92), B(93), B(94), B(95),
+  B(96), B(97), B(98), B(99), B(100)
+};
+
+#undef B
+
+// Dense index of a token name (see MINIMAL_TOKEN_INDEX), -1 if the name is not a valid token name
+int token_index(MiniTokenName name) {
+  if (name < 0 || name > NOT_DETERMINED) return -1;
+  int index = token_block_base[name / 100] + name % 100;
+  if (index >= MINIMAL_TOKEN_INDEX_COUNT) return -1;
+  return index;
+}
+
 
 MiniToken *alloc_token(MiniStatus *status) {
   MiniToken *token = malloc(sizeof(MiniToken));
@@ -145,23 +200,43 @@ MiniStatus init_token(MiniToken *token, char *string, int tok_category, int tok_
   strcpy(token->string_repr, string);
   token->category=tok_category;
   token->name = tok_name;
+  token->value.int_value = 0;
+  token->type_id = MINIMAL_NO_TYPE;
+  token->line = 0;
+  token->in_tree = false;
+  token->node = NULL;
+  token->mark_count = 0;
   token->next_token = NULL;
   return SUCCESS;
 }
 
 void add_token(MiniHeadToken *head_token, MiniToken *new_token) {
-  MiniToken *temp = head_token->head;
-  if (temp == NULL) {
+  if (head_token->head == NULL) {
     head_token->head = new_token;
   } else {
-    while (temp->next_token != NULL) {
-      temp = temp->next_token;
-    }
-    temp->next_token = new_token;
+    head_token->tail->next_token = new_token;
   }
+  head_token->tail = new_token;
   head_token->token_count++;
 }
 
+// Moves every token of tail_tokens to the end of head_token, leaving tail_tokens empty
+void append_tokens(MiniHeadToken *head_token, MiniHeadToken *tail_tokens) {
+  if (tail_tokens->head == NULL) {
+    return;
+  }
+  if (head_token->head == NULL) {
+    head_token->head = tail_tokens->head;
+  } else {
+    head_token->tail->next_token = tail_tokens->head;
+  }
+  head_token->tail = tail_tokens->tail;
+  head_token->token_count += tail_tokens->token_count;
+  tail_tokens->head = NULL;
+  tail_tokens->tail = NULL;
+  tail_tokens->token_count = 0;
+}
+
 bool last_token(MiniToken *current_token) {
   if (current_token == NULL) {
     return true;
@@ -170,17 +245,98 @@ bool last_token(MiniToken *current_token) {
   }
 }
 
+// Stream that next_token() pulls from once the parser reaches the end of the token list.
+// Thread local so that only the thread that attached the stream ever pulls from it
+static _Thread_local MiniTokenStream *attached_stream = NULL;
+// Line of the last token handed to the parser on this thread, for parse error messages
+static _Thread_local uint32_t reached_line = 0;
+
+static void free_token(MiniToken *token) {
+  if (!token->in_tree) {
+    free(token->string_repr);
+  }
+  token->string_repr = NULL;
+  free(token);
+}
+
+// Moves every token the lexer has queued so far to the end of the parser's window,
+// blocking until there is at least one. Returns false once the lexer is done
+static bool pull_tokens(MiniTokenStream *stream) {
+  MiniHeadToken *window = stream->window;
+  while (window->token_count > MINIMAL_TOKEN_LOOKBEHIND && window->head->mark_count == 0) {
+    MiniToken *oldest = window->head;
+    window->head = oldest->next_token;
+    window->token_count--;
+    free_token(oldest);
+  }
+
+  pthread_mutex_lock(&stream->lock);
+  while (stream->count == 0 && !stream->closed) {
+    pthread_cond_wait(&stream->not_empty, &stream->lock);
+  }
+  if (stream->count == 0) {
+    pthread_mutex_unlock(&stream->lock);
+    return false;
+  }
+  while (stream->count > 0) {
+    add_token(window, stream->ring[stream->first]);
+    stream->first = (stream->first + 1) & (MINIMAL_TOKEN_RING_SIZE - 1);
+    stream->count--;
+  }
+  pthread_cond_signal(&stream->not_full);
+  pthread_mutex_unlock(&stream->lock);
+  return true;
+}
+
+MiniToken *first_token(MiniHeadToken *head_token) {
+  if (head_token->head == NULL && attached_stream != NULL && attached_stream->window == head_token) {
+    pull_tokens(attached_stream);
+  }
+  if (head_token->head != NULL) {
+    reached_line = head_token->head->line;
+  }
+  return head_token->head;
+}
+
+// Returns the token after current_token or NULL if current_token is the last one
+MiniToken *peek_token(MiniToken *current_token) {
+  COUNT_WORK(1);
+  if (current_token->next_token == NULL && attached_stream != NULL && attached_stream->window->tail == current_token) {
+    pull_tokens(attached_stream);
+  }
+  return current_token->next_token;
+}
+
 MiniToken *next_token(MiniToken *current_token, MiniStatus *status) {
-  MiniToken *next = current_token->next_token;
+  MiniToken *next = peek_token(current_token);
   if (next == NULL) {
     //printf("DEBUG: next_token: Last token reached\n");
     *status = LAST_TOKEN;
     return NULL;
   }
   *status = SUCCESS;
+  reached_line = next->line;
   return next;
 }
 
+uint32_t reached_token_line(void) {
+  return reached_line;
+}
+
+// Only the window of a token stream reads the marks. Tokens are never marked without one,
+// so the threads of parse_parallel() don't write to tokens they may share
+void mark_token(MiniToken *token) {
+  if (attached_stream != NULL) {
+    token->mark_count++;
+  }
+}
+
+void unmark_token(MiniToken *token) {
+  if (attached_stream != NULL) {
+    token->mark_count--;
+  }
+}
+
 void print_tokens(MiniHeadToken *head_token) {
   MiniToken *temp = head_token->head;
   int counter = 0;
@@ -196,11 +352,145 @@ void free_tokens(MiniHeadToken *head_token) {
   MiniToken *temp = head_token->head;
   while (temp != NULL) {
     MiniToken *next = temp->next_token;
-    free(temp->string_repr);
-    temp->string_repr = NULL;
-    free(temp);
+    free_token(temp);
     temp = next;
   }
   head_token->head = NULL;
+  head_token->tail = NULL;
   head_token->token_count = 0;
 }
+
+// Replaces the tokens strictly between before and after with the tokens of replacement, which
+// is left empty. before == NULL stands for the start of the list and after == NULL for its end.
+// The replaced tokens are freed along with their strings whether they are in a tree or not,
+// so nodes copied from them have to be freed with free_syntax_tree_nodes()
+void splice_tokens(MiniHeadToken *head_token, MiniToken *before, MiniToken *after, MiniHeadToken *replacement) {
+  MiniToken *temp = (before == NULL) ? head_token->head : before->next_token;
+  while (temp != after) {
+    MiniToken *next = temp->next_token;
+    temp->in_tree = false;
+    free_token(temp);
+    head_token->token_count--;
+    temp = next;
+  }
+
+  MiniToken *first = after;
+  MiniToken *last = before;
+  if (replacement->head != NULL) {
+    first = replacement->head;
+    last = replacement->tail;
+    last->next_token = after;
+  }
+  if (before == NULL) {
+    head_token->head = first;
+  } else {
+    before->next_token = first;
+  }
+  if (after == NULL) {
+    head_token->tail = last;
+  }
+  head_token->token_count += replacement->token_count;
+  replacement->head = NULL;
+  replacement->tail = NULL;
+  replacement->token_count = 0;
+}
+
+MiniStatus init_token_stream(MiniTokenStream *stream, MiniHeadToken *window) {
+  stream->first = 0;
+  stream->count = 0;
+  stream->closed = false;
+  stream->draining = false;
+  stream->lex_status = SUCCESS;
+  stream->window = window;
+  if (pthread_mutex_init(&stream->lock, NULL) != 0) {
+    printf("init_token_stream: Thread Error: Failed to initialize token stream lock\n");
+    return THREAD_FAIL;
+  }
+  if (pthread_cond_init(&stream->not_empty, NULL) != 0) {
+    printf("init_token_stream: Thread Error: Failed to initialize token stream condition\n");
+    pthread_mutex_destroy(&stream->lock);
+    return THREAD_FAIL;
+  }
+  if (pthread_cond_init(&stream->not_full, NULL) != 0) {
+    printf("init_token_stream: Thread Error: Failed to initialize token stream condition\n");
+    pthread_cond_destroy(&stream->not_empty);
+    pthread_mutex_destroy(&stream->lock);
+    return THREAD_FAIL;
+  }
+  return SUCCESS;
+}
+
+// Called by the lexer thread. Moves every token of tokens into the ring, blocking while
+// the ring is full, and leaves tokens empty. Once the parser has stopped pulling the
+// tokens are freed instead
+void push_tokens(MiniTokenStream *stream, MiniHeadToken *tokens) {
+  MiniToken *token = tokens->head;
+  tokens->head = NULL;
+  tokens->tail = NULL;
+  tokens->token_count = 0;
+
+  pthread_mutex_lock(&stream->lock);
+  while (token != NULL && !stream->draining) {
+    while (stream->count == MINIMAL_TOKEN_RING_SIZE && !stream->draining) {
+      pthread_cond_signal(&stream->not_empty);
+      pthread_cond_wait(&stream->not_full, &stream->lock);
+    }
+    if (stream->draining) {
+      break;
+    }
+    MiniToken *next = token->next_token;
+    token->next_token = NULL;
+    stream->ring[(stream->first + stream->count) & (MINIMAL_TOKEN_RING_SIZE - 1)] = token;
+    stream->count++;
+    token = next;
+  }
+  pthread_cond_signal(&stream->not_empty);
+  pthread_mutex_unlock(&stream->lock);
+
+  while (token != NULL) {
+    MiniToken *next = token->next_token;
+    free_token(token);
+    token = next;
+  }
+}
+
+// Called by the lexer thread once it has pushed its last token or failed
+void close_token_stream(MiniTokenStream *stream, MiniStatus lex_status) {
+  pthread_mutex_lock(&stream->lock);
+  stream->closed = true;
+  stream->lex_status = lex_status;
+  pthread_cond_broadcast(&stream->not_empty);
+  pthread_mutex_unlock(&stream->lock);
+}
+
+// Makes next_token() on the calling thread pull from stream when it runs out of tokens.
+// A NULL stream detaches
+void attach_token_stream(MiniTokenStream *stream) {
+  attached_stream = stream;
+}
+
+// Whether the token list seen by the calling thread may still grow
+bool token_stream_attached(void) {
+  return attached_stream != NULL;
+}
+
+// Called by the parser when it is done. The lexer keeps running so that lexical errors
+// further on are still reported, but it frees its tokens instead of queueing them
+void drain_token_stream(MiniTokenStream *stream) {
+  pthread_mutex_lock(&stream->lock);
+  stream->draining = true;
+  pthread_cond_broadcast(&stream->not_full);
+  pthread_mutex_unlock(&stream->lock);
+}
+
+// Frees the tokens left in the ring. The lexer thread must have been joined
+void free_token_stream(MiniTokenStream *stream) {
+  while (stream->count > 0) {
+    free_token(stream->ring[stream->first]);
+    stream->first = (stream->first + 1) & (MINIMAL_TOKEN_RING_SIZE - 1);
+    stream->count--;
+  }
+  pthread_cond_destroy(&stream->not_full);
+  pthread_cond_destroy(&stream->not_empty);
+  pthread_mutex_destroy(&stream->lock);
+}
@@ -0,0 +1,641 @@
+/* 
+  =======================================================================
+  This file is part of Minimal (mnml) - A *.mini source to C compiler for 
+  the Minimal programming language
+
+  Written in 2025 by approx-error
+
+  Minimal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Minimal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+  ======================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "inc/retcodes.h"
+#include "inc/tokens.h"
+#include "inc/ast.h"
+#include "inc/semantic.h"
+
+// Marks in the canonical type table: the alias is being resolved (so meeting it again is a
+// cycle), or it can't be resolved because a type is not defined or an alias refers to itself
+#define CANONICAL_BUSY UINT32_MAX
+#define CANONICAL_UNDEFINED (UINT32_MAX - 1)
+#define CANONICAL_CYCLE (UINT32_MAX - 2)
+
+#define TYPE_TEXT_SIZE 64
+
+struct minimal_type_check {
+  // Types that literals and operators produce
+  MiniTypeId void_type;
+  MiniTypeId int_type;
+  MiniTypeId float_type;
+  MiniTypeId str_type;
+  MiniTypeId bool_type;
+  MiniTypeId stream_type;
+  MiniTypeId null_type; // <>^
+  // All indexed by type id and filled in by prepare_type_check(). aliases holds the type a
+  // custom type without pointers stands for, canonical the type with every alias in it
+  // replaced, and failed the type to name in the error when that can't be done
+  MiniTypeId *aliases;
+  MiniTypeId *canonical;
+  MiniTypeId *failed;
+  uint32_t capacity;
+  // The rest belongs to one walk, which works on its own copy of the prepared check
+  bool module_items; // Subprogram bodies are left out
+  MiniAstNode *subprogram; // The AST_SUBPROGRAM being walked, NULL in the main program
+  size_t typed_count;
+  MiniStatus status;
+};
+
+static MiniStatus reserve_type_slots(MiniTypeCheck *check, MiniTypeId id) {
+  if (id < check->capacity) {
+    return SUCCESS;
+  }
+  uint32_t capacity = check->capacity == 0 ? 64 : check->capacity;
+  while (capacity <= id) {
+    capacity *= 2;
+  }
+  MiniTypeId *aliases = realloc(check->aliases, capacity * sizeof(MiniTypeId));
+  if (aliases == NULL) {
+    printf("reserve_type_slots: Memory Error: Failed to reallocate memory for type aliases\n");
+    return REALLOCATION_FAIL;
+  }
+  check->aliases = aliases;
+  MiniTypeId *canonical = realloc(check->canonical, capacity * sizeof(MiniTypeId));
+  if (canonical == NULL) {
+    printf("reserve_type_slots: Memory Error: Failed to reallocate memory for canonical types\n");
+    return REALLOCATION_FAIL;
+  }
+  check->canonical = canonical;
+  MiniTypeId *failed = realloc(check->failed, capacity * sizeof(MiniTypeId));
+  if (failed == NULL) {
+    printf("reserve_type_slots: Memory Error: Failed to reallocate memory for failed types\n");
+    return REALLOCATION_FAIL;
+  }
+  check->failed = failed;
+  memset(aliases + check->capacity, 0, (capacity - check->capacity) * sizeof(MiniTypeId));
+  memset(canonical + check->capacity, 0, (capacity - check->capacity) * sizeof(MiniTypeId));
+  memset(failed + check->capacity, 0, (capacity - check->capacity) * sizeof(MiniTypeId));
+  check->capacity = capacity;
+  return SUCCESS;
+}
+
+// Writes the keyword of id into buffer for an error message. Long keywords are cut short
+static const char *type_text(MiniTypeId id, char *buffer, size_t size) {
+  memset(buffer, 0, size);
+  FILE *stream = fmemopen(buffer, size - 1, "w");
+  if (stream == NULL) {
+    return "<?>";
+  }
+  file_print_type(stream, id);
+  fclose(stream);
+  return buffer;
+}
+
+static bool is_kind(MiniTypeId id, MiniTokenName kind) {
+  const MiniType *type = get_type(id);
+  return type != NULL && type->kind == kind && type->pointer_depth == 0;
+}
+
+static bool is_numeric(MiniTypeId id) {
+  return is_kind(id, INT) || is_kind(id, FLOAT);
+}
+
+static bool is_pointer(MiniTypeId id) {
+  const MiniType *type = get_type(id);
+  return type != NULL && type->pointer_depth > 0;
+}
+
+// Whether a value of type from can go where a value of type to is expected. A missing type
+// belongs to something that couldn't be typed (an external name or an error reported
+// already) and goes anywhere
+static bool assignable(MiniTypeCheck *check, MiniTypeId from, MiniTypeId to) {
+  if (from == MINIMAL_NO_TYPE || to == MINIMAL_NO_TYPE || from == to) {
+    return true;
+  }
+  if (is_kind(to, FLOAT) && is_kind(from, INT)) {
+    return true;
+  }
+  // N and <>^ values go into any pointer, any pointer goes into <>^
+  if (is_pointer(to) && (from == check->null_type || to == check->null_type) && is_pointer(from)) {
+    return true;
+  }
+  return false;
+}
+
+// Works out the type id stands for once every custom type is replaced by its alias, for
+// prepare_type_check(). Nothing is reported here: undefined and self-referring aliases are
+// marked in canonical, with the type to name in failed, and reported where they are used
+static MiniTypeId resolve_canonical(MiniTypeCheck *check, MiniTypeId id) {
+  check->status = reserve_type_slots(check, id);
+  if (check->status != SUCCESS) return MINIMAL_NO_TYPE;
+  MiniTypeId cached = check->canonical[id];
+  if (cached == CANONICAL_BUSY) {
+    check->canonical[id] = CANONICAL_CYCLE;
+    check->failed[id] = id;
+    return MINIMAL_NO_TYPE;
+  }
+  if (cached == CANONICAL_UNDEFINED || cached == CANONICAL_CYCLE) {
+    return MINIMAL_NO_TYPE;
+  }
+  if (cached != MINIMAL_NO_TYPE) {
+    return cached;
+  }
+
+  const MiniType *type = get_type(id);
+  if (type->kind != CUSTOM_T) {
+    check->canonical[id] = id;
+    return id;
+  }
+  MiniTypeId base;
+  check->status = intern_pointer_type(id, 0, &base);
+  if (check->status != SUCCESS) return MINIMAL_NO_TYPE;
+  check->status = reserve_type_slots(check, base);
+  if (check->status != SUCCESS) return MINIMAL_NO_TYPE;
+  MiniTypeId alias = check->aliases[base];
+  if (alias == MINIMAL_NO_TYPE) {
+    check->canonical[id] = CANONICAL_UNDEFINED;
+    check->failed[id] = base;
+    return MINIMAL_NO_TYPE;
+  }
+
+  check->canonical[id] = CANONICAL_BUSY;
+  MiniTypeId result = resolve_canonical(check, alias);
+  if (result != MINIMAL_NO_TYPE) {
+    // <status>^ where <status> is <#> is <#>^
+    check->status = intern_pointer_type(result, get_type(result)->pointer_depth + type->pointer_depth, &result);
+  }
+  if (check->status != SUCCESS) return MINIMAL_NO_TYPE;
+  if (check->canonical[id] == CANONICAL_BUSY) {
+    if (result == MINIMAL_NO_TYPE) {
+      // Failed further along the aliases, which decides the error
+      check->canonical[id] = check->canonical[alias];
+      check->failed[id] = check->failed[alias];
+    } else {
+      check->canonical[id] = result;
+    }
+  }
+  return result;
+}
+
+// The type id stands for once every custom type is replaced by its alias, or
+// MINIMAL_NO_TYPE if there is none, which is reported at node
+static MiniTypeId canonical_type(MiniTypeCheck *check, MiniTypeId id, MiniAstNode *node) {
+  if (id == MINIMAL_NO_TYPE || check->status != SUCCESS) {
+    return MINIMAL_NO_TYPE;
+  }
+  // Types interned after the preparation come from canonical types and have no aliases
+  if (id >= check->capacity || check->canonical[id] == MINIMAL_NO_TYPE) {
+    return id;
+  }
+  char text[TYPE_TEXT_SIZE];
+  switch (check->canonical[id]) {
+    case CANONICAL_UNDEFINED:
+      semantic_error_once(node, "Type %s is not defined", type_text(check->failed[id], text, sizeof(text)));
+      return MINIMAL_NO_TYPE;
+    case CANONICAL_CYCLE:
+      semantic_error_once(node, "Type alias %s refers to itself", type_text(check->failed[id], text, sizeof(text)));
+      return MINIMAL_NO_TYPE;
+    default:
+      return check->canonical[id];
+  }
+}
+
+static MiniTypeId literal_type(MiniTypeCheck *check, MiniTokenName name) {
+  switch (name) {
+    case INT_LITERAL: return check->int_type;
+    case FLOAT_LITERAL: return check->float_type;
+    case STRING_LITERAL: return check->str_type;
+    case TRUE:
+    case FALSE: return check->bool_type;
+    case NUL: return check->null_type;
+    case STDIO: return check->stream_type;
+    default: return MINIMAL_NO_TYPE;
+  }
+}
+
+// Type of what a name refers to: a variable, constant or parameter. Subprograms and
+// unresolved names have none
+static MiniTypeId declared_type(MiniTypeCheck *check, MiniAstNode *node) {
+  MiniAstNode *declaration = node->declaration;
+  if (declaration == NULL || declaration->kind == AST_SUBPROGRAM) {
+    return MINIMAL_NO_TYPE;
+  }
+  return canonical_type(check, declaration->type_id, node);
+}
+
+// Values of a list or dict literal must each be one of the member types of the collection
+static bool is_member(MiniTypeCheck *check, MiniTypeId id, const MiniType *collection, uint32_t first, uint32_t end) {
+  for (uint32_t i = first; i < end; i++) {
+    if (assignable(check, id, collection->members[i])) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void check_collection(MiniTypeCheck *check, MiniAstNode *value, MiniTypeId expected) {
+  if (expected == MINIMAL_NO_TYPE) {
+    return;
+  }
+  const MiniType *type = get_type(expected);
+  MiniTokenName kind = value->kind == AST_LIST ? LIST_T : DICT_T;
+  char given[TYPE_TEXT_SIZE];
+  char wanted[TYPE_TEXT_SIZE];
+  if (type->kind != kind || type->pointer_depth > 0) {
+    semantic_error(value, "%s where %s is expected", kind == LIST_T ? "List" : "Associative array", type_text(expected, wanted, sizeof(wanted)));
+    return;
+  }
+  value->type_id = expected;
+  for (MiniAstNode *item = value->list; item != NULL; item = item->next) {
+    if (kind == LIST_T && !is_member(check, item->type_id, type, 0, type->member_count)) {
+      semantic_error(item, "List element of type %s in %s", type_text(item->type_id, given, sizeof(given)), type_text(expected, wanted, sizeof(wanted)));
+    } else if (kind == DICT_T) {
+      MiniAstNode *key = item->operands[0];
+      MiniAstNode *element = item->operands[1];
+      if (!is_member(check, key->type_id, type, 0, type->key_count)) {
+        semantic_error(key, "Key of type %s in %s", type_text(key->type_id, given, sizeof(given)), type_text(expected, wanted, sizeof(wanted)));
+      }
+      if (!is_member(check, element->type_id, type, type->key_count, type->member_count)) {
+        semantic_error(element, "Value of type %s in %s", type_text(element->type_id, given, sizeof(given)), type_text(expected, wanted, sizeof(wanted)));
+      }
+    }
+  }
+}
+
+// Checks value, which goes where a value of type expected goes. Collection literals get
+// their type from there
+static void check_value(MiniTypeCheck *check, MiniAstNode *value, MiniTypeId expected) {
+  if (value->kind == AST_LIST || value->kind == AST_DICT) {
+    check_collection(check, value, expected);
+    return;
+  }
+  if (!assignable(check, value->type_id, expected)) {
+    char given[TYPE_TEXT_SIZE];
+    char wanted[TYPE_TEXT_SIZE];
+    semantic_error(value, "Value of type %s where %s is expected", type_text(value->type_id, given, sizeof(given)), type_text(expected, wanted, sizeof(wanted)));
+  }
+}
+
+static void check_condition(MiniAstNode *condition) {
+  if (condition->type_id != MINIMAL_NO_TYPE && !is_kind(condition->type_id, BOOL) && !is_pointer(condition->type_id)) {
+    char given[TYPE_TEXT_SIZE];
+    semantic_error(condition, "Condition of type %s is neither <B> nor a pointer", type_text(condition->type_id, given, sizeof(given)));
+  }
+}
+
+static void check_call(MiniTypeCheck *check, MiniAstNode *call) {
+  MiniAstNode *subprogram = call->declaration;
+  if (subprogram == NULL || subprogram->kind != AST_SUBPROGRAM) {
+    return;
+  }
+  int parameter_count = 0;
+  int argument_count = 0;
+  MiniAstNode *parameter = subprogram->operands[0];
+  for (MiniAstNode *argument = call->list; argument != NULL; argument = argument->next) {
+    if (parameter != NULL) {
+      check_value(check, argument, canonical_type(check, parameter->type_id, argument));
+      parameter = parameter->next;
+      parameter_count++;
+    }
+    argument_count++;
+  }
+  for (; parameter != NULL; parameter = parameter->next) {
+    parameter_count++;
+  }
+  if (argument_count != parameter_count) {
+    semantic_error(call, "%s takes %d argument(s) but is given %d", call->token.string_repr, parameter_count, argument_count);
+  }
+  call->type_id = canonical_type(check, subprogram->type_id, call);
+}
+
+static MiniTypeId arithmetic_type(MiniTypeCheck *check, MiniAstNode *node, MiniTypeId left, MiniTypeId right) {
+  if (left == MINIMAL_NO_TYPE || right == MINIMAL_NO_TYPE) {
+    return MINIMAL_NO_TYPE;
+  }
+  if (!is_numeric(left) || !is_numeric(right) || (node->op == MOD && (!is_kind(left, INT) || !is_kind(right, INT)))) {
+    char first[TYPE_TEXT_SIZE];
+    char second[TYPE_TEXT_SIZE];
+    semantic_error(node, "Operands of type %s and %s for %s", type_text(left, first, sizeof(first)), type_text(right, second, sizeof(second)), desc_token(node->op));
+    return MINIMAL_NO_TYPE;
+  }
+  return is_kind(left, FLOAT) || is_kind(right, FLOAT) ? check->float_type : check->int_type;
+}
+
+static MiniTypeId binary_type(MiniTypeCheck *check, MiniAstNode *node) {
+  MiniTypeId left = node->operands[0]->type_id;
+  MiniTypeId right = node->operands[1]->type_id;
+  char first[TYPE_TEXT_SIZE];
+  char second[TYPE_TEXT_SIZE];
+  switch (node->op) {
+    case PLUS:
+    case MINUS:
+    case TIMES:
+    case DIV:
+    case MOD:
+    case POW:
+      return arithmetic_type(check, node, left, right);
+    case EQUALS:
+    case NOT_EQUAL:
+      if (!assignable(check, left, right) && !assignable(check, right, left)) {
+        semantic_error(node, "Values of type %s and %s can't be compared", type_text(left, first, sizeof(first)), type_text(right, second, sizeof(second)));
+      }
+      return check->bool_type;
+    case LESS_THAN:
+    case GREATER_THAN:
+    case LESS_EQUAL:
+    case GREATER_EQUAL:
+      arithmetic_type(check, node, left, right);
+      return check->bool_type;
+    case AND:
+    case OR:
+      if ((left != MINIMAL_NO_TYPE && !is_kind(left, BOOL)) || (right != MINIMAL_NO_TYPE && !is_kind(right, BOOL))) {
+        semantic_error(node, "Operands of type %s and %s for %s", type_text(left, first, sizeof(first)), type_text(right, second, sizeof(second)), desc_token(node->op));
+      }
+      return check->bool_type;
+    default:
+      return MINIMAL_NO_TYPE;
+  }
+}
+
+static MiniTypeId unary_type(MiniTypeCheck *check, MiniAstNode *node) {
+  MiniTypeId operand = node->operands[0]->type_id;
+  if (operand == MINIMAL_NO_TYPE) {
+    return MINIMAL_NO_TYPE;
+  }
+  const MiniType *type = get_type(operand);
+  MiniTypeId result = MINIMAL_NO_TYPE;
+  bool valid = true;
+  switch (node->op) {
+    case PLUS:
+    case MINUS:
+      valid = is_numeric(operand);
+      result = operand;
+      break;
+    case SQRT:
+      valid = is_numeric(operand);
+      result = check->float_type;
+      break;
+    case NOT:
+      valid = is_kind(operand, BOOL);
+      result = check->bool_type;
+      break;
+    case DEREFERENCE:
+      valid = type->pointer_depth > 0 && operand != check->null_type;
+      if (valid) {
+        check->status = intern_pointer_type(operand, type->pointer_depth - 1, &result);
+      }
+      break;
+    case ADDRESS:
+      check->status = intern_pointer_type(operand, type->pointer_depth + 1, &result);
+      break;
+    default:
+      break;
+  }
+  if (!valid) {
+    char text[TYPE_TEXT_SIZE];
+    semantic_error(node, "Operand of type %s for %s", type_text(operand, text, sizeof(text)), desc_token(node->op));
+    return MINIMAL_NO_TYPE;
+  }
+  return result;
+}
+
+static void check_increment(MiniTypeCheck *check, MiniAstNode *node) {
+  MiniTypeId target = declared_type(check, node);
+  if (target == MINIMAL_NO_TYPE) {
+    return;
+  }
+  char text[TYPE_TEXT_SIZE];
+  if (!is_numeric(target) || (node->op == MOD_ASSIGN && !is_kind(target, INT))) {
+    semantic_error(node, "%s of type %s for %s", node->token.string_repr, type_text(target, text, sizeof(text)), desc_token(node->op));
+    return;
+  }
+  if (node->operands[0] != NULL) {
+    check_value(check, node->operands[0], target);
+  }
+}
+
+static void check_return(MiniTypeCheck *check, MiniAstNode *node) {
+  // The main program returns its exit code
+  MiniTypeId expected = check->int_type;
+  if (check->subprogram != NULL) {
+    expected = canonical_type(check, check->subprogram->type_id, check->subprogram);
+  }
+  MiniAstNode *value = node->operands[0];
+  char text[TYPE_TEXT_SIZE];
+  if (expected == check->void_type && value != NULL) {
+    semantic_error(node, "Value returned from %s, which returns <>", check->subprogram->token.string_repr);
+  } else if (expected != check->void_type && expected != MINIMAL_NO_TYPE && value == NULL) {
+    semantic_error(node, "Return without a value of type %s", type_text(expected, text, sizeof(text)));
+  } else if (value != NULL) {
+    check_value(check, value, expected);
+  }
+}
+
+// Case labels are int or string literals or names, which must match the value switched on.
+// A switch on a value without a type takes labels of either
+static void check_switch(MiniTypeCheck *check, MiniAstNode *node) {
+  MiniTypeId value = node->operands[0]->type_id;
+  char text[TYPE_TEXT_SIZE];
+  if (value != MINIMAL_NO_TYPE && !is_kind(value, INT) && !is_kind(value, STR)) {
+    semantic_error(node->operands[0], "Switch on a value of type %s instead of <#> or <\">", type_text(value, text, sizeof(text)));
+    return;
+  }
+  for (MiniAstNode *case_node = node->list; case_node != NULL; case_node = case_node->next) {
+    if (case_node->token.name == DEFAULT) {
+      continue;
+    }
+    MiniTypeId label = case_node->token.category == IDENTIFIER ? declared_type(check, case_node) : literal_type(check, case_node->token.name);
+    case_node->type_id = label;
+    if (value != MINIMAL_NO_TYPE && !assignable(check, label, value)) {
+      char expected[TYPE_TEXT_SIZE];
+      semantic_error(case_node, "Case label of type %s instead of %s", type_text(label, text, sizeof(text)), type_text(value, expected, sizeof(expected)));
+    } else if (value == MINIMAL_NO_TYPE && label != MINIMAL_NO_TYPE && !is_kind(label, INT) && !is_kind(label, STR)) {
+      semantic_error(case_node, "Case label of type %s instead of <#> or <\">", type_text(label, text, sizeof(text)));
+    }
+  }
+}
+
+static MiniVisitAction enter_typed_node(MiniAstNode *node, int depth, void *context) {
+  (void) depth;
+  MiniTypeCheck *check = context;
+  if (node->kind == AST_SUBPROGRAM) {
+    if (check->module_items) {
+      return VISIT_SKIP;
+    }
+    check->subprogram = node;
+    canonical_type(check, node->type_id, node);
+  }
+  return VISIT_CONTINUE;
+}
+
+// Every operand has its type by the time the node using it is left
+static MiniVisitAction leave_typed_node(MiniAstNode *node, int depth, void *context) {
+  (void) depth;
+  MiniTypeCheck *check = context;
+  switch (node->kind) {
+    case AST_LITERAL:
+      node->type_id = literal_type(check, node->token.name);
+      break;
+    case AST_NAME:
+      node->type_id = declared_type(check, node);
+      break;
+    case AST_CALL:
+      check_call(check, node);
+      break;
+    case AST_BINARY:
+      node->type_id = binary_type(check, node);
+      break;
+    case AST_UNARY:
+      node->type_id = unary_type(check, node);
+      break;
+    case AST_PARAMETER:
+      canonical_type(check, node->type_id, node);
+      break;
+    case AST_DECLARATION:
+      if (node->operands[0] != NULL) {
+        check_value(check, node->operands[0], canonical_type(check, node->type_id, node));
+      } else {
+        canonical_type(check, node->type_id, node);
+      }
+      break;
+    case AST_ASSIGNMENT:
+      check_value(check, node->operands[0], declared_type(check, node));
+      break;
+    case AST_INCREMENT:
+      check_increment(check, node);
+      break;
+    case AST_RETURN:
+      check_return(check, node);
+      break;
+    case AST_IF:
+    case AST_WHILE:
+      check_condition(node->operands[0]);
+      break;
+    case AST_FOR:
+      check_condition(node->operands[1]);
+      break;
+    case AST_SWITCH:
+      check_switch(check, node);
+      break;
+    case AST_SUBPROGRAM:
+      check->subprogram = NULL;
+      break;
+    default:
+      break;
+  }
+  if (node->type_id != MINIMAL_NO_TYPE && node->kind != AST_DECLARATION && node->kind != AST_PARAMETER && node->kind != AST_SUBPROGRAM) {
+    check->typed_count++;
+  }
+  if (check->status != SUCCESS) {
+    return VISIT_STOP;
+  }
+  return VISIT_CONTINUE;
+}
+
+// Type aliases are visible everywhere, whichever module declares them
+static void collect_aliases(MiniTypeCheck *check, MiniAst *ast) {
+  for (MiniAstNode *file = ast->root->list; file != NULL && check->status == SUCCESS; file = file->next) {
+    MiniAstNode *module = file->kind == AST_MAIN ? file->operands[0] : file;
+    if (module == NULL || module->kind != AST_MODULE) {
+      continue;
+    }
+    for (MiniAstNode *item = module->list; item != NULL; item = item->next) {
+      if (item->kind != AST_TYPE_ALIAS) {
+        continue;
+      }
+      MiniTypeId custom = item->token.type_id;
+      check->status = reserve_type_slots(check, custom);
+      if (check->status != SUCCESS) return;
+      MiniTypeId previous = check->aliases[custom];
+      if (previous != MINIMAL_NO_TYPE && previous != item->type_id) {
+        char text[TYPE_TEXT_SIZE];
+        semantic_error(item, "%s is already an alias of %s", item->token.string_repr, type_text(previous, text, sizeof(text)));
+        continue;
+      }
+      check->aliases[custom] = item->type_id;
+    }
+  }
+}
+
+static MiniStatus intern_basic_types(MiniTypeCheck *check) {
+  char *keywords[] = {"<>", "<#>", "<%>", "<\">", "<B>", "<S>", "<>^"};
+  MiniTypeId *ids[] = {&check->void_type, &check->int_type, &check->float_type, &check->str_type, &check->bool_type, &check->stream_type, &check->null_type};
+  for (size_t i = 0; i < sizeof(ids) / sizeof(ids[0]); i++) {
+    MiniStatus status = intern_type_keyword(keywords[i], ids[i]);
+    if (status != SUCCESS) return status;
+  }
+  return SUCCESS;
+}
+
+MiniStatus prepare_type_check(MiniAst *ast, MiniTypeCheck **check_out) {
+  MiniTypeCheck *check = calloc(1, sizeof(MiniTypeCheck));
+  if (check == NULL) {
+    printf("prepare_type_check: Memory Error: Failed to allocate memory for the type check\n");
+    return ALLOCATION_FAIL;
+  }
+  check->status = intern_basic_types(check);
+  if (check->status == SUCCESS) {
+    collect_aliases(check, ast);
+  }
+  // Resolving a type can intern new ones, which are resolved as the loop gets to them
+  for (MiniTypeId id = 1; id <= last_type_id() && check->status == SUCCESS; id++) {
+    resolve_canonical(check, id);
+  }
+  MiniStatus status = check->status;
+  if (status != SUCCESS) {
+    free_type_check(check);
+    return status;
+  }
+  *check_out = check;
+  return SUCCESS;
+}
+
+static MiniStatus walk_typed(const MiniTypeCheck *prepared, MiniAstNode *root, bool module_items, size_t *typed_count) {
+  MiniTypeCheck check = *prepared;
+  check.module_items = module_items;
+  check.subprogram = NULL;
+  check.typed_count = 0;
+  check.status = SUCCESS;
+  MiniAstVisitor visitor = {enter_typed_node, leave_typed_node, &check};
+  MiniStatus status = walk_ast(root, &visitor);
+  *typed_count += check.typed_count;
+  return status != SUCCESS ? status : check.status;
+}
+
+MiniStatus check_module_types(const MiniTypeCheck *check, MiniAstNode *module, size_t *typed_count) {
+  return walk_typed(check, module, true, typed_count);
+}
+
+MiniStatus check_body_types(const MiniTypeCheck *check, MiniAstNode *body, size_t *typed_count) {
+  if (body->kind == AST_SUBPROGRAM) {
+    return walk_typed(check, body, false, typed_count);
+  }
+  for (MiniAstNode *statement = body->list; statement != NULL; statement = statement->next) {
+    MiniStatus status = walk_typed(check, statement, false, typed_count);
+    if (status != SUCCESS) return status;
+  }
+  return SUCCESS;
+}
+
+void free_type_check(MiniTypeCheck *check) {
+  free(check->aliases);
+  free(check->canonical);
+  free(check->failed);
+  free(check);
+}
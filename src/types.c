@@ -0,0 +1,462 @@
+/* 
+  =======================================================================
+  This file is part of Minimal (mnml) - A *.mini source to C compiler for 
+  the Minimal programming language
+
+  Written in 2025 by approx-error
+
+  Minimal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Minimal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+  ======================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include <pthread.h>
+#include "inc/tokens.h"
+#include "inc/retcodes.h"
+
+// Types are stored in fixed size pages that are never moved, so a MiniType pointer
+// returned by get_type() stays valid while other threads keep interning new types
+#define TYPE_PAGE_SIZE 256
+#define MAX_TYPE_PAGES 4096
+
+static MiniType *type_pages[MAX_TYPE_PAGES];
+static uint32_t type_count = 0;
+
+// Open addressing hash index from a type's structure to its id. 0 marks an empty slot
+static MiniTypeId *type_index = NULL;
+static size_t type_index_capacity = 0;
+
+// Types are interned from the stream lexer thread while the parser runs, and from the
+// threads of check_bodies_parallel(). The ids the latter get depend on how the threads are
+// scheduled, so ids are only compared and outputs name types by keyword (file_print_type())
+static pthread_mutex_t type_table_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static MiniType *type_slot(MiniTypeId id) {
+  return &type_pages[(id - 1) / TYPE_PAGE_SIZE][(id - 1) % TYPE_PAGE_SIZE];
+}
+
+static uint64_t hash_bytes(uint64_t hash, const void *bytes, size_t length) {
+  const unsigned char *byte = bytes;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= byte[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+static uint64_t hash_type(const MiniType *type) {
+  uint64_t hash = 14695981039346656037ULL;
+  hash = hash_bytes(hash, &type->kind, sizeof(type->kind));
+  hash = hash_bytes(hash, &type->pointer_depth, sizeof(type->pointer_depth));
+  hash = hash_bytes(hash, &type->key_count, sizeof(type->key_count));
+  hash = hash_bytes(hash, type->members, type->member_count * sizeof(MiniTypeId));
+  if (type->name != NULL) {
+    hash = hash_bytes(hash, type->name, strlen(type->name));
+  }
+  return hash;
+}
+
+static bool same_type(const MiniType *first, const MiniType *second) {
+  if (first->hash != second->hash || first->kind != second->kind ||
+      first->pointer_depth != second->pointer_depth || first->member_count != second->member_count ||
+      first->key_count != second->key_count) {
+    return false;
+  }
+  if (first->member_count > 0 && memcmp(first->members, second->members, first->member_count * sizeof(MiniTypeId)) != 0) {
+    return false;
+  }
+  if (first->name == NULL || second->name == NULL) {
+    return first->name == second->name;
+  }
+  return strcmp(first->name, second->name) == 0;
+}
+
+static void insert_index(MiniTypeId id) {
+  size_t mask = type_index_capacity - 1;
+  size_t slot = type_slot(id)->hash & mask;
+  while (type_index[slot] != MINIMAL_NO_TYPE) {
+    slot = (slot + 1) & mask;
+  }
+  type_index[slot] = id;
+}
+
+static MiniStatus grow_index(void) {
+  size_t capacity = type_index_capacity == 0 ? 64 : type_index_capacity * 2;
+  MiniTypeId *index = calloc(capacity, sizeof(MiniTypeId));
+  if (index == NULL) {
+    printf("grow_index: Memory Error: Failed to allocate memory for type index\n");
+    return ALLOCATION_FAIL;
+  }
+  free(type_index);
+  type_index = index;
+  type_index_capacity = capacity;
+  for (MiniTypeId id = 1; id <= type_count; id++) {
+    insert_index(id);
+  }
+  return SUCCESS;
+}
+
+// Returns the id of the type structurally equal to candidate, adding a copy of candidate
+// to the table if there is none yet
+static MiniStatus intern_type(MiniType *candidate, MiniTypeId *id) {
+  candidate->hash = hash_type(candidate);
+
+  pthread_mutex_lock(&type_table_lock);
+  if (type_index_capacity > 0) {
+    size_t mask = type_index_capacity - 1;
+    size_t slot = candidate->hash & mask;
+    while (type_index[slot] != MINIMAL_NO_TYPE) {
+      if (same_type(type_slot(type_index[slot]), candidate)) {
+        *id = type_index[slot];
+        pthread_mutex_unlock(&type_table_lock);
+        return SUCCESS;
+      }
+      slot = (slot + 1) & mask;
+    }
+  }
+
+  if (type_count == MAX_TYPE_PAGES * TYPE_PAGE_SIZE) {
+    printf("intern_type: Error: Too many distinct types, maximum is %d\n", MAX_TYPE_PAGES * TYPE_PAGE_SIZE);
+    pthread_mutex_unlock(&type_table_lock);
+    return ALLOCATION_FAIL;
+  }
+  if ((type_count + 1) * 2 > type_index_capacity) {
+    MiniStatus status = grow_index();
+    if (status != SUCCESS) {
+      pthread_mutex_unlock(&type_table_lock);
+      return status;
+    }
+  }
+  size_t page = type_count / TYPE_PAGE_SIZE;
+  if (type_pages[page] == NULL) {
+    type_pages[page] = malloc(TYPE_PAGE_SIZE * sizeof(MiniType));
+    if (type_pages[page] == NULL) {
+      printf("intern_type: Memory Error: Failed to allocate memory for type table\n");
+      pthread_mutex_unlock(&type_table_lock);
+      return ALLOCATION_FAIL;
+    }
+  }
+
+  MiniType entry = *candidate;
+  entry.members = NULL;
+  entry.name = NULL;
+  if (candidate->member_count > 0) {
+    entry.members = malloc(candidate->member_count * sizeof(MiniTypeId));
+    if (entry.members == NULL) {
+      printf("intern_type: Memory Error: Failed to allocate memory for type members\n");
+      pthread_mutex_unlock(&type_table_lock);
+      return ALLOCATION_FAIL;
+    }
+    memcpy(entry.members, candidate->members, candidate->member_count * sizeof(MiniTypeId));
+  }
+  if (candidate->name != NULL) {
+    entry.name = malloc((strlen(candidate->name) + 1) * sizeof(char));
+    if (entry.name == NULL) {
+      printf("intern_type: Memory Error: Failed to allocate memory for type name\n");
+      free(entry.members);
+      pthread_mutex_unlock(&type_table_lock);
+      return ALLOCATION_FAIL;
+    }
+    strcpy(entry.name, candidate->name);
+  }
+
+  type_count++;
+  *type_slot(type_count) = entry;
+  insert_index(type_count);
+  *id = type_count;
+  pthread_mutex_unlock(&type_table_lock);
+  return SUCCESS;
+}
+
+static MiniStatus intern_basic_type(MiniTokenName kind, uint32_t pointer_depth, MiniTypeId *id) {
+  MiniType candidate = {.kind = kind, .pointer_depth = pointer_depth, .member_count = 0, .key_count = 0, .members = NULL, .name = NULL};
+  return intern_type(&candidate, id);
+}
+
+// Basic type denoted by a single symbol inside a type keyword
+static MiniTokenName member_kind(char symbol) {
+  switch (symbol) {
+    case '#':
+      return INT;
+    case '%':
+      return FLOAT;
+    case '"':
+      return STR;
+    case 'B':
+      return BOOL;
+    case 'S':
+      return STREAM;
+    default:
+      return TOKEN_UNDETERMINED;
+  }
+}
+
+// Whether the first length characters of keyword open and close with matching symbols
+static bool closed_keyword(char *keyword, size_t length) {
+  const char *begin = strchr(MINIMAL_VAR_KW_BEGIN_SYMBOLS, keyword[0]);
+  if (length < 2 || keyword[0] == '\0' || begin == NULL) {
+    return false;
+  }
+  return keyword[length - 1] == MINIMAL_VAR_KW_END_SYMBOLS[begin - MINIMAL_VAR_KW_BEGIN_SYMBOLS];
+}
+
+// Whether the first length characters of keyword are spelled the way the lexer accepts a
+// type keyword (is_type_keyword() in lexer.c), with only MINIMAL_VAR_KW_MID_SYMBOLS
+// between the begin and end symbols
+static bool spelled_as_type_keyword(char *keyword, size_t length) {
+  if (!closed_keyword(keyword, length)) {
+    return false;
+  }
+  for (size_t i = 1; i < length - 1; i++) {
+    if (strchr(MINIMAL_VAR_KW_MID_SYMBOLS, keyword[i]) == NULL) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Structured form of the first length characters of keyword, see intern_type_keyword()
+static MiniStatus intern_structured_keyword(char *keyword, size_t length, uint32_t pointer_depth, MiniTypeId *id) {
+  if (!closed_keyword(keyword, length)) {
+    return INVALID_SYNTAX;
+  }
+  char begin = keyword[0];
+  char *body = keyword + 1;
+  size_t body_length = length - 2;
+
+  MiniType candidate = {.kind = VOID, .pointer_depth = pointer_depth, .member_count = 0, .key_count = 0, .members = NULL, .name = NULL};
+  if (begin == '<' && body_length > 0 && body[0] >= 'a' && body[0] <= 'z') {
+    char name[body_length + 1];
+    memcpy(name, body, body_length);
+    name[body_length] = '\0';
+    candidate.kind = CUSTOM_T;
+    candidate.name = name;
+    return intern_type(&candidate, id);
+  }
+
+  // Inside braces a leading S, U or E is always the tag, never a member. So {S} is the empty
+  // struct and {SS#} the struct of a stream and an int, while {#S} has a stream after the int
+  char tag = '\0';
+  size_t i = 0;
+  if (begin == '{' && body_length > 0 && (body[0] == 'S' || body[0] == 'U' || body[0] == 'E')) {
+    tag = body[0];
+    i = 1;
+  }
+
+  MiniTypeId members[body_length + 1];
+  uint32_t member_depths[body_length + 1];
+  bool has_colon = false;
+  MiniStatus status;
+  for (; i < body_length; i++) {
+    if (body[i] == ',') {
+      continue;
+    }
+    if (body[i] == ':') {
+      if (begin != '[' || has_colon) {
+        return INVALID_SYNTAX;
+      }
+      has_colon = true;
+      candidate.key_count = candidate.member_count;
+      continue;
+    }
+    MiniTokenName kind = member_kind(body[i]);
+    if (kind == TOKEN_UNDETERMINED) {
+      return INVALID_SYNTAX;
+    }
+    uint32_t member_depth = 0;
+    while (i + 1 < body_length && body[i + 1] == '^') {
+      member_depth++;
+      i++;
+    }
+    status = intern_basic_type(kind, member_depth, &members[candidate.member_count]);
+    if (status != SUCCESS) return status;
+    member_depths[candidate.member_count] = member_depth;
+    candidate.member_count++;
+  }
+
+  switch (begin) {
+    case '<':
+      if (candidate.member_count == 0) {
+        return intern_basic_type(VOID, pointer_depth, id);
+      } else if (candidate.member_count == 1) {
+        return intern_basic_type(type_slot(members[0])->kind, member_depths[0] + pointer_depth, id);
+      }
+      return INVALID_SYNTAX;
+    case '[':
+      candidate.kind = has_colon ? DICT_T : LIST_T;
+      break;
+    case '{':
+      if (tag == 'E') {
+        if (candidate.member_count > 0) {
+          return INVALID_SYNTAX;
+        }
+        candidate.kind = ENUM_T;
+      } else if (tag == 'U') {
+        candidate.kind = UNION_T;
+      } else {
+        candidate.kind = STRUCT_T;
+      }
+      break;
+    default:
+      return INVALID_SYNTAX;
+  }
+  candidate.members = members;
+  return intern_type(&candidate, id);
+}
+
+// Parses a keyword of category TYPE_KW into its structured form and interns it.
+// <x> is a basic type (<> being void) and <name> a custom type. [x] is a list and
+// [k:v] a dict of the member types x, k and v. {x} is a struct of the member types x,
+// optionally tagged with a leading S, while {U x} is a union and {E} an enum. Commas
+// between members are ignored, a '^' after a member makes the member a pointer and
+// every '^' after the closing symbol makes the whole type a pointer.
+// The lexer also accepts keywords that mix the symbols in other ways, such as <E>, <#%> or
+// {E#}. Those have no structure and are interned as a custom type named by their spelling,
+// which can't clash with a <name>, so each one is a type of its own.
+// Returns INVALID_SYNTAX if the keyword isn't spelled as a type keyword at all
+MiniStatus intern_type_keyword(char *keyword, MiniTypeId *id) {
+  size_t length = strlen(keyword);
+  uint32_t pointer_depth = 0;
+  while (length > 0 && keyword[length - 1] == '^') {
+    pointer_depth++;
+    length--;
+  }
+  MiniStatus status = intern_structured_keyword(keyword, length, pointer_depth, id);
+  if (status != INVALID_SYNTAX || !spelled_as_type_keyword(keyword, length)) {
+    return status;
+  }
+  char name[length + 1];
+  memcpy(name, keyword, length);
+  name[length] = '\0';
+  MiniType candidate = {.kind = CUSTOM_T, .pointer_depth = pointer_depth, .member_count = 0, .key_count = 0, .members = NULL, .name = name};
+  return intern_type(&candidate, id);
+}
+
+// The type id with its pointer depth replaced by pointer_depth, so <#>^ for <#> and 1
+MiniStatus intern_pointer_type(MiniTypeId id, uint32_t pointer_depth, MiniTypeId *result) {
+  MiniType candidate = *get_type(id);
+  if (candidate.pointer_depth == pointer_depth) {
+    *result = id;
+    return SUCCESS;
+  }
+  candidate.pointer_depth = pointer_depth;
+  return intern_type(&candidate, result);
+}
+
+MiniTypeId last_type_id(void) {
+  pthread_mutex_lock(&type_table_lock);
+  MiniTypeId id = type_count;
+  pthread_mutex_unlock(&type_table_lock);
+  return id;
+}
+
+// id must have been returned by intern_type_keyword()
+const MiniType *get_type(MiniTypeId id) {
+  if (id == MINIMAL_NO_TYPE) {
+    return NULL;
+  }
+  return type_slot(id);
+}
+
+static char basic_symbol(MiniTokenName kind) {
+  switch (kind) {
+    case INT:
+      return '#';
+    case FLOAT:
+      return '%';
+    case STR:
+      return '"';
+    case BOOL:
+      return 'B';
+    case STREAM:
+      return 'S';
+    default:
+      return '\0';
+  }
+}
+
+static void file_print_pointers(FILE *file_ptr, uint32_t pointer_depth) {
+  for (uint32_t i = 0; i < pointer_depth; i++) {
+    fputc('^', file_ptr);
+  }
+}
+
+// Prints the type keyword that denotes id in the form intern_type_keyword() reads, which is
+// not necessarily the form it was written in (<#^> is printed as <#>^)
+void file_print_type(FILE *file_ptr, MiniTypeId id) {
+  const MiniType *type = get_type(id);
+  if (type == NULL) {
+    fprintf(file_ptr, "<?>");
+    return;
+  }
+  switch (type->kind) {
+    case VOID:
+      fprintf(file_ptr, "<>");
+      break;
+    case CUSTOM_T:
+      // Keywords without structure are named by their whole spelling
+      fprintf(file_ptr, islower((unsigned char) type->name[0]) ? "<%s>" : "%s", type->name);
+      break;
+    case LIST_T:
+    case DICT_T:
+    case ENUM_T:
+    case UNION_T:
+    case STRUCT_T:
+      fputc(type->kind == LIST_T || type->kind == DICT_T ? '[' : '{', file_ptr);
+      if (type->kind == ENUM_T) {
+        fputc('E', file_ptr);
+      } else if (type->kind == UNION_T) {
+        fputc('U', file_ptr);
+      } else if (type->kind == STRUCT_T) {
+        fputc('S', file_ptr);
+      }
+      for (uint32_t i = 0; i < type->member_count; i++) {
+        if (type->kind == DICT_T && i == type->key_count) {
+          fputc(':', file_ptr);
+        }
+        const MiniType *member = get_type(type->members[i]);
+        fputc(basic_symbol(member->kind), file_ptr);
+        file_print_pointers(file_ptr, member->pointer_depth);
+      }
+      fputc(type->kind == LIST_T || type->kind == DICT_T ? ']' : '}', file_ptr);
+      break;
+    default:
+      fprintf(file_ptr, "<%c>", basic_symbol(type->kind));
+      break;
+  }
+  file_print_pointers(file_ptr, type->pointer_depth);
+}
+
+void free_type_table(void) {
+  pthread_mutex_lock(&type_table_lock);
+  for (MiniTypeId id = 1; id <= type_count; id++) {
+    MiniType *type = type_slot(id);
+    free(type->members);
+    free(type->name);
+  }
+  for (size_t page = 0; page < MAX_TYPE_PAGES && type_pages[page] != NULL; page++) {
+    free(type_pages[page]);
+    type_pages[page] = NULL;
+  }
+  free(type_index);
+  type_index = NULL;
+  type_index_capacity = 0;
+  type_count = 0;
+  pthread_mutex_unlock(&type_table_lock);
+}
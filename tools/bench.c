@@ -0,0 +1,400 @@
+/*
+  =======================================================================
+  This file is part of Minimal (mnml) - A *.mini source to C compiler for
+  the Minimal programming language
+
+  Written in 2025 by approx-error
+
+  Minimal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Minimal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+  ======================================================================
+*/
+
+// minibench: Times every stage of the compiler on the given source files
+//
+// Usage: minibench [-t timeout] <file.mini>...
+//
+// The files should be the same kind of program (see mkprog) in increasing size. Every
+// stage of every file runs in a child process that first runs the stages before it, so a
+// crash or a timeout (60 seconds by default) only loses that measurement. The measured
+// stage runs on a thread of its own with a large stack, which makes deep recursion
+// possible and lets the stack depth be read back from the pages it touched. Stages that
+// write a file (.prep, .toke, .pars) write it as they would in a normal run, except that
+// the syntax tree dump goes to /dev/null.
+//
+// For each file and stage the report has the time, the throughput in source bytes and in
+// tokens or nodes per second, the peak RSS of the process and the stack depth. Then the
+// growth of the time between consecutive files is given as an exponent of the growth of
+// the source, and stages that grow faster than SUPER_LINEAR are flagged. The exit status
+// is nonzero if any stage was flagged.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+#include <limits.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include "inc/retcodes.h"
+#include "inc/preprocessor.h"
+#include "inc/tokens.h"
+#include "inc/syntax.h"
+#include "inc/ast.h"
+#include "inc/semantic.h"
+
+#define MAX_BENCH_FILES 32
+#define STAGE_STACK_SIZE ((size_t)1 << 30)
+#define DEFAULT_TIMEOUT 60
+// Time exponent above which a stage counts as super-linear. Linear is 1, quadratic 2
+#define SUPER_LINEAR 1.25
+// Shorter times are too noisy to compute an exponent from
+#define MIN_SCALING_TIME 0.01
+
+typedef enum bench_stage {
+  STAGE_PREPROCESS,
+  STAGE_TOKENIZE,
+  STAGE_PARSE,
+  STAGE_TABLE_PARSE,
+  STAGE_LOWER,
+  STAGE_SEMANTIC,
+  STAGE_COUNT
+} BenchStage;
+
+static const char *stage_names[STAGE_COUNT] = {"preprocess", "tokenize", "parse", "table-parse", "lower", "semantic"};
+static const char *item_names[STAGE_COUNT] = {"", "tokens", "nodes", "nodes", "AST nodes", "AST nodes"};
+
+typedef enum bench_outcome {
+  OUTCOME_OK,
+  OUTCOME_ERROR, // The stage returned an error status
+  OUTCOME_CRASHED,
+  OUTCOME_TIMEOUT,
+  OUTCOME_SKIPPED // Crashed or timed out on a smaller file
+} BenchOutcome;
+
+typedef struct bench_result {
+  BenchOutcome outcome;
+  MiniStatus status;
+  double seconds;
+  uint64_t items; // Tokens or nodes
+  long peak_rss_kb;
+  size_t stack_bytes;
+} BenchResult;
+
+// Everything the stages pass on to each other
+typedef struct bench_pipeline {
+  char main_file[PATH_MAX];
+  char prep_file[PATH_MAX];
+  char token_file[PATH_MAX];
+  char parse_file[PATH_MAX];
+  char ast_file[PATH_MAX];
+  char sema_file[PATH_MAX];
+  MiniHeadToken head_token;
+  MiniSyntaxTree root;
+  MiniAst ast;
+} BenchPipeline;
+
+typedef struct bench_job {
+  BenchPipeline *pipeline;
+  BenchStage stage;
+  MiniStatus status;
+} BenchJob;
+
+static double now(void) {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return (double)time.tv_sec + (double)time.tv_nsec / 1e9;
+}
+
+static uint64_t count_tree_nodes(MiniSyntaxTree *root) {
+  size_t capacity = 1024;
+  size_t depth = 0;
+  MiniSyntaxTree **stack = malloc(capacity * sizeof(MiniSyntaxTree *));
+  if (stack == NULL) {
+    return 0;
+  }
+  uint64_t count = 0;
+  stack[depth++] = root;
+  while (depth > 0) {
+    MiniSyntaxTree *node = stack[--depth];
+    for (; node != NULL; node = node->sibling) {
+      count++;
+      if (node->child == NULL) {
+        continue;
+      }
+      if (depth == capacity) {
+        MiniSyntaxTree **grown = realloc(stack, 2 * capacity * sizeof(MiniSyntaxTree *));
+        if (grown == NULL) {
+          free(stack);
+          return count;
+        }
+        stack = grown;
+        capacity *= 2;
+      }
+      stack[depth++] = node->child;
+    }
+  }
+  free(stack);
+  return count;
+}
+
+static MiniStatus run_stage(BenchPipeline *pipeline, BenchStage stage) {
+  MiniStatus status;
+  switch (stage) {
+    case STAGE_PREPROCESS: {
+      char *input_files[1] = {pipeline->main_file};
+      return preprocess(input_files, 1, pipeline->main_file, pipeline->prep_file, 0);
+    }
+    case STAGE_TOKENIZE:
+      return tokenize(pipeline->prep_file, pipeline->token_file, &pipeline->head_token, 0);
+    case STAGE_PARSE:
+    case STAGE_TABLE_PARSE:
+      strcpy(pipeline->parse_file, "/dev/null");
+      status = generate_ast(pipeline->token_file, pipeline->parse_file, &pipeline->head_token, &pipeline->root, stage == STAGE_TABLE_PARSE, 0);
+      return status == VALID_CONSTRUCT ? SUCCESS : status;
+    case STAGE_LOWER:
+      return lower_syntax_tree(pipeline->parse_file, pipeline->ast_file, &pipeline->root, &pipeline->ast, 0, 0);
+    default:
+      // Reporting errors is part of the work, a program doesn't have to be correct to be timed
+      status = analyse_semantics(pipeline->parse_file, pipeline->sema_file, &pipeline->ast, 0, 0);
+      return status == SEMANTIC_ERROR ? SUCCESS : status;
+  }
+}
+
+static void *stage_thread(void *arg) {
+  BenchJob *job = arg;
+  job->status = run_stage(job->pipeline, job->stage);
+  return NULL;
+}
+
+// Runs the stage on a thread whose stack is mapped but not committed, so the resident
+// pages at the end are the ones the stage touched
+static void measure_stage(BenchPipeline *pipeline, BenchStage stage, BenchResult *result) {
+  result->outcome = OUTCOME_ERROR;
+  result->status = ALLOCATION_FAIL;
+  void *stack = mmap(NULL, STAGE_STACK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (stack == MAP_FAILED) {
+    return;
+  }
+  pthread_attr_t attributes;
+  pthread_attr_init(&attributes);
+  pthread_attr_setstack(&attributes, stack, STAGE_STACK_SIZE);
+  BenchJob job = {.pipeline = pipeline, .stage = stage, .status = SUCCESS};
+  pthread_t thread;
+  double start = now();
+  if (pthread_create(&thread, &attributes, stage_thread, &job) != 0) {
+    pthread_attr_destroy(&attributes);
+    munmap(stack, STAGE_STACK_SIZE);
+    return;
+  }
+  pthread_join(thread, NULL);
+  result->seconds = now() - start;
+  pthread_attr_destroy(&attributes);
+
+  // The stack grows down, so the lowest resident page is the deepest point reached
+  size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+  size_t page_count = STAGE_STACK_SIZE / page_size;
+  unsigned char *residency = malloc(page_count);
+  if (residency != NULL && mincore(stack, STAGE_STACK_SIZE, residency) == 0) {
+    size_t lowest = 0;
+    while (lowest < page_count && !(residency[lowest] & 1)) {
+      lowest++;
+    }
+    result->stack_bytes = (page_count - lowest) * page_size;
+  }
+  free(residency);
+  munmap(stack, STAGE_STACK_SIZE);
+
+  result->status = job.status;
+  result->outcome = job.status == SUCCESS ? OUTCOME_OK : OUTCOME_ERROR;
+  switch (stage) {
+    case STAGE_TOKENIZE:
+      result->items = pipeline->head_token.token_count;
+      break;
+    case STAGE_PARSE:
+    case STAGE_TABLE_PARSE:
+      result->items = count_tree_nodes(pipeline->root.child);
+      break;
+    case STAGE_LOWER:
+    case STAGE_SEMANTIC:
+      result->items = pipeline->ast.node_count;
+      break;
+    default:
+      break;
+  }
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  result->peak_rss_kb = usage.ru_maxrss;
+}
+
+// Runs in the child: the stages before stage untimed, then stage measured
+static BenchResult bench_child(const char *file, BenchStage stage) {
+  BenchResult result = {.outcome = OUTCOME_ERROR, .status = SUCCESS};
+  BenchPipeline *pipeline = calloc(1, sizeof(BenchPipeline));
+  if (pipeline == NULL) {
+    result.status = ALLOCATION_FAIL;
+    return result;
+  }
+  strncpy(pipeline->main_file, file, PATH_MAX - 1);
+  pipeline->root.data.non_terminal = SOURCE;
+  pipeline->root.data_type = NON_TERMINAL;
+  for (BenchStage before = STAGE_PREPROCESS; before < stage; before++) {
+    // Lowering works on the tree of the table-driven parser, the recursive descent one is
+    // timed on its own
+    if (before == STAGE_PARSE) {
+      continue;
+    }
+    result.status = run_stage(pipeline, before);
+    if (result.status != SUCCESS) {
+      return result;
+    }
+  }
+  measure_stage(pipeline, stage, &result);
+  return result;
+}
+
+static BenchResult bench_stage(const char *file, BenchStage stage, int timeout) {
+  BenchResult result = {.outcome = OUTCOME_CRASHED, .status = SUCCESS};
+  int channel[2];
+  if (pipe(channel) != 0) {
+    return result;
+  }
+  fflush(stdout);
+  pid_t child = fork();
+  if (child < 0) {
+    close(channel[0]);
+    close(channel[1]);
+    return result;
+  }
+  if (child == 0) {
+    // The stages report errors on stdout
+    close(channel[0]);
+    int null_fd = open("/dev/null", O_WRONLY);
+    if (null_fd >= 0) {
+      dup2(null_fd, STDOUT_FILENO);
+      close(null_fd);
+    }
+    alarm((unsigned)timeout);
+    BenchResult child_result = bench_child(file, stage);
+    ssize_t written = write(channel[1], &child_result, sizeof(child_result));
+    _exit(written == (ssize_t)sizeof(child_result) ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+  close(channel[1]);
+  ssize_t received = read(channel[0], &result, sizeof(result));
+  close(channel[0]);
+  int child_status;
+  waitpid(child, &child_status, 0);
+  if (received != (ssize_t)sizeof(result)) {
+    result.outcome = WIFSIGNALED(child_status) && WTERMSIG(child_status) == SIGALRM ? OUTCOME_TIMEOUT : OUTCOME_CRASHED;
+  }
+  return result;
+}
+
+static void print_result(const BenchResult *result, BenchStage stage, off_t bytes) {
+  switch (result->outcome) {
+    case OUTCOME_ERROR:
+      printf("  %-12s error %d\n", stage_names[stage], result->status);
+      return;
+    case OUTCOME_CRASHED:
+      printf("  %-12s crashed\n", stage_names[stage]);
+      return;
+    case OUTCOME_TIMEOUT:
+      printf("  %-12s timed out\n", stage_names[stage]);
+      return;
+    case OUTCOME_SKIPPED:
+      printf("  %-12s skipped\n", stage_names[stage]);
+      return;
+    default:
+      break;
+  }
+  double seconds = result->seconds > 0 ? result->seconds : 1e-9;
+  printf("  %-12s %10.4f s %9.2f MB/s", stage_names[stage], result->seconds, (double)bytes / seconds / 1e6);
+  if (item_names[stage][0] != '\0') {
+    printf(" %12.0f %s/s", (double)result->items / seconds, item_names[stage]);
+  } else {
+    printf(" %*s", 20, "");
+  }
+  printf("   peak RSS %8ld KiB   stack %8zu KiB\n", result->peak_rss_kb, result->stack_bytes / 1024);
+}
+
+int main(int argc, char **argv) {
+  int timeout = DEFAULT_TIMEOUT;
+  int option;
+  while ((option = getopt(argc, argv, "t:")) != -1) {
+    if (option == 't') {
+      timeout = atoi(optarg);
+    } else {
+      fprintf(stderr, "Usage: %s [-t timeout] <file.mini>...\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  int file_count = argc - optind;
+  if (file_count < 1 || file_count > MAX_BENCH_FILES || timeout < 1) {
+    fprintf(stderr, "Usage: %s [-t timeout] <file.mini>... (at most %d files)\n", argv[0], MAX_BENCH_FILES);
+    return EXIT_FAILURE;
+  }
+
+  static BenchResult results[MAX_BENCH_FILES][STAGE_COUNT];
+  off_t sizes[MAX_BENCH_FILES];
+  bool given_up[STAGE_COUNT] = {false};
+  for (int i = 0; i < file_count; i++) {
+    const char *file = argv[optind + i];
+    struct stat file_stat;
+    if (stat(file, &file_stat) != 0) {
+      fprintf(stderr, "minibench: Error: Can't read %s\n", file);
+      return EXIT_FAILURE;
+    }
+    sizes[i] = file_stat.st_size;
+    printf("%s (%lld bytes)\n", file, (long long)sizes[i]);
+    for (BenchStage stage = STAGE_PREPROCESS; stage < STAGE_COUNT; stage++) {
+      if (given_up[stage]) {
+        results[i][stage].outcome = OUTCOME_SKIPPED;
+      } else {
+        results[i][stage] = bench_stage(file, stage, timeout);
+        given_up[stage] = results[i][stage].outcome == OUTCOME_CRASHED || results[i][stage].outcome == OUTCOME_TIMEOUT;
+      }
+      print_result(&results[i][stage], stage, sizes[i]);
+    }
+  }
+
+  // Time ~ size^exponent between consecutive files
+  bool super_linear = false;
+  printf("\nScaling (1 = linear, 2 = quadratic)\n");
+  for (BenchStage stage = STAGE_PREPROCESS; stage < STAGE_COUNT; stage++) {
+    printf("  %-12s", stage_names[stage]);
+    bool flagged = false;
+    for (int i = 1; i < file_count; i++) {
+      BenchResult *smaller = &results[i - 1][stage];
+      BenchResult *larger = &results[i][stage];
+      if (smaller->outcome != OUTCOME_OK || larger->outcome != OUTCOME_OK ||
+          sizes[i] <= sizes[i - 1] || smaller->seconds < MIN_SCALING_TIME) {
+        printf("      -");
+        continue;
+      }
+      double exponent = log(larger->seconds / smaller->seconds) / log((double)sizes[i] / (double)sizes[i - 1]);
+      printf(" %6.2f", exponent);
+      flagged = flagged || exponent > SUPER_LINEAR;
+    }
+    printf("%s\n", flagged ? "   SUPER-LINEAR" : "");
+    super_linear = super_linear || flagged;
+  }
+  return super_linear ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,676 @@
+/*
+  =======================================================================
+  This file is part of Minimal (mnml) - A *.mini source to C compiler for
+  the Minimal programming language
+
+  Written in 2025 by approx-error
+
+  Minimal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Minimal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+  ======================================================================
+*/
+
+// minifuzz: Coverage-guided fuzzer that looks for inputs on which the lexer and the
+// parsers do more than linear work
+//
+// Usage: minifuzz [-t seconds] [-n runs] [-s seed] [-p hand|table|both] [-T run timeout]
+//                 [-o findings directory] [seed files...]
+//    or: minifuzz -x <files...>
+//
+// Every run feeds one input to tokenize_text_lines() and generate_ast() in this process,
+// once for each parser.
+// The compiler is built with -fsanitize-coverage=trace-pc, which calls
+// __sanitizer_cov_trace_pc() below on every basic block, and with -DMINIMAL_WORK_COUNT,
+// which counts the operations of the lexer and the parsers (see COUNT_WORK()). Inputs that
+// reach new code or do more operations per byte than any input before are kept and mutated
+// further.
+//
+// Every kept input is grown in two ways: repeated as a whole, and with every line repeated
+// within itself as many times as the longest line still fits in the maximum line length. If
+// the operations grow faster than the size (an exponent above SUPER_LINEAR), the input is
+// minimised while it keeps growing that fast and saved in the findings directory as
+// slow-<n>.mini. Inputs that crash or run longer than the run timeout are saved as crash.mini
+// or timeout.mini. At the end the input with the most operations per byte is saved as
+// heaviest.mini. Saved inputs are regression benchmarks: -x replays them and exits with
+// failure if any of them still grows too fast.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "inc/retcodes.h"
+#include "inc/preprocessor.h"
+#include "inc/tokens.h"
+#include "inc/syntax.h"
+
+#define MAX_INPUT 4096
+#define MAX_CORPUS 4096
+#define MAX_FINDINGS 64
+// Findings are spread over the ways of growing an input
+#define MAX_GROWTH_FINDINGS (MAX_FINDINGS / GROWTH_COUNT)
+#define COVERAGE_SIZE (1 << 16)
+#define MAX_MUTATIONS 4
+// Operation exponent above which an input counts as super-linear. Linear is 1
+#define SUPER_LINEAR 1.25
+#define REPEAT_FACTOR 8
+// Below this many operations fixed costs hide how the work grows
+#define MIN_GROWTH_WORK 100
+#define STATUS_INTERVAL 2.0
+
+typedef enum fuzz_parser {
+  PARSER_HAND = 1,
+  PARSER_TABLE = 2,
+  PARSER_BOTH = 3
+} FuzzParser;
+
+typedef enum fuzz_growth {
+  GROWTH_REPEAT, // The whole input is repeated
+  GROWTH_WIDEN, // Every line is repeated within itself
+  GROWTH_COUNT
+} FuzzGrowth;
+
+static const char *growth_names[GROWTH_COUNT] = {"repeat", "widen"};
+
+typedef struct fuzz_input {
+  uint8_t *data;
+  size_t length;
+  uint64_t work;
+} FuzzInput;
+
+// Lexemes of the language, so that mutations build tokens faster than flipping bits would
+static const char *dictionary[] = {
+  "}}} ", "{{{", ">>> ", "<<<", "!~>..<~!", "$$ ", "~$", "?? ", "|? ", "|.:", "~?", "## ", "#= ",
+  "~#", "@@ ", "~@", "<#>", "<%>", "<\">", "<B>", "<>", "[#]", "[\":#]", ":: ", "M::", "C::",
+  " := ", " -> ", "<- ", "++", "--", " += ", "...", "!", ":", ";", "(", ")", "[", "]", ", ",
+  "\"", "T", "F", "N", "_", ".;", ">;", "v0", "K", "mod", "0", "12", "1.5", "1e9", " ", "\n",
+  "//", "..", "&&", "||", "==", "<", ">", "*", "/", "+", "-", "%", "^", "#"
+};
+#define DICTIONARY_SIZE (sizeof(dictionary) / sizeof(dictionary[0]))
+
+static uint8_t trace_map[COVERAGE_SIZE];
+static uint8_t seen_map[COVERAGE_SIZE];
+static uintptr_t previous_location;
+
+static FuzzParser parser = PARSER_BOTH;
+static uint64_t random_state;
+
+// The input of the run in progress, for the crash and timeout handlers
+static const uint8_t *current_data;
+static size_t current_length;
+static char crash_file[4096];
+static char timeout_file[4096];
+
+void __sanitizer_cov_trace_pc(void);
+
+// Edges as in AFL: the hash of the block xored with the shifted hash of the one before
+void __sanitizer_cov_trace_pc(void) {
+  uintptr_t location = (uintptr_t)__builtin_return_address(0);
+  location = (location ^ (location >> 16)) & (COVERAGE_SIZE - 1);
+  trace_map[location ^ previous_location]++;
+  previous_location = location >> 1;
+}
+
+static uint64_t next_random(void) {
+  // xorshift64*
+  random_state ^= random_state >> 12;
+  random_state ^= random_state << 25;
+  random_state ^= random_state >> 27;
+  return random_state * 2685821657736338717ULL;
+}
+
+static size_t random_below(size_t bound) {
+  return bound == 0 ? 0 : (size_t)(next_random() % bound);
+}
+
+static double now(void) {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return (double)time.tv_sec + (double)time.tv_nsec / 1e9;
+}
+
+static void save_input(const char *file, const uint8_t *data, size_t length) {
+  int fd = open(file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return;
+  }
+  while (length > 0) {
+    ssize_t written = write(fd, data, length);
+    if (written <= 0) {
+      break;
+    }
+    data += written;
+    length -= (size_t)written;
+  }
+  close(fd);
+}
+
+static void crash_handler(int signal_number) {
+  save_input(signal_number == SIGALRM ? timeout_file : crash_file, current_data, current_length);
+  const char *message = signal_number == SIGALRM ? "minifuzz: Run timed out, input saved\n" : "minifuzz: Crashed, input saved\n";
+  ssize_t ignored = write(STDERR_FILENO, message, strlen(message));
+  (void)ignored;
+  _exit(EXIT_FAILURE);
+}
+
+// Result of lexing the last input run_input() ran
+static MiniStatus lex_status;
+
+// Lexes and parses the input the way the compiler would and returns the operations counted
+static uint64_t run_input(const uint8_t *data, size_t length) {
+  static char text[MAX_INPUT * REPEAT_FACTOR + 1];
+  static char *lines[MAX_INPUT * REPEAT_FACTOR + 1];
+  current_data = data;
+  current_length = length;
+  memcpy(text, data, length);
+  text[length] = '\0';
+  int line_count = 0;
+  for (char *line = text; line < text + length; ) {
+    lines[line_count++] = line;
+    char *newline = memchr(line, '\n', (size_t)(text + length - line));
+    line = newline == NULL ? text + length : newline + 1;
+  }
+
+  memset(trace_map, 0, sizeof(trace_map));
+  previous_location = 0;
+  mini_work_count = 0;
+  for (int table = 0; table <= 1; table++) {
+    if (!(parser & (table ? PARSER_TABLE : PARSER_HAND))) {
+      continue;
+    }
+    // The syntax tree takes over the strings of the tokens it holds, so every parser gets
+    // its own tokens
+    MiniHeadToken head_token = {.token_count = 0, .head = NULL, .tail = NULL};
+    MiniStatus status = tokenize_text_lines(lines, line_count, 0, &head_token);
+    lex_status = status;
+    if (status == SUCCESS && head_token.token_count > 0) {
+      char parse_file[] = "/dev/null";
+      MiniSyntaxTree root = {.data.non_terminal = SOURCE, .data_type = NON_TERMINAL, .child = NULL, .sibling = NULL};
+      generate_ast(parse_file, parse_file, &head_token, &root, table, 0);
+      free_syntax_tree(root.child);
+    }
+    free_tokens(&head_token);
+    free_type_table();
+    if (status != SUCCESS) {
+      break;
+    }
+  }
+  return mini_work_count;
+}
+
+// AFL's hit count buckets, so that loops running a few more times don't count as new
+static uint8_t hit_bucket(uint8_t hits) {
+  if (hits <= 3) return hits == 3 ? 4 : hits;
+  if (hits <= 7) return 8;
+  if (hits <= 15) return 16;
+  if (hits <= 31) return 32;
+  if (hits <= 127) return 64;
+  return 128;
+}
+
+static bool has_new_coverage(void) {
+  bool found = false;
+  for (size_t i = 0; i < COVERAGE_SIZE; i++) {
+    if (trace_map[i] == 0) {
+      continue;
+    }
+    uint8_t bucket = hit_bucket(trace_map[i]);
+    if (bucket & ~seen_map[i]) {
+      seen_map[i] |= bucket;
+      found = true;
+    }
+  }
+  return found;
+}
+
+// Writes the input grown by factor to output and returns its size, or 0 if it doesn't fit in
+// capacity
+static size_t grow_input(const uint8_t *data, size_t length, FuzzGrowth growth, int factor, uint8_t *output, size_t capacity) {
+  size_t size = 0;
+  if (growth == GROWTH_REPEAT) {
+    if (factor * (length + 1) > capacity) {
+      return 0;
+    }
+    for (int i = 0; i < factor; i++) {
+      memcpy(output + size, data, length);
+      size += length;
+      if (length > 0 && data[length - 1] != '\n') {
+        output[size++] = '\n';
+      }
+    }
+    return size;
+  }
+  const uint8_t *line = data;
+  const uint8_t *end = data + length;
+  while (line < end) {
+    const uint8_t *newline = memchr(line, '\n', (size_t)(end - line));
+    size_t line_length = (size_t)((newline == NULL ? end : newline) - line);
+    size_t wide_length = line_length * factor;
+    if (size + wide_length + 1 > capacity) {
+      return 0;
+    }
+    for (size_t i = 0; i < wide_length; i++) {
+      output[size++] = line[i % line_length];
+    }
+    output[size++] = '\n';
+    line = newline == NULL ? end : newline + 1;
+  }
+  return size;
+}
+
+// Lines are widened by the same factor, so that every part of the input grows alike, as far
+// as the longest one stays within the maximum line length
+static int widen_factor(const uint8_t *data, size_t length) {
+  size_t longest = 0;
+  const uint8_t *line = data;
+  const uint8_t *end = data + length;
+  while (line < end) {
+    const uint8_t *newline = memchr(line, '\n', (size_t)(end - line));
+    size_t line_length = (size_t)((newline == NULL ? end : newline) - line);
+    if (line_length > longest) longest = line_length;
+    line = newline == NULL ? end : newline + 1;
+  }
+  if (longest == 0 || MAX_LINE_LENGTH / longest >= REPEAT_FACTOR) {
+    return REPEAT_FACTOR;
+  }
+  return (int)(MAX_LINE_LENGTH / longest);
+}
+
+// Bytes of the input that aren't line breaks. Widening doesn't add any of those
+static size_t text_size(const uint8_t *data, size_t length) {
+  size_t size = length;
+  for (const uint8_t *newline = data; (newline = memchr(newline, '\n', (size_t)(data + length - newline))) != NULL; newline++) {
+    size--;
+  }
+  return size;
+}
+
+// Lexes and parses the input grown by factor into grown. Returns false if it doesn't fit
+static bool run_grown(const uint8_t *data, size_t length, FuzzGrowth growth, int factor, size_t *text, uint64_t *work, MiniStatus *status) {
+  static uint8_t grown[MAX_INPUT * REPEAT_FACTOR];
+  size_t size = grow_input(data, length, growth, factor, grown, sizeof(grown));
+  if (size == 0 && length > 0) {
+    return false;
+  }
+  *text = text_size(grown, size);
+  *work = run_input(grown, size);
+  *status = lex_status;
+  return true;
+}
+
+// How the operations grow with the size: work ~ size^exponent, with the size in bytes that
+// aren't line breaks. The input is grown halfway and all the way, and the smaller exponent
+// of the two halves is taken, so that an input whose outcome changes once as it grows (a
+// string that gets closed, an error that moves) isn't taken for one that grows too fast.
+// Negative if the input can't grow four times or does too little work to tell. An input
+// that does too little work is repeated as a whole first, which scales the work of all
+// sizes alike, so that minimised inputs can be measured too
+static double growth_exponent(const uint8_t *data, size_t length, FuzzGrowth growth) {
+  static uint8_t repeated[MAX_INPUT];
+  const uint8_t *base = data;
+  size_t base_length = length;
+  size_t text[3];
+  uint64_t work[3];
+  MiniStatus status[3];
+  run_grown(base, base_length, growth, 1, &text[0], &work[0], &status[0]);
+  for (int copies = 2; work[0] < MIN_GROWTH_WORK && copies * (length + 1) <= sizeof(repeated); copies *= 2) {
+    base_length = grow_input(data, length, GROWTH_REPEAT, copies, repeated, sizeof(repeated));
+    base = repeated;
+    run_grown(base, base_length, growth, 1, &text[0], &work[0], &status[0]);
+  }
+
+  int factor = growth == GROWTH_WIDEN ? widen_factor(base, base_length) : REPEAT_FACTOR;
+  if (factor < 4) {
+    return -1;
+  }
+  int factors[3] = {1, factor / 2, factor};
+  for (int i = 1; i < 3; i++) {
+    if (!run_grown(base, base_length, growth, factors[i], &text[i], &work[i], &status[i]) || text[i] <= text[i - 1]) {
+      return -1;
+    }
+    // Widening can close a string that was left open, which changes where lexing stops
+    // rather than how much work the input takes
+    if (status[i] != status[0]) {
+      return -1;
+    }
+  }
+  if (work[0] < MIN_GROWTH_WORK) {
+    // Work that stays this small doesn't grow at all, usually because the input stops at a
+    // lexical error
+    return work[2] < MIN_GROWTH_WORK ? 0 : -1;
+  }
+
+  double exponent = INFINITY;
+  for (int i = 1; i < 3; i++) {
+    double half = log((double)work[i] / (double)work[i - 1]) / log((double)text[i] / (double)text[i - 1]);
+    exponent = fmin(exponent, half);
+  }
+  return exponent;
+}
+
+// Removes ever smaller chunks of the input as long as it keeps growing super-linearly
+static size_t minimise_input(uint8_t *data, size_t length, FuzzGrowth growth) {
+  static uint8_t candidate[MAX_INPUT];
+  for (size_t chunk = length / 2; chunk >= 1; chunk /= 2) {
+    for (size_t start = 0; start + chunk <= length; ) {
+      memcpy(candidate, data, start);
+      memcpy(candidate + start, data + start + chunk, length - start - chunk);
+      if (growth_exponent(candidate, length - chunk, growth) > SUPER_LINEAR) {
+        memcpy(data, candidate, length - chunk);
+        length -= chunk;
+      } else {
+        start += chunk;
+      }
+    }
+  }
+  return length;
+}
+
+static size_t mutate(uint8_t *data, size_t length, const FuzzInput *corpus, size_t corpus_size) {
+  int mutations = 1 + (int)random_below(MAX_MUTATIONS);
+  for (int m = 0; m < mutations; m++) {
+    size_t position = random_below(length + 1);
+    size_t span = 1 + random_below(length < 32 ? 8 : 32);
+    if (position + span > length) {
+      span = length - position;
+    }
+    switch (random_below(7)) {
+      case 0:
+        if (length > 0) {
+          data[random_below(length)] ^= (uint8_t)(1 << random_below(8));
+        }
+        break;
+      case 1:
+        if (length > 0) {
+          data[random_below(length)] = (uint8_t)(' ' + random_below(95));
+        }
+        break;
+      case 2: {
+        const char *lexeme = dictionary[random_below(DICTIONARY_SIZE)];
+        size_t lexeme_length = strlen(lexeme);
+        if (length + lexeme_length <= MAX_INPUT) {
+          memmove(data + position + lexeme_length, data + position, length - position);
+          memcpy(data + position, lexeme, lexeme_length);
+          length += lexeme_length;
+        }
+        break;
+      }
+      case 3:
+        memmove(data + position, data + position + span, length - position - span);
+        length -= span;
+        break;
+      case 4:
+      case 5: {
+        // Repetition is what makes most super-linear cases, so it gets two chances
+        size_t copies = 1 + random_below(8);
+        if (span > 0 && length + copies * span <= MAX_INPUT) {
+          memmove(data + position + copies * span, data + position, length - position);
+          for (size_t i = 1; i <= copies; i++) {
+            memcpy(data + position + i * span, data + position, span);
+          }
+          length += copies * span;
+        }
+        break;
+      }
+      default: {
+        const FuzzInput *other = &corpus[random_below(corpus_size)];
+        size_t from = random_below(other->length);
+        size_t amount = 1 + random_below(64);
+        if (from + amount > other->length) {
+          amount = other->length - from;
+        }
+        if (length + amount <= MAX_INPUT) {
+          memmove(data + position + amount, data + position, length - position);
+          memcpy(data + position, other->data + from, amount);
+          length += amount;
+        }
+        break;
+      }
+    }
+  }
+  return length;
+}
+
+static uint64_t hash_input(const uint8_t *data, size_t length) {
+  // FNV-1a
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < length; i++) {
+    hash = (hash ^ data[i]) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+static bool add_to_corpus(FuzzInput *corpus, size_t *corpus_size, const uint8_t *data, size_t length, uint64_t work) {
+  if (*corpus_size == MAX_CORPUS) {
+    return false;
+  }
+  uint8_t *copy = malloc(length > 0 ? length : 1);
+  if (copy == NULL) {
+    return false;
+  }
+  memcpy(copy, data, length);
+  corpus[(*corpus_size)++] = (FuzzInput) {.data = copy, .length = length, .work = work};
+  return true;
+}
+
+static double work_per_byte(uint64_t work, size_t length) {
+  return (double)work / (double)(length > 0 ? length : 1);
+}
+
+static uint8_t *read_input(const char *file, size_t *length) {
+  FILE *input_ptr = fopen(file, "rb");
+  if (input_ptr == NULL) {
+    fprintf(stderr, "minifuzz: Error: Can't read %s\n", file);
+    return NULL;
+  }
+  uint8_t *data = malloc(MAX_INPUT);
+  if (data != NULL) {
+    *length = fread(data, 1, MAX_INPUT, input_ptr);
+  }
+  fclose(input_ptr);
+  return data;
+}
+
+static int replay(char **files, int file_count, FILE *report) {
+  bool super_linear = false;
+  for (int i = 0; i < file_count; i++) {
+    size_t length = 0;
+    uint8_t *data = read_input(files[i], &length);
+    if (data == NULL) {
+      return EXIT_FAILURE;
+    }
+    uint64_t work = run_input(data, length);
+    fprintf(report, "%s: %zu bytes, %llu operations (%.1f per byte)", files[i], length, (unsigned long long)work, work_per_byte(work, length));
+    bool flagged = false;
+    for (FuzzGrowth growth = GROWTH_REPEAT; growth < GROWTH_COUNT; growth++) {
+      double exponent = growth_exponent(data, length, growth);
+      if (exponent < 0) {
+        fprintf(report, ", %s -", growth_names[growth]);
+      } else {
+        fprintf(report, ", %s %.2f", growth_names[growth], exponent);
+      }
+      flagged = flagged || exponent > SUPER_LINEAR;
+    }
+    fprintf(report, "%s\n", flagged ? "   SUPER-LINEAR" : "");
+    super_linear = super_linear || flagged;
+    free(data);
+  }
+  return super_linear ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+  double duration = 60;
+  uint64_t max_runs = 0;
+  unsigned run_timeout = 10;
+  const char *findings = ".";
+  bool replaying = false;
+  random_state = 1;
+  int option;
+  while ((option = getopt(argc, argv, "t:n:s:p:T:o:x")) != -1) {
+    switch (option) {
+      case 't': duration = atof(optarg); break;
+      case 'n': max_runs = strtoull(optarg, NULL, 10); break;
+      case 's': random_state = strtoull(optarg, NULL, 10) * 0x9E3779B97F4A7C15ULL + 1; break;
+      case 'T': run_timeout = (unsigned)atoi(optarg); break;
+      case 'o': findings = optarg; break;
+      case 'x': replaying = true; break;
+      case 'p':
+        parser = strcmp(optarg, "hand") == 0 ? PARSER_HAND : strcmp(optarg, "table") == 0 ? PARSER_TABLE : PARSER_BOTH;
+        break;
+      default:
+        fprintf(stderr, "Usage: %s [-t seconds] [-n runs] [-s seed] [-p hand|table|both] [-T run timeout] [-o findings directory] [seed files...]\n", argv[0]);
+        fprintf(stderr, "   or: %s -x <files...>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+
+  // The lexer and the parsers report errors on stdout, and most inputs have errors
+  fflush(stdout);
+  int saved_stdout = dup(STDOUT_FILENO);
+  int null_fd = open("/dev/null", O_WRONLY);
+  if (null_fd >= 0) {
+    dup2(null_fd, STDOUT_FILENO);
+    close(null_fd);
+  }
+  if (replaying) {
+    // Only the report goes to the real stdout
+    FILE *report = saved_stdout >= 0 ? fdopen(saved_stdout, "w") : NULL;
+    if (report == NULL) {
+      return EXIT_FAILURE;
+    }
+    int status = replay(argv + optind, argc - optind, report);
+    fclose(report);
+    return status;
+  }
+
+  mkdir(findings, 0755);
+  snprintf(crash_file, sizeof(crash_file), "%s/crash.mini", findings);
+  snprintf(timeout_file, sizeof(timeout_file), "%s/timeout.mini", findings);
+  // The handler gets a stack of its own so that stack overflows are caught too
+  static uint8_t handler_stack[1 << 16];
+  stack_t alternate_stack = {.ss_sp = handler_stack, .ss_size = sizeof(handler_stack), .ss_flags = 0};
+  sigaltstack(&alternate_stack, NULL);
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = crash_handler;
+  action.sa_flags = SA_ONSTACK;
+  int signals[] = {SIGSEGV, SIGBUS, SIGABRT, SIGFPE, SIGALRM};
+  for (size_t i = 0; i < sizeof(signals) / sizeof(signals[0]); i++) {
+    sigaction(signals[i], &action, NULL);
+  }
+
+  static FuzzInput corpus[MAX_CORPUS];
+  size_t corpus_size = 0;
+  for (int i = optind; i < argc; i++) {
+    size_t length = 0;
+    uint8_t *data = read_input(argv[i], &length);
+    if (data == NULL) {
+      continue;
+    }
+    uint64_t work = run_input(data, length);
+    has_new_coverage();
+    add_to_corpus(corpus, &corpus_size, data, length, work);
+    free(data);
+  }
+  if (corpus_size == 0) {
+    const uint8_t empty[] = "\n";
+    add_to_corpus(corpus, &corpus_size, empty, 1, run_input(empty, 1));
+  }
+
+  static uint8_t input[MAX_INPUT];
+  size_t heaviest = 0;
+  for (size_t i = 1; i < corpus_size; i++) {
+    if (work_per_byte(corpus[i].work, corpus[i].length) > work_per_byte(corpus[heaviest].work, corpus[heaviest].length)) {
+      heaviest = i;
+    }
+  }
+  int finding_count = 0;
+  int growth_findings[GROWTH_COUNT] = {0};
+  uint64_t finding_hashes[MAX_FINDINGS];
+  uint64_t runs = 0;
+  double start = now();
+  double last_status = start;
+  while ((max_runs == 0 || runs < max_runs) && now() - start < duration) {
+    // Two picks, the heavier one is mutated, so work per byte keeps climbing
+    const FuzzInput *first = &corpus[random_below(corpus_size)];
+    const FuzzInput *second = &corpus[random_below(corpus_size)];
+    const FuzzInput *parent = work_per_byte(first->work, first->length) >= work_per_byte(second->work, second->length) ? first : second;
+    memcpy(input, parent->data, parent->length);
+    size_t length = mutate(input, parent->length, corpus, corpus_size);
+
+    alarm(run_timeout);
+    uint64_t work = run_input(input, length);
+    alarm(0);
+    runs++;
+    bool interesting = has_new_coverage();
+    bool heavier = work_per_byte(work, length) > work_per_byte(corpus[heaviest].work, corpus[heaviest].length);
+    if ((interesting || heavier) && add_to_corpus(corpus, &corpus_size, input, length, work)) {
+      if (heavier) {
+        heaviest = corpus_size - 1;
+      }
+      for (FuzzGrowth growth = GROWTH_REPEAT; growth < GROWTH_COUNT; growth++) {
+        if (growth_findings[growth] == MAX_GROWTH_FINDINGS) {
+          continue;
+        }
+        alarm(run_timeout * 2);
+        double exponent = growth_exponent(input, length, growth);
+        alarm(0);
+        if (exponent <= SUPER_LINEAR) {
+          continue;
+        }
+        uint8_t minimised[MAX_INPUT];
+        memcpy(minimised, input, length);
+        size_t minimised_length = minimise_input(minimised, length, growth);
+        // Many inputs minimise to the same one
+        uint64_t hash = hash_input(minimised, minimised_length);
+        bool known = false;
+        for (int i = 0; i < finding_count; i++) {
+          known = known || finding_hashes[i] == hash;
+        }
+        if (known) {
+          continue;
+        }
+        finding_hashes[finding_count] = hash;
+        growth_findings[growth]++;
+        char file[4096];
+        snprintf(file, sizeof(file), "%s/slow-%d.mini", findings, finding_count++);
+        save_input(file, minimised, minimised_length);
+        fprintf(stderr, "minifuzz: %s grows with exponent %.2f (%zu bytes), saved as %s\n",
+                growth_names[growth], growth_exponent(minimised, minimised_length, growth), minimised_length, file);
+      }
+    }
+
+    if (now() - last_status >= STATUS_INTERVAL) {
+      last_status = now();
+      fprintf(stderr, "minifuzz: %llu runs (%.0f/s), corpus %zu, heaviest %.1f operations per byte, %d findings\n",
+              (unsigned long long)runs, (double)runs / (last_status - start), corpus_size,
+              work_per_byte(corpus[heaviest].work, corpus[heaviest].length), finding_count);
+    }
+  }
+
+  char file[4096];
+  snprintf(file, sizeof(file), "%s/heaviest.mini", findings);
+  save_input(file, corpus[heaviest].data, corpus[heaviest].length);
+  fprintf(stderr, "minifuzz: Done after %llu runs. Heaviest input: %.1f operations per byte, saved as %s. %d super-linear inputs\n",
+          (unsigned long long)runs, work_per_byte(corpus[heaviest].work, corpus[heaviest].length), file, finding_count);
+  for (size_t i = 0; i < corpus_size; i++) {
+    free(corpus[i].data);
+  }
+  return finding_count > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
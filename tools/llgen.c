@@ -0,0 +1,569 @@
+/*
+  =======================================================================
+  This file is part of Minimal (mnml) - A *.mini source to C compiler for
+  the Minimal programming language
+
+  Written in 2025 by approx-error
+
+  Minimal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Minimal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+  ======================================================================
+*/
+
+// llgen: Reads grammar/minimal.grammar and writes the predict table of the table-driven
+// parser as a C source file (see src/inc/ll-table.h for the layout)
+//
+// Usage: llgen [-v] <grammar file> <output file>
+//
+// Lookahead sets are computed for two tokens: FIRST2 of every production followed by
+// FOLLOW2 of its left-hand side. Cells that one token decides go straight into
+// ll_predict, the others get a row in ll_second_predict indexed by the next token.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <ctype.h>
+
+#define MAX_NAME_LEN 64
+#define MAX_SYMBOLS 256
+#define MAX_PRODUCTIONS 512
+#define MAX_RHS 32
+// Terminals are numbered in order of appearance, the end of input comes last
+#define MAX_TERMINALS 127
+#define SET_WORDS 2
+
+typedef struct grammar_symbol {
+  char name[MAX_NAME_LEN];
+  bool is_nonterm;
+  int nonterm_index;
+  int terminal_index;
+} GramSymbol;
+
+typedef struct grammar_production {
+  int lhs; // Non-terminal index
+  int length;
+  int rhs[MAX_RHS]; // Symbol indices
+  bool child[MAX_RHS];
+  int line;
+} GramProduction;
+
+// Set of token strings of length 0, 1 and 2
+typedef struct lookahead_set {
+  bool empty;
+  uint64_t one[SET_WORDS];
+  uint64_t two[MAX_TERMINALS + 1][SET_WORDS];
+} LookSet;
+
+static GramSymbol symbols[MAX_SYMBOLS];
+static int symbol_count = 0;
+static int nonterm_symbols[MAX_SYMBOLS]; // Non-terminal index -> symbol index
+static int nonterm_count = 0;
+static int terminal_symbols[MAX_TERMINALS]; // Terminal index -> symbol index
+static int terminal_count = 0;
+static int end_of_input; // Terminal index of the end of input
+
+static GramProduction productions[MAX_PRODUCTIONS];
+static int production_count = 0;
+
+static char start_name[MAX_NAME_LEN] = {'\0'};
+static int expected_conflicts = 0;
+static bool verbose = false; // List the decisions left to the order of alternatives
+
+static LookSet first_sets[MAX_SYMBOLS];
+static LookSet follow_sets[MAX_SYMBOLS];
+static LookSet production_sets[MAX_PRODUCTIONS];
+
+static bool set_bit(uint64_t *words, int bit) {
+  uint64_t mask = (uint64_t)1 << (bit % 64);
+  bool was_set = words[bit / 64] & mask;
+  words[bit / 64] |= mask;
+  return !was_set;
+}
+
+static bool test_bit(const uint64_t *words, int bit) {
+  return (words[bit / 64] >> (bit % 64)) & 1;
+}
+
+// Adds src to dst, returns true if dst changed
+static bool merge_set(LookSet *dst, const LookSet *src) {
+  bool changed = false;
+  if (src->empty && !dst->empty) {
+    dst->empty = true;
+    changed = true;
+  }
+  for (int w = 0; w < SET_WORDS; w++) {
+    if (src->one[w] & ~dst->one[w]) {
+      dst->one[w] |= src->one[w];
+      changed = true;
+    }
+  }
+  for (int a = 0; a < terminal_count; a++) {
+    for (int w = 0; w < SET_WORDS; w++) {
+      if (src->two[a][w] & ~dst->two[a][w]) {
+        dst->two[a][w] |= src->two[a][w];
+        changed = true;
+      }
+    }
+  }
+  return changed;
+}
+
+// result = every string of left followed by every string of right, cut to two tokens
+static void concat_sets(LookSet *result, const LookSet *left, const LookSet *right) {
+  LookSet temp;
+  memset(&temp, 0, sizeof(temp));
+  temp.empty = left->empty && right->empty;
+
+  // Tokens that can start a string of right
+  uint64_t right_first[SET_WORDS];
+  memcpy(right_first, right->one, sizeof(right_first));
+  for (int a = 0; a < terminal_count; a++) {
+    for (int w = 0; w < SET_WORDS; w++) {
+      if (right->two[a][w]) {
+        set_bit(right_first, a);
+        break;
+      }
+    }
+  }
+
+  for (int w = 0; w < SET_WORDS; w++) {
+    if (left->empty) temp.one[w] |= right->one[w];
+    if (right->empty) temp.one[w] |= left->one[w];
+  }
+  for (int a = 0; a < terminal_count; a++) {
+    for (int w = 0; w < SET_WORDS; w++) {
+      temp.two[a][w] = left->two[a][w];
+      if (left->empty) temp.two[a][w] |= right->two[a][w];
+      if (test_bit(left->one, a)) temp.two[a][w] |= right_first[w];
+    }
+  }
+  *result = temp;
+}
+
+static void sequence_first(LookSet *result, const int *rhs, int length) {
+  memset(result, 0, sizeof(*result));
+  result->empty = true;
+  for (int i = 0; i < length; i++) {
+    concat_sets(result, result, &first_sets[rhs[i]]);
+  }
+}
+
+static int find_symbol(const char *name) {
+  for (int i = 0; i < symbol_count; i++) {
+    if (strcmp(symbols[i].name, name) == 0) return i;
+  }
+  return -1;
+}
+
+static int intern_symbol(const char *name) {
+  int index = find_symbol(name);
+  if (index >= 0) return index;
+  if (symbol_count == MAX_SYMBOLS) {
+    fprintf(stderr, "llgen: Error: More than %d symbols\n", MAX_SYMBOLS);
+    exit(EXIT_FAILURE);
+  }
+  strcpy(symbols[symbol_count].name, name);
+  symbols[symbol_count].is_nonterm = false;
+  symbols[symbol_count].nonterm_index = -1;
+  symbols[symbol_count].terminal_index = -1;
+  return symbol_count++;
+}
+
+// Grammar file reading:
+
+static char *grammar_text;
+static char *grammar_pos;
+static int grammar_line = 1;
+
+static void skip_space(void) {
+  while (*grammar_pos != '\0') {
+    if (*grammar_pos == '#') {
+      while (*grammar_pos != '\0' && *grammar_pos != '\n') grammar_pos++;
+    } else if (isspace((unsigned char)*grammar_pos)) {
+      if (*grammar_pos == '\n') grammar_line++;
+      grammar_pos++;
+    } else {
+      return;
+    }
+  }
+}
+
+static bool read_name(char *name) {
+  skip_space();
+  int length = 0;
+  while (isalnum((unsigned char)*grammar_pos) || *grammar_pos == '_') {
+    if (length == MAX_NAME_LEN - 1) {
+      fprintf(stderr, "llgen: Error: Name too long on line %d\n", grammar_line);
+      exit(EXIT_FAILURE);
+    }
+    name[length++] = *grammar_pos++;
+  }
+  name[length] = '\0';
+  return length > 0;
+}
+
+static void syntax_error(const char *message) {
+  fprintf(stderr, "llgen: Error: %s on line %d\n", message, grammar_line);
+  exit(EXIT_FAILURE);
+}
+
+static void read_directive(void) {
+  char name[MAX_NAME_LEN];
+  grammar_pos++;
+  if (!read_name(name)) syntax_error("Missing directive name after %");
+  if (strcmp(name, "start") == 0) {
+    if (!read_name(start_name)) syntax_error("Missing rule name after %start");
+  } else if (strcmp(name, "expect") == 0) {
+    skip_space();
+    char *end;
+    expected_conflicts = (int)strtol(grammar_pos, &end, 10);
+    if (end == grammar_pos) syntax_error("Missing number after %expect");
+    grammar_pos = end;
+  } else {
+    syntax_error("Unknown directive");
+  }
+}
+
+static void read_rule(void) {
+  char name[MAX_NAME_LEN];
+  if (!read_name(name)) syntax_error("Expected a rule name");
+  int lhs = intern_symbol(name);
+  if (symbols[lhs].is_nonterm) syntax_error("Rule defined twice");
+  symbols[lhs].is_nonterm = true;
+  symbols[lhs].nonterm_index = nonterm_count;
+  nonterm_symbols[nonterm_count++] = lhs;
+
+  skip_space();
+  if (*grammar_pos != ':') syntax_error("Expected ':' after the rule name");
+  grammar_pos++;
+
+  GramProduction *production = &productions[production_count];
+  memset(production, 0, sizeof(*production));
+  production->lhs = lhs;
+  production->line = grammar_line;
+  while (true) {
+    skip_space();
+    if (*grammar_pos == '|' || *grammar_pos == ';') {
+      production_count++;
+      if (production_count == MAX_PRODUCTIONS) syntax_error("Too many productions");
+      if (*grammar_pos++ == ';') return;
+      production = &productions[production_count];
+      memset(production, 0, sizeof(*production));
+      production->lhs = lhs;
+      production->line = grammar_line;
+      continue;
+    }
+    bool child = false;
+    if (*grammar_pos == '>') {
+      child = true;
+      grammar_pos++;
+    }
+    if (!read_name(name)) syntax_error("Expected a symbol, '|' or ';'");
+    if (production->length == MAX_RHS) syntax_error("Production too long");
+    production->child[production->length] = child;
+    production->rhs[production->length++] = intern_symbol(name);
+  }
+}
+
+static void read_grammar(const char *path) {
+  FILE *file = fopen(path, "r");
+  if (file == NULL) {
+    fprintf(stderr, "llgen: Error: Could not open %s\n", path);
+    exit(EXIT_FAILURE);
+  }
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  grammar_text = malloc(size + 1);
+  if (grammar_text == NULL) {
+    fprintf(stderr, "llgen: Memory Error: Could not allocate the grammar text\n");
+    exit(EXIT_FAILURE);
+  }
+  size_t read = fread(grammar_text, 1, size, file);
+  grammar_text[read] = '\0';
+  fclose(file);
+
+  grammar_pos = grammar_text;
+  while (true) {
+    skip_space();
+    if (*grammar_pos == '\0') break;
+    if (*grammar_pos == '%') {
+      read_directive();
+    } else {
+      read_rule();
+    }
+  }
+  free(grammar_text);
+}
+
+// Remaining symbols are terminals. Rules are renumbered in order of definition, which
+// is also the order of their first production
+static void number_terminals(void) {
+  for (int i = 0; i < symbol_count; i++) {
+    if (symbols[i].is_nonterm) continue;
+    if (islower((unsigned char)symbols[i].name[0])) {
+      fprintf(stderr, "llgen: Error: Helper rule %s is used but never defined\n", symbols[i].name);
+      exit(EXIT_FAILURE);
+    }
+    if (terminal_count == MAX_TERMINALS - 1) {
+      fprintf(stderr, "llgen: Error: More than %d terminals\n", MAX_TERMINALS - 1);
+      exit(EXIT_FAILURE);
+    }
+    symbols[i].terminal_index = terminal_count;
+    terminal_symbols[terminal_count++] = i;
+  }
+  end_of_input = terminal_count++;
+}
+
+static void compute_first_sets(void) {
+  for (int i = 0; i < symbol_count; i++) {
+    memset(&first_sets[i], 0, sizeof(LookSet));
+    if (!symbols[i].is_nonterm) set_bit(first_sets[i].one, symbols[i].terminal_index);
+  }
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (int p = 0; p < production_count; p++) {
+      LookSet set;
+      sequence_first(&set, productions[p].rhs, productions[p].length);
+      changed |= merge_set(&first_sets[productions[p].lhs], &set);
+    }
+  }
+}
+
+static void compute_follow_sets(int start) {
+  for (int i = 0; i < symbol_count; i++) {
+    memset(&follow_sets[i], 0, sizeof(LookSet));
+  }
+  set_bit(follow_sets[start].one, end_of_input);
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (int p = 0; p < production_count; p++) {
+      GramProduction *production = &productions[p];
+      for (int i = 0; i < production->length; i++) {
+        int symbol = production->rhs[i];
+        if (!symbols[symbol].is_nonterm) continue;
+        LookSet set;
+        sequence_first(&set, production->rhs + i + 1, production->length - i - 1);
+        concat_sets(&set, &set, &follow_sets[production->lhs]);
+        changed |= merge_set(&follow_sets[symbol], &set);
+      }
+    }
+  }
+}
+
+// Whether production p can start with token a followed by token b (b = end_of_input
+// also covers strings that end right after a)
+static bool predicts(int p, int a, int b) {
+  const LookSet *set = &production_sets[p];
+  if (test_bit(set->two[a], b)) return true;
+  return b == end_of_input && test_bit(set->one, a);
+}
+
+static bool predicts_first(int p, int a) {
+  const LookSet *set = &production_sets[p];
+  if (test_bit(set->one, a)) return true;
+  for (int w = 0; w < SET_WORDS; w++) {
+    if (set->two[a][w]) return true;
+  }
+  return false;
+}
+
+static void print_terminal(FILE *out, int terminal) {
+  if (terminal == end_of_input) {
+    fprintf(out, "LL_END_OF_INPUT");
+  } else {
+    fprintf(out, "MINIMAL_TOKEN_INDEX(%s)", symbols[terminal_symbols[terminal]].name);
+  }
+}
+
+static const char *terminal_name(int terminal) {
+  return terminal == end_of_input ? "end of input" : symbols[terminal_symbols[terminal]].name;
+}
+
+static void write_tables(const char *grammar_path, const char *path, int start) {
+  FILE *out = fopen(path, "w");
+  if (out == NULL) {
+    fprintf(stderr, "llgen: Error: Could not open %s for writing\n", path);
+    exit(EXIT_FAILURE);
+  }
+
+  fprintf(out, "// Generated by tools/llgen from %s. Do not edit\n\n", grammar_path);
+  fprintf(out, "#include <stdio.h>\n#include <stdint.h>\n#include <stdbool.h>\n\n");
+  fprintf(out, "#include \"inc/ll-table.h\"\n\n");
+
+  fprintf(out, "const MiniGramNonTerm ll_nonterms[] = {\n");
+  for (int n = 0; n < nonterm_count; n++) {
+    const char *name = symbols[nonterm_symbols[n]].name;
+    if (isupper((unsigned char)name[0])) {
+      fprintf(out, "  {%s, \"%s\"},\n", name, name);
+    } else {
+      fprintf(out, "  {NON_TERM_UNDETERMINED, \"%s\"},\n", name);
+    }
+  }
+  fprintf(out, "};\n\n");
+
+  fprintf(out, "const MiniGramSymbol ll_symbols[] = {\n");
+  int first_symbol = 0;
+  for (int p = 0; p < production_count; p++) {
+    GramProduction *production = &productions[p];
+    fprintf(out, "  // %d: %s :", p, symbols[production->lhs].name);
+    for (int i = 0; i < production->length; i++) {
+      fprintf(out, " %s%s", production->child[i] ? ">" : "", symbols[production->rhs[i]].name);
+    }
+    fprintf(out, "\n");
+    if (production->length == 0) continue;
+    fprintf(out, " ");
+    for (int i = 0; i < production->length; i++) {
+      int symbol = production->rhs[i];
+      fprintf(out, " ");
+      if (symbols[symbol].is_nonterm) {
+        fprintf(out, "(LL_NONTERM_BASE + %d)", symbols[symbol].nonterm_index);
+      } else {
+        print_terminal(out, symbols[symbol].terminal_index);
+      }
+      fprintf(out, "%s,", production->child[i] ? " | LL_CHILD_FLAG" : "");
+    }
+    fprintf(out, "\n");
+  }
+  fprintf(out, "  0\n};\n\n");
+
+  fprintf(out, "const MiniGramProduction ll_productions[] = {\n");
+  for (int p = 0; p < production_count; p++) {
+    fprintf(out, "  {%d, %d, %d},\n", symbols[productions[p].lhs].nonterm_index, first_symbol, productions[p].length);
+    first_symbol += productions[p].length;
+  }
+  fprintf(out, "};\n\n");
+
+  // Decide every cell, remembering the ones that need the second token
+  static int second_rows[MAX_SYMBOLS][MAX_TERMINALS + 1];
+  static int second_cells[MAX_SYMBOLS * 4][MAX_TERMINALS + 1];
+  int second_row_count = 0;
+  int conflicts = 0;
+  memset(second_rows, -1, sizeof(second_rows));
+
+  for (int n = 0; n < nonterm_count; n++) {
+    int lhs = nonterm_symbols[n];
+    for (int a = 0; a < terminal_count; a++) {
+      int chosen = -1;
+      bool ambiguous = false;
+      for (int p = 0; p < production_count; p++) {
+        if (productions[p].lhs != lhs || !predicts_first(p, a)) continue;
+        if (chosen < 0) {
+          chosen = p;
+        } else {
+          ambiguous = true;
+        }
+      }
+      if (!ambiguous) {
+        second_rows[n][a] = chosen < 0 ? -1 : -2 - chosen;
+        continue;
+      }
+
+      int row = second_row_count++;
+      if (row == MAX_SYMBOLS * 4) {
+        fprintf(stderr, "llgen: Error: Too many decisions need a second token\n");
+        exit(EXIT_FAILURE);
+      }
+      second_rows[n][a] = row;
+      bool conflicting = false;
+      for (int b = 0; b < terminal_count; b++) {
+        second_cells[row][b] = -1;
+        for (int p = 0; p < production_count; p++) {
+          if (productions[p].lhs != lhs || !predicts(p, a, b)) continue;
+          if (second_cells[row][b] < 0) {
+            second_cells[row][b] = p;
+          } else if (!conflicting) {
+            conflicting = true;
+            if (verbose) fprintf(stderr, "llgen: Note: %s on %s %s: production %d (line %d) taken over production %d (line %d)\n",
+              symbols[lhs].name, terminal_name(a), terminal_name(b),
+              second_cells[row][b], productions[second_cells[row][b]].line, p, productions[p].line);
+          }
+        }
+      }
+      if (conflicting) conflicts++;
+    }
+  }
+
+  fprintf(out, "const uint16_t ll_predict[][LL_TERMINAL_COUNT] = {\n");
+  for (int n = 0; n < nonterm_count; n++) {
+    fprintf(out, "  { // %s\n", symbols[nonterm_symbols[n]].name);
+    for (int a = 0; a < terminal_count; a++) {
+      int entry = second_rows[n][a];
+      if (entry == -1) continue;
+      fprintf(out, "    [");
+      print_terminal(out, a);
+      if (entry >= 0) {
+        fprintf(out, "] = LL_SECOND_TOKEN | %d,\n", entry);
+      } else {
+        fprintf(out, "] = %d,\n", -2 - entry + 1);
+      }
+    }
+    fprintf(out, "  },\n");
+  }
+  fprintf(out, "};\n\n");
+
+  fprintf(out, "const uint16_t ll_second_predict[][LL_TERMINAL_COUNT] = {\n");
+  for (int row = 0; row < second_row_count; row++) {
+    fprintf(out, "  {\n");
+    for (int b = 0; b < terminal_count; b++) {
+      if (second_cells[row][b] < 0) continue;
+      fprintf(out, "    [");
+      print_terminal(out, b);
+      fprintf(out, "] = %d,\n", second_cells[row][b] + 1);
+    }
+    fprintf(out, "  },\n");
+  }
+  if (second_row_count == 0) fprintf(out, "  {0}\n");
+  fprintf(out, "};\n\n");
+
+  fprintf(out, "const uint16_t ll_start = %d;\n", symbols[start].nonterm_index);
+  fclose(out);
+
+  if (conflicts != expected_conflicts) {
+    fprintf(stderr, "llgen: Warning: %d decision(s) left to the order of alternatives, %%expect says %d (-v lists them)\n",
+      conflicts, expected_conflicts);
+  }
+}
+
+int main(int argc, char **argv) {
+  if (argc == 4 && strcmp(argv[1], "-v") == 0) {
+    verbose = true;
+    argv++;
+    argc--;
+  }
+  if (argc != 3) {
+    fprintf(stderr, "Usage: %s [-v] <grammar file> <output file>\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  read_grammar(argv[1]);
+  number_terminals();
+
+  int start = find_symbol(start_name);
+  if (start < 0 || !symbols[start].is_nonterm) {
+    fprintf(stderr, "llgen: Error: Missing or unknown %%start rule\n");
+    return EXIT_FAILURE;
+  }
+  compute_first_sets();
+  compute_follow_sets(start);
+  for (int p = 0; p < production_count; p++) {
+    sequence_first(&production_sets[p], productions[p].rhs, productions[p].length);
+    concat_sets(&production_sets[p], &production_sets[p], &follow_sets[productions[p].lhs]);
+  }
+
+  write_tables(argv[1], argv[2], start);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,455 @@
+/*
+  =======================================================================
+  This file is part of Minimal (mnml) - A *.mini source to C compiler for
+  the Minimal programming language
+
+  Written in 2025 by approx-error
+
+  Minimal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Minimal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+  ======================================================================
+*/
+
+// mkprog: Writes a random Minimal program of about the requested size, for benchmarks
+//
+// Usage: mkprog [-b bytes] [-s seed] [-m modules] [-n statements] [-d depth]
+//               [-e complexity] [-c collection size] <output file>
+//
+// The program is one file with m modules and a main part. The modules are filled with
+// subprograms until the file reaches the requested size (K and M suffixes are accepted),
+// so the size decides how many subprograms there are (every module gets at least one, which
+// makes very small programs larger than requested) and the other options decide what
+// they look like: n statements per sequence, branches nested up to d levels deep,
+// expressions nested up to e levels deep and collection literals of c elements.
+// Everything follows grammar/minimal.grammar, names are declared before they are used
+// and no line is longer than the preprocessor allows. Collections and expressions are
+// made smaller where they wouldn't fit on a line. The same options and seed always
+// give the same program.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <unistd.h>
+
+// MAX_LINE_LENGTH of src/preprocessor.c
+#define MAX_LINE 100
+#define MAX_VISIBLE 4096
+#define INDENT_WIDTH 2
+#define MAX_INDENT 16
+
+typedef struct program_shape {
+  uint64_t bytes;
+  uint64_t seed;
+  int modules;
+  int statements;
+  int depth;
+  int complexity;
+  int collection;
+} ProgShape;
+
+typedef struct program_state {
+  FILE *output;
+  uint64_t written;
+  uint64_t random;
+  const ProgShape *shape;
+  int module; // Module being written, shape->modules for the main part
+  int function_count; // Subprograms of the current module so far
+  int visible[MAX_VISIBLE]; // Ids of the local variables in scope
+  int visible_count;
+  int next_variable;
+} ProgState;
+
+static uint64_t next_random(ProgState *state) {
+  // xorshift64*
+  state->random ^= state->random >> 12;
+  state->random ^= state->random << 25;
+  state->random ^= state->random >> 27;
+  return state->random * 2685821657736338717ULL;
+}
+
+static int random_below(ProgState *state, int bound) {
+  return bound <= 0 ? 0 : (int)(next_random(state) % (uint64_t)bound);
+}
+
+static void emit_line(ProgState *state, int level, const char *line) {
+  int indent = (level > MAX_INDENT ? MAX_INDENT : level) * INDENT_WIDTH;
+  int length = fprintf(state->output, "%*s%s\n", indent, "", line);
+  if (length > 0) {
+    state->written += (uint64_t)length;
+  }
+}
+
+// Appends to a line being built. Returns false if it doesn't fit
+static bool append(char *line, size_t *length, const char *format, ...) __attribute__((format(printf, 3, 4)));
+
+static bool append(char *line, size_t *length, const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  int added = vsnprintf(line + *length, MAX_LINE + 1 - *length, format, args);
+  va_end(args);
+  if (added < 0 || *length + (size_t)added > MAX_LINE) {
+    line[*length] = '\0';
+    return false;
+  }
+  *length += (size_t)added;
+  return true;
+}
+
+// An integer: a local, a constant of the module, or a literal
+static bool append_operand(ProgState *state, char *line, size_t *length) {
+  int choice = random_below(state, 3);
+  if (choice == 0 && state->visible_count > 0) {
+    return append(line, length, "v%d", state->visible[random_below(state, state->visible_count)]);
+  }
+  if (choice == 1) {
+    // Main sees the constants of the module in its own file, the last one
+    int module = state->module < state->shape->modules ? state->module : state->shape->modules - 1;
+    return append(line, length, "K%dN%d", module, random_below(state, 4));
+  }
+  return append(line, length, "%d", random_below(state, 100000));
+}
+
+static bool append_expression(ProgState *state, char *line, size_t *length, int complexity);
+
+static bool append_call(ProgState *state, char *line, size_t *length, int complexity) {
+  int module = state->module;
+  int functions = state->function_count;
+  if (module == state->shape->modules) {
+    // Main can call any subprogram of the last module
+    module--;
+    functions = 1;
+  }
+  if (functions == 0) {
+    return append_operand(state, line, length);
+  }
+  return append(line, length, "$f%dx%d(", module, random_below(state, functions)) &&
+    append_expression(state, line, length, complexity - 1) &&
+    append(line, length, ", ") &&
+    append_expression(state, line, length, complexity - 1) &&
+    append(line, length, ")");
+}
+
+// The grammar allows a single operator per arithmetic expression, so complexity is the
+// nesting of parentheses and subprogram calls around and inside it
+static bool append_expression(ProgState *state, char *line, size_t *length, int complexity) {
+  static const char *operators[] = {"+", "-", "*", "/"};
+  if (complexity <= 0) {
+    return append_operand(state, line, length);
+  }
+  switch (random_below(state, 3)) {
+    case 0:
+      return append(line, length, "(") &&
+        append_expression(state, line, length, complexity - 1) &&
+        append(line, length, ")");
+    case 1:
+      return append_call(state, line, length, complexity);
+    default:
+      return append_operand(state, line, length) &&
+        append(line, length, " %s ", operators[random_below(state, 4)]) &&
+        (random_below(state, 2) == 0 ? append_call(state, line, length, complexity) : append_operand(state, line, length));
+  }
+}
+
+static bool has_callee(ProgState *state) {
+  return state->module == state->shape->modules || state->function_count > 0;
+}
+
+// A call statement, or output if there is nothing to call yet
+static void emit_call(ProgState *state, int level) {
+  char line[MAX_LINE + 1];
+  if (!has_callee(state)) {
+    emit_line(state, level, "!\"nothing to call\" -> ...;");
+    return;
+  }
+  // Arguments are single operands at complexity 0, which always fits
+  for (int complexity = state->shape->complexity; ; complexity--) {
+    size_t length = 0;
+    if ((append_call(state, line, &length, complexity) && append(line, &length, ";")) || complexity <= 0) {
+      emit_line(state, level, line);
+      return;
+    }
+  }
+}
+
+// Writes prefix, an expression and suffix on one line, simplifying the expression until
+// the line fits
+static void emit_with_expression(ProgState *state, int level, const char *prefix, const char *suffix) {
+  char line[MAX_LINE + 1];
+  for (int complexity = state->shape->complexity; complexity >= 0; complexity--) {
+    size_t length = 0;
+    uint64_t random = state->random;
+    if (append(line, &length, "%s", prefix) &&
+        append_expression(state, line, &length, complexity) &&
+        append(line, &length, "%s", suffix)) {
+      emit_line(state, level, line);
+      return;
+    }
+    state->random = random + 1;
+  }
+  // A single operand always fits after the prefixes used here
+  snprintf(line, sizeof(line), "%s0%s", prefix, suffix);
+  emit_line(state, level, line);
+}
+
+static int declare_variable(ProgState *state) {
+  int id = state->next_variable++;
+  if (state->visible_count < MAX_VISIBLE) {
+    state->visible[state->visible_count++] = id;
+  }
+  return id;
+}
+
+static void emit_sequence(ProgState *state, int level, int depth);
+
+static void emit_nested(ProgState *state, int level, int depth) {
+  int saved = state->visible_count;
+  emit_sequence(state, level, depth);
+  state->visible_count = saved;
+}
+
+static void emit_statement(ProgState *state, int level, int depth) {
+  char prefix[MAX_LINE + 1];
+  int nested = depth < state->shape->depth ? 4 : 0;
+  int choice = random_below(state, 6 + nested);
+  if (state->visible_count == 0 && choice >= 1 && choice <= 3) {
+    choice = 0;
+  }
+  int variable;
+  int cases;
+  int saved;
+  switch (choice) {
+    case 0:
+      // The variable is only visible after its own initial value
+      variable = state->next_variable;
+      snprintf(prefix, sizeof(prefix), "<#> v%d := ", variable);
+      emit_with_expression(state, level, prefix, ";");
+      declare_variable(state);
+      break;
+    case 1:
+      snprintf(prefix, sizeof(prefix), "v%d := ", state->visible[random_below(state, state->visible_count)]);
+      emit_with_expression(state, level, prefix, ";");
+      break;
+    case 2:
+      snprintf(prefix, sizeof(prefix), "v%d++;", state->visible[random_below(state, state->visible_count)]);
+      emit_line(state, level, prefix);
+      break;
+    case 3:
+      snprintf(prefix, sizeof(prefix), "v%d += ", state->visible[random_below(state, state->visible_count)]);
+      emit_with_expression(state, level, prefix, ";");
+      break;
+    case 4:
+      snprintf(prefix, sizeof(prefix), "!\"line %d\" -> ...;", random_below(state, 1000));
+      emit_line(state, level, prefix);
+      break;
+    case 5:
+      emit_call(state, level);
+      break;
+    case 6:
+      emit_line(state, level, random_below(state, 2) == 0 ? "?? T:" : "?? F:");
+      emit_nested(state, level + 1, depth + 1);
+      if (random_below(state, 2) == 0) {
+        emit_line(state, level, "|? N:");
+        emit_nested(state, level + 1, depth + 1);
+      }
+      if (random_below(state, 2) == 0) {
+        emit_line(state, level, "|.:");
+        emit_nested(state, level + 1, depth + 1);
+      }
+      emit_line(state, level, "~?");
+      break;
+    case 7:
+      emit_with_expression(state, level, "## ", ":");
+      cases = 1 + random_below(state, 3);
+      for (int i = 0; i < cases; i++) {
+        snprintf(prefix, sizeof(prefix), "#= %d:", i);
+        emit_line(state, level + 1, prefix);
+        emit_nested(state, level + 2, depth + 1);
+        emit_line(state, level + 2, ".;");
+      }
+      emit_line(state, level + 1, "#= _:");
+      emit_nested(state, level + 2, depth + 1);
+      emit_line(state, level, "~#");
+      break;
+    case 8:
+      emit_line(state, level, "@@ T:");
+      emit_nested(state, level + 1, depth + 1);
+      emit_line(state, level, "~@");
+      break;
+    default:
+      // The loop variable is only visible in the body
+      variable = state->next_variable;
+      snprintf(prefix, sizeof(prefix), "@@ <#> v%d := 0; T; v%d++:", variable, variable);
+      emit_line(state, level, prefix);
+      saved = state->visible_count;
+      declare_variable(state);
+      emit_sequence(state, level + 1, depth + 1);
+      state->visible_count = saved;
+      emit_line(state, level, "~@");
+      break;
+  }
+}
+
+static void emit_sequence(ProgState *state, int level, int depth) {
+  int statements = state->shape->statements > 0 ? state->shape->statements : 1;
+  for (int i = 0; i < statements; i++) {
+    emit_statement(state, level, depth);
+  }
+}
+
+// Fills the collection literal started in line with elements while there is room left for
+// the closing "];". Returns the number of elements
+static int append_elements(ProgState *state, char *line, size_t *length, bool dict) {
+  int count = 0;
+  for (int i = 0; i < state->shape->collection; i++) {
+    size_t before = *length;
+    const char *separator = i == 0 ? "" : ", ";
+    bool fits = dict ?
+      append(line, length, "%s\"k%d\": %d", separator, i, random_below(state, 1000)) :
+      append(line, length, "%s%d", separator, random_below(state, 1000));
+    if (!fits || *length + 2 > MAX_LINE) {
+      *length = before;
+      line[before] = '\0';
+      break;
+    }
+    count++;
+  }
+  return count;
+}
+
+static void emit_collections(ProgState *state) {
+  char line[MAX_LINE + 1];
+  size_t length = 0;
+  append(line, &length, "[#] l%d := [", state->module);
+  if (append_elements(state, line, &length, false) == 0) {
+    append(line, &length, "0");
+  }
+  append(line, &length, "];");
+  emit_line(state, 1, line);
+
+  length = 0;
+  append(line, &length, "[\":#] d%d := [", state->module);
+  if (append_elements(state, line, &length, true) == 0) {
+    append(line, &length, "\"k\": 0");
+  }
+  append(line, &length, "];");
+  emit_line(state, 1, line);
+}
+
+static void emit_subprogram(ProgState *state) {
+  char line[MAX_LINE + 1];
+  snprintf(line, sizeof(line), "$$ f%dx%d(<#> v0, <#> v1) -> <#>:", state->module, state->function_count);
+  emit_line(state, 1, line);
+  state->visible[0] = 0;
+  state->visible[1] = 1;
+  state->visible_count = 2;
+  state->next_variable = 2;
+  emit_sequence(state, 2, 0);
+  emit_with_expression(state, 2, "<- ", ";");
+  emit_line(state, 1, "~$");
+  state->function_count++;
+}
+
+static void emit_module_header(ProgState *state) {
+  char line[MAX_LINE + 1];
+  snprintf(line, sizeof(line), "}}} m%d:", state->module);
+  emit_line(state, 0, line);
+  if (state->module > 0) {
+    snprintf(line, sizeof(line), ":: m%d;", state->module - 1);
+    emit_line(state, 1, line);
+  }
+  emit_line(state, 1, "C::\"stdio.h\";");
+  snprintf(line, sizeof(line), "<#> -> <t%d>;", state->module);
+  emit_line(state, 1, line);
+  for (int i = 0; i < 4; i++) {
+    snprintf(line, sizeof(line), "<#> K%dN%d := %d;", state->module, i, random_below(state, 1000));
+    emit_line(state, 1, line);
+  }
+  emit_collections(state);
+}
+
+static void write_program(ProgState *state) {
+  const ProgShape *shape = state->shape;
+  // Every module gets an equal share of the size, the main part is small
+  uint64_t share = shape->bytes / (uint64_t)shape->modules;
+  for (int module = 0; module < shape->modules; module++) {
+    state->module = module;
+    state->function_count = 0;
+    if (module == shape->modules - 1) {
+      emit_line(state, 0, "!~>..<~!");
+    }
+    emit_module_header(state);
+    do {
+      emit_subprogram(state);
+    } while (state->written < share * (uint64_t)(module + 1));
+    emit_line(state, 0, "{{{");
+  }
+
+  // The main part calls the first subprogram of the last module
+  state->module = shape->modules;
+  state->visible_count = 0;
+  state->next_variable = 0;
+  emit_line(state, 0, ">>> prog [..]:");
+  emit_sequence(state, 1, shape->depth);
+  emit_line(state, 1, "<- 0;");
+  emit_line(state, 0, "<<<");
+}
+
+static uint64_t parse_size(const char *text) {
+  char *end;
+  uint64_t size = strtoull(text, &end, 10);
+  if (*end == 'K' || *end == 'k') {
+    size <<= 10;
+  } else if (*end == 'M' || *end == 'm') {
+    size <<= 20;
+  } else if (*end == 'G' || *end == 'g') {
+    size <<= 30;
+  }
+  return size;
+}
+
+int main(int argc, char **argv) {
+  ProgShape shape = {.bytes = 1 << 10, .seed = 1, .modules = 4, .statements = 4, .depth = 2, .complexity = 1, .collection = 5};
+  int option;
+  while ((option = getopt(argc, argv, "b:s:m:n:d:e:c:")) != -1) {
+    switch (option) {
+      case 'b': shape.bytes = parse_size(optarg); break;
+      case 's': shape.seed = strtoull(optarg, NULL, 10); break;
+      case 'm': shape.modules = atoi(optarg); break;
+      case 'n': shape.statements = atoi(optarg); break;
+      case 'd': shape.depth = atoi(optarg); break;
+      case 'e': shape.complexity = atoi(optarg); break;
+      case 'c': shape.collection = atoi(optarg); break;
+      default:
+        fprintf(stderr, "Usage: %s [-b bytes] [-s seed] [-m modules] [-n statements] [-d depth] [-e complexity] [-c collection size] <output file>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+  if (optind != argc - 1 || shape.modules < 1) {
+    fprintf(stderr, "Usage: %s [-b bytes] [-s seed] [-m modules] [-n statements] [-d depth] [-e complexity] [-c collection size] <output file>\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  ProgState state = {.output = fopen(argv[optind], "w"), .written = 0, .shape = &shape};
+  if (state.output == NULL) {
+    fprintf(stderr, "mkprog: Error: Can't open %s\n", argv[optind]);
+    return EXIT_FAILURE;
+  }
+  // xorshift can't start from 0
+  state.random = shape.seed * 0x9E3779B97F4A7C15ULL + 1;
+  write_program(&state);
+  fclose(state.output);
+  return EXIT_SUCCESS;
+}
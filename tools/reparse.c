@@ -0,0 +1,273 @@
+/*
+  =======================================================================
+  This file is part of Minimal (mnml) - A *.mini source to C compiler for
+  the Minimal programming language
+
+  Written in 2025 by approx-error
+
+  Minimal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Minimal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+  ======================================================================
+*/
+
+// minireparse: Checks reparse_edit() against full parses on random edits
+//
+// Usage: minireparse [-n edits] [-s seed] <file.prep>...
+//
+// Every preprocessed file that parses is edited n times (200 by default). An edit replaces
+// up to three lines with up to three copies of other lines of the file, or one line with
+// another, the way moving, copying and deleting code would. After every edit the tree and
+// the token list that reparse_edit() left must be the same as the ones a full parse of the
+// edited lines gives: the same nodes with the same tokens on the same lines, parent links
+// that match the tree and tokens that point at their nodes. The two parses must also agree
+// on whether the source is valid, and after an edit that makes it invalid the file starts
+// over from a full parse of the edited lines. The exit status is nonzero on any difference.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "inc/retcodes.h"
+#include "inc/preprocessor.h"
+#include "inc/tokens.h"
+#include "inc/syntax.h"
+
+#define MAX_LINES 65536
+#define MAX_EDIT_LINES 3
+
+static uint64_t random_state = 1;
+
+static uint64_t next_random(void) {
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 7;
+  random_state ^= random_state << 17;
+  return random_state;
+}
+
+static size_t random_below(size_t bound) {
+  return bound == 0 ? 0 : next_random() % bound;
+}
+
+typedef struct reparse_source {
+  char *lines[MAX_LINES];
+  uint32_t line_count;
+  MiniHeadToken tokens;
+  MiniSyntaxTree root;
+} ReparseSource;
+
+static void free_parse(MiniHeadToken *tokens, MiniSyntaxTree *root) {
+  free_syntax_tree(root->child);
+  root->child = NULL;
+  free_tokens(tokens);
+}
+
+// Lexes and parses lines from scratch the way the compiler would
+static MiniStatus full_parse(char **lines, uint32_t line_count, MiniHeadToken *tokens, MiniSyntaxTree *root) {
+  *tokens = (MiniHeadToken) {.token_count = 0, .head = NULL, .tail = NULL};
+  *root = (MiniSyntaxTree) {.data.non_terminal = SOURCE, .data_type = NON_TERMINAL, .child = NULL, .sibling = NULL, .parent = NULL};
+  MiniStatus status = tokenize_text_lines(lines, line_count, 0, tokens);
+  if (status != SUCCESS) return status;
+  if (tokens->token_count == 0) return LAST_TOKEN;
+  char parse_file[] = "/dev/null";
+  return generate_ast(parse_file, parse_file, tokens, root, 0, 0);
+}
+
+static bool same_node(MiniSyntaxTree *a, MiniSyntaxTree *b) {
+  if (a->data_type != b->data_type) return false;
+  if (a->data_type == NON_TERMINAL) return a->data.non_terminal == b->data.non_terminal;
+  MiniToken *x = &a->data.token;
+  MiniToken *y = &b->data.token;
+  return x->name == y->name && x->line == y->line && strcmp(x->string_repr, y->string_repr) == 0;
+}
+
+// Walks both trees in preorder through the parent links, without recursion, so that the
+// links are checked along with the nodes
+static bool same_tree(MiniSyntaxTree *a_root, MiniSyntaxTree *b_root) {
+  MiniSyntaxTree *a = a_root;
+  MiniSyntaxTree *b = b_root;
+  while (true) {
+    if (!same_node(a, b)) return false;
+    if (a->child != NULL || b->child != NULL) {
+      if (a->child == NULL || b->child == NULL || a->child->parent != a) return false;
+      a = a->child;
+      b = b->child;
+      continue;
+    }
+    while (a->sibling == NULL && b->sibling == NULL) {
+      a = a->parent;
+      b = b->parent;
+      if (a == a_root) return b == b_root;
+      if (a == NULL || b == NULL) return false;
+    }
+    if (a->sibling == NULL || b->sibling == NULL || a->sibling->parent != a->parent) return false;
+    a = a->sibling;
+    b = b->sibling;
+  }
+}
+
+static bool same_tokens(MiniHeadToken *a, MiniHeadToken *b) {
+  if (a->token_count != b->token_count) return false;
+  MiniToken *x = a->head;
+  MiniToken *y = b->head;
+  for (; x != NULL && y != NULL; x = x->next_token, y = y->next_token) {
+    if (x->name != y->name || x->line != y->line || strcmp(x->string_repr, y->string_repr) != 0) return false;
+    // A token in the tree points at the node copied from it
+    if (x->node != NULL && (x->node->data.token.string_repr != x->string_repr || x->node->data.token.line != x->line)) return false;
+  }
+  return x == NULL && y == NULL;
+}
+
+// Makes a random edit, applies it to the lines and returns it with the new lines in added
+static MiniTextEdit random_edit(ReparseSource *source, char **added) {
+  MiniTextEdit edit;
+  uint32_t count = source->line_count;
+  if (next_random() % 2 == 0 && count > 0) {
+    edit.first_line = random_below(count);
+    edit.removed_lines = 1;
+    edit.added_lines = 1;
+  } else {
+    edit.first_line = random_below(count + 1);
+    uint32_t left = count - edit.first_line;
+    edit.removed_lines = random_below((left < MAX_EDIT_LINES ? left : MAX_EDIT_LINES) + 1);
+    edit.added_lines = random_below(MAX_EDIT_LINES + 1);
+  }
+  if (count + edit.added_lines - edit.removed_lines > MAX_LINES) {
+    edit.added_lines = edit.removed_lines;
+  }
+  for (uint32_t i = 0; i < edit.added_lines; i++) {
+    added[i] = strdup(count == 0 ? "" : source->lines[random_below(count)]);
+  }
+
+  for (uint32_t i = 0; i < edit.removed_lines; i++) {
+    free(source->lines[edit.first_line + i]);
+  }
+  uint32_t tail = count - edit.first_line - edit.removed_lines;
+  memmove(&source->lines[edit.first_line + edit.added_lines], &source->lines[edit.first_line + edit.removed_lines], tail * sizeof(char *));
+  for (uint32_t i = 0; i < edit.added_lines; i++) {
+    source->lines[edit.first_line + i] = strdup(added[i]);
+  }
+  source->line_count = count + edit.added_lines - edit.removed_lines;
+  edit.lines = added;
+  return edit;
+}
+
+static void free_lines(ReparseSource *source) {
+  for (uint32_t i = 0; i < source->line_count; i++) {
+    free(source->lines[i]);
+  }
+  source->line_count = 0;
+}
+
+static bool read_source(const char *file, ReparseSource *source) {
+  FILE *input_ptr = fopen(file, "r");
+  if (input_ptr == NULL) {
+    fprintf(stderr, "minireparse: Error: Can't read %s\n", file);
+    return false;
+  }
+  char line_buffer[MAX_LINE_LENGTH + 2];
+  source->line_count = 0;
+  while (source->line_count < MAX_LINES && fgets(line_buffer, sizeof(line_buffer), input_ptr) != NULL) {
+    line_buffer[strcspn(line_buffer, "\n")] = '\0';
+    source->lines[source->line_count++] = strdup(line_buffer);
+  }
+  fclose(input_ptr);
+  return true;
+}
+
+// Returns the number of edits that came out different from a full parse
+static int check_file(const char *file, int edit_count) {
+  static ReparseSource source;
+  if (!read_source(file, &source)) return 1;
+
+  int failures = 0;
+  MiniStatus status = full_parse(source.lines, source.line_count, &source.tokens, &source.root);
+  if (status != VALID_CONSTRUCT) {
+    fprintf(stderr, "minireparse: %s doesn't parse, skipped\n", file);
+    edit_count = 0;
+  }
+  for (int i = 0; i < edit_count && failures == 0; i++) {
+    char *added[MAX_EDIT_LINES];
+    MiniTextEdit edit = random_edit(&source, added);
+    status = reparse_edit(&source.root, &source.tokens, &edit, 1);
+
+    MiniHeadToken tokens;
+    MiniSyntaxTree root;
+    MiniStatus full_status = full_parse(source.lines, source.line_count, &tokens, &root);
+    bool valid = status == VALID_CONSTRUCT;
+    if (valid != (full_status == VALID_CONSTRUCT) || (valid && (!same_tree(&source.root, &root) || !same_tokens(&source.tokens, &tokens)))) {
+      fprintf(stderr, "minireparse: %s: Edit %d (%u line(s) from line %u replaced with %u) differs from a full parse\n",
+              file, i + 1, edit.removed_lines, edit.first_line + 1, edit.added_lines);
+      failures++;
+    }
+    for (uint32_t j = 0; j < edit.added_lines; j++) {
+      free(added[j]);
+    }
+    free_parse(&tokens, &root);
+    if (valid) continue;
+    // The tree of a failed parse may be missing nodes, so the edits go on from the file
+    free_parse(&source.tokens, &source.root);
+    free_lines(&source);
+    if (!read_source(file, &source)) return failures + 1;
+    full_parse(source.lines, source.line_count, &source.tokens, &source.root);
+  }
+  free_parse(&source.tokens, &source.root);
+  free_type_table();
+  free_lines(&source);
+  return failures;
+}
+
+int main(int argc, char **argv) {
+  int edit_count = 200;
+  int option;
+  while ((option = getopt(argc, argv, "n:s:")) != -1) {
+    switch (option) {
+      case 'n': edit_count = atoi(optarg); break;
+      case 's': random_state = strtoull(optarg, NULL, 10) * 0x9E3779B97F4A7C15ULL + 1; break;
+      default:
+        fprintf(stderr, "Usage: %s [-n edits] [-s seed] <file.prep>...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+
+  // The parser reports errors and what it parsed again on stdout. The messages are kept
+  // to count the edits that were parsed again on their own
+  fflush(stdout);
+  FILE *messages = tmpfile();
+  if (messages != NULL) {
+    dup2(fileno(messages), STDOUT_FILENO);
+  }
+
+  int failures = 0;
+  for (int i = optind; i < argc; i++) {
+    failures += check_file(argv[i], edit_count);
+  }
+
+  fflush(stdout);
+  int local = 0;
+  int whole = 0;
+  if (messages != NULL) {
+    rewind(messages);
+    char line[512];
+    while (fgets(line, sizeof(line), messages) != NULL) {
+      if (strncmp(line, "Reparsed the construct", 22) == 0) local++;
+      if (strncmp(line, "Reparsed the whole source", 25) == 0) whole++;
+    }
+    fclose(messages);
+  }
+  fprintf(stderr, "minireparse: %d edit(s) parsed again on their own, %d by parsing the whole source, %d different from a full parse\n",
+          local, whole, failures);
+  return failures > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
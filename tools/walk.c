@@ -0,0 +1,236 @@
+/*
+  =======================================================================
+  This file is part of Minimal (mnml) - A *.mini source to C compiler for
+  the Minimal programming language
+
+  Written in 2025 by approx-error
+
+  Minimal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Minimal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+  ======================================================================
+*/
+
+// miniwalk: Checks walk_ast() on trees built by hand
+//
+// Usage: miniwalk
+//
+// A small tree is walked with hooks that return VISIT_SKIP or VISIT_STOP at chosen nodes,
+// and the order of the calls and their depths must be the ones walk_ast() documents. Then
+// a chain of DEEP_NODES nodes linked by operands[0], one linked by list and a list of as
+// many nodes are walked, which would overflow the stack of a recursive walk: every node
+// must be visited once on the way down and once on the way up at the right depth. The
+// exit status is nonzero on any difference.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "inc/retcodes.h"
+#include "inc/ast.h"
+
+#define DEEP_NODES 300000
+#define TRACE_SIZE 256
+
+// The nodes of the small tree are told apart by their letter, kept in token.line
+typedef struct walk_trace {
+  char text[TRACE_SIZE];
+  size_t length;
+  uint32_t skip_pre;
+  uint32_t stop_pre;
+  uint32_t skip_post;
+  uint32_t stop_post;
+} WalkTrace;
+
+static void trace_call(WalkTrace *trace, char direction, MiniAstNode *node, int depth) {
+  trace->length += snprintf(trace->text + trace->length, TRACE_SIZE - trace->length, "%s%c%c%d",
+                            trace->length == 0 ? "" : " ", direction, (char) node->token.line, depth);
+}
+
+static MiniVisitAction trace_pre(MiniAstNode *node, int depth, void *context) {
+  WalkTrace *trace = context;
+  trace_call(trace, '+', node, depth);
+  if (node->token.line == trace->stop_pre) return VISIT_STOP;
+  if (node->token.line == trace->skip_pre) return VISIT_SKIP;
+  return VISIT_CONTINUE;
+}
+
+static MiniVisitAction trace_post(MiniAstNode *node, int depth, void *context) {
+  WalkTrace *trace = context;
+  trace_call(trace, '-', node, depth);
+  if (node->token.line == trace->stop_post) return VISIT_STOP;
+  if (node->token.line == trace->skip_post) return VISIT_SKIP;
+  return VISIT_CONTINUE;
+}
+
+static MiniAstNode *letter_node(MiniAst *ast, char letter) {
+  MiniStatus status;
+  MiniAstNode *node = alloc_ast_node(ast, AST_BLOCK, &status);
+  if (node == NULL) exit(EXIT_FAILURE);
+  node->token.line = letter;
+  return node;
+}
+
+// P: list A B C. A: operands[0] X, list Y Z. B: list W. D follows P by next and must not
+// be visited
+static MiniAstNode *small_tree(MiniAst *ast) {
+  MiniAstNode *p = letter_node(ast, 'P');
+  MiniAstNode *a = letter_node(ast, 'A');
+  MiniAstNode *b = letter_node(ast, 'B');
+  MiniAstNode *y = letter_node(ast, 'Y');
+  p->list = a;
+  p->next = letter_node(ast, 'D');
+  a->next = b;
+  b->next = letter_node(ast, 'C');
+  a->operands[0] = letter_node(ast, 'X');
+  a->list = y;
+  y->next = letter_node(ast, 'Z');
+  b->list = letter_node(ast, 'W');
+  return p;
+}
+
+typedef struct walk_case {
+  const char *name;
+  char skip_pre;
+  char stop_pre;
+  char skip_post;
+  char stop_post;
+  bool no_post;
+  const char *expected;
+} WalkCase;
+
+static const WalkCase walk_cases[] = {
+  {"Walking in source order", 0, 0, 0, 0, false,
+   "+P0 +A1 +X2 -X2 +Y2 -Y2 +Z2 -Z2 -A1 +B1 +W2 -W2 -B1 +C1 -C1 -P0"},
+  {"VISIT_SKIP from pre", 'A', 0, 0, 0, false,
+   "+P0 +A1 -A1 +B1 +W2 -W2 -B1 +C1 -C1 -P0"},
+  {"VISIT_SKIP from pre without post", 'A', 0, 0, 0, true,
+   "+P0 +A1 +B1 +W2 +C1"},
+  {"VISIT_SKIP from post", 0, 0, 'A', 0, false,
+   "+P0 +A1 +X2 -X2 +Y2 -Y2 +Z2 -Z2 -A1 +B1 +W2 -W2 -B1 +C1 -C1 -P0"},
+  {"VISIT_STOP from pre", 0, 'W', 0, 0, false,
+   "+P0 +A1 +X2 -X2 +Y2 -Y2 +Z2 -Z2 -A1 +B1 +W2"},
+  {"VISIT_STOP from post", 0, 0, 0, 'Z', false,
+   "+P0 +A1 +X2 -X2 +Y2 -Y2 +Z2 -Z2"},
+};
+
+static int check_small_tree(void) {
+  MiniAst ast = {.root = NULL, .blocks = NULL, .node_count = 0};
+  MiniAstNode *root = small_tree(&ast);
+  int failures = 0;
+  for (size_t i = 0; i < sizeof(walk_cases) / sizeof(walk_cases[0]); i++) {
+    const WalkCase *test = &walk_cases[i];
+    WalkTrace trace = {.length = 0, .skip_pre = test->skip_pre, .stop_pre = test->stop_pre,
+                       .skip_post = test->skip_post, .stop_post = test->stop_post};
+    trace.text[0] = '\0';
+    MiniAstVisitor visitor = {trace_pre, test->no_post ? NULL : trace_post, &trace};
+    MiniStatus status = walk_ast(root, &visitor);
+    if (status != SUCCESS || strcmp(trace.text, test->expected) != 0) {
+      fprintf(stderr, "miniwalk: %s: Got \"%s\", expected \"%s\"\n", test->name, trace.text, test->expected);
+      failures++;
+    }
+  }
+  free_ast(&ast);
+  return failures;
+}
+
+typedef struct walk_count {
+  size_t pre_count;
+  size_t post_count;
+  int max_depth;
+  int last_post_depth;
+  bool misordered;
+} WalkCount;
+
+static MiniVisitAction count_pre(MiniAstNode *node, int depth, void *context) {
+  WalkCount *count = context;
+  // Every node knows the depth it should be visited at
+  if ((int) node->token.line != depth) count->misordered = true;
+  if (depth > count->max_depth) count->max_depth = depth;
+  count->pre_count++;
+  return VISIT_CONTINUE;
+}
+
+static MiniVisitAction count_post(MiniAstNode *node, int depth, void *context) {
+  WalkCount *count = context;
+  if ((int) node->token.line != depth) count->misordered = true;
+  count->last_post_depth = depth;
+  count->post_count++;
+  return VISIT_CONTINUE;
+}
+
+typedef enum deep_shape {
+  DEEP_OPERANDS,
+  DEEP_LIST,
+  WIDE_LIST
+} DeepShape;
+
+static int check_deep_tree(DeepShape shape, const char *name) {
+  MiniAst ast = {.root = NULL, .blocks = NULL, .node_count = 0};
+  MiniStatus status;
+  MiniAstNode *root = alloc_ast_node(&ast, AST_UNARY, &status);
+  if (root == NULL) return 1;
+  root->token.line = 0;
+  MiniAstNode *last = root;
+  for (int i = 1; i < DEEP_NODES; i++) {
+    MiniAstNode *node = alloc_ast_node(&ast, AST_UNARY, &status);
+    if (node == NULL) {
+      free_ast(&ast);
+      return 1;
+    }
+    switch (shape) {
+      case DEEP_OPERANDS:
+        node->token.line = i;
+        last->operands[0] = node;
+        last = node;
+        break;
+      case DEEP_LIST:
+        node->token.line = i;
+        last->list = node;
+        last = node;
+        break;
+      case WIDE_LIST:
+        node->token.line = 1;
+        if (last == root) {
+          root->list = node;
+        } else {
+          last->next = node;
+        }
+        last = node;
+        break;
+    }
+  }
+
+  WalkCount count = {.pre_count = 0, .post_count = 0, .max_depth = 0, .last_post_depth = -1, .misordered = false};
+  MiniAstVisitor visitor = {count_pre, count_post, &count};
+  status = walk_ast(root, &visitor);
+  int expected_depth = shape == WIDE_LIST ? 1 : DEEP_NODES - 1;
+  int failures = 0;
+  if (status != SUCCESS || count.pre_count != DEEP_NODES || count.post_count != DEEP_NODES ||
+      count.max_depth != expected_depth || count.last_post_depth != 0 || count.misordered) {
+    fprintf(stderr, "miniwalk: %s: Visited %zu node(s) on the way down and %zu on the way up, %d deep, expected %d node(s) %d deep\n",
+            name, count.pre_count, count.post_count, count.max_depth, DEEP_NODES, expected_depth);
+    failures++;
+  }
+  free_ast(&ast);
+  return failures;
+}
+
+int main(void) {
+  int failures = check_small_tree();
+  failures += check_deep_tree(DEEP_OPERANDS, "Chain of operands");
+  failures += check_deep_tree(DEEP_LIST, "Chain of lists");
+  failures += check_deep_tree(WIDE_LIST, "Long list");
+  fprintf(stderr, "miniwalk: %d check(s) failed\n", failures);
+  return failures > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}